@@ -0,0 +1,328 @@
+#include "aes_batch.h"
+#include <openssl/crypto.h>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PASSWORD_MANAGER_HAVE_AES_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace EncryptionNS {
+
+const char *aesKernelName(AesKernel kernel) {
+    switch (kernel) {
+    case AesKernel::AesNi:
+        return "aes-ni";
+    case AesKernel::Vaes:
+        return "vaes";
+    default:
+        return "evp";
+    }
+}
+
+#ifdef PASSWORD_MANAGER_HAVE_AES_KERNELS
+
+// Only these functions use AES instructions; the rest of the file is plain x86-64, so the
+// build needs no -maes and the kernels are only entered once the CPU has been checked
+#define AES_NI_TARGET __attribute__((target("aes,sse4.1")))
+#define VAES_TARGET __attribute__((target("aes,vaes,avx2")))
+
+namespace {
+
+constexpr size_t rounds = 14; // AES-256
+
+// Wiped when it goes away, as EVP wipes its own key schedule; that covers the copies that are returned by value too
+struct RoundKeys {
+    alignas(16) unsigned char bytes[rounds + 1][16];
+
+    RoundKeys() = default;
+    RoundKeys(const RoundKeys &) = default;
+    RoundKeys &operator=(const RoundKeys &) = default;
+    ~RoundKeys() { OPENSSL_cleanse(bytes, sizeof(bytes)); }
+
+    const __m128i *keys() const { return reinterpret_cast<const __m128i *>(bytes); }
+    __m128i *keys() { return reinterpret_cast<__m128i *>(bytes); }
+};
+
+// One step of the AES-256 key schedule (the Intel AES-NI white paper's KEY_256_ASSIST_1 and _2)
+AES_NI_TARGET inline __m128i mixPrevious(__m128i key) {
+    __m128i shifted = _mm_slli_si128(key, 4);
+    key = _mm_xor_si128(key, shifted);
+    shifted = _mm_slli_si128(shifted, 4);
+    key = _mm_xor_si128(key, shifted);
+    shifted = _mm_slli_si128(shifted, 4);
+    return _mm_xor_si128(key, shifted);
+}
+
+template <int Rcon>
+AES_NI_TARGET inline void expandPair(__m128i &even, __m128i &odd, __m128i *out) {
+    even = _mm_xor_si128(mixPrevious(even), _mm_shuffle_epi32(_mm_aeskeygenassist_si128(odd, Rcon), 0xff));
+    out[0] = even;
+    odd = _mm_xor_si128(mixPrevious(odd), _mm_shuffle_epi32(_mm_aeskeygenassist_si128(even, 0), 0xaa));
+    out[1] = odd;
+}
+
+AES_NI_TARGET RoundKeys expandKey(const unsigned char *key) {
+    RoundKeys schedule;
+    __m128i *out = schedule.keys();
+    __m128i even = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key));
+    __m128i odd = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + 16));
+    out[0] = even;
+    out[1] = odd;
+    expandPair<0x01>(even, odd, out + 2);
+    expandPair<0x02>(even, odd, out + 4);
+    expandPair<0x04>(even, odd, out + 6);
+    expandPair<0x08>(even, odd, out + 8);
+    expandPair<0x10>(even, odd, out + 10);
+    expandPair<0x20>(even, odd, out + 12);
+    out[14] = _mm_xor_si128(mixPrevious(even), _mm_shuffle_epi32(_mm_aeskeygenassist_si128(odd, 0x40), 0xff));
+    return schedule;
+}
+
+// The equivalent inverse cipher runs the rounds backwards with InvMixColumns applied to the middle keys
+AES_NI_TARGET RoundKeys decryptionKeys(const RoundKeys &encryption) {
+    RoundKeys schedule;
+    const __m128i *in = encryption.keys();
+    __m128i *out = schedule.keys();
+    out[0] = in[rounds];
+    for (size_t i = 1; i < rounds; ++i) {
+        out[i] = _mm_aesimc_si128(in[rounds - i]);
+    }
+    out[rounds] = in[0];
+    return schedule;
+}
+
+// Full AES on every lane. Each round instruction has all lanes behind it, which is the point.
+using LaneCipher = void (*)(const RoundKeys &schedule, __m128i *lanes);
+
+AES_NI_TARGET void encryptLanesAesNi(const RoundKeys &schedule, __m128i *lanes) {
+    const __m128i *keys = schedule.keys();
+    __m128i state[8];
+    for (size_t l = 0; l < 8; ++l) {
+        state[l] = _mm_xor_si128(lanes[l], keys[0]);
+    }
+    for (size_t r = 1; r < rounds; ++r) {
+        for (size_t l = 0; l < 8; ++l) {
+            state[l] = _mm_aesenc_si128(state[l], keys[r]);
+        }
+    }
+    for (size_t l = 0; l < 8; ++l) {
+        lanes[l] = _mm_aesenclast_si128(state[l], keys[rounds]);
+    }
+}
+
+AES_NI_TARGET void decryptLanesAesNi(const RoundKeys &schedule, __m128i *lanes) {
+    const __m128i *keys = schedule.keys();
+    __m128i state[8];
+    for (size_t l = 0; l < 8; ++l) {
+        state[l] = _mm_xor_si128(lanes[l], keys[0]);
+    }
+    for (size_t r = 1; r < rounds; ++r) {
+        for (size_t l = 0; l < 8; ++l) {
+            state[l] = _mm_aesdec_si128(state[l], keys[r]);
+        }
+    }
+    for (size_t l = 0; l < 8; ++l) {
+        lanes[l] = _mm_aesdeclast_si128(state[l], keys[rounds]);
+    }
+}
+
+// VAES runs the same instruction on both halves of a 256-bit register: sixteen lanes in eight registers
+VAES_TARGET void encryptLanesVaes(const RoundKeys &schedule, __m128i *lanes) {
+    const __m128i *keys = schedule.keys();
+    __m256i state[8];
+    __m256i key = _mm256_broadcastsi128_si256(keys[0]);
+    for (size_t i = 0; i < 8; ++i) {
+        state[i] = _mm256_xor_si256(_mm256_inserti128_si256(_mm256_castsi128_si256(lanes[2 * i]), lanes[2 * i + 1], 1), key);
+    }
+    for (size_t r = 1; r < rounds; ++r) {
+        key = _mm256_broadcastsi128_si256(keys[r]);
+        for (size_t i = 0; i < 8; ++i) {
+            state[i] = _mm256_aesenc_epi128(state[i], key);
+        }
+    }
+    key = _mm256_broadcastsi128_si256(keys[rounds]);
+    for (size_t i = 0; i < 8; ++i) {
+        state[i] = _mm256_aesenclast_epi128(state[i], key);
+        lanes[2 * i] = _mm256_castsi256_si128(state[i]);
+        lanes[2 * i + 1] = _mm256_extracti128_si256(state[i], 1);
+    }
+}
+
+VAES_TARGET void decryptLanesVaes(const RoundKeys &schedule, __m128i *lanes) {
+    const __m128i *keys = schedule.keys();
+    __m256i state[8];
+    __m256i key = _mm256_broadcastsi128_si256(keys[0]);
+    for (size_t i = 0; i < 8; ++i) {
+        state[i] = _mm256_xor_si256(_mm256_inserti128_si256(_mm256_castsi128_si256(lanes[2 * i]), lanes[2 * i + 1], 1), key);
+    }
+    for (size_t r = 1; r < rounds; ++r) {
+        key = _mm256_broadcastsi128_si256(keys[r]);
+        for (size_t i = 0; i < 8; ++i) {
+            state[i] = _mm256_aesdec_epi128(state[i], key);
+        }
+    }
+    key = _mm256_broadcastsi128_si256(keys[rounds]);
+    for (size_t i = 0; i < 8; ++i) {
+        state[i] = _mm256_aesdeclast_epi128(state[i], key);
+        lanes[2 * i] = _mm256_castsi256_si128(state[i]);
+        lanes[2 * i + 1] = _mm256_extracti128_si256(state[i], 1);
+    }
+}
+
+// CBC encryption is sequential within an entry, so each lane carries one entry's chain and
+// takes the next entry as soon as its own is done. Idle lanes at the end encrypt garbage.
+template <size_t Lanes>
+void encryptChains(const RoundKeys &schedule, const std::vector<CbcBuffer> &buffers, LaneCipher cipher) {
+    const CbcBuffer *entry[Lanes] = {};
+    size_t block[Lanes] = {};
+    __m128i chain[Lanes];
+    __m128i lanes[Lanes];
+    size_t next = 0;
+    while (true) {
+        bool busy = false;
+        for (size_t l = 0; l < Lanes; ++l) {
+            if (entry[l] == nullptr) {
+                while (next < buffers.size() && buffers[next].blocks == 0) {
+                    ++next;
+                }
+                if (next < buffers.size()) {
+                    entry[l] = &buffers[next++];
+                    block[l] = 0;
+                    chain[l] = _mm_setzero_si128(); // Zero IV, as in encrypt()
+                }
+            }
+            busy = busy || entry[l] != nullptr;
+        }
+        if (!busy) {
+            return;
+        }
+
+        for (size_t l = 0; l < Lanes; ++l) {
+            lanes[l] = entry[l] == nullptr
+                           ? chain[l]
+                           : _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(entry[l]->input + 16 * block[l])),
+                                           chain[l]);
+        }
+        cipher(schedule, lanes);
+        for (size_t l = 0; l < Lanes; ++l) {
+            if (entry[l] != nullptr) {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(entry[l]->output + 16 * block[l]), lanes[l]);
+                chain[l] = lanes[l];
+                if (++block[l] == entry[l]->blocks) {
+                    entry[l] = nullptr;
+                }
+            }
+        }
+    }
+}
+
+// CBC decryption has no chain to wait for: every block only needs the ciphertext before it,
+// so all blocks of all entries simply go through the lanes in order
+template <size_t Lanes>
+void decryptBlocks(const RoundKeys &schedule, const std::vector<CbcBuffer> &buffers, LaneCipher cipher) {
+    const unsigned char *input[Lanes];
+    const unsigned char *previous[Lanes];
+    unsigned char *output[Lanes];
+    __m128i lanes[Lanes];
+    size_t entry = 0;
+    size_t block = 0;
+    while (true) {
+        size_t count = 0;
+        while (count < Lanes) {
+            while (entry < buffers.size() && block == buffers[entry].blocks) {
+                ++entry;
+                block = 0;
+            }
+            if (entry == buffers.size()) {
+                break;
+            }
+            input[count] = buffers[entry].input + 16 * block;
+            previous[count] = block == 0 ? nullptr : input[count] - 16;
+            output[count] = buffers[entry].output + 16 * block;
+            ++block;
+            ++count;
+        }
+        if (count == 0) {
+            OPENSSL_cleanse(lanes, sizeof(lanes)); // The last plaintext blocks
+            return;
+        }
+
+        for (size_t l = 0; l < Lanes; ++l) {
+            lanes[l] = l < count ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(input[l])) : _mm_setzero_si128();
+        }
+        cipher(schedule, lanes);
+        for (size_t l = 0; l < count; ++l) {
+            __m128i chained = previous[l] == nullptr ? _mm_setzero_si128()
+                                                     : _mm_loadu_si128(reinterpret_cast<const __m128i *>(previous[l]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output[l]), _mm_xor_si128(lanes[l], chained));
+        }
+    }
+}
+
+void checkKernel(AesKernel kernel) {
+    if (kernel == AesKernel::Evp || !aesKernelAvailable(kernel)) {
+        throw std::invalid_argument(std::string("The ") + aesKernelName(kernel) + " AES kernel is not available.");
+    }
+}
+
+} // namespace
+
+bool aesKernelAvailable(AesKernel kernel) {
+    switch (kernel) {
+    case AesKernel::AesNi:
+        return __builtin_cpu_supports("aes");
+    case AesKernel::Vaes:
+        return __builtin_cpu_supports("aes") && __builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx2");
+    default:
+        return true;
+    }
+}
+
+void cbcEncryptBatch(AesKernel kernel, const unsigned char *key, const std::vector<CbcBuffer> &buffers) {
+    checkKernel(kernel);
+    RoundKeys schedule = expandKey(key);
+    if (kernel == AesKernel::Vaes) {
+        encryptChains<16>(schedule, buffers, encryptLanesVaes);
+    } else {
+        encryptChains<8>(schedule, buffers, encryptLanesAesNi);
+    }
+}
+
+void cbcDecryptBatch(AesKernel kernel, const unsigned char *key, const std::vector<CbcBuffer> &buffers) {
+    checkKernel(kernel);
+    RoundKeys schedule = decryptionKeys(expandKey(key));
+    if (kernel == AesKernel::Vaes) {
+        decryptBlocks<16>(schedule, buffers, decryptLanesVaes);
+    } else {
+        decryptBlocks<8>(schedule, buffers, decryptLanesAesNi);
+    }
+}
+
+#else
+
+bool aesKernelAvailable(AesKernel kernel) {
+    return kernel == AesKernel::Evp;
+}
+
+void cbcEncryptBatch(AesKernel kernel, const unsigned char *, const std::vector<CbcBuffer> &) {
+    throw std::invalid_argument(std::string("The ") + aesKernelName(kernel) + " AES kernel is not available.");
+}
+
+void cbcDecryptBatch(AesKernel kernel, const unsigned char *, const std::vector<CbcBuffer> &) {
+    throw std::invalid_argument(std::string("The ") + aesKernelName(kernel) + " AES kernel is not available.");
+}
+
+#endif
+
+std::vector<AesKernel> availableAesKernels() {
+    std::vector<AesKernel> kernels;
+    for (AesKernel kernel : {AesKernel::Vaes, AesKernel::AesNi, AesKernel::Evp}) {
+        if (aesKernelAvailable(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+} // namespace EncryptionNS
@@ -0,0 +1,42 @@
+#ifndef AES_BATCH_H
+#define AES_BATCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace EncryptionNS
+{
+
+    // Multi-buffer AES-256-CBC kernels behind encryptBatch() and decryptBatch() (encryption.h).
+    // One CBC chain can only go block by block, and a vault entry is one or two blocks long, so
+    // a lone entry leaves the AES unit waiting on each round. These kernels run several entries
+    // side by side, one per lane, so every round instruction has independent work behind it.
+    enum class AesKernel
+    {
+        Evp,   // No kernel: the callers loop over the OpenSSL EVP path
+        AesNi, // AES-NI, eight entries in eight 128-bit registers
+        Vaes   // VAES with AVX2, sixteen entries in eight 256-bit registers
+    };
+
+    // One entry: blocks whole 16-byte blocks from input to output, with a zero IV like encrypt()
+    struct CbcBuffer
+    {
+        const unsigned char *input;
+        unsigned char *output;
+        size_t blocks;
+    };
+
+    const char *aesKernelName(AesKernel kernel);
+    std::vector<AesKernel> availableAesKernels(); // Best first; always ends with Evp
+    bool aesKernelAvailable(AesKernel kernel);
+
+    // key is 32 bytes. Padding is the caller's job. Encryption may work in place; decryption
+    // reads each previous ciphertext block after the fact, so it needs a separate output.
+    // Throws std::invalid_argument for the Evp kernel or one this CPU does not have.
+    void cbcEncryptBatch(AesKernel kernel, const unsigned char *key, const std::vector<CbcBuffer> &buffers);
+    void cbcDecryptBatch(AesKernel kernel, const unsigned char *key, const std::vector<CbcBuffer> &buffers);
+
+} // namespace EncryptionNS
+
+#endif
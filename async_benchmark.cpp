@@ -0,0 +1,140 @@
+// async_benchmark.cpp
+// Runs one session per vault (load it, decrypt a few passwords, add an entry, save it) for
+// many vaults: first one blocking call after another, then all sessions at once on an
+// Executor driven by this thread, with decryption and saves on its workers and vault reads
+// through its file I/O. Built as C++20, each session is a coroutine using co_await; otherwise
+// the same steps are chained with then().
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "async_task.h"
+#include "manager.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+const std::string benchPassword = "Passw0rd-benchmark";
+
+std::string serviceName(size_t index) { return "service" + std::to_string(index); }
+
+double millisecondsFor(const std::function<void()> &operation) {
+    auto start = std::chrono::steady_clock::now();
+    operation();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+#if defined(__cpp_impl_coroutine)
+Task<void> session(PasswordManager &vault, Executor &executor, size_t entries, size_t lookups, size_t &mismatches) {
+    co_await vault.loadAsync(executor);
+    for (size_t i = 0; i < lookups; ++i) {
+        std::optional<std::string> password = co_await vault.getDecryptedCredentialAsync(serviceName(i * 7 % entries), executor);
+        mismatches += password != benchPassword;
+    }
+    vault.addNewPassword("added", "user", benchPassword);
+    co_await vault.saveAsync(executor);
+}
+#else
+Task<void> session(PasswordManager &vault, Executor &executor, size_t entries, size_t lookups, size_t &mismatches) {
+    Task<void> steps = vault.loadAsync(executor);
+    for (size_t i = 0; i < lookups; ++i) {
+        steps = steps.then([&vault, &executor, &mismatches, entries, i]() {
+            return vault.getDecryptedCredentialAsync(serviceName(i * 7 % entries), executor)
+                .then([&mismatches](std::optional<std::string> password) { mismatches += password != benchPassword; });
+        });
+    }
+    return steps.then([&vault, &executor]() {
+        vault.addNewPassword("added", "user", benchPassword);
+        return vault.saveAsync(executor);
+    });
+}
+#endif
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t vaults = argc > 1 ? std::stoull(argv[1]) : 2000;
+    size_t entries = argc > 2 ? std::stoull(argv[2]) : 50;
+    size_t lookups = argc > 3 ? std::stoull(argv[3]) : 4;
+
+    // Work in a scratch directory so the benchmark never touches real vaults
+    auto originalDirectory = std::filesystem::current_path();
+    auto workDirectory = std::filesystem::temp_directory_path() / "password_manager_async_benchmark";
+    std::filesystem::remove_all(workDirectory);
+    std::filesystem::create_directories(workDirectory);
+    std::filesystem::current_path(workDirectory);
+
+    // Managers report adds and their own destruction on the console; keep that out of the output
+    std::streambuf *console = std::cout.rdbuf(nullptr);
+    CredentialList vault;
+    std::string encrypted = PasswordManager::encryptToHex(benchPassword, PasswordManager::getDefaultEncryptionKey());
+    for (size_t i = 0; i < entries; ++i) {
+        vault.emplace_back(serviceName(i), "user" + std::to_string(i) + ":" + encrypted);
+    }
+    std::vector<std::unique_ptr<PasswordManager>> managers;
+    for (size_t i = 0; i < vaults; ++i) {
+        managers.push_back(std::make_unique<PasswordManager>());
+        managers.back()->setCompressOnExit(false);
+        managers.back()->setUsername("vault" + std::to_string(i));
+        managers.back()->restoreCredentialList(vault);
+    }
+
+    size_t mismatches = 0;
+    double blocking = millisecondsFor([&] {
+        for (auto &manager : managers) {
+            manager->loadCredentialsFromFile();
+            for (size_t i = 0; i < lookups; ++i) {
+                std::optional<std::string> hex = manager->getCredential(serviceName(i * 7 % entries));
+                mismatches += !hex || PasswordManager::decryptFromHex(*hex, PasswordManager::getDefaultEncryptionKey()) != benchPassword;
+            }
+            manager->addNewPassword("added", "user", benchPassword);
+            manager->saveCredentials();
+        }
+    });
+
+    for (auto &manager : managers) {
+        manager->restoreCredentialList(vault); // Undo the blocking run's add
+    }
+    Executor executor;
+    size_t failures = 0;
+    double concurrent = millisecondsFor([&] {
+        std::vector<Task<void>> sessions;
+        for (auto &manager : managers) {
+            sessions.push_back(session(*manager, executor, entries, lookups, mismatches));
+        }
+        executor.run();
+        for (auto &task : sessions) {
+            try {
+                task.get();
+            } catch (const std::exception &) {
+                ++failures;
+            }
+        }
+    });
+    managers.clear();
+    std::cout.rdbuf(console);
+
+    std::cout << vaults << " sessions (load a " << entries << "-entry vault, decrypt " << lookups
+              << " passwords, add an entry, save)\n";
+    std::cout << "Executor: " << executor.workerCount() << " workers, " << executor.ioEngineName() << " file I/O, "
+#if defined(__cpp_impl_coroutine)
+              << "coroutine sessions\n\n";
+#else
+              << "continuation sessions\n\n";
+#endif
+    for (auto [label, milliseconds] : {std::pair<const char *, double>("Blocking, one after another", blocking),
+                                       std::pair<const char *, double>("Concurrent on one executor", concurrent)}) {
+        std::cout << std::left << std::setw(30) << label << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << milliseconds << " ms" << std::setw(12) << vaults / (milliseconds / 1e3)
+                  << " sessions/s\n";
+    }
+
+    std::filesystem::current_path(originalDirectory);
+    std::filesystem::remove_all(workDirectory);
+    return mismatches == 0 && failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,586 @@
+#include "async_io.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "durable_file.h"
+#include "worker_pool.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define PASSWORD_MANAGER_HAVE_IO_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace PasswordNS {
+
+struct AsyncFileIO::Implementation {
+    virtual ~Implementation() noexcept = default;
+    virtual Engine engine() const = 0;
+    virtual void read(std::string path, ReadCallback callback) = 0;
+    virtual void write(std::string path, std::string contents, bool sync, WriteCallback callback) = 0;
+};
+
+namespace {
+
+std::string readWholeFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::ios_base::failure("Unable to open '" + path + "' for reading.");
+    }
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (file.bad()) {
+        throw std::ios_base::failure("Unable to read '" + path + "'.");
+    }
+    return contents;
+}
+
+// Blocking reads and writes on a WorkerPool: the portable engine, and the fallback for io_uring
+class PoolEngine : public AsyncFileIO::Implementation {
+public:
+    explicit PoolEngine(size_t threads) : pool(std::max<size_t>(1, threads)) {}
+
+    AsyncFileIO::Engine engine() const override { return AsyncFileIO::Engine::ThreadPool; }
+
+    void read(std::string path, AsyncFileIO::ReadCallback callback) override {
+        pool.submit([path = std::move(path), callback = std::move(callback)]() {
+            std::string contents;
+            std::exception_ptr error;
+            try {
+                contents = readWholeFile(path);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            callback(std::move(contents), error);
+        });
+    }
+
+    void write(std::string path, std::string contents, bool sync, AsyncFileIO::WriteCallback callback) override {
+        pool.submit([path = std::move(path), contents = std::move(contents), sync, callback = std::move(callback)]() {
+            std::exception_ptr error;
+            try {
+                writeFileAtomically(path, contents, sync);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            callback(error);
+        });
+    }
+
+private:
+    WorkerPool pool;
+};
+
+#ifdef PASSWORD_MANAGER_HAVE_IO_URING
+
+std::ios_base::failure ioError(const std::string &what, const std::string &path, int error) {
+    return std::ios_base::failure(what + " '" + path + "': " + std::strerror(error));
+}
+
+// io_uring through its system calls, so the build needs only the kernel header (no liburing).
+// One thread owns the ring. Each operation in flight holds one registered buffer for its whole
+// life and has one request in the ring at a time: the next chunk of a file is submitted when
+// the previous one completes. An eventfd poll in the ring wakes the thread for new work.
+class UringEngine : public AsyncFileIO::Implementation {
+public:
+    explicit UringEngine(const AsyncIoOptions &options)
+        : depth(std::max<size_t>(1, options.queueDepth)), bufferSize(std::max<size_t>(4096, options.bufferSize)) {
+        io_uring_params params{};
+        ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(depth + 1), &params));
+        if (ringFd < 0) {
+            throw ioError("Unable to set up", "io_uring", errno);
+        }
+        try {
+            mapRing(params);
+            buffers.reset(static_cast<char *>(::operator new(depth * bufferSize, std::align_val_t(4096))));
+            std::vector<iovec> vectors(depth);
+            for (size_t slot = 0; slot < depth; ++slot) {
+                vectors[slot] = {bufferAt(slot), bufferSize};
+                freeSlots.push_back(slot);
+            }
+            // Pinning counts against RLIMIT_MEMLOCK; without it, plain reads into the same buffers still work
+            fixedBuffers = ::syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, vectors.data(),
+                                     static_cast<unsigned>(vectors.size())) == 0;
+            wakeFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (wakeFd < 0) {
+                throw ioError("Unable to create", "eventfd", errno);
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+        thread = std::thread(&UringEngine::run, this);
+    }
+
+    ~UringEngine() noexcept override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake();
+        thread.join();
+        release();
+    }
+
+    AsyncFileIO::Engine engine() const override { return AsyncFileIO::Engine::IoUring; }
+
+    void read(std::string path, AsyncFileIO::ReadCallback callback) override {
+        auto operation = std::make_unique<Operation>();
+        operation->path = std::move(path);
+        operation->onRead = std::move(callback);
+        enqueue(std::move(operation));
+    }
+
+    void write(std::string path, std::string contents, bool sync, AsyncFileIO::WriteCallback callback) override {
+        auto operation = std::make_unique<Operation>();
+        operation->writing = true;
+        operation->path = std::move(path);
+        operation->contents = std::move(contents);
+        operation->sync = sync;
+        operation->onWrite = std::move(callback);
+        enqueue(std::move(operation));
+    }
+
+private:
+    struct Operation {
+        bool writing = false;
+        bool sync = false;
+        bool syncing = false; // The fsync is in the ring
+        std::string path;
+        std::string temporaryPath;
+        std::string contents; // Read so far, or to write
+        int fd = -1;
+        size_t offset = 0;
+        size_t slot = 0;
+        AsyncFileIO::ReadCallback onRead;
+        AsyncFileIO::WriteCallback onWrite;
+    };
+
+    struct BufferDelete {
+        void operator()(char *buffer) const { ::operator delete(buffer, std::align_val_t(4096)); }
+    };
+
+    static constexpr uint64_t wakeTag = 0; // user_data of the eventfd poll; operations use their address
+
+    size_t depth;
+    size_t bufferSize;
+    int ringFd = -1;
+    int wakeFd = -1;
+    void *submissionRing = MAP_FAILED;
+    void *completionRing = MAP_FAILED;
+    size_t submissionRingSize = 0;
+    size_t completionRingSize = 0;
+    io_uring_sqe *entries = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t entriesSize = 0;
+    unsigned *submissionTail = nullptr;
+    unsigned submissionMask = 0;
+    unsigned *submissionArray = nullptr;
+    unsigned *completionHead = nullptr;
+    unsigned *completionTail = nullptr;
+    unsigned completionMask = 0;
+    io_uring_cqe *completions = nullptr;
+    unsigned toSubmit = 0;
+
+    std::unique_ptr<char, BufferDelete> buffers;
+    bool fixedBuffers = false;
+    std::vector<size_t> freeSlots;          // Ring thread only
+    std::vector<std::unique_ptr<Operation>> active; // Ring thread only
+
+    std::mutex mutex;
+    std::deque<std::unique_ptr<Operation>> incoming;
+    bool stopping = false;
+    std::thread thread;
+
+    char *bufferAt(size_t slot) const { return buffers.get() + slot * bufferSize; }
+
+    void mapRing(const io_uring_params &params) {
+        submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            submissionRingSize = completionRingSize = std::max(submissionRingSize, completionRingSize);
+        }
+        submissionRing = ::mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                                IORING_OFF_SQ_RING);
+        if (submissionRing == MAP_FAILED) {
+            throw ioError("Unable to map", "io_uring", errno);
+        }
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            completionRing = submissionRing;
+        } else {
+            completionRing = ::mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                    ringFd, IORING_OFF_CQ_RING);
+            if (completionRing == MAP_FAILED) {
+                throw ioError("Unable to map", "io_uring", errno);
+            }
+        }
+        entriesSize = params.sq_entries * sizeof(io_uring_sqe);
+        entries = static_cast<io_uring_sqe *>(::mmap(nullptr, entriesSize, PROT_READ | PROT_WRITE,
+                                                     MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES));
+        if (entries == MAP_FAILED) {
+            throw ioError("Unable to map", "io_uring", errno);
+        }
+
+        char *submission = static_cast<char *>(submissionRing);
+        char *completion = static_cast<char *>(completionRing);
+        submissionTail = reinterpret_cast<unsigned *>(submission + params.sq_off.tail);
+        submissionMask = *reinterpret_cast<unsigned *>(submission + params.sq_off.ring_mask);
+        submissionArray = reinterpret_cast<unsigned *>(submission + params.sq_off.array);
+        completionHead = reinterpret_cast<unsigned *>(completion + params.cq_off.head);
+        completionTail = reinterpret_cast<unsigned *>(completion + params.cq_off.tail);
+        completionMask = *reinterpret_cast<unsigned *>(completion + params.cq_off.ring_mask);
+        completions = reinterpret_cast<io_uring_cqe *>(completion + params.cq_off.cqes);
+    }
+
+    void release() noexcept {
+        if (entries != MAP_FAILED) {
+            ::munmap(entries, entriesSize);
+        }
+        if (completionRing != MAP_FAILED && completionRing != submissionRing) {
+            ::munmap(completionRing, completionRingSize);
+        }
+        if (submissionRing != MAP_FAILED) {
+            ::munmap(submissionRing, submissionRingSize);
+        }
+        if (wakeFd >= 0) {
+            ::close(wakeFd);
+        }
+        if (ringFd >= 0) {
+            ::close(ringFd); // Also drops the buffer registration
+        }
+        entries = static_cast<io_uring_sqe *>(MAP_FAILED);
+        completionRing = submissionRing = MAP_FAILED;
+        wakeFd = ringFd = -1;
+    }
+
+    void enqueue(std::unique_ptr<Operation> operation) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            incoming.push_back(std::move(operation));
+        }
+        wake();
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written; // EAGAIN means the counter is already non-zero, which wakes the ring just as well
+    }
+
+    // Only the ring thread touches the submission queue; the tail store publishes the entry
+    io_uring_sqe *nextEntry(uint64_t userData) {
+        unsigned tail = *submissionTail;
+        unsigned index = tail & submissionMask;
+        io_uring_sqe *entry = &entries[index];
+        std::memset(entry, 0, sizeof(*entry));
+        entry->user_data = userData;
+        submissionArray[index] = index;
+        __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+        ++toSubmit;
+        return entry;
+    }
+
+    void armWakeup() {
+        io_uring_sqe *entry = nextEntry(wakeTag);
+        entry->opcode = IORING_OP_POLL_ADD;
+        entry->fd = wakeFd;
+        entry->poll32_events = POLLIN;
+    }
+
+    void submitTransfer(Operation &operation) {
+        io_uring_sqe *entry = nextEntry(reinterpret_cast<uint64_t>(&operation));
+        size_t length = bufferSize;
+        if (operation.writing) {
+            length = std::min(bufferSize, operation.contents.size() - operation.offset);
+            std::memcpy(bufferAt(operation.slot), operation.contents.data() + operation.offset, length);
+            entry->opcode = fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        } else {
+            entry->opcode = fixedBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        }
+        entry->fd = operation.fd;
+        entry->addr = reinterpret_cast<uint64_t>(bufferAt(operation.slot));
+        entry->len = static_cast<unsigned>(length);
+        entry->off = operation.offset;
+        if (fixedBuffers) {
+            entry->buf_index = static_cast<uint16_t>(operation.slot);
+        }
+    }
+
+    void submitSync(Operation &operation) {
+        io_uring_sqe *entry = nextEntry(reinterpret_cast<uint64_t>(&operation));
+        entry->opcode = IORING_OP_FSYNC;
+        entry->fd = operation.fd;
+        operation.syncing = true;
+    }
+
+    // Opens the file (open(2) is cheap next to the transfers) and puts the first request in the ring
+    void start(std::unique_ptr<Operation> operation) {
+        operation->slot = freeSlots.back();
+        freeSlots.pop_back();
+        Operation &current = *operation;
+        active.push_back(std::move(operation));
+        if (current.writing) {
+            current.temporaryPath = temporaryPathFor(current.path);
+            current.fd = ::open(current.temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+            if (current.fd < 0) {
+                finish(current, std::make_exception_ptr(ioError("Unable to open", current.temporaryPath, errno)));
+            } else if (current.contents.empty()) {
+                advanceWrite(current);
+            } else {
+                submitTransfer(current);
+            }
+            return;
+        }
+        current.fd = ::open(current.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (current.fd < 0) {
+            finish(current, std::make_exception_ptr(
+                                std::ios_base::failure("Unable to open '" + current.path + "' for reading.")));
+            return;
+        }
+        struct stat status{};
+        if (::fstat(current.fd, &status) == 0 && status.st_size > 0) {
+            current.contents.reserve(static_cast<size_t>(status.st_size));
+        }
+        submitTransfer(current);
+    }
+
+    // After a write completed: more data, the fsync, or the rename that publishes the file
+    void advanceWrite(Operation &operation) {
+        if (operation.offset < operation.contents.size()) {
+            submitTransfer(operation);
+            return;
+        }
+        if (operation.sync && !operation.syncing) {
+            submitSync(operation);
+            return;
+        }
+        std::exception_ptr error;
+        try {
+            int fd = operation.fd;
+            operation.fd = -1;
+            if (::close(fd) != 0) {
+                throw ioError("Unable to close", operation.temporaryPath, errno);
+            }
+            if (std::rename(operation.temporaryPath.c_str(), operation.path.c_str()) != 0) {
+                throw ioError("Unable to replace", operation.path, errno);
+            }
+            if (operation.sync) {
+                syncDirectoryOf(operation.path);
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        finish(operation, error);
+    }
+
+    void complete(Operation &operation, int result) {
+        if (result == -EINTR || result == -EAGAIN) {
+            operation.syncing ? submitSync(operation) : submitTransfer(operation);
+            return;
+        }
+        if (result < 0) {
+            const char *action = operation.syncing ? "Unable to sync" : operation.writing ? "Unable to write" : "Unable to read";
+            finish(operation, std::make_exception_ptr(
+                                  ioError(action, operation.writing ? operation.temporaryPath : operation.path, -result)));
+            return;
+        }
+        if (operation.writing) {
+            operation.offset += operation.syncing ? 0 : static_cast<size_t>(result);
+            advanceWrite(operation);
+        } else if (result == 0) {
+            finish(operation, nullptr);
+        } else {
+            operation.contents.append(bufferAt(operation.slot), static_cast<size_t>(result));
+            operation.offset += static_cast<size_t>(result);
+            submitTransfer(operation);
+        }
+    }
+
+    // Releases the operation's file and buffer, then reports it
+    void finish(Operation &operation, std::exception_ptr error) {
+        if (operation.fd >= 0) {
+            ::close(operation.fd);
+            operation.fd = -1;
+        }
+        if (operation.writing && error) {
+            std::remove(operation.temporaryPath.c_str());
+        }
+        freeSlots.push_back(operation.slot);
+        auto found = std::find_if(active.begin(), active.end(),
+                                  [&operation](const std::unique_ptr<Operation> &entry) { return entry.get() == &operation; });
+        std::unique_ptr<Operation> finished = std::move(*found);
+        *found = std::move(active.back());
+        active.pop_back();
+
+        try {
+            if (finished->writing) {
+                finished->onWrite(error);
+            } else {
+                finished->onRead(error ? std::string() : std::move(finished->contents), error);
+            }
+        } catch (...) {
+            // Callbacks must not throw; the ring thread has nobody to report to
+        }
+    }
+
+    void run() {
+        armWakeup();
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                std::deque<std::unique_ptr<Operation>> ready;
+                while (!incoming.empty() && ready.size() < freeSlots.size()) {
+                    ready.push_back(std::move(incoming.front()));
+                    incoming.pop_front();
+                }
+                if (stopping && incoming.empty() && ready.empty() && active.empty()) {
+                    return;
+                }
+                lock.unlock();
+                for (auto &operation : ready) {
+                    start(std::move(operation));
+                }
+            }
+
+            // Submit everything queued and sleep until at least one completion arrives
+            int entered = static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, 1u,
+                                                     IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (entered < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                std::perror("io_uring_enter");
+                std::abort(); // The ring is unusable and operations in it can never be reported
+            }
+            if (entered > 0) {
+                toSubmit -= static_cast<unsigned>(entered);
+            }
+
+            unsigned head = *completionHead;
+            unsigned tail = __atomic_load_n(completionTail, __ATOMIC_ACQUIRE);
+            std::vector<std::pair<uint64_t, int>> reaped;
+            for (; head != tail; ++head) {
+                const io_uring_cqe &completion = completions[head & completionMask];
+                reaped.emplace_back(completion.user_data, completion.res);
+            }
+            __atomic_store_n(completionHead, head, __ATOMIC_RELEASE);
+            for (const auto &[userData, result] : reaped) {
+                if (userData == wakeTag) {
+                    uint64_t count;
+                    ssize_t drained = ::read(wakeFd, &count, sizeof(count));
+                    (void)drained;
+                    armWakeup();
+                } else {
+                    complete(*reinterpret_cast<Operation *>(userData), result);
+                }
+            }
+        }
+    }
+};
+
+#endif
+
+} // namespace
+
+AsyncFileIO::AsyncFileIO(AsyncIoOptions options) {
+#ifdef PASSWORD_MANAGER_HAVE_IO_URING
+    if (options.useIoUring) {
+        try {
+            implementation = std::make_unique<UringEngine>(options);
+        } catch (const std::exception &) {
+            // Kernels before 5.6, and sandboxes that block io_uring, get the thread pool
+        }
+    }
+#endif
+    if (!implementation) {
+        implementation = std::make_unique<PoolEngine>(options.threads);
+    }
+}
+
+AsyncFileIO::~AsyncFileIO() noexcept = default;
+
+AsyncFileIO::Engine AsyncFileIO::engine() const {
+    return implementation->engine();
+}
+
+void AsyncFileIO::read(const std::string &path, ReadCallback callback) {
+    implementation->read(path, std::move(callback));
+}
+
+void AsyncFileIO::write(const std::string &path, std::string contents, bool sync, WriteCallback callback) {
+    implementation->write(path, std::move(contents), sync, std::move(callback));
+}
+
+std::future<std::string> AsyncFileIO::read(const std::string &path) {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> result = promise->get_future();
+    read(path, [promise](std::string contents, std::exception_ptr error) {
+        error ? promise->set_exception(error) : promise->set_value(std::move(contents));
+    });
+    return result;
+}
+
+std::future<void> AsyncFileIO::write(const std::string &path, std::string contents, bool sync) {
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> result = promise->get_future();
+    write(path, std::move(contents), sync, [promise](std::exception_ptr error) {
+        error ? promise->set_exception(error) : promise->set_value();
+    });
+    return result;
+}
+
+// Read a Batch of Files
+std::vector<FileResult> AsyncFileIO::readAll(const std::vector<std::string> &paths) {
+    std::vector<FileResult> results(paths.size());
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t pending = paths.size();
+    for (size_t i = 0; i < paths.size(); ++i) {
+        results[i].path = paths[i];
+        read(paths[i], [&, i](std::string contents, std::exception_ptr error) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results[i].contents = std::move(contents);
+            results[i].error = error;
+            if (--pending == 0) {
+                finished.notify_one();
+            }
+        });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&pending] { return pending == 0; });
+    return results;
+}
+
+// Write a Batch of Files
+std::vector<FileResult> AsyncFileIO::writeAll(std::vector<std::pair<std::string, std::string>> files, bool sync) {
+    std::vector<FileResult> results(files.size());
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t pending = files.size();
+    for (size_t i = 0; i < files.size(); ++i) {
+        results[i].path = files[i].first;
+        write(files[i].first, std::move(files[i].second), sync, [&, i](std::exception_ptr error) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results[i].error = error;
+            if (--pending == 0) {
+                finished.notify_one();
+            }
+        });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&pending] { return pending == 0; });
+    return results;
+}
+
+} // namespace PasswordNS
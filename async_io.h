@@ -0,0 +1,79 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace PasswordNS
+{
+
+    struct AsyncIoOptions
+    {
+        size_t queueDepth = 32;         // Reads and writes in flight at once
+        size_t bufferSize = 64 << 10;   // Bytes per registered buffer; larger files take several rounds
+        size_t threads = 4;             // Workers of the thread-pool engine
+        bool useIoUring = true;         // False forces the thread-pool engine
+    };
+
+    // Outcome of one file of a batch
+    struct FileResult
+    {
+        std::string path;
+        std::string contents;     // What was read (reads only)
+        std::exception_ptr error; // std::ios_base::failure when the file could not be read or written
+    };
+
+    // Runs whole-file reads and atomic whole-file writes (the writeFileAtomically contract of
+    // durable_file.h) in the background. On Linux the engine is io_uring: one thread owns a
+    // submission ring and a set of registered buffers, keeps up to queueDepth operations in
+    // flight and reaps their completions in batches, so many small vault files cost a few
+    // system calls instead of several each. Elsewhere, or when the kernel refuses io_uring,
+    // the same calls run blocking I/O on a WorkerPool.
+    //
+    // Callbacks run on an I/O thread and must not block on further I/O from this object.
+    // The destructor waits for everything submitted. All methods are thread-safe.
+    class AsyncFileIO
+    {
+    public:
+        enum class Engine
+        {
+            IoUring,
+            ThreadPool
+        };
+
+        using ReadCallback = std::function<void(std::string contents, std::exception_ptr error)>;
+        using WriteCallback = std::function<void(std::exception_ptr error)>;
+
+        explicit AsyncFileIO(AsyncIoOptions options = AsyncIoOptions());
+        ~AsyncFileIO() noexcept;
+
+        AsyncFileIO(const AsyncFileIO &) = delete;
+        AsyncFileIO &operator=(const AsyncFileIO &) = delete;
+
+        Engine engine() const;
+        const char *engineName() const { return engine() == Engine::IoUring ? "io_uring" : "thread pool"; }
+
+        void read(const std::string &path, ReadCallback callback);
+        void write(const std::string &path, std::string contents, bool sync, WriteCallback callback);
+        std::future<std::string> read(const std::string &path);
+        std::future<void> write(const std::string &path, std::string contents, bool sync);
+
+        // Submits the whole batch and waits for it; results keep the order of the input
+        std::vector<FileResult> readAll(const std::vector<std::string> &paths);
+        std::vector<FileResult> writeAll(std::vector<std::pair<std::string, std::string>> files, bool sync);
+
+        struct Implementation; // One per engine, in async_io.cpp
+
+    private:
+        std::unique_ptr<Implementation> implementation;
+    };
+
+} // namespace PasswordNS
+
+#endif
@@ -0,0 +1,96 @@
+#include "async_task.h"
+
+namespace PasswordNS {
+
+Executor::Executor(size_t workerThreads, AsyncIoOptions ioOptions) : pool(workerThreads), io(ioOptions) {}
+
+// Computations, the pool and the I/O engine drain first: work they finish only queues jobs nobody runs
+Executor::~Executor() noexcept = default;
+
+void Executor::hold() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++outstanding;
+}
+
+void Executor::deliver(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void Executor::post(std::function<void()> function) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++outstanding;
+        ready.push_back(std::move(function));
+    }
+    wake.notify_one();
+}
+
+// Run One Job, Waiting for Work Still Being Produced Elsewhere
+bool Executor::runOne() {
+    std::function<void()> job;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this]() { return !ready.empty() || outstanding == 0; });
+        if (ready.empty()) {
+            return false;
+        }
+        job = std::move(ready.front());
+        ready.pop_front();
+        --outstanding;
+    }
+    job();
+    return true;
+}
+
+// Run the Loop Until No Work Is Left
+size_t Executor::run() {
+    size_t jobs = 0;
+    while (runOne()) {
+        ++jobs;
+    }
+    return jobs;
+}
+
+Task<std::string> Executor::readFile(const std::string &path) {
+    auto state = std::make_shared<detail::TaskState<std::string>>(this);
+    hold();
+    try {
+        io.read(path, [this, state](std::string contents, std::exception_ptr error) {
+            if (error) {
+                state->error = error;
+            } else {
+                state->value.emplace(std::move(contents));
+            }
+            deliver([state]() { state->finish(); });
+        });
+    } catch (...) {
+        state->error = std::current_exception();
+        deliver([state]() { state->finish(); });
+    }
+    return detail::TaskAccess::make(state);
+}
+
+Task<void> Executor::writeFile(const std::string &path, std::string contents, bool sync) {
+    auto state = std::make_shared<detail::TaskState<void>>(this);
+    hold();
+    try {
+        io.write(path, std::move(contents), sync, [this, state](std::exception_ptr error) {
+            if (error) {
+                state->error = error;
+            } else {
+                state->value.emplace();
+            }
+            deliver([state]() { state->finish(); });
+        });
+    } catch (...) {
+        state->error = std::current_exception();
+        deliver([state]() { state->finish(); });
+    }
+    return detail::TaskAccess::make(state);
+}
+
+} // namespace PasswordNS
@@ -0,0 +1,468 @@
+#ifndef ASYNC_TASK_H
+#define ASYNC_TASK_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "async_io.h"    // For the file reads and writes tasks wait on
+#include "task_scheduler.h" // For CPU-bound work tasks hand off (decryption)
+#include "worker_pool.h"    // For blocking work tasks hand off (engine writes)
+
+namespace PasswordNS
+{
+
+    class Executor;
+    template <typename T>
+    class Task;
+
+    namespace detail
+    {
+        // Outcome of a task. Everything but the value is touched only on the executor's loop
+        // thread; work running elsewhere fills in value or error, then hands finish() to the loop.
+        template <typename T>
+        struct TaskState
+        {
+            using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+            explicit TaskState(Executor *owner) : executor(owner) {}
+
+            Executor *executor; // Where continuations of a finished task are posted; null runs them inline
+            bool done = false;
+            bool continued = false; // A continuation was attached
+            std::optional<Value> value;
+            std::exception_ptr error;
+            std::function<void()> continuation;
+
+            void finish()
+            {
+                done = true;
+                if (continuation)
+                {
+                    std::function<void()> next = std::move(continuation);
+                    continuation = nullptr;
+                    next();
+                }
+            }
+
+            template <typename... Args>
+            void succeed(Args &&...args)
+            {
+                value.emplace(std::forward<Args>(args)...);
+                finish();
+            }
+
+            void fail(std::exception_ptr failure)
+            {
+                error = std::move(failure);
+                finish();
+            }
+
+            void completeFrom(TaskState &other)
+            {
+                if (other.error)
+                {
+                    fail(other.error);
+                }
+                else
+                {
+                    succeed(std::move(*other.value));
+                }
+            }
+
+            void onComplete(std::function<void()> next);
+        };
+
+        template <typename T>
+        struct IsTask : std::false_type
+        {
+        };
+        template <typename T>
+        struct IsTask<Task<T>> : std::true_type
+        {
+        };
+
+        template <typename T>
+        struct Unwrap
+        {
+            using type = T;
+        };
+        template <typename T>
+        struct Unwrap<Task<T>>
+        {
+            using type = T;
+        };
+
+        // What a continuation of Task<T> returns: it takes the value, or nothing for Task<void>
+        template <typename F, typename T, typename = void>
+        struct ContinuationResult
+        {
+            using type = std::invoke_result_t<F, T>;
+        };
+        template <typename F, typename T>
+        struct ContinuationResult<F, T, std::enable_if_t<std::is_void_v<T>>>
+        {
+            using type = std::invoke_result_t<F>;
+        };
+
+        // Reaches the shared state of a task, for the executor and the coroutine support below
+        struct TaskAccess
+        {
+            template <typename T>
+            static const std::shared_ptr<TaskState<T>> &state(const Task<T> &task) { return task.state; }
+            template <typename T>
+            static Task<T> make(std::shared_ptr<TaskState<T>> state) { return Task<T>(std::move(state)); }
+        };
+    } // namespace detail
+
+    // Result of an asynchronous operation, delivered on the thread that runs its Executor. A task
+    // takes at most one continuation: then() consumes it, as does co_await in C++20 code (the
+    // end of this header makes Task a coroutine type there). Not thread-safe: create, chain and
+    // inspect tasks on the loop thread, or before the loop runs.
+    template <typename T>
+    class Task
+    {
+    private:
+        std::shared_ptr<detail::TaskState<T>> state;
+
+        explicit Task(std::shared_ptr<detail::TaskState<T>> taskState) : state(std::move(taskState)) {}
+
+        friend struct detail::TaskAccess;
+        template <typename>
+        friend class Task;
+
+    public:
+        Task() = default; // No operation; valid() is false
+
+        bool valid() const { return static_cast<bool>(state); }
+        bool ready() const { return state && state->done; }
+
+        // The value, or the exception the operation failed with; throws std::logic_error before ready()
+        T get()
+        {
+            if (!ready())
+            {
+                throw std::logic_error("The task has not completed.");
+            }
+            if (state->error)
+            {
+                std::rethrow_exception(state->error);
+            }
+            if constexpr (!std::is_void_v<T>)
+            {
+                return std::move(*state->value);
+            }
+        }
+
+        // Runs function with the value once the task succeeds and returns a task for its result.
+        // A function returning a task is waited for too. Errors skip the function and pass on.
+        template <typename F>
+        auto then(F function) -> Task<typename detail::Unwrap<typename detail::ContinuationResult<F, T>::type>::type>
+        {
+            using Result = typename detail::ContinuationResult<F, T>::type;
+            using Next = typename detail::Unwrap<Result>::type;
+            if (!state)
+            {
+                throw std::logic_error("Cannot continue an empty task.");
+            }
+            auto next = std::make_shared<detail::TaskState<Next>>(state->executor);
+            std::shared_ptr<detail::TaskState<T>> source = std::move(state);
+            source->onComplete([source, next, function = std::move(function)]() mutable {
+                if (source->error)
+                {
+                    next->fail(source->error);
+                    return;
+                }
+                try
+                {
+                    auto call = [&]() -> Result {
+                        if constexpr (std::is_void_v<T>)
+                        {
+                            return function();
+                        }
+                        else
+                        {
+                            return function(std::move(*source->value));
+                        }
+                    };
+                    if constexpr (detail::IsTask<Result>::value)
+                    {
+                        std::shared_ptr<detail::TaskState<Next>> inner = call().state;
+                        inner->onComplete([inner, next]() { next->completeFrom(*inner); });
+                    }
+                    else if constexpr (std::is_void_v<Result>)
+                    {
+                        call();
+                        next->succeed();
+                    }
+                    else
+                    {
+                        next->succeed(call());
+                    }
+                }
+                catch (...)
+                {
+                    next->fail(std::current_exception());
+                }
+            });
+            return Task<Next>(next);
+        }
+    };
+
+    // A small event loop for asynchronous vault operations. The loop runs on whichever thread
+    // calls run(), and every continuation runs there, so one thread can drive thousands of
+    // operations on PasswordManager objects without locking them. Work that would block the
+    // loop goes elsewhere: compute() runs CPU-bound steps (decryption) on the shared
+    // TaskScheduler, offload() runs blocking ones (engine writes) on a WorkerPool, and
+    // readFile() / writeFile() go through AsyncFileIO (io_uring where available).
+    // post() is the only method other threads may call.
+    class Executor
+    {
+    private:
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<std::function<void()>> ready; // Loop work, oldest first
+        size_t outstanding = 0;                  // Loop work queued or still being produced elsewhere
+        WorkerPool pool;
+        AsyncFileIO io;
+        TaskGroup computing; // Declared last, so it is waited for before the rest goes away
+
+        void hold();                             // One more piece of loop work is on its way
+        void deliver(std::function<void()> job); // Queues the work a hold() announced
+        bool runOne();                           // False once no work is left
+
+        template <typename R>
+        static void produce(detail::TaskState<R> &state, std::function<R()> &function) noexcept
+        {
+            try
+            {
+                if constexpr (std::is_void_v<R>)
+                {
+                    function();
+                    state.value.emplace();
+                }
+                else
+                {
+                    state.value.emplace(function());
+                }
+            }
+            catch (...)
+            {
+                state.error = std::current_exception();
+            }
+        }
+
+    public:
+        explicit Executor(size_t workerThreads = std::thread::hardware_concurrency(),
+                          AsyncIoOptions ioOptions = AsyncIoOptions());
+        ~Executor() noexcept; // Waits for offloaded work and file I/O; queued loop work is dropped
+
+        Executor(const Executor &) = delete;
+        Executor &operator=(const Executor &) = delete;
+
+        // Queues function on the loop; safe from any thread. Exceptions it throws leave run().
+        void post(std::function<void()> function);
+
+        // Runs the loop on the calling thread until no work is left; returns how many jobs ran
+        size_t run();
+
+        // Runs the loop until task completes, then returns its value or rethrows its error
+        template <typename T>
+        T run(Task<T> task)
+        {
+            while (!task.ready())
+            {
+                if (!runOne())
+                {
+                    throw std::logic_error("The task can never complete: the executor has no work left.");
+                }
+            }
+            return task.get();
+        }
+
+        // A task that has already succeeded
+        template <typename T>
+        Task<std::decay_t<T>> completed(T &&value)
+        {
+            auto state = std::make_shared<detail::TaskState<std::decay_t<T>>>(this);
+            state->succeed(std::forward<T>(value));
+            return detail::TaskAccess::make(state);
+        }
+        Task<void> completed()
+        {
+            auto state = std::make_shared<detail::TaskState<void>>(this);
+            state->succeed();
+            return detail::TaskAccess::make(state);
+        }
+
+        // Runs function on the loop, after the work already queued there
+        template <typename F>
+        auto schedule(F function) -> Task<std::invoke_result_t<F>>
+        {
+            using R = std::invoke_result_t<F>;
+            auto state = std::make_shared<detail::TaskState<R>>(this);
+            post([state, job = std::function<R()>(std::move(function))]() mutable {
+                produce(*state, job);
+                state->finish();
+            });
+            return detail::TaskAccess::make(state);
+        }
+
+        // Runs CPU-bound function on the shared TaskScheduler; the task completes on the loop.
+        // Function must not block on I/O (use offload()) or touch objects the loop is using.
+        template <typename F>
+        auto compute(F function) -> Task<std::invoke_result_t<F>>
+        {
+            using R = std::invoke_result_t<F>;
+            auto state = std::make_shared<detail::TaskState<R>>(this);
+            hold();
+            try
+            {
+                computing.run([this, state, job = std::function<R()>(std::move(function))]() mutable {
+                    produce(*state, job);
+                    deliver([state]() { state->finish(); });
+                });
+            }
+            catch (...)
+            {
+                state->error = std::current_exception();
+                deliver([state]() { state->finish(); });
+            }
+            return detail::TaskAccess::make(state);
+        }
+
+        // Runs function on a worker thread, where it may block; the task completes on the loop.
+        // Function must not touch objects the loop is using.
+        template <typename F>
+        auto offload(F function) -> Task<std::invoke_result_t<F>>
+        {
+            using R = std::invoke_result_t<F>;
+            auto state = std::make_shared<detail::TaskState<R>>(this);
+            hold();
+            try
+            {
+                pool.submit([this, state, job = std::function<R()>(std::move(function))]() mutable {
+                    produce(*state, job);
+                    deliver([state]() { state->finish(); });
+                });
+            }
+            catch (...)
+            {
+                state->error = std::current_exception();
+                deliver([state]() { state->finish(); });
+            }
+            return detail::TaskAccess::make(state);
+        }
+
+        // Whole-file read and atomic whole-file write (see async_io.h)
+        Task<std::string> readFile(const std::string &path);
+        Task<void> writeFile(const std::string &path, std::string contents, bool sync);
+
+        size_t workerCount() const { return pool.size(); }
+        const char *ioEngineName() const { return io.engineName(); }
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        void TaskState<T>::onComplete(std::function<void()> next)
+        {
+            if (continued)
+            {
+                throw std::logic_error("A task takes only one continuation.");
+            }
+            continued = true;
+            if (!done)
+            {
+                continuation = std::move(next);
+            }
+            else if (executor != nullptr)
+            {
+                executor->post(std::move(next)); // Never inside the call that attached it
+            }
+            else
+            {
+                next();
+            }
+        }
+    } // namespace detail
+
+} // namespace PasswordNS
+
+// C++20: a function returning Task<T> may be a coroutine, and co_await suspends on a task until
+// it completes. Coroutines start right away on the calling thread and resume on the loop thread.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+
+namespace PasswordNS
+{
+    namespace detail
+    {
+        template <typename T>
+        struct TaskAwaiter
+        {
+            std::shared_ptr<TaskState<T>> state;
+
+            bool await_ready() const noexcept { return state->done; }
+            void await_suspend(std::coroutine_handle<> coroutine)
+            {
+                state->onComplete([coroutine]() { coroutine.resume(); });
+            }
+            T await_resume() { return TaskAccess::make(state).get(); }
+        };
+
+        template <typename T>
+        struct TaskPromiseBase
+        {
+            std::shared_ptr<TaskState<T>> state = std::make_shared<TaskState<T>>(nullptr);
+
+            Task<T> get_return_object() { return TaskAccess::make(state); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void unhandled_exception() { state->fail(std::current_exception()); }
+        };
+
+        template <typename T>
+        struct TaskPromise : TaskPromiseBase<T>
+        {
+            template <typename U>
+            void return_value(U &&value) { this->state->succeed(std::forward<U>(value)); }
+        };
+
+        template <>
+        struct TaskPromise<void> : TaskPromiseBase<void>
+        {
+            void return_void() { state->succeed(); }
+        };
+    } // namespace detail
+
+    template <typename T>
+    detail::TaskAwaiter<T> operator co_await(Task<T> task)
+    {
+        if (!task.valid())
+        {
+            throw std::logic_error("Cannot await an empty task.");
+        }
+        return detail::TaskAwaiter<T>{detail::TaskAccess::state(task)};
+    }
+
+} // namespace PasswordNS
+
+template <typename T, typename... Args>
+struct std::coroutine_traits<PasswordNS::Task<T>, Args...>
+{
+    using promise_type = PasswordNS::detail::TaskPromise<T>;
+};
+#endif
+
+#endif
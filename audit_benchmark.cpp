@@ -0,0 +1,68 @@
+// audit_benchmark.cpp
+// Measures reused/weak password detection throughput on a large vault
+// with one worker thread and with every core.
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <filesystem>
+#include "manager.h"
+#include "vault_audit.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+const std::string benchUser = "audit_bench_user";
+
+// Writes a vault where every tenth entry shares its password with nine others and every
+// hundredth is too short (the batch importer would refuse those)
+void writeVault(const PasswordManager &manager, size_t entries) {
+    std::ofstream vault(manager.getVaultFileName(), std::ios::trunc);
+    for (size_t i = 0; i < entries; ++i) {
+        std::string password = i % 10 == 0 ? "Shared-Passw0rd-" + std::to_string(i / 100) : "Passw0rd-" + std::to_string(i);
+        if (i % 100 == 1) {
+            password = "short";
+        }
+        vault << "service" << i << " user" << i << ":" << PasswordManager::encryptToHex(password, PasswordManager::getDefaultEncryptionKey()) << "\n";
+    }
+}
+
+void printReport(const std::string &label, const AuditReport &report) {
+    std::cout << std::left << std::setw(20) << label << std::right << std::setw(12)
+              << static_cast<size_t>(report.entriesPerSecond()) << " entries/s" << std::setw(10) << std::fixed
+              << std::setprecision(2) << report.seconds << " s" << std::setw(10) << report.reuseClusters.size()
+              << " clusters" << std::setw(10) << report.weak.size() << " weak\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t entries = argc > 1 ? std::stoull(argv[1]) : 1000000;
+
+    // Work in a scratch directory so the benchmark never touches real vaults
+    auto originalDirectory = std::filesystem::current_path();
+    auto workDirectory = std::filesystem::temp_directory_path() / "password_manager_audit_benchmark";
+    std::filesystem::remove_all(workDirectory);
+    std::filesystem::create_directories(workDirectory);
+    std::filesystem::current_path(workDirectory);
+
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setUsername(benchUser);
+    writeVault(manager, entries);
+    manager.loadCredentialsFromFile();
+    std::cout << "Audit of a " << entries << "-entry vault\n";
+
+    AuditOptions options;
+    options.threads = 1;
+    printReport("1 thread", auditVault(manager, options));
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    printReport("all cores (" + std::to_string(options.threads) + ")", auditVault(manager, options));
+
+    std::filesystem::current_path(originalDirectory);
+    std::filesystem::remove_all(workDirectory);
+    return 0;
+}
@@ -0,0 +1,474 @@
+#include "batch_io.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+#include "encryption.h"
+#include "task_scheduler.h"
+
+namespace PasswordNS {
+
+namespace {
+
+// One plaintext entry read from a CSV/JSONL input
+struct PlainEntry {
+    std::string service;
+    std::string username;
+    std::string password;
+    bool parsed = false;
+};
+
+// Runs fn on contiguous slices of [0, count) on the shared scheduler, at most `threads` at once
+void forEachSlice(size_t count, size_t threads, const std::function<void(size_t, size_t)> &fn) {
+    threads = std::max<size_t>(1, threads);
+    parallelFor(0, count, (count + threads - 1) / threads, fn);
+}
+
+// Reads one CSV record, joining physical lines while a quoted field is open
+bool readCsvRecord(std::istream &input, std::string &record) {
+    std::string line;
+    if (!std::getline(input, line)) {
+        return false;
+    }
+    record = line;
+    while (std::count(record.begin(), record.end(), '"') % 2 != 0 && std::getline(input, line)) {
+        record += '\n';
+        record += line;
+    }
+    if (!record.empty() && record.back() == '\r') {
+        record.pop_back();
+    }
+    return true;
+}
+
+// Splits a CSV record into fields (RFC 4180 quoting)
+std::vector<std::string> splitCsv(const std::string &record) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < record.size(); ++i) {
+        char c = record[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < record.size() && record[i + 1] == '"') {
+                fields.back() += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                fields.back() += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+std::string quoteCsv(const std::string &field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos) {
+        return field;
+    }
+    std::string quoted = "\"";
+    for (char c : field) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void appendUtf8(std::string &out, unsigned long codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// Minimal JSON string reader; pos points at the opening quote
+bool readJsonString(const std::string &line, size_t &pos, std::string &out) {
+    if (pos >= line.size() || line[pos] != '"') {
+        return false;
+    }
+    out.clear();
+    for (++pos; pos < line.size(); ++pos) {
+        char c = line[pos];
+        if (c == '"') {
+            ++pos;
+            return true;
+        }
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (++pos >= line.size()) {
+            return false;
+        }
+        switch (line[pos]) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            if (pos + 4 >= line.size()) {
+                return false;
+            }
+            unsigned long codePoint = std::strtoul(line.substr(pos + 1, 4).c_str(), nullptr, 16);
+            pos += 4;
+            // Combine UTF-16 surrogate pairs
+            if (codePoint >= 0xD800 && codePoint < 0xDC00 && pos + 6 < line.size() &&
+                line[pos + 1] == '\\' && line[pos + 2] == 'u') {
+                unsigned long low = std::strtoul(line.substr(pos + 3, 4).c_str(), nullptr, 16);
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                pos += 6;
+            }
+            appendUtf8(out, codePoint);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+void skipSpaces(const std::string &line, size_t &pos) {
+    while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos]))) {
+        ++pos;
+    }
+}
+
+// Parses a flat JSON object of string values
+bool parseJsonLine(const std::string &line, PlainEntry &entry) {
+    size_t pos = 0;
+    skipSpaces(line, pos);
+    if (pos >= line.size() || line[pos++] != '{') {
+        return false;
+    }
+
+    bool hasService = false, hasUsername = false, hasPassword = false;
+    std::string key, value;
+    while (true) {
+        skipSpaces(line, pos);
+        if (pos < line.size() && line[pos] == '}') {
+            break;
+        }
+        if (!readJsonString(line, pos, key)) {
+            return false;
+        }
+        skipSpaces(line, pos);
+        if (pos >= line.size() || line[pos++] != ':') {
+            return false;
+        }
+        skipSpaces(line, pos);
+        if (!readJsonString(line, pos, value)) {
+            return false;
+        }
+
+        if (key == "service") {
+            entry.service = value;
+            hasService = true;
+        } else if (key == "username") {
+            entry.username = value;
+            hasUsername = true;
+        } else if (key == "password") {
+            entry.password = value;
+            hasPassword = true;
+        }
+
+        skipSpaces(line, pos);
+        if (pos < line.size() && line[pos] == ',') {
+            ++pos;
+        } else if (pos < line.size() && line[pos] == '}') {
+            break;
+        } else {
+            return false;
+        }
+    }
+    return hasService && hasUsername && hasPassword;
+}
+
+std::string quoteJson(const std::string &value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        switch (c) {
+        case '"': quoted += "\\\""; break;
+        case '\\': quoted += "\\\\"; break;
+        case '\n': quoted += "\\n"; break;
+        case '\r': quoted += "\\r"; break;
+        case '\t': quoted += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                quoted += escaped;
+            } else {
+                quoted += c;
+            }
+        }
+    }
+    return quoted + "\"";
+}
+
+// Reads the next plaintext entry; returns false at end of input
+bool readEntry(std::istream &input, BatchFormat format, PlainEntry &entry) {
+    std::string record;
+    entry = PlainEntry{};
+    if (format == BatchFormat::Csv) {
+        if (!readCsvRecord(input, record)) {
+            return false;
+        }
+        auto fields = splitCsv(record);
+        if (fields.size() == 3) {
+            entry.service = fields[0];
+            entry.username = fields[1];
+            entry.password = fields[2];
+            entry.parsed = true;
+        }
+        return true;
+    }
+
+    if (!std::getline(input, record)) {
+        return false;
+    }
+    entry.parsed = parseJsonLine(record, entry);
+    return true;
+}
+
+bool isHeader(const PlainEntry &entry) {
+    return entry.service == "service" && entry.username == "username" && entry.password == "password";
+}
+
+// The vault format is "service username:hex", one record per line, split at the last space:
+// services may hold spaces but no line breaks, and usernames neither spaces nor ':'
+bool isStorable(const PlainEntry &entry) {
+    auto hasSpace = [](const std::string &text) {
+        return std::any_of(text.begin(), text.end(), [](unsigned char c) { return std::isspace(c); });
+    };
+    return !entry.service.empty() && !entry.username.empty() &&
+           entry.service.find_first_of("\r\n") == std::string::npos && !hasSpace(entry.username) &&
+           entry.username.find(':') == std::string::npos;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Tracks when the next progress report is due
+class ProgressReporter {
+public:
+    ProgressReporter(const BatchOptions &options, const BatchProgressCallback &callback)
+        : interval(options.progressInterval), next(options.progressInterval), callback(callback),
+          start(std::chrono::steady_clock::now()) {}
+
+    void update(BatchStats &stats) {
+        stats.seconds = secondsSince(start);
+        if (callback && interval > 0 && stats.processed + stats.skipped >= next) {
+            callback(stats);
+            next = stats.processed + stats.skipped + interval;
+        }
+    }
+
+private:
+    size_t interval;
+    size_t next;
+    const BatchProgressCallback &callback;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace
+
+// Parse a Batch Format Name
+BatchFormat parseBatchFormat(const std::string &name) {
+    if (name == "csv") {
+        return BatchFormat::Csv;
+    }
+    if (name == "jsonl") {
+        return BatchFormat::Jsonl;
+    }
+    throw std::invalid_argument("Unknown format: " + name + " (expected csv or jsonl)");
+}
+
+// Import Plaintext Entries into a Vault
+BatchStats importCredentials(const PasswordManager &manager, std::istream &input, std::ostream &vault,
+                             const BatchOptions &options, const BatchProgressCallback &progress) {
+    BatchStats stats;
+    ProgressReporter reporter(options, progress);
+    size_t batchSize = std::max<size_t>(1, options.batchSize);
+
+    std::vector<PlainEntry> batch(batchSize);
+    std::vector<std::string> records(batchSize);
+    bool firstEntry = true;
+
+    while (true) {
+        options.cancel.throwIfCancelled();
+        size_t count = 0;
+        while (count < batchSize && readEntry(input, options.format, batch[count])) {
+            // Skip an optional CSV header row
+            if (firstEntry && options.format == BatchFormat::Csv && isHeader(batch[count])) {
+                firstEntry = false;
+                continue;
+            }
+            firstEntry = false;
+            ++count;
+        }
+        if (count == 0) {
+            break;
+        }
+
+        forEachSlice(count, options.threads, [&](size_t begin, size_t end) {
+            // A slice's storable entries are encrypted together, several at a time (see aes_batch.h)
+            std::vector<size_t> storable;
+            std::vector<std::string> passwords;
+            for (size_t i = begin; i < end; ++i) {
+                const PlainEntry &entry = batch[i];
+                records[i].clear();
+                if (entry.parsed && isStorable(entry) && manager.validate(entry.password)) {
+                    storable.push_back(i);
+                    passwords.push_back(entry.password);
+                }
+            }
+            auto ciphertexts = EncryptionNS::encryptBatch(passwords, manager.getEncryptionKey());
+            for (size_t k = 0; k < storable.size(); ++k) {
+                const PlainEntry &entry = batch[storable[k]];
+                records[storable[k]] = entry.service + " " + entry.username + ":" +
+                                       EncryptionNS::toHex(ciphertexts[k]) + "\n";
+            }
+        });
+
+        // Write in input order so the vault keeps the import order
+        for (size_t i = 0; i < count; ++i) {
+            if (records[i].empty()) {
+                ++stats.skipped;
+            } else {
+                vault << records[i];
+                ++stats.processed;
+            }
+        }
+        if (!vault) {
+            throw std::ios_base::failure("Failed to write vault records.");
+        }
+        reporter.update(stats);
+    }
+
+    vault.flush();
+    reporter.update(stats);
+    return stats;
+}
+
+// Export Vault Records as Plaintext Entries
+BatchStats exportCredentials(std::istream &vault, std::ostream &output, const std::string &key,
+                             const BatchOptions &options, const BatchProgressCallback &progress) {
+    BatchStats stats;
+    ProgressReporter reporter(options, progress);
+    size_t batchSize = std::max<size_t>(1, options.batchSize);
+
+    std::vector<std::string> lines(batchSize);
+    std::vector<std::string> records(batchSize);
+
+    if (options.format == BatchFormat::Csv) {
+        output << "service,username,password\n";
+    }
+
+    while (true) {
+        options.cancel.throwIfCancelled();
+        size_t count = 0;
+        while (count < batchSize && std::getline(vault, lines[count])) {
+            if (!lines[count].empty()) {
+                ++count;
+            }
+        }
+        if (count == 0) {
+            break;
+        }
+
+        forEachSlice(count, options.threads, [&](size_t begin, size_t end) {
+            // Parse the slice first, then decrypt all of its passwords in one batch
+            std::vector<size_t> decodable;
+            std::vector<PlainEntry> entries;
+            std::vector<std::vector<unsigned char>> ciphertexts;
+            for (size_t i = begin; i < end; ++i) {
+                const std::string &line = lines[i];
+                records[i].clear();
+
+                std::pair<std::string, std::string> record;
+                size_t colon = std::string::npos;
+                if (PasswordManager::parseVaultRecord(line, record)) {
+                    colon = record.second.find(':');
+                }
+                if (colon == std::string::npos) {
+                    continue;
+                }
+
+                PlainEntry entry;
+                entry.service = std::move(record.first);
+                entry.username = record.second.substr(0, colon);
+                try {
+                    ciphertexts.push_back(EncryptionNS::fromHex(record.second.substr(colon + 1)));
+                } catch (const std::exception &) {
+                    continue; // Corrupt hex is reported as skipped
+                }
+                decodable.push_back(i);
+                entries.push_back(std::move(entry));
+            }
+
+            std::vector<bool> failed;
+            auto passwords = EncryptionNS::decryptBatch(ciphertexts, key, &failed);
+            for (size_t k = 0; k < decodable.size(); ++k) {
+                if (failed[k]) {
+                    continue; // So is a password that does not decrypt
+                }
+                PlainEntry &entry = entries[k];
+                entry.password = std::move(passwords[k]);
+                size_t i = decodable[k];
+                if (options.format == BatchFormat::Csv) {
+                    records[i] = quoteCsv(entry.service) + "," + quoteCsv(entry.username) + "," +
+                                 quoteCsv(entry.password) + "\n";
+                } else {
+                    records[i] = "{\"service\":" + quoteJson(entry.service) + ",\"username\":" +
+                                 quoteJson(entry.username) + ",\"password\":" + quoteJson(entry.password) + "}\n";
+                }
+            }
+        });
+
+        for (size_t i = 0; i < count; ++i) {
+            if (records[i].empty()) {
+                ++stats.skipped;
+            } else {
+                output << records[i];
+                ++stats.processed;
+            }
+        }
+        if (!output) {
+            throw std::ios_base::failure("Failed to write exported entries.");
+        }
+        reporter.update(stats);
+    }
+
+    output.flush();
+    reporter.update(stats);
+    return stats;
+}
+
+} // namespace PasswordNS
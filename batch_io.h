@@ -0,0 +1,60 @@
+#ifndef BATCH_IO_H
+#define BATCH_IO_H
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "manager.h"
+#include "worker_pool.h"
+
+namespace PasswordNS
+{
+
+    // Plaintext formats understood by the batch import/export tools
+    enum class BatchFormat
+    {
+        Csv,  // service,username,password (RFC 4180 quoting)
+        Jsonl // {"service":"...","username":"...","password":"..."} per line
+    };
+
+    // Tuning knobs for batch operations
+    struct BatchOptions
+    {
+        BatchFormat format = BatchFormat::Csv;
+        size_t threads = std::thread::hardware_concurrency(); // Slices run at once on the shared scheduler (0 = 1)
+        size_t batchSize = 4096;                              // Entries held in memory at a time
+        size_t progressInterval = 100000;                     // Report progress every N entries (0 = never)
+        CancellationToken cancel;                             // Checked between batches
+    };
+
+    // Counters reported while a batch operation runs and when it finishes
+    struct BatchStats
+    {
+        size_t processed = 0; // Entries written to the output
+        size_t skipped = 0;   // Malformed, weak or unsupported entries
+        double seconds = 0.0;
+
+        double entriesPerSecond() const { return seconds > 0.0 ? processed / seconds : 0.0; }
+    };
+
+    using BatchProgressCallback = std::function<void(const BatchStats &)>;
+
+    // Parses "csv" or "jsonl", throws std::invalid_argument otherwise
+    BatchFormat parseBatchFormat(const std::string &name);
+
+    // Streams plaintext entries from input, encrypts them under manager's key and appends vault records to vault.
+    // Memory use is bounded by options.batchSize regardless of the input size.
+    // Both operations throw OperationCancelled if options.cancel is triggered between batches.
+    BatchStats importCredentials(const PasswordManager &manager, std::istream &input, std::ostream &vault,
+                                 const BatchOptions &options, const BatchProgressCallback &progress = {});
+
+    // Streams vault records, decrypts them under key (the vault's PasswordManager::getEncryptionKey())
+    // and writes plaintext entries to output
+    BatchStats exportCredentials(std::istream &vault, std::ostream &output, const std::string &key,
+                                 const BatchOptions &options, const BatchProgressCallback &progress = {});
+
+} // namespace PasswordNS
+
+#endif
@@ -0,0 +1,122 @@
+// breach_benchmark.cpp
+// Measures breached-password lookups against a memory-mapped SHA-1 corpus:
+// index build time and size, lookups/second, and the cost of adding the
+// check to a vault audit.
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <filesystem>
+#include "breach_corpus.h"
+#include "manager.h"
+#include "vault_audit.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string breachedPassword(size_t i) {
+    return "breached-" + std::to_string(i);
+}
+
+// Writes a sorted corpus of the SHA-1 digests of breachedPassword(0 .. count - 1)
+void writeCorpus(const std::string &path, size_t count) {
+    std::vector<Sha1Digest> digests(count);
+    for (size_t i = 0; i < count; ++i) {
+        digests[i] = sha1Digest(breachedPassword(i));
+    }
+    std::sort(digests.begin(), digests.end());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(digests.data()), static_cast<std::streamsize>(count * sizeof(Sha1Digest)));
+}
+
+// Looks up lookups digests on each of threads threads, half of them present in the corpus
+double lookupsPerSecond(const BreachCorpus &corpus, size_t corpusSize, size_t lookups, size_t threads) {
+    std::vector<std::vector<Sha1Digest>> queries(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        for (size_t i = 0; i < lookups; ++i) {
+            size_t n = (i * 7919 + t * 104729) % corpusSize;
+            queries[t].push_back(sha1Digest(i % 2 == 0 ? breachedPassword(n) : "safe-" + std::to_string(n)));
+        }
+    }
+
+    std::vector<size_t> found(threads, 0);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (const auto &digest : queries[t]) {
+                found[t] += corpus.contains(digest) ? 1 : 0;
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    double seconds = secondsSince(start);
+    for (size_t t = 0; t < threads; ++t) {
+        if (found[t] != lookups / 2) {
+            std::cerr << "Unexpected lookup results: " << found[t] << " of " << lookups << std::endl;
+        }
+    }
+    return threads * lookups / seconds;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t corpusSize = argc > 1 ? std::stoull(argv[1]) : 10000000;
+    const size_t lookups = 1000000;
+    const size_t vaultEntries = 100000;
+
+    // Work in a scratch directory so the benchmark never touches real vaults
+    auto originalDirectory = std::filesystem::current_path();
+    auto workDirectory = std::filesystem::temp_directory_path() / "password_manager_breach_benchmark";
+    std::filesystem::remove_all(workDirectory);
+    std::filesystem::create_directories(workDirectory);
+    std::filesystem::current_path(workDirectory);
+
+    writeCorpus("corpus.bin", corpusSize);
+    auto start = std::chrono::steady_clock::now();
+    BreachCorpus corpus("corpus.bin");
+    double openSeconds = secondsSince(start);
+
+    std::cout << "Breach corpus of " << corpusSize << " digests (" << corpusSize * 20 / (1024 * 1024) << " MB)\n";
+    std::cout << "Open and index:      " << std::fixed << std::setprecision(1) << openSeconds * 1e3 << " ms\n";
+    std::cout << "Prefix index memory: " << corpus.indexBytes() / 1024 << " KB\n";
+    std::cout << "Lookups, 1 thread:   " << static_cast<size_t>(lookupsPerSecond(corpus, corpusSize, lookups, 1)) << " /s\n";
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Lookups, all cores (" << threads << "): "
+              << static_cast<size_t>(lookupsPerSecond(corpus, corpusSize, lookups, threads)) << " /s\n";
+
+    // What the check adds to an audit, which already decrypts every entry
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setTestCredentials("breach_bench_user", "secure_password");
+    CredentialList list;
+    for (size_t i = 0; i < vaultEntries; ++i) {
+        std::string password = i % 100 == 0 ? breachedPassword(i) : "Passw0rd-" + std::to_string(i);
+        list.push_back({"service" + std::to_string(i), "user:" + PasswordManager::encryptToHex(password, PasswordManager::getDefaultEncryptionKey())});
+    }
+    manager.restoreCredentialList(list);
+
+    AuditOptions options;
+    AuditReport plain = auditVault(manager, options);
+    options.breaches = &corpus;
+    AuditReport checked = auditVault(manager, options);
+    std::cout << "Audit of " << vaultEntries << " entries: " << static_cast<size_t>(plain.entriesPerSecond())
+              << " entries/s, with breach check " << static_cast<size_t>(checked.entriesPerSecond()) << " entries/s ("
+              << checked.breached.size() << " breached)\n";
+
+    std::filesystem::current_path(originalDirectory);
+    std::filesystem::remove_all(workDirectory);
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include "breach_corpus.h"
+#include <openssl/sha.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace PasswordNS {
+
+namespace {
+
+const size_t digestSize = 20;
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Enough buckets for about 16 digests each, between 2^8 and 2^24 (128 MB of index)
+size_t choosePrefixBits(size_t count) {
+    size_t bits = 8;
+    while (bits < 24 && (count >> bits) > 16) {
+        ++bits;
+    }
+    return bits;
+}
+
+} // namespace
+
+// Hash a Password with SHA-1 (the format breach corpora are published in)
+Sha1Digest sha1Digest(std::string_view data) {
+    Sha1Digest digest;
+    SHA1(reinterpret_cast<const unsigned char *>(data.data()), data.size(), digest.data());
+    return digest;
+}
+
+// Map the Corpus and Build Its Prefix Index
+BreachCorpus::BreachCorpus(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::ios_base::failure("Unable to open breach corpus '" + path + "'.");
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::ios_base::failure("Unable to read breach corpus '" + path + "'.");
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    if (bytes % digestSize != 0) {
+        ::close(fd);
+        throw std::invalid_argument("Breach corpus '" + path + "' is not a list of 20-byte digests.");
+    }
+
+    count = bytes / digestSize;
+    if (count != 0) {
+        void *mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw std::ios_base::failure("Unable to map breach corpus '" + path + "'.");
+        }
+        digests = static_cast<const unsigned char *>(mapping);
+    }
+    ::close(fd); // The mapping keeps the file alive
+
+    // One sequential pass builds the index and checks the order; lookups then jump around
+    prefixBits = choosePrefixBits(count);
+    bucketStarts.assign((size_t(1) << prefixBits) + 1, count);
+    if (digests != nullptr) {
+        ::madvise(const_cast<unsigned char *>(digests), bytes, MADV_SEQUENTIAL);
+    }
+    size_t nextBucket = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char *digest = digests + i * digestSize;
+        if (i != 0 && std::memcmp(digest - digestSize, digest, digestSize) > 0) {
+            ::munmap(const_cast<unsigned char *>(digests), bytes); // The destructor does not run for a throwing constructor
+            throw std::invalid_argument("Breach corpus '" + path + "' is not sorted (digest " + std::to_string(i + 1) + ").");
+        }
+        size_t bucket = bucketOf(digest);
+        while (nextBucket <= bucket) {
+            bucketStarts[nextBucket++] = i;
+        }
+    }
+    if (digests != nullptr) {
+        ::madvise(const_cast<unsigned char *>(digests), bytes, MADV_RANDOM);
+    }
+}
+
+BreachCorpus::~BreachCorpus() noexcept {
+    if (digests != nullptr) {
+        ::munmap(const_cast<unsigned char *>(digests), count * digestSize);
+        digests = nullptr;
+    }
+}
+
+size_t BreachCorpus::bucketOf(const unsigned char *digest) const {
+    uint32_t prefix = (uint32_t(digest[0]) << 24) | (uint32_t(digest[1]) << 16) | (uint32_t(digest[2]) << 8) | digest[3];
+    return prefix >> (32 - prefixBits);
+}
+
+// Look Up a Digest
+bool BreachCorpus::contains(const Sha1Digest &digest) const {
+    if (count == 0) {
+        return false;
+    }
+    size_t bucket = bucketOf(digest.data());
+    size_t low = bucketStarts[bucket];
+    size_t high = bucketStarts[bucket + 1];
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int order = std::memcmp(digests + middle * digestSize, digest.data(), digestSize);
+        if (order == 0) {
+            return true;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return false;
+}
+
+// Convert a Sorted Hex Digest List into a Corpus File
+size_t writeBreachCorpus(std::istream &hexList, const std::string &path) {
+    const std::string temporaryPath = path + ".tmp";
+    std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()) {
+        throw std::ios_base::failure("Unable to open '" + temporaryPath + "' for writing.");
+    }
+
+    size_t written = 0;
+    size_t lineNumber = 0;
+    Sha1Digest previous{};
+    Sha1Digest digest{};
+    std::string line;
+    try {
+        while (std::getline(hexList, line)) {
+            ++lineNumber;
+            if (line.empty() || line == "\r") {
+                continue;
+            }
+            bool valid = line.size() >= 2 * digestSize &&
+                         (line.size() == 2 * digestSize || line[2 * digestSize] == ':' || line[2 * digestSize] == '\r');
+            for (size_t i = 0; valid && i < digestSize; ++i) {
+                int high = hexValue(line[2 * i]);
+                int low = hexValue(line[2 * i + 1]);
+                valid = high >= 0 && low >= 0;
+                digest[i] = static_cast<unsigned char>((high << 4) | low);
+            }
+            if (!valid) {
+                throw std::invalid_argument("Line " + std::to_string(lineNumber) + " is not a SHA-1 hex digest.");
+            }
+
+            if (written != 0 && digest <= previous) {
+                if (digest == previous) {
+                    continue; // Dumps merged from several sources repeat hashes
+                }
+                throw std::invalid_argument("Line " + std::to_string(lineNumber) + " is out of order; sort the list by hash first.");
+            }
+            output.write(reinterpret_cast<const char *>(digest.data()), digestSize);
+            previous = digest;
+            ++written;
+        }
+        output.close();
+        if (!output) {
+            throw std::ios_base::failure("Unable to write '" + temporaryPath + "'.");
+        }
+    } catch (...) {
+        output.close();
+        std::filesystem::remove(temporaryPath);
+        throw;
+    }
+    std::filesystem::rename(temporaryPath, path);
+    return written;
+}
+
+} // namespace PasswordNS
@@ -0,0 +1,58 @@
+#ifndef BREACH_CORPUS_H
+#define BREACH_CORPUS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PasswordNS
+{
+
+    using Sha1Digest = std::array<unsigned char, 20>;
+
+    Sha1Digest sha1Digest(std::string_view data);
+
+    // Read-only, memory-mapped list of breached-password SHA-1 digests: a file of raw
+    // 20-byte digests in ascending order and nothing else. Only the pages a lookup
+    // touches are read, so multi-GB corpora work without loading them. A prefix-bucket
+    // index (first index with each leading-bits prefix) narrows every lookup to a few
+    // dozen digests, usually on one page. Lookups are thread-safe.
+    class BreachCorpus
+    {
+    private:
+        const unsigned char *digests = nullptr;
+        size_t count = 0;
+        size_t prefixBits = 0;
+        std::vector<uint64_t> bucketStarts; // 2^prefixBits + 1 entries
+
+        size_t bucketOf(const unsigned char *digest) const;
+
+    public:
+        // Throws ios_base::failure if the file cannot be mapped and invalid_argument if it
+        // is not a sorted digest list (the index build checks the order)
+        explicit BreachCorpus(const std::string &path);
+        ~BreachCorpus() noexcept;
+
+        BreachCorpus(const BreachCorpus &) = delete;
+        BreachCorpus &operator=(const BreachCorpus &) = delete;
+
+        bool contains(const Sha1Digest &digest) const;
+        bool containsPassword(std::string_view password) const { return contains(sha1Digest(password)); }
+
+        size_t size() const { return count; }
+        size_t indexBytes() const { return bucketStarts.size() * sizeof(uint64_t); }
+    };
+
+    // Converts a hex digest list sorted by hash, one per line (the "HASH:count" lines of
+    // published breach dumps work as is), into a corpus file. Streams, so the input can
+    // be far larger than memory; throws invalid_argument on bad or out-of-order lines.
+    // Returns the number of distinct digests written.
+    size_t writeBreachCorpus(std::istream &hexList, const std::string &path);
+
+} // namespace PasswordNS
+
+#endif
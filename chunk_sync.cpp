@@ -0,0 +1,350 @@
+#include "chunk_sync.h"
+#include "durable_file.h"
+#include <openssl/sha.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace PasswordNS {
+
+namespace {
+
+const std::string manifestHeader = "password-manager-manifest 1";
+
+// 256 pseudo-random 64-bit values from splitmix64 with a fixed seed, so every machine cuts the same chunks
+const std::array<uint64_t, 256> &gearTable() {
+    static const std::array<uint64_t, 256> table = []() {
+        std::array<uint64_t, 256> values{};
+        uint64_t state = 0x5061737357617264ULL;
+        for (auto &value : values) {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            value = z ^ (z >> 31);
+        }
+        return values;
+    }();
+    return table;
+}
+
+// Mask over the top bits of the hash: with a shift-left gear hash the high bits
+// depend on the last 64 bytes, the low bits only on the last few
+uint64_t highBitMask(size_t bits) {
+    return bits == 0 ? 0 : ~uint64_t(0) << (64 - bits);
+}
+
+// Length of the chunk starting at data[0]
+size_t nextChunkLength(const unsigned char *data, size_t size, const ChunkerOptions &options, uint64_t strictMask,
+                       uint64_t looseMask) {
+    if (size <= options.minSize) {
+        return size;
+    }
+    const auto &gear = gearTable();
+    size_t limit = std::min(size, options.maxSize);
+    size_t normal = std::min(limit, options.averageSize);
+    uint64_t hash = 0;
+    size_t i = options.minSize;
+
+    // Normalized chunking: harder to cut before the average size, easier after it
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + gear[data[i]];
+        if ((hash & strictMask) == 0) {
+            return i + 1;
+        }
+    }
+    for (; i < limit; ++i) {
+        hash = (hash << 1) + gear[data[i]];
+        if ((hash & looseMask) == 0) {
+            return i + 1;
+        }
+    }
+    return limit;
+}
+
+std::string readWholeFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::ios_base::failure("Unable to open '" + path + "' for reading.");
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+// Rebuilds a file from its chunks, copying those that local already has and fetching the rest
+std::string assembleChunks(const ChunkStore &store, const std::vector<ChunkRef> &chunks, uint64_t totalSize,
+                           const std::string &local, const ChunkerOptions &options, size_t &chunksFetched,
+                           uint64_t &bytesFetched) {
+    std::unordered_map<std::string, ChunkRef> localChunks;
+    for (const auto &chunk : splitIntoChunks(local, options)) {
+        localChunks.emplace(chunk.id, chunk);
+    }
+
+    std::string data;
+    data.reserve(totalSize);
+    for (const auto &chunk : chunks) {
+        auto found = localChunks.find(chunk.id);
+        if (found != localChunks.end()) {
+            data.append(local, found->second.offset, found->second.size);
+        } else {
+            data += store.getChunk(chunk.id);
+            ++chunksFetched;
+            bytesFetched += chunk.size;
+        }
+    }
+    if (data.size() != totalSize) {
+        throw std::ios_base::failure("Chunks do not add up to the size in their manifest.");
+    }
+    return data;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+// Hash Data with SHA-256
+std::string sha256Hex(const char *data, size_t size) {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char *>(data), size, digest);
+
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(2 * SHA256_DIGEST_LENGTH);
+    for (unsigned char c : digest) {
+        hex += digits[c >> 4];
+        hex += digits[c & 0x0f];
+    }
+    return hex;
+}
+
+// Split Data into Content-Defined Chunks
+std::vector<ChunkRef> splitIntoChunks(const std::string &data, const ChunkerOptions &options) {
+    if (options.averageSize == 0 || (options.averageSize & (options.averageSize - 1)) != 0 ||
+        options.minSize >= options.averageSize || options.averageSize >= options.maxSize) {
+        throw std::invalid_argument("Chunk sizes must satisfy min < average < max with a power-of-two average.");
+    }
+
+    size_t averageBits = 0;
+    while ((size_t(1) << averageBits) < options.averageSize) {
+        ++averageBits;
+    }
+    uint64_t strictMask = highBitMask(averageBits + 2);
+    uint64_t looseMask = highBitMask(averageBits > 2 ? averageBits - 2 : 1);
+
+    std::vector<ChunkRef> chunks;
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+    size_t offset = 0;
+    while (offset < data.size()) {
+        size_t length = nextChunkLength(bytes + offset, data.size() - offset, options, strictMask, looseMask);
+        chunks.push_back({sha256Hex(data.data() + offset, length), offset, length});
+        offset += length;
+    }
+    return chunks;
+}
+
+std::string ChunkManifest::serialize() const {
+    std::ostringstream out;
+    out << manifestHeader << "\n" << "size " << totalSize << "\n";
+    for (const auto &chunk : chunks) {
+        out << chunk.id << " " << chunk.size << "\n";
+    }
+    return out.str();
+}
+
+ChunkManifest ChunkManifest::parse(const std::string &text) {
+    std::istringstream in(text);
+    std::string line;
+    if (!std::getline(in, line) || line != manifestHeader) {
+        throw std::invalid_argument("Not a chunk manifest.");
+    }
+
+    ChunkManifest manifest;
+    std::string keyword;
+    if (!(in >> keyword >> manifest.totalSize) || keyword != "size") {
+        throw std::invalid_argument("Chunk manifest is missing its size.");
+    }
+
+    ChunkRef chunk;
+    uint64_t offset = 0;
+    while (in >> chunk.id >> chunk.size) {
+        if (chunk.id.size() != 2 * SHA256_DIGEST_LENGTH) {
+            throw std::invalid_argument("Malformed chunk id in manifest: " + chunk.id);
+        }
+        chunk.offset = offset;
+        offset += chunk.size;
+        manifest.chunks.push_back(chunk);
+    }
+    if (!in.eof() || offset != manifest.totalSize) {
+        throw std::invalid_argument("Chunk manifest does not add up to its size.");
+    }
+    return manifest;
+}
+
+ChunkStore::ChunkStore(std::string storeDirectory) : directory(std::move(storeDirectory)) {
+    std::filesystem::create_directories(directory + "/chunks");
+    std::filesystem::create_directories(directory + "/manifests");
+}
+
+std::string ChunkStore::chunkPath(const std::string &id) const {
+    return directory + "/chunks/" + id.substr(0, 2) + "/" + id;
+}
+
+std::string ChunkStore::manifestPath(const std::string &name) const {
+    return directory + "/manifests/" + name + ".manifest";
+}
+
+bool ChunkStore::hasChunk(const std::string &id) const {
+    return std::filesystem::exists(chunkPath(id));
+}
+
+// Store a Chunk Unless It Is Already Present
+bool ChunkStore::putChunk(const std::string &id, const char *data, size_t size) {
+    std::string path = chunkPath(id);
+    if (std::filesystem::exists(path)) {
+        // A chunk cut short by a crash would otherwise be kept, and fail every later read
+        std::string stored = readWholeFile(path);
+        if (sha256Hex(stored.data(), stored.size()) == id) {
+            return false;
+        }
+    }
+    std::string shard = directory + "/chunks/" + id.substr(0, 2);
+    if (std::filesystem::create_directories(shard)) {
+        unsyncedDirectories.insert(directory + "/chunks"); // Holds the new shard's entry
+    }
+    writeFileAtomically(path, std::string(data, size), false);
+    unsyncedChunks.push_back(path);
+    unsyncedDirectories.insert(shard);
+    return true;
+}
+
+// Make Every Chunk Written So Far Durable
+void ChunkStore::syncChunks() {
+    for (const auto &path : unsyncedChunks) {
+        syncFile(path);
+    }
+    for (const auto &path : unsyncedDirectories) {
+        syncDirectoryOf(path + "/"); // The parent of "<dir>/" is the directory itself
+    }
+    unsyncedChunks.clear();
+    unsyncedDirectories.clear();
+}
+
+std::string ChunkStore::getChunk(const std::string &id) const {
+    std::string data = readWholeFile(chunkPath(id));
+    if (sha256Hex(data.data(), data.size()) != id) {
+        throw std::ios_base::failure("Chunk " + id + " is corrupt.");
+    }
+    return data;
+}
+
+bool ChunkStore::hasManifest(const std::string &name) const {
+    return std::filesystem::exists(manifestPath(name));
+}
+
+std::vector<std::string> ChunkStore::listManifests() const {
+    const std::string suffix = ".manifest";
+    std::vector<std::string> names;
+    for (const auto &entry : std::filesystem::directory_iterator(directory + "/manifests")) {
+        std::string file = entry.path().filename().string();
+        if (file.size() > suffix.size() && file.compare(file.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            names.push_back(file.substr(0, file.size() - suffix.size()));
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// Publish a Manifest (after all of its chunks are stored)
+uint64_t ChunkStore::putManifest(const std::string &name, const ChunkManifest &manifest, const ChunkerOptions &options) {
+    std::string text = manifest.serialize();
+    ChunkManifest root;
+    root.chunks = splitIntoChunks(text, options);
+    root.totalSize = text.size();
+
+    uint64_t bytesWritten = 0;
+    for (const auto &chunk : root.chunks) {
+        if (putChunk(chunk.id, text.data() + chunk.offset, chunk.size)) {
+            bytesWritten += chunk.size;
+        }
+    }
+    // Every chunk the manifest names, the vault's included, is on disk before the manifest is
+    syncChunks();
+    std::string rootText = root.serialize();
+    writeFileAtomically(manifestPath(name), rootText, true);
+    return bytesWritten + rootText.size();
+}
+
+ChunkManifest ChunkStore::getManifest(const std::string &name, const std::string &previousText, uint64_t &bytesRead,
+                                      const ChunkerOptions &options) const {
+    std::string rootText = readWholeFile(manifestPath(name));
+    ChunkManifest root = ChunkManifest::parse(rootText);
+
+    size_t chunksFetched = 0;
+    bytesRead = rootText.size();
+    return ChunkManifest::parse(
+        assembleChunks(*this, root.chunks, root.totalSize, previousText, options, chunksFetched, bytesRead));
+}
+
+ChunkManifest ChunkStore::getManifest(const std::string &name) const {
+    uint64_t bytesRead = 0;
+    return getManifest(name, "", bytesRead);
+}
+
+// Push a Vault to a Chunk Store
+SyncStats pushVault(const std::string &vaultPath, ChunkStore &remote, const std::string &name,
+                    const ChunkerOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    std::string data = readWholeFile(vaultPath);
+
+    ChunkManifest manifest;
+    manifest.chunks = splitIntoChunks(data, options);
+    manifest.totalSize = data.size();
+
+    SyncStats stats;
+    stats.chunks = manifest.chunks.size();
+    stats.totalBytes = data.size();
+    for (const auto &chunk : manifest.chunks) {
+        if (remote.putChunk(chunk.id, data.data() + chunk.offset, chunk.size)) {
+            ++stats.chunksTransferred;
+            stats.bytesTransferred += chunk.size;
+        }
+    }
+
+    // The manifest goes last, so a remote never names chunks it does not have
+    stats.bytesTransferred += remote.putManifest(name, manifest, options);
+    stats.seconds = secondsSince(start);
+    return stats;
+}
+
+// Pull a Vault from a Chunk Store
+SyncStats pullVault(const ChunkStore &remote, const std::string &name, const std::string &vaultPath,
+                    const ChunkerOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    const std::string manifestCache = vaultPath + ".manifest";
+    std::string previousManifest = std::filesystem::exists(manifestCache) ? readWholeFile(manifestCache) : "";
+
+    SyncStats stats;
+    ChunkManifest manifest = remote.getManifest(name, previousManifest, stats.bytesTransferred, options);
+    stats.chunks = manifest.chunks.size();
+    stats.totalBytes = manifest.totalSize;
+
+    // Chunks the local copy already has never cross the wire
+    std::string local = std::filesystem::exists(vaultPath) ? readWholeFile(vaultPath) : "";
+    std::string data = assembleChunks(remote, manifest.chunks, manifest.totalSize, local, options,
+                                      stats.chunksTransferred, stats.bytesTransferred);
+
+    writeFileAtomically(vaultPath, data, true);
+    writeFileAtomically(manifestCache, manifest.serialize(), false);
+    stats.seconds = secondsSince(start);
+    return stats;
+}
+
+} // namespace PasswordNS
@@ -0,0 +1,108 @@
+#ifndef CHUNK_SYNC_H
+#define CHUNK_SYNC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace PasswordNS
+{
+
+    // Content-defined chunking parameters; boundaries follow the data, so an edit only
+    // changes the chunks around it instead of shifting every later chunk
+    struct ChunkerOptions
+    {
+        size_t minSize = 2 * 1024;
+        size_t averageSize = 8 * 1024; // Must be a power of two
+        size_t maxSize = 64 * 1024;
+    };
+
+    // One chunk of a file, named by the SHA-256 of its bytes
+    struct ChunkRef
+    {
+        std::string id;
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    // Lowercase hex SHA-256 of data
+    std::string sha256Hex(const char *data, size_t size);
+
+    // Splits data with a gear rolling hash (FastCDC-style normalized chunking)
+    std::vector<ChunkRef> splitIntoChunks(const std::string &data, const ChunkerOptions &options = ChunkerOptions());
+
+    // Ordered chunk list that rebuilds one file
+    struct ChunkManifest
+    {
+        std::vector<ChunkRef> chunks;
+        uint64_t totalSize = 0;
+
+        std::string serialize() const;
+        static ChunkManifest parse(const std::string &text); // Throws invalid_argument on malformed input
+    };
+
+    // Directory of immutable chunks stored as <dir>/chunks/<first two hex digits>/<id>.
+    // A large vault has a large manifest, so the manifest text is chunked as well and
+    // <dir>/manifests/<name>.manifest only lists the manifest's own chunks.
+    // Chunks are written without fsync; putManifest() syncs them all, and their directories,
+    // before the manifest naming them is published, so a durable manifest never points at
+    // chunks lost in a power failure.
+    class ChunkStore
+    {
+    private:
+        std::string directory;
+        std::vector<std::string> unsyncedChunks;   // Written since the last putManifest()
+        std::set<std::string> unsyncedDirectories; // Directories whose new entries are not durable yet
+
+        void syncChunks();
+
+        std::string chunkPath(const std::string &id) const;
+        std::string manifestPath(const std::string &name) const;
+
+    public:
+        explicit ChunkStore(std::string storeDirectory);
+
+        bool hasChunk(const std::string &id) const;
+        // Returns false when the chunk was already stored intact; a damaged copy is replaced
+        bool putChunk(const std::string &id, const char *data, size_t size);
+        // Reads a chunk and checks it against its id (throws ios_base::failure if missing or corrupt)
+        std::string getChunk(const std::string &id) const;
+
+        bool hasManifest(const std::string &name) const;
+        std::vector<std::string> listManifests() const; // Sorted names
+        // Returns the bytes written (new manifest chunks plus the root listing)
+        uint64_t putManifest(const std::string &name, const ChunkManifest &manifest,
+                             const ChunkerOptions &options = ChunkerOptions());
+        // previousText is an earlier manifest text whose chunks need not be read again;
+        // bytesRead receives the bytes actually fetched
+        ChunkManifest getManifest(const std::string &name, const std::string &previousText, uint64_t &bytesRead,
+                                  const ChunkerOptions &options = ChunkerOptions()) const;
+        ChunkManifest getManifest(const std::string &name) const;
+
+        const std::string &getDirectory() const { return directory; }
+    };
+
+    // What a push or pull moved
+    struct SyncStats
+    {
+        size_t chunks = 0;            // Chunks in the manifest
+        size_t chunksTransferred = 0; // Chunks that had to be copied
+        uint64_t totalBytes = 0;      // Size of the vault
+        uint64_t bytesTransferred = 0; // Chunk bytes plus the manifest
+        double seconds = 0.0;
+    };
+
+    // Uploads the chunks of vaultPath the remote does not have yet, then its manifest under name
+    SyncStats pushVault(const std::string &vaultPath, ChunkStore &remote, const std::string &name,
+                        const ChunkerOptions &options = ChunkerOptions());
+
+    // Rebuilds vaultPath from the remote manifest, reusing chunks found in the current local file.
+    // The manifest is kept next to the vault (vaultPath + ".manifest") so the next pull reuses it too.
+    SyncStats pullVault(const ChunkStore &remote, const std::string &name, const std::string &vaultPath,
+                        const ChunkerOptions &options = ChunkerOptions());
+
+} // namespace PasswordNS
+
+#endif
@@ -0,0 +1,455 @@
+// cli.cpp
+// Headless entry point for scripting bulk vault operations without wxWidgets.
+#include <iostream>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include "batch_io.h"
+#include "breach_corpus.h"
+#include "chunk_sync.h"
+#include "durable_file.h"
+#include "encryption.h"
+#include "manager.h"
+#include "metrics.h"
+#include "vault_bundle.h"
+#include "vault_audit.h"
+#include "vault_store.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: password_manager_cli <command> --user <name> [options] [file]\n"
+              << "       password_manager_cli verify --store <dir> [--threads <n>]\n"
+              << "       password_manager_cli breach-corpus <file|-> --breaches <corpus>\n"
+              << "\n"
+              << "Commands:\n"
+              << "  import <file|->   Encrypt plaintext entries and append them to the user's vault\n"
+              << "  export <file|->   Decrypt the user's vault and write plaintext entries\n"
+              << "  count             Print the number of entries in the user's vault\n"
+              << "  audit             Report reused, weak, breached and unreadable passwords in the user's vault\n"
+              << "  breach-corpus <file|->  Convert a hex SHA-1 list sorted by hash into a --breaches corpus\n"
+              << "  verify            Load and decrypt every vault in a sharded vault store\n"
+              << "  push <dir>        Upload the chunks of the user's vault that <dir> does not have yet\n"
+              << "  pull <dir>        Rebuild the user's vault from <dir>, fetching only missing chunks\n"
+              << "  bundle-export <file|->  Write the user's vault as a bundle encrypted with a passphrase\n"
+              << "  bundle-import <file|->  Add the entries of a bundle to the user's vault\n"
+              << "  rekey             Re-encrypt the user's vault under the key from PASSWORD_MANAGER_NEW_VAULT_PASSPHRASE\n"
+              << "\n"
+              << "Options:\n"
+              << "  --user <name>        Vault owner (reads/writes <name>_passwords.dat)\n"
+              << "  --store <dir>        Root directory of a sharded multi-user vault store\n"
+              << "  --breaches <corpus>  Breached-password corpus for audit (output of breach-corpus)\n"
+              << "  --format csv|jsonl   Plaintext format (default: csv)\n"
+              << "  --threads <n>        Encryption worker threads (default: all cores)\n"
+              << "  --batch <n>          Entries held in memory at a time (default: 4096)\n"
+              << "  --progress <n>       Report progress every n entries, 0 to disable (default: 100000)\n"
+              << "\n"
+              << "Bundle commands read the passphrase from PASSWORD_MANAGER_BUNDLE_PASSPHRASE.\n"
+              << "Vaults are encrypted with a key derived from PASSWORD_MANAGER_VAULT_PASSPHRASE, or the default key\n"
+              << "when it is not set.\n";
+}
+
+// Progress goes to stderr so exports to stdout stay clean
+void reportProgress(const char *verb, const BatchStats &stats) {
+    std::cerr << verb << " " << stats.processed << " entries (" << stats.skipped << " skipped) in "
+              << stats.seconds << " s, " << static_cast<size_t>(stats.entriesPerSecond()) << " entries/s" << std::endl;
+}
+
+size_t parseCount(const std::string &option, const std::string &value) {
+    try {
+        size_t used = 0;
+        long long parsed = std::stoll(value, &used);
+        if (used != value.size() || parsed < 0) {
+            throw std::invalid_argument(value);
+        }
+        return static_cast<size_t>(parsed);
+    } catch (const std::exception &) {
+        throw std::invalid_argument("Invalid value for " + option + ": " + value);
+    }
+}
+
+// Commands below read or append to the vault file directly, so in-place edits still in the journal are written into it first
+void foldJournal(const std::string &user) {
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setUsername(user);
+    manager.setEncryptionKey(PasswordManager::startupEncryptionKey(user));
+    if (std::filesystem::exists(manager.getJournalFileName())) {
+        manager.loadCredentialsFromFile();
+        manager.compactVault();
+    }
+}
+
+int runImport(const std::string &user, const std::string &path, const BatchOptions &options) {
+    foldJournal(user);
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setUsername(user);
+    manager.setEncryptionKey(PasswordManager::startupEncryptionKey(user));
+
+    std::ifstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file.is_open()) {
+            throw std::ios_base::failure("Unable to open '" + path + "' for reading.");
+        }
+    }
+    std::istream &input = path == "-" ? std::cin : file;
+
+    // The vault is copied beside itself, each batch is appended to the copy as it is encrypted, and
+    // the copy is renamed over the vault. Memory stays constant, and a crash or a full disk cannot
+    // leave a torn last line that would stop the whole vault from loading.
+    std::string vaultPath = manager.getVaultFileName();
+    std::string importName = vaultPath + ".import";
+    BatchStats stats;
+    try {
+        bool endsInNewline = true;
+        if (std::filesystem::exists(vaultPath)) {
+            std::filesystem::copy_file(vaultPath, importName, std::filesystem::copy_options::overwrite_existing);
+            std::ifstream vault(importName, std::ios::binary | std::ios::ate);
+            if (vault.tellg() > 0) {
+                vault.seekg(-1, std::ios::end);
+                endsInNewline = vault.get() == '\n';
+            }
+        }
+        std::ofstream vault(importName, std::ios::binary | std::ios::app);
+        if (!vault.is_open()) {
+            throw std::ios_base::failure("Unable to open '" + importName + "' for writing.");
+        }
+        if (!endsInNewline) {
+            vault << '\n';
+        }
+        stats = importCredentials(manager, input, vault, options,
+                                  [](const BatchStats &s) { reportProgress("Imported", s); });
+        vault.close();
+        if (!vault) {
+            throw std::ios_base::failure("Unable to write '" + importName + "'.");
+        }
+        if (stats.processed != 0) {
+            replaceFile(importName, vaultPath, manager.getDurability() != Durability::Atomic);
+        } else {
+            std::filesystem::remove(importName);
+        }
+    } catch (...) {
+        std::filesystem::remove(importName);
+        throw;
+    }
+    reportProgress("Imported", stats);
+    return 0;
+}
+
+int runExport(const std::string &user, const std::string &path, const BatchOptions &options) {
+    foldJournal(user);
+    std::string vaultName = user + "_passwords.dat";
+    std::ifstream vault(vaultName);
+    if (!vault.is_open()) {
+        throw std::ios_base::failure("Unable to open '" + vaultName + "' for reading.");
+    }
+
+    std::ofstream file;
+    if (path != "-") {
+        file.open(path, std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::ios_base::failure("Unable to open '" + path + "' for writing.");
+        }
+    }
+    std::ostream &output = path == "-" ? std::cout : file;
+
+    BatchStats stats = exportCredentials(vault, output, PasswordManager::startupEncryptionKey(user), options,
+                                         [](const BatchStats &s) { reportProgress("Exported", s); });
+    reportProgress("Exported", stats);
+    return 0;
+}
+
+int runCount(const std::string &user) {
+    foldJournal(user);
+    std::string vaultName = user + "_passwords.dat";
+    std::ifstream vault(vaultName);
+    if (!vault.is_open()) {
+        throw std::ios_base::failure("Unable to open '" + vaultName + "' for reading.");
+    }
+
+    size_t count = 0;
+    std::string line;
+    while (std::getline(vault, line)) {
+        if (!line.empty()) {
+            ++count;
+        }
+    }
+    std::cout << count << std::endl;
+    return 0;
+}
+
+// Kept out of the command line, where other users could read it
+std::string bundlePassphrase() {
+    const char *passphrase = std::getenv("PASSWORD_MANAGER_BUNDLE_PASSPHRASE");
+    if (passphrase == nullptr || *passphrase == '\0') {
+        throw std::invalid_argument("Set PASSWORD_MANAGER_BUNDLE_PASSPHRASE to the bundle passphrase.");
+    }
+    return passphrase;
+}
+
+void reportBundle(const char *verb, const BundleStats &stats) {
+    std::cerr << verb << " " << stats.entries << " entries in " << stats.frames << " frames (" << stats.bundleBytes
+              << " bundle bytes) in " << stats.seconds << " s, " << stats.megabytesPerSecond() << " MB/s" << std::endl;
+}
+
+int runBundleExport(const std::string &user, const std::string &path) {
+    foldJournal(user);
+    std::string vaultName = user + "_passwords.dat";
+    std::ifstream vault(vaultName);
+    if (!vault.is_open()) {
+        throw std::ios_base::failure("Unable to open '" + vaultName + "' for reading.");
+    }
+
+    std::ofstream file;
+    if (path != "-") {
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::ios_base::failure("Unable to open '" + path + "' for writing.");
+        }
+    }
+    std::ostream &output = path == "-" ? std::cout : file;
+    reportBundle("Exported", exportBundle(vault, output, bundlePassphrase(), PasswordManager::startupEncryptionKey(user)));
+    return 0;
+}
+
+// The entries go into a copy of the vault that replaces it only once the whole bundle has checked out
+int runBundleImport(const std::string &user, const std::string &path) {
+    foldJournal(user);
+    std::string passphrase = bundlePassphrase();
+    std::ifstream file;
+    if (path != "-") {
+        file.open(path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::ios_base::failure("Unable to open '" + path + "' for reading.");
+        }
+    }
+    std::istream &input = path == "-" ? std::cin : file;
+
+    std::string vaultName = user + "_passwords.dat";
+    std::string importName = vaultName + ".import";
+    try {
+        if (std::filesystem::exists(vaultName)) {
+            std::filesystem::copy_file(vaultName, importName, std::filesystem::copy_options::overwrite_existing);
+        }
+        std::ofstream vault(importName, std::ios::app);
+        if (!vault.is_open()) {
+            throw std::ios_base::failure("Unable to open '" + importName + "' for writing.");
+        }
+        BundleStats stats = importBundle(input, vault, passphrase, PasswordManager::startupEncryptionKey(user));
+        vault.close();
+        replaceFile(importName, vaultName, true);
+        reportBundle("Imported", stats);
+    } catch (...) {
+        std::filesystem::remove(importName);
+        throw;
+    }
+    return 0;
+}
+
+void reportSync(const char *verb, const SyncStats &stats) {
+    std::cerr << verb << " " << stats.chunksTransferred << " of " << stats.chunks << " chunks, "
+              << stats.bytesTransferred << " of " << stats.totalBytes << " bytes in " << stats.seconds << " s" << std::endl;
+}
+
+int runPush(const std::string &user, const std::string &remoteDirectory) {
+    foldJournal(user);
+    ChunkStore remote(remoteDirectory);
+    reportSync("Pushed", pushVault(user + "_passwords.dat", remote, user));
+    return 0;
+}
+
+int runPull(const std::string &user, const std::string &remoteDirectory) {
+    ChunkStore remote(remoteDirectory);
+    if (!remote.hasManifest(user)) {
+        throw std::ios_base::failure("No vault for '" + user + "' in " + remoteDirectory + ".");
+    }
+    reportSync("Pulled", pullVault(remote, user, user + "_passwords.dat"));
+    return 0;
+}
+
+int runAudit(const std::string &user, size_t threads, const std::string &breachCorpus) {
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setUsername(user);
+    manager.setEncryptionKey(PasswordManager::startupEncryptionKey(user));
+    manager.loadCredentialsFromFile();
+
+    std::unique_ptr<BreachCorpus> breaches;
+    if (!breachCorpus.empty()) {
+        breaches = std::make_unique<BreachCorpus>(breachCorpus);
+    }
+
+    AuditOptions auditOptions;
+    auditOptions.threads = threads;
+    auditOptions.breaches = breaches.get();
+    AuditReport report = auditVault(manager, auditOptions);
+
+    for (const auto &cluster : report.reuseClusters) {
+        std::cout << "Reused by " << cluster.size() << " entries:";
+        for (const auto &entry : cluster) {
+            std::cout << " " << entry.service << " (" << entry.username << ")";
+        }
+        std::cout << "\n";
+    }
+    for (const auto &entry : report.weak) {
+        std::cout << "Weak (strength " << entry.strength << " of 4): " << entry.service << " (" << entry.username << ")\n";
+    }
+    for (const auto &entry : report.breached) {
+        std::cout << "Breached: " << entry.service << " (" << entry.username << ")\n";
+    }
+    for (const auto &entry : report.unreadable) {
+        std::cout << "Unreadable: entry " << entry.index + 1 << " (" << entry.service << ")\n";
+    }
+    std::cerr << "Audited " << report.entries << " entries in " << report.seconds << " s, "
+              << static_cast<size_t>(report.entriesPerSecond()) << " entries/s: " << report.reuseClusters.size()
+              << " reuse clusters, " << report.weak.size() << " weak, " << report.breached.size() << " breached, " << report.unreadable.size() << " unreadable"
+              << std::endl;
+    bool clean = report.reuseClusters.empty() && report.weak.empty() && report.breached.empty() && report.unreadable.empty();
+    return clean ? 0 : 2;
+}
+
+int runBreachCorpus(const std::string &path, const std::string &corpus) {
+    std::ifstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file.is_open()) {
+            throw std::ios_base::failure("Unable to open '" + path + "' for reading.");
+        }
+    }
+    std::istream &input = path == "-" ? std::cin : file;
+
+    size_t written = writeBreachCorpus(input, corpus);
+    BreachCorpus check(corpus);
+    std::cerr << "Wrote " << written << " digests to " << corpus << " (" << check.indexBytes() / 1024
+              << " KB prefix index)" << std::endl;
+    return 0;
+}
+
+// The vault is opened with the current key and then switches to the new one; after this,
+// PASSWORD_MANAGER_VAULT_PASSPHRASE must hold the new passphrase
+int runRekey(const std::string &user, size_t threads) {
+    const char *passphrase = std::getenv("PASSWORD_MANAGER_NEW_VAULT_PASSPHRASE");
+    if (passphrase == nullptr || *passphrase == '\0') {
+        throw std::invalid_argument("Set PASSWORD_MANAGER_NEW_VAULT_PASSPHRASE to the new vault passphrase.");
+    }
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setUsername(user);
+    manager.setEncryptionKey(PasswordManager::startupEncryptionKey(user));
+
+    RekeyOptions rekeyOptions;
+    rekeyOptions.threads = threads;
+    RekeyStats stats = manager.rekey(EncryptionNS::deriveKey(passphrase, user), rekeyOptions);
+    std::cerr << "Re-keyed " << stats.entries << " entries (" << stats.resumedEntries << " resumed) in "
+              << stats.seconds << " s" << std::endl;
+    return 0;
+}
+
+int runVerify(const std::string &storeDirectory, size_t threads) {
+    VaultStoreOptions storeOptions;
+    storeOptions.threads = threads;
+    storeOptions.cacheCapacity = 1; // Only checking, nothing needs to stay resident
+    storeOptions.encryptionKey = PasswordManager::startupEncryptionKey;
+    VaultStore store(storeDirectory, storeOptions);
+
+    PreloadReport report = store.preloadAll(true);
+    for (const auto &failure : report.failures) {
+        std::cerr << failure.username << ": " << failure.error << std::endl;
+    }
+    std::cerr << "Verified " << report.loaded + report.failed << " vaults (" << report.failed << " failed) in "
+              << report.seconds << " s, " << static_cast<size_t>(report.vaultsPerSecond()) << " vaults/s" << std::endl;
+    return report.failed == 0 ? 0 : 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.empty() || args[0] == "--help" || args[0] == "-h") {
+        printUsage();
+        return args.empty() ? 1 : 0;
+    }
+
+    try {
+        std::string command = args[0];
+        std::string user;
+        std::string store;
+        std::string breaches;
+        std::string path;
+        BatchOptions options;
+
+        for (size_t i = 1; i < args.size(); ++i) {
+            const std::string &arg = args[i];
+            bool hasValue = i + 1 < args.size();
+            if (arg == "--user" && hasValue) {
+                user = args[++i];
+            } else if (arg == "--store" && hasValue) {
+                store = args[++i];
+            } else if (arg == "--breaches" && hasValue) {
+                breaches = args[++i];
+            } else if (arg == "--format" && hasValue) {
+                options.format = parseBatchFormat(args[++i]);
+            } else if (arg == "--threads" && hasValue) {
+                options.threads = parseCount(arg, args[++i]);
+            } else if (arg == "--batch" && hasValue) {
+                options.batchSize = parseCount(arg, args[++i]);
+            } else if (arg == "--progress" && hasValue) {
+                options.progressInterval = parseCount(arg, args[++i]);
+            } else if (path.empty() && (arg == "-" || arg.rfind("--", 0) != 0)) {
+                path = arg;
+            } else {
+                throw std::invalid_argument("Unexpected argument: " + arg);
+            }
+        }
+
+        if (command == "verify" ? store.empty() : command == "breach-corpus" ? breaches.empty() : user.empty()) {
+            throw std::invalid_argument(command == "verify"          ? "--store is required."
+                                        : command == "breach-corpus" ? "--breaches is required."
+                                                                     : "--user is required.");
+        }
+
+        int result = 1;
+        if (command == "verify") {
+            result = runVerify(store, options.threads);
+        } else if (command == "breach-corpus" && !path.empty()) {
+            result = runBreachCorpus(path, breaches);
+        } else if (command == "import" && !path.empty()) {
+            result = runImport(user, path, options);
+        } else if (command == "export" && !path.empty()) {
+            result = runExport(user, path, options);
+        } else if (command == "push" && !path.empty()) {
+            result = runPush(user, path);
+        } else if (command == "pull" && !path.empty()) {
+            result = runPull(user, path);
+        } else if (command == "bundle-export" && !path.empty()) {
+            result = runBundleExport(user, path);
+        } else if (command == "bundle-import" && !path.empty()) {
+            result = runBundleImport(user, path);
+        } else if (command == "audit") {
+            result = runAudit(user, options.threads, breaches);
+        } else if (command == "rekey") {
+            result = runRekey(user, options.threads);
+        } else if (command == "count") {
+            result = runCount(user);
+        } else {
+            printUsage();
+            return 1;
+        }
+
+        // Set PASSWORD_MANAGER_METRICS=metrics.prom (or .txt) to keep operation latencies from this run
+        MetricsNS::writeSnapshotFromEnvironment();
+        return result;
+    }
+    catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
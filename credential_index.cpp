@@ -0,0 +1,275 @@
+#include "credential_index.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace PasswordNS {
+
+namespace {
+
+// Backslash-escapes the separators of the sidecar format: tab between columns, comma between tags
+std::string escapeField(const std::string &text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '\\': escaped += "\\\\"; break;
+        case '\t': escaped += "\\t"; break;
+        case '\n': escaped += "\\n"; break;
+        case ',': escaped += "\\,"; break;
+        default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+// Splits text at unescaped separators and unescapes each part
+std::vector<std::string> splitEscaped(const std::string &text, char separator) {
+    std::vector<std::string> parts(1);
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == separator) {
+            parts.emplace_back();
+        } else if (c == '\\' && i + 1 < text.size()) {
+            char next = text[++i];
+            parts.back() += next == 't' ? '\t' : next == 'n' ? '\n' : next;
+        } else {
+            parts.back() += c;
+        }
+    }
+    return parts;
+}
+
+int64_t parseTimestamp(const std::string &field) {
+    size_t end = 0;
+    int64_t value = std::stoll(field, &end);
+    if (end != field.size()) {
+        throw std::invalid_argument("Malformed metadata timestamp: '" + field + "'.");
+    }
+    return value;
+}
+
+} // namespace
+
+// Username Part of a Vault Value
+std::string usernameOf(const std::string &value) {
+    return value.substr(0, value.find(':'));
+}
+
+void CredentialIndex::unindex(const CredentialKey &key, const CredentialMetadata &metadata) {
+    auto byUsername = usernames.find(key.second);
+    if (byUsername != usernames.end() && byUsername->second.erase(key) != 0 && byUsername->second.empty()) {
+        usernames.erase(byUsername);
+    }
+    for (const auto &tag : metadata.tags) {
+        auto byTag = tags.find(tag);
+        if (byTag != tags.end() && byTag->second.erase(key) != 0 && byTag->second.empty()) {
+            tags.erase(byTag);
+        }
+    }
+    modifiedTimes.erase({metadata.modified, key});
+}
+
+void CredentialIndex::index(const CredentialKey &key, const CredentialMetadata &metadata) {
+    usernames[key.second].insert(key);
+    for (const auto &tag : metadata.tags) {
+        tags[tag].insert(key);
+    }
+    modifiedTimes.insert({metadata.modified, key});
+}
+
+// Insert or Replace the Metadata of an Entry
+void CredentialIndex::put(const CredentialKey &key, CredentialMetadata metadata) {
+    std::sort(metadata.tags.begin(), metadata.tags.end());
+    metadata.tags.erase(std::unique(metadata.tags.begin(), metadata.tags.end()), metadata.tags.end());
+
+    auto existing = records.find(key);
+    if (existing != records.end()) {
+        unindex(key, existing->second.metadata);
+        existing->second.metadata = std::move(metadata);
+        index(key, existing->second.metadata);
+    } else {
+        index(key, records.emplace(key, Record{std::move(metadata), {}}).first->second.metadata);
+    }
+}
+
+bool CredentialIndex::erase(const CredentialKey &key) {
+    auto existing = records.find(key);
+    if (existing == records.end()) {
+        return false;
+    }
+    unindex(key, existing->second.metadata);
+    records.erase(existing);
+    return true;
+}
+
+// Remove Every Username of a Service
+size_t CredentialIndex::eraseService(const std::string &service) {
+    size_t removed = 0;
+    auto it = records.lower_bound({service, std::string()});
+    while (it != records.end() && it->first.first == service) {
+        unindex(it->first, it->second.metadata);
+        it = records.erase(it);
+        ++removed;
+    }
+    return removed;
+}
+
+const CredentialMetadata *CredentialIndex::find(const CredentialKey &key) const {
+    auto existing = records.find(key);
+    return existing == records.end() ? nullptr : &existing->second.metadata;
+}
+
+void CredentialIndex::addEntry(const CredentialKey &key, EntryId id) {
+    auto existing = records.find(key);
+    if (existing == records.end()) {
+        put(key, CredentialMetadata());
+        existing = records.find(key);
+    }
+    auto &entries = existing->second.entries;
+    entries.insert(std::upper_bound(entries.begin(), entries.end(), id), id);
+}
+
+bool CredentialIndex::removeEntry(const CredentialKey &key, EntryId id) {
+    auto existing = records.find(key);
+    if (existing == records.end()) {
+        return false;
+    }
+    auto &entries = existing->second.entries;
+    auto it = std::lower_bound(entries.begin(), entries.end(), id);
+    if (it == entries.end() || *it != id) {
+        return false;
+    }
+    entries.erase(it);
+    if (entries.empty()) {
+        erase(key);
+    }
+    return true;
+}
+
+std::vector<EntryId> CredentialIndex::entriesOf(const CredentialKey &key) const {
+    auto existing = records.find(key);
+    return existing == records.end() ? std::vector<EntryId>() : existing->second.entries;
+}
+
+std::vector<EntryId> CredentialIndex::entriesOfService(const std::string &service) const {
+    std::vector<EntryId> entries;
+    for (auto it = records.lower_bound({service, std::string()}); it != records.end() && it->first.first == service; ++it) {
+        entries.insert(entries.end(), it->second.entries.begin(), it->second.entries.end());
+    }
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+void CredentialIndex::clear() {
+    records.clear();
+    usernames.clear();
+    tags.clear();
+    modifiedTimes.clear();
+}
+
+std::vector<CredentialKey> CredentialIndex::findByUsername(const std::string &username) const {
+    auto found = usernames.find(username);
+    return found == usernames.end() ? std::vector<CredentialKey>()
+                                    : std::vector<CredentialKey>(found->second.begin(), found->second.end());
+}
+
+std::vector<CredentialKey> CredentialIndex::findByTag(const std::string &tag) const {
+    auto found = tags.find(tag);
+    return found == tags.end() ? std::vector<CredentialKey>()
+                               : std::vector<CredentialKey>(found->second.begin(), found->second.end());
+}
+
+std::vector<CredentialKey> CredentialIndex::findModifiedBetween(int64_t from, int64_t to) const {
+    std::vector<CredentialKey> keys;
+    for (auto it = modifiedTimes.lower_bound({from, CredentialKey()}); it != modifiedTimes.end() && it->first <= to; ++it) {
+        keys.push_back(it->second);
+    }
+    return keys;
+}
+
+// Match the Index to a Replaced Credential List
+void CredentialIndex::sync(const PersistentVector<std::pair<std::string, std::string>> &credentials) {
+    std::map<CredentialKey, Record> kept;
+    EntryId id = 0;
+    for (const auto &entry : credentials) {
+        CredentialKey key(entry.first, usernameOf(entry.second));
+        auto record = kept.find(key);
+        if (record == kept.end()) {
+            auto existing = records.find(key);
+            record = kept.emplace(key, Record{existing == records.end() ? CredentialMetadata()
+                                                                        : std::move(existing->second.metadata),
+                                              {}})
+                         .first;
+        }
+        record->second.entries.push_back(++id);
+    }
+
+    clear();
+    records = std::move(kept);
+    for (const auto &record : records) {
+        index(record.first, record.second.metadata);
+    }
+}
+
+// Sidecar Text: service, username, created, modified, url, tags
+std::string CredentialIndex::serialize() const {
+    std::string text;
+    for (const auto &record : records) {
+        const CredentialMetadata &metadata = record.second.metadata;
+        if (metadata == CredentialMetadata()) {
+            continue;
+        }
+        text.append(escapeField(record.first.first)).append("\t").append(escapeField(record.first.second));
+        text.append("\t").append(std::to_string(metadata.created)).append("\t").append(std::to_string(metadata.modified));
+        text.append("\t").append(escapeField(metadata.url)).append("\t");
+        for (size_t t = 0; t < metadata.tags.size(); ++t) {
+            text.append(t == 0 ? "" : ",").append(escapeField(metadata.tags[t]));
+        }
+        text.append("\n");
+    }
+    return text;
+}
+
+CredentialIndex CredentialIndex::parse(const std::string &text) {
+    CredentialIndex parsed;
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = text.size();
+        }
+        std::string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        if (line.empty()) {
+            continue;
+        }
+
+        // Split columns first, keeping escapes, so commas inside tags survive until the tags are split
+        std::vector<std::string> columns(1);
+        for (size_t i = 0; i < line.size(); ++i) {
+            if (line[i] == '\t') {
+                columns.emplace_back();
+            } else {
+                columns.back() += line[i];
+                if (line[i] == '\\' && i + 1 < line.size()) {
+                    columns.back() += line[++i];
+                }
+            }
+        }
+        if (columns.size() != 6) {
+            throw std::invalid_argument("Malformed metadata record: expected 6 columns.");
+        }
+
+        CredentialMetadata metadata;
+        metadata.created = parseTimestamp(columns[2]);
+        metadata.modified = parseTimestamp(columns[3]);
+        metadata.url = splitEscaped(columns[4], '\t')[0];
+        if (!columns[5].empty()) {
+            metadata.tags = splitEscaped(columns[5], ',');
+        }
+        parsed.put({splitEscaped(columns[0], '\t')[0], splitEscaped(columns[1], '\t')[0]}, std::move(metadata));
+    }
+    return parsed;
+}
+
+} // namespace PasswordNS
@@ -0,0 +1,89 @@
+#ifndef CREDENTIAL_INDEX_H
+#define CREDENTIAL_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "entry_ids.h"
+#include "persistent_vector.h"
+
+namespace PasswordNS
+{
+
+    // A vault entry named by (service, username), the plaintext part of its record
+    using CredentialKey = std::pair<std::string, std::string>;
+
+    // Plaintext columns kept beside each entry; timestamps are Unix seconds, 0 when unknown
+    struct CredentialMetadata
+    {
+        std::vector<std::string> tags;
+        std::string url;
+        int64_t created = 0;
+        int64_t modified = 0;
+
+        bool operator==(const CredentialMetadata &other) const
+        {
+            return tags == other.tags && url == other.url && created == other.created && modified == other.modified;
+        }
+    };
+
+    // Metadata of every vault entry with secondary indexes by username, tag and modification
+    // time. Each change updates the indexes in O(log n) instead of rebuilding them, and no query
+    // reads ciphertext. Entries without metadata still appear, with empty columns.
+    // A key may name several entries (a service can hold more than one password for an account),
+    // so each key also lists the ids of its entries: this is the (service, account) multimap.
+    class CredentialIndex
+    {
+    private:
+        struct Record
+        {
+            CredentialMetadata metadata;
+            std::vector<EntryId> entries; // Ascending, which is vault order
+        };
+
+        std::map<CredentialKey, Record> records;
+        std::unordered_map<std::string, std::set<CredentialKey>> usernames;
+        std::unordered_map<std::string, std::set<CredentialKey>> tags;
+        std::set<std::pair<int64_t, CredentialKey>> modifiedTimes;
+
+        void unindex(const CredentialKey &key, const CredentialMetadata &metadata);
+        void index(const CredentialKey &key, const CredentialMetadata &metadata);
+
+    public:
+        // Inserts or replaces the metadata of key; duplicate tags are dropped
+        void put(const CredentialKey &key, CredentialMetadata metadata);
+        bool erase(const CredentialKey &key);
+        size_t eraseService(const std::string &service); // Every username of service
+        const CredentialMetadata *find(const CredentialKey &key) const;
+        void addEntry(const CredentialKey &key, EntryId id);     // Creates the key with empty metadata if needed
+        bool removeEntry(const CredentialKey &key, EntryId id);  // The key and its metadata go with its last entry
+        std::vector<EntryId> entriesOf(const CredentialKey &key) const;
+        std::vector<EntryId> entriesOfService(const std::string &service) const; // Every account, in vault order
+        size_t size() const { return records.size(); }
+        void clear();
+
+        // Results are sorted by key, or by modification time (oldest first) for ranges
+        std::vector<CredentialKey> findByUsername(const std::string &username) const;
+        std::vector<CredentialKey> findByTag(const std::string &tag) const;
+        std::vector<CredentialKey> findModifiedBetween(int64_t from, int64_t to) const; // Inclusive
+
+        // Keeps the metadata of keys still in the vault, adds empty metadata for new ones and drops the rest;
+        // entries get the ids EntryIdIndex::reset hands out, position + 1
+        void sync(const PersistentVector<std::pair<std::string, std::string>> &credentials);
+
+        // Sidecar file text: one tab-separated line per entry that has any metadata
+        std::string serialize() const;
+        static CredentialIndex parse(const std::string &text); // Throws std::invalid_argument on malformed lines
+    };
+
+    // Username part of a "username:hex" vault value
+    std::string usernameOf(const std::string &value);
+
+} // namespace PasswordNS
+
+#endif
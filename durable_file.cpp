@@ -0,0 +1,225 @@
+#include "durable_file.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <ios>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace PasswordNS {
+
+namespace {
+
+std::ios_base::failure systemError(const std::string &what, const std::string &path) {
+    return std::ios_base::failure(what + " '" + path + "': " + std::strerror(errno));
+}
+
+void writeAll(int fd, const std::string &contents, const std::string &path) {
+    const char *data = contents.data();
+    size_t remaining = contents.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("Unable to write", path);
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+}
+
+} // namespace
+
+// Unique per process and call, so concurrent writers never share a temp file
+std::string temporaryPathFor(const std::string &path) {
+    static std::atomic<uint64_t> counter{0};
+    return path + ".tmp." + std::to_string(::getpid()) + "." + std::to_string(counter.fetch_add(1));
+}
+
+// The rename is only durable once the directory entry itself has been flushed
+void syncDirectoryOf(const std::string &path) {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    std::string directory = parent.empty() ? "." : parent.string();
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        throw systemError("Unable to open directory", directory);
+    }
+    int result = ::fsync(fd);
+    ::close(fd);
+    if (result != 0) {
+        throw systemError("Unable to sync directory", directory);
+    }
+}
+
+void syncFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw systemError("Unable to open", path);
+    }
+    int result = ::fsync(fd);
+    ::close(fd);
+    if (result != 0) {
+        throw systemError("Unable to sync", path);
+    }
+}
+
+// Write a File by Replacing It Atomically
+void writeFileAtomically(const std::string &path, const std::string &contents, bool sync) {
+    std::string temporaryPath = temporaryPathFor(path);
+    int fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        throw systemError("Unable to open", temporaryPath);
+    }
+
+    try {
+        writeAll(fd, contents, temporaryPath);
+        if (sync && ::fsync(fd) != 0) {
+            throw systemError("Unable to sync", temporaryPath);
+        }
+        if (::close(fd) != 0) {
+            fd = -1;
+            throw systemError("Unable to close", temporaryPath);
+        }
+        fd = -1;
+        if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+            throw systemError("Unable to replace", path);
+        }
+    } catch (...) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        std::remove(temporaryPath.c_str());
+        throw;
+    }
+
+    if (sync) {
+        syncDirectoryOf(path);
+    }
+}
+
+// Append to a File, Creating It If Needed
+void appendToFile(const std::string &path, const std::string &contents, bool sync) {
+    bool created = !std::filesystem::exists(path);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd < 0) {
+        throw systemError("Unable to open", path);
+    }
+    try {
+        writeAll(fd, contents, path);
+        if (sync && ::fsync(fd) != 0) {
+            throw systemError("Unable to sync", path);
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw systemError("Unable to close", path);
+    }
+    if (sync && created) {
+        syncDirectoryOf(path);
+    }
+}
+
+// Replace a File with One Written Elsewhere
+void replaceFile(const std::string &source, const std::string &path, bool sync) {
+    if (sync) {
+        syncFile(source);
+    }
+    if (std::rename(source.c_str(), path.c_str()) != 0) {
+        throw systemError("Unable to replace", path);
+    }
+    if (sync) {
+        syncDirectoryOf(path);
+    }
+}
+
+GroupCommitter::GroupCommitter(std::string filePath, std::chrono::microseconds commitWindow)
+    : path(std::move(filePath)), window(commitWindow), writer(&GroupCommitter::writerLoop, this) {}
+
+GroupCommitter::~GroupCommitter() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    pendingChanged.notify_all();
+    writer.join();
+}
+
+// Queue New File Contents
+uint64_t GroupCommitter::submit(std::string contents) {
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::move(contents);
+        ticket = ++submitted;
+    }
+    pendingChanged.notify_one();
+    return ticket;
+}
+
+// Wait Until a Submission Is on Disk
+void GroupCommitter::wait(uint64_t ticket) {
+    std::unique_lock<std::mutex> lock(mutex);
+    committed.wait(lock, [this, ticket] { return settled >= ticket; });
+    if (durable < ticket) {
+        std::rethrow_exception(error);
+    }
+}
+
+void GroupCommitter::flush() {
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ticket = submitted;
+    }
+    wait(ticket);
+}
+
+uint64_t GroupCommitter::commits() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return commitCount;
+}
+
+void GroupCommitter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        pendingChanged.wait(lock, [this] { return stopping || submitted > settled; });
+        if (submitted == settled) {
+            return; // Stopping with nothing left to commit
+        }
+
+        // Let the window fill up; saves arriving meanwhile only replace the pending contents
+        if (!stopping && window.count() > 0) {
+            pendingChanged.wait_for(lock, window, [this] { return stopping; });
+        }
+
+        std::string contents = std::move(pending);
+        uint64_t batch = submitted;
+        lock.unlock();
+
+        std::exception_ptr failure;
+        try {
+            writeFileAtomically(path, contents, true);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+
+        lock.lock();
+        settled = batch;
+        if (failure) {
+            error = failure; // The next submission retries with its own contents
+        } else {
+            durable = batch;
+            error = nullptr;
+            ++commitCount;
+        }
+        committed.notify_all();
+    }
+}
+
+} // namespace PasswordNS
@@ -0,0 +1,90 @@
+#ifndef DURABLE_FILE_H
+#define DURABLE_FILE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace PasswordNS
+{
+
+    // How vault writes reach the disk
+    enum class Durability
+    {
+        Atomic,      // Write a temp file and rename it over the vault (survives a crash of the process)
+        Sync,        // Atomic, plus fsync of the file and directory before every save returns
+        GroupCommit  // Atomic + fsync, but saves within a short window share a single fsync
+    };
+
+    // Replaces path with contents: the data goes to a temp file in the same directory
+    // which is renamed over path, so readers see either the old or the new file, never a
+    // partial one. With sync, the file and its directory are fsynced before returning.
+    void writeFileAtomically(const std::string &path, const std::string &contents, bool sync);
+
+    // Appends contents to path in one write. A crash can leave a partial tail, which
+    // readers must tolerate. With sync, the data (and a new file's directory entry) is
+    // fsynced before returning.
+    void appendToFile(const std::string &path, const std::string &contents, bool sync);
+
+    // Renames source over path, for files too large to build in memory. With sync, source
+    // is fsynced before the rename and the directory after it.
+    void replaceFile(const std::string &source, const std::string &path, bool sync);
+
+    // For writers that do the I/O themselves (async_io.h): a temp file name beside path that no
+    // other writer uses, and the fsync of path's directory that makes a rename durable
+    std::string temporaryPathFor(const std::string &path);
+    void syncDirectoryOf(const std::string &path);
+    // fsyncs a file written without sync, e.g. one of a batch that is made durable all at once
+    void syncFile(const std::string &path);
+
+    // Coalesces whole-file rewrites of one path. Every submit() replaces the pending
+    // contents; a background thread waits for the commit window to close, writes only the
+    // newest contents and fsyncs once, which makes all submissions up to then durable.
+    class GroupCommitter
+    {
+    private:
+        std::string path;
+        std::chrono::microseconds window;
+
+        std::mutex mutex;
+        std::condition_variable pendingChanged;
+        std::condition_variable committed;
+        std::string pending;
+        uint64_t submitted = 0;   // Ticket of the newest submission
+        uint64_t settled = 0;     // Every ticket up to this one has been written or has failed
+        uint64_t durable = 0;     // Every ticket up to this one is on disk
+        uint64_t commitCount = 0; // Number of fsynced writes
+        std::exception_ptr error; // Failure of the last write, reported by wait() for unsettled tickets
+        bool stopping = false;
+        std::thread writer;
+
+        void writerLoop();
+
+    public:
+        explicit GroupCommitter(std::string filePath,
+                                std::chrono::microseconds commitWindow = std::chrono::milliseconds(2));
+        ~GroupCommitter() noexcept; // Commits what is pending, then stops the writer
+
+        GroupCommitter(const GroupCommitter &) = delete;
+        GroupCommitter &operator=(const GroupCommitter &) = delete;
+
+        // Queues contents as the new file and returns its ticket without waiting for the disk
+        uint64_t submit(std::string contents);
+
+        // Blocks until the ticket is durable; rethrows the write error if the commit failed
+        void wait(uint64_t ticket);
+
+        // Blocks until everything submitted so far is durable
+        void flush();
+
+        uint64_t commits();
+        const std::string &getPath() const { return path; }
+    };
+
+} // namespace PasswordNS
+
+#endif
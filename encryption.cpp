@@ -1,15 +1,35 @@
 #include "encryption.h"
 #include <openssl/aes.h>
 #include <openssl/evp.h>
+#include <openssl/crypto.h>
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <stdexcept>
 #include <vector>
 #include <memory> // For smart pointers
+#include "aes_batch.h"
+#include "metrics.h"
 
 namespace EncryptionNS {
 
+namespace {
+
+constexpr int aeadTagSize = 16;
+
+// AES-256 reads 32 key bytes whatever the string holds, so shorter keys would read past it
+void checkKey(const std::string &key) {
+    if (key.size() < 32) {
+        throw std::invalid_argument("Encryption keys must be at least 32 bytes.");
+    }
+}
+
+} // namespace
+
 // Encrypt Function
 std::vector<unsigned char> encrypt(const std::string &plaintext, const std::string &key) {
+    METRICS_SCOPE(MetricsNS::Operation::Encrypt);
+    checkKey(key);
     const unsigned char *key_data = reinterpret_cast<const unsigned char *>(key.c_str());
     unsigned char iv[16] = {}; // Use a secure random IV in production
     std::vector<unsigned char> ciphertext(plaintext.size() + AES_BLOCK_SIZE);
@@ -32,11 +52,14 @@ std::vector<unsigned char> encrypt(const std::string &plaintext, const std::stri
     return ciphertext;
 }
 
-// Decrypt Function
-std::string decrypt(const std::vector<unsigned char> &ciphertext, const std::string &key) {
+namespace {
+
+// Decrypts into output, which must hold ciphertext.size() + EVP_MAX_BLOCK_LENGTH bytes; returns the plaintext length
+size_t decryptInto(const std::vector<unsigned char> &ciphertext, const std::string &key, unsigned char *output) {
+    METRICS_SCOPE(MetricsNS::Operation::Decrypt);
+    checkKey(key);
     const unsigned char *key_data = reinterpret_cast<const unsigned char *>(key.c_str());
     unsigned char iv[16] = {}; // Use the same IV used for encryption
-    std::vector<unsigned char> plaintext(ciphertext.size());
     int out_len = 0;
 
     // Use a unique_ptr with a custom deleter for automatic cleanup of the cipher context
@@ -44,14 +67,313 @@ std::string decrypt(const std::vector<unsigned char> &ciphertext, const std::str
     if (!ctx) throw std::runtime_error("Failed to create cipher context");
 
     EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_cbc(), nullptr, key_data, iv);
-    EVP_DecryptUpdate(ctx.get(), plaintext.data(), &out_len, ciphertext.data(), ciphertext.size());
+    EVP_DecryptUpdate(ctx.get(), output, &out_len, ciphertext.data(), ciphertext.size());
     int total_len = out_len;
 
-    EVP_DecryptFinal_ex(ctx.get(), plaintext.data() + out_len, &out_len);
+    // Bad padding almost always means the wrong key; garbage must not pass for a password
+    if (EVP_DecryptFinal_ex(ctx.get(), output + out_len, &out_len) != 1) {
+        OPENSSL_cleanse(output, static_cast<size_t>(total_len));
+        throw std::invalid_argument("Ciphertext does not decrypt with this key.");
+    }
     total_len += out_len;
-    plaintext.resize(total_len);
+    return static_cast<size_t>(total_len);
+}
+
+} // namespace
+
+// Decrypt Function
+std::string decrypt(const std::vector<unsigned char> &ciphertext, const std::string &key) {
+    std::vector<unsigned char> plaintext(ciphertext.size() + EVP_MAX_BLOCK_LENGTH);
+    size_t length = decryptInto(ciphertext, key, plaintext.data());
+    std::string result(plaintext.begin(), plaintext.begin() + length);
+    OPENSSL_cleanse(plaintext.data(), plaintext.size()); // Only the returned copy is left
+    return result;
+}
+
+// Decrypt straight into protected memory
+SecureString decryptSecure(const std::vector<unsigned char> &ciphertext, const std::string &key,
+                           const std::shared_ptr<SecureArena> &arena) {
+    SecureString plaintext(ciphertext.size() + EVP_MAX_BLOCK_LENGTH, arena);
+    plaintext.truncate(decryptInto(ciphertext, key, reinterpret_cast<unsigned char *>(plaintext.data())));
+    return plaintext;
+}
+
+namespace {
+
+constexpr int automaticKernel = -1;
+std::atomic<int> chosenKernel{automaticKernel};
+
+AesKernel batchKernel() {
+    static const AesKernel best = availableAesKernels().front();
+    int chosen = chosenKernel.load(std::memory_order_relaxed);
+    return chosen == automaticKernel ? best : static_cast<AesKernel>(chosen);
+}
+
+// Length of the plaintext once a PKCS#7 pad is checked and stripped, or npos when the pad is
+// malformed, which is what EVP_DecryptFinal_ex rejects
+size_t unpaddedLength(const unsigned char *plaintext, size_t size) {
+    unsigned char pad = plaintext[size - 1];
+    if (pad == 0 || pad > AES_BLOCK_SIZE) {
+        return std::string::npos;
+    }
+    for (size_t i = size - pad; i < size; ++i) {
+        if (plaintext[i] != pad) {
+            return std::string::npos;
+        }
+    }
+    return size - pad;
+}
+
+// Decrypts ciphertexts[i] into outputs[i], which must hold its size + EVP_MAX_BLOCK_LENGTH bytes;
+// returns the plaintext lengths, with npos for entries that do not decrypt (their output is wiped)
+std::vector<size_t> decryptBatchInto(const std::vector<std::vector<unsigned char>> &ciphertexts, const std::string &key,
+                                     const std::vector<unsigned char *> &outputs) {
+    checkKey(key);
+    std::vector<size_t> lengths(ciphertexts.size(), std::string::npos);
+    AesKernel kernel = batchKernel();
+    if (kernel == AesKernel::Evp) {
+        for (size_t i = 0; i < ciphertexts.size(); ++i) {
+            try {
+                lengths[i] = decryptInto(ciphertexts[i], key, outputs[i]);
+            } catch (const std::invalid_argument &) {
+                // Left at npos
+            }
+        }
+        return lengths;
+    }
+
+    METRICS_SCOPE_BATCH(MetricsNS::Operation::Decrypt, ciphertexts.size()); // EVP records each entry itself
+    std::vector<CbcBuffer> buffers;
+    buffers.reserve(ciphertexts.size());
+    for (size_t i = 0; i < ciphertexts.size(); ++i) {
+        // Empty or partial-block ciphertext cannot be ours; EVP refuses it too
+        size_t size = ciphertexts[i].size();
+        bool whole = size != 0 && size % AES_BLOCK_SIZE == 0;
+        buffers.push_back({ciphertexts[i].data(), outputs[i], whole ? size / AES_BLOCK_SIZE : 0});
+    }
+    cbcDecryptBatch(kernel, reinterpret_cast<const unsigned char *>(key.data()), buffers);
+    for (size_t i = 0; i < ciphertexts.size(); ++i) {
+        size_t size = buffers[i].blocks * AES_BLOCK_SIZE;
+        if (size != 0) {
+            lengths[i] = unpaddedLength(outputs[i], size);
+            if (lengths[i] == std::string::npos) {
+                OPENSSL_cleanse(outputs[i], size);
+            }
+        }
+    }
+    return lengths;
+}
+
+void reportFailures(const std::vector<size_t> &lengths, std::vector<bool> *failed) {
+    if (failed != nullptr) {
+        failed->assign(lengths.size(), false);
+        for (size_t i = 0; i < lengths.size(); ++i) {
+            (*failed)[i] = lengths[i] == std::string::npos;
+        }
+    } else if (std::find(lengths.begin(), lengths.end(), std::string::npos) != lengths.end()) {
+        throw std::invalid_argument("Ciphertext does not decrypt with this key.");
+    }
+}
+
+} // namespace
+
+// Encrypt Many Entries Under One Key
+std::vector<std::vector<unsigned char>> encryptBatch(const std::vector<std::string> &plaintexts, const std::string &key) {
+    checkKey(key);
+    std::vector<std::vector<unsigned char>> ciphertexts;
+    ciphertexts.reserve(plaintexts.size());
+    AesKernel kernel = batchKernel();
+    if (kernel == AesKernel::Evp) {
+        for (const auto &plaintext : plaintexts) {
+            ciphertexts.push_back(encrypt(plaintext, key));
+        }
+        return ciphertexts;
+    }
+
+    METRICS_SCOPE_BATCH(MetricsNS::Operation::Encrypt, plaintexts.size()); // EVP records each entry itself
+    // PKCS#7 as EVP does it: always at least one byte of pad, a whole block when already aligned
+    std::vector<CbcBuffer> buffers;
+    buffers.reserve(plaintexts.size());
+    for (const auto &plaintext : plaintexts) {
+        size_t blocks = plaintext.size() / AES_BLOCK_SIZE + 1;
+        unsigned char pad = static_cast<unsigned char>(blocks * AES_BLOCK_SIZE - plaintext.size());
+        ciphertexts.emplace_back(blocks * AES_BLOCK_SIZE, pad);
+        std::memcpy(ciphertexts.back().data(), plaintext.data(), plaintext.size());
+        buffers.push_back({ciphertexts.back().data(), ciphertexts.back().data(), blocks});
+    }
+    cbcEncryptBatch(kernel, reinterpret_cast<const unsigned char *>(key.data()), buffers);
+    return ciphertexts;
+}
+
+// Decrypt Many Entries Under One Key
+std::vector<std::string> decryptBatch(const std::vector<std::vector<unsigned char>> &ciphertexts, const std::string &key,
+                                      std::vector<bool> *failed) {
+    // One scratch buffer for the whole batch, wiped once the strings are made
+    std::vector<size_t> offsets;
+    size_t total = 0;
+    for (const auto &ciphertext : ciphertexts) {
+        offsets.push_back(total);
+        total += ciphertext.size() + EVP_MAX_BLOCK_LENGTH;
+    }
+    std::vector<unsigned char> scratch(total);
+    std::vector<unsigned char *> outputs;
+    for (size_t offset : offsets) {
+        outputs.push_back(scratch.data() + offset);
+    }
+
+    std::vector<size_t> lengths = decryptBatchInto(ciphertexts, key, outputs);
+    std::vector<std::string> plaintexts(ciphertexts.size());
+    for (size_t i = 0; i < ciphertexts.size(); ++i) {
+        if (lengths[i] != std::string::npos) {
+            plaintexts[i].assign(reinterpret_cast<const char *>(outputs[i]), lengths[i]);
+        }
+    }
+    OPENSSL_cleanse(scratch.data(), scratch.size());
+    reportFailures(lengths, failed);
+    return plaintexts;
+}
+
+// Decrypt Many Entries Straight Into Protected Memory
+std::vector<SecureString> decryptSecureBatch(const std::vector<std::vector<unsigned char>> &ciphertexts,
+                                             const std::string &key, const std::shared_ptr<SecureArena> &arena,
+                                             std::vector<bool> *failed) {
+    std::vector<SecureString> plaintexts;
+    std::vector<unsigned char *> outputs;
+    plaintexts.reserve(ciphertexts.size());
+    for (const auto &ciphertext : ciphertexts) {
+        plaintexts.emplace_back(ciphertext.size() + EVP_MAX_BLOCK_LENGTH, arena);
+        outputs.push_back(reinterpret_cast<unsigned char *>(plaintexts.back().data()));
+    }
+
+    std::vector<size_t> lengths = decryptBatchInto(ciphertexts, key, outputs);
+    for (size_t i = 0; i < plaintexts.size(); ++i) {
+        plaintexts[i].truncate(lengths[i] == std::string::npos ? 0 : lengths[i]);
+    }
+    reportFailures(lengths, failed);
+    return plaintexts;
+}
+
+std::vector<std::string> batchCipherEngines() {
+    std::vector<std::string> engines;
+    for (AesKernel kernel : availableAesKernels()) {
+        engines.push_back(aesKernelName(kernel));
+    }
+    return engines;
+}
+
+void setBatchCipherEngine(const std::string &engine) {
+    for (AesKernel kernel : availableAesKernels()) {
+        if (engine == aesKernelName(kernel)) {
+            chosenKernel.store(static_cast<int>(kernel), std::memory_order_relaxed);
+            return;
+        }
+    }
+    throw std::invalid_argument("Unknown or unavailable batch cipher engine: " + engine);
+}
+
+std::string batchCipherEngine() {
+    return aesKernelName(batchKernel());
+}
+
+// Authenticated Encryption (AES-256-GCM)
+std::vector<unsigned char> encryptAead(const std::string &plaintext, const std::string &key, const AeadNonce &nonce,
+                                       const std::string &aad) {
+    checkKey(key);
+    std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx(EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free);
+    if (!ctx) throw std::runtime_error("Failed to create cipher context");
+
+    std::vector<unsigned char> sealed(plaintext.size() + aeadTagSize);
+    int length = 0;
+    if (EVP_EncryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, reinterpret_cast<const unsigned char *>(key.data()),
+                           nonce.data()) != 1 ||
+        EVP_EncryptUpdate(ctx.get(), nullptr, &length, reinterpret_cast<const unsigned char *>(aad.data()),
+                          static_cast<int>(aad.size())) != 1 ||
+        EVP_EncryptUpdate(ctx.get(), sealed.data(), &length, reinterpret_cast<const unsigned char *>(plaintext.data()),
+                          static_cast<int>(plaintext.size())) != 1 ||
+        EVP_EncryptFinal_ex(ctx.get(), sealed.data() + length, &length) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG, aeadTagSize, sealed.data() + plaintext.size()) != 1) {
+        throw std::runtime_error("AES-GCM encryption failed.");
+    }
+    return sealed;
+}
+
+std::string decryptAead(const std::vector<unsigned char> &sealed, const std::string &key, const AeadNonce &nonce,
+                        const std::string &aad) {
+    checkKey(key);
+    if (sealed.size() < aeadTagSize) {
+        throw std::invalid_argument("AES-GCM ciphertext is shorter than its tag.");
+    }
+    std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx(EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free);
+    if (!ctx) throw std::runtime_error("Failed to create cipher context");
+
+    size_t cipherLength = sealed.size() - aeadTagSize;
+    std::string plaintext(cipherLength, '\0');
+    std::array<unsigned char, aeadTagSize> tag;
+    std::copy(sealed.end() - aeadTagSize, sealed.end(), tag.begin());
+    int length = 0;
+    if (EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, reinterpret_cast<const unsigned char *>(key.data()),
+                           nonce.data()) != 1 ||
+        EVP_DecryptUpdate(ctx.get(), nullptr, &length, reinterpret_cast<const unsigned char *>(aad.data()),
+                          static_cast<int>(aad.size())) != 1 ||
+        EVP_DecryptUpdate(ctx.get(), reinterpret_cast<unsigned char *>(&plaintext[0]), &length, sealed.data(),
+                          static_cast<int>(cipherLength)) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG, aeadTagSize, tag.data()) != 1) {
+        throw std::runtime_error("AES-GCM decryption failed.");
+    }
+    if (EVP_DecryptFinal_ex(ctx.get(), reinterpret_cast<unsigned char *>(&plaintext[0]) + length, &length) != 1) {
+        OPENSSL_cleanse(&plaintext[0], plaintext.size());
+        throw std::invalid_argument("AES-GCM tag mismatch: wrong key or tampered data.");
+    }
+    return plaintext;
+}
+
+// Derive an Encryption Key from a Password
+std::string deriveKey(const std::string &password, const std::string &salt, int iterations) {
+    if (iterations < 1) {
+        throw std::invalid_argument("Key derivation needs at least one iteration.");
+    }
+    std::string key(32, '\0');
+    if (PKCS5_PBKDF2_HMAC(password.data(), static_cast<int>(password.size()),
+                          reinterpret_cast<const unsigned char *>(salt.data()), static_cast<int>(salt.size()), iterations,
+                          EVP_sha256(), static_cast<int>(key.size()), reinterpret_cast<unsigned char *>(&key[0])) != 1) {
+        throw std::runtime_error("Key derivation failed.");
+    }
+    return key;
+}
+
+// Convert binary data to a lowercase hex string
+std::string toHex(const std::vector<unsigned char> &bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(bytes.size() * 2);
+    for (unsigned char c : bytes) {
+        hex += digits[c >> 4];
+        hex += digits[c & 0x0f];
+    }
+    return hex;
+}
 
-    return std::string(plaintext.begin(), plaintext.end());
+// Convert a hex string back to binary data; throws on odd lengths and non-hex characters
+std::vector<unsigned char> fromHex(std::string_view hex) {
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    if (hex.size() % 2 != 0) {
+        throw std::invalid_argument("Hex string has an odd length.");
+    }
+    std::vector<unsigned char> bytes(hex.size() / 2);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        int high = nibble(hex[2 * i]);
+        int low = nibble(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            throw std::invalid_argument("Hex string has a non-hex character.");
+        }
+        bytes[i] = static_cast<unsigned char>(high << 4 | low);
+    }
+    return bytes;
 }
 
 } // namespace EncryptionNS
@@ -2,12 +2,54 @@
 #define ENCRYPTION_H
 
 #include <openssl/evp.h>
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "secure_memory.h"
 
 namespace EncryptionNS {
     std::vector<unsigned char> encrypt(const std::string &plaintext, const std::string &key);
     std::string decrypt(const std::vector<unsigned char> &ciphertext, const std::string &key);
+    // Decrypts into a SecureString, from the arena when one is given (bulk decryption)
+    SecureString decryptSecure(const std::vector<unsigned char> &ciphertext, const std::string &key,
+                               const std::shared_ptr<SecureArena> &arena = nullptr);
+
+    // Many entries under one key, with the multi-buffer kernels of aes_batch.h when the CPU has
+    // them and a loop over encrypt() and decrypt() otherwise. The ciphertexts are byte for byte
+    // those of encrypt(), so batches and single calls read each other's output.
+    std::vector<std::vector<unsigned char>> encryptBatch(const std::vector<std::string> &plaintexts,
+                                                         const std::string &key);
+    // An entry that does not decrypt throws std::invalid_argument like decrypt(), unless failed
+    // is given: then it is left empty, flagged in failed, and the rest still decrypt
+    std::vector<std::string> decryptBatch(const std::vector<std::vector<unsigned char>> &ciphertexts,
+                                          const std::string &key, std::vector<bool> *failed = nullptr);
+    std::vector<SecureString> decryptSecureBatch(const std::vector<std::vector<unsigned char>> &ciphertexts,
+                                                 const std::string &key,
+                                                 const std::shared_ptr<SecureArena> &arena = nullptr,
+                                                 std::vector<bool> *failed = nullptr);
+
+    // Kernels the batch calls can use on this CPU, best first: "vaes", "aes-ni", "evp". The best
+    // is used unless one is chosen; an unknown or unavailable name throws std::invalid_argument.
+    std::vector<std::string> batchCipherEngines();
+    void setBatchCipherEngine(const std::string &engine);
+    std::string batchCipherEngine();
+
+    // 32-byte AES key from a master password: PBKDF2-HMAC-SHA-256 over password and salt
+    std::string deriveKey(const std::string &password, const std::string &salt, int iterations = 600000);
+
+    // AES-256-GCM with a 12-byte nonce; the 16-byte tag follows the ciphertext. A nonce must
+    // never be used twice with the same key. decryptAead throws std::invalid_argument when the
+    // tag does not match: the wrong key, or ciphertext or aad that were tampered with.
+    using AeadNonce = std::array<unsigned char, 12>;
+    std::vector<unsigned char> encryptAead(const std::string &plaintext, const std::string &key, const AeadNonce &nonce,
+                                           const std::string &aad);
+    std::string decryptAead(const std::vector<unsigned char> &sealed, const std::string &key, const AeadNonce &nonce,
+                            const std::string &aad);
+
+    // Hex helpers for the "username:hex" record format
+    std::string toHex(const std::vector<unsigned char> &bytes);
+    std::vector<unsigned char> fromHex(std::string_view hex);
 }
 
 #endif
\ No newline at end of file
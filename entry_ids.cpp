@@ -0,0 +1,80 @@
+#include "entry_ids.h"
+#include <stdexcept>
+
+namespace PasswordNS {
+
+namespace {
+
+size_t lowbit(size_t i) {
+    return i & (~i + 1);
+}
+
+} // namespace
+
+size_t EntryIdIndex::liveUpTo(EntryId id) const {
+    size_t count = 0;
+    for (size_t i = static_cast<size_t>(id); i > 0; i -= lowbit(i)) {
+        count += tree[i];
+    }
+    return count;
+}
+
+// Number Positions 0 .. count - 1 as Ids 1 .. count
+void EntryIdIndex::reset(size_t count) {
+    tree.assign(count + 1, 0);
+    for (size_t i = 1; i <= count; ++i) {
+        tree[i] = static_cast<uint32_t>(lowbit(i)); // Every id in the node's range is live
+    }
+    live = count;
+}
+
+EntryId EntryIdIndex::append() {
+    size_t id = tree.size();
+    // The new node covers (id - lowbit(id), id]: the new id plus the live ids already in that range
+    tree.push_back(static_cast<uint32_t>(1 + liveUpTo(id - 1) - liveUpTo(id - lowbit(id))));
+    ++live;
+    return id;
+}
+
+void EntryIdIndex::remove(EntryId id) {
+    if (!contains(id)) {
+        throw std::invalid_argument("Entry " + std::to_string(id) + " does not exist.");
+    }
+    for (size_t i = static_cast<size_t>(id); i < tree.size(); i += lowbit(i)) {
+        --tree[i];
+    }
+    --live;
+}
+
+bool EntryIdIndex::contains(EntryId id) const {
+    return id >= 1 && id < tree.size() && liveUpTo(id) != liveUpTo(id - 1);
+}
+
+std::optional<size_t> EntryIdIndex::positionOf(EntryId id) const {
+    if (!contains(id)) {
+        return std::nullopt;
+    }
+    return liveUpTo(id) - 1;
+}
+
+// Id at a Position: descend the tree for the smallest id with position + 1 live ids up to it
+EntryId EntryIdIndex::idAt(size_t position) const {
+    if (position >= live) {
+        throw std::out_of_range("Entry position out of range.");
+    }
+    size_t step = 1;
+    while (step * 2 < tree.size()) {
+        step *= 2;
+    }
+    size_t id = 0;
+    size_t remaining = position + 1;
+    for (; step > 0; step /= 2) {
+        if (id + step < tree.size() && tree[id + step] < remaining) {
+            id += step;
+            remaining -= tree[id];
+        }
+    }
+    return id + 1;
+}
+
+} // namespace PasswordNS
@@ -0,0 +1,39 @@
+#ifndef ENTRY_IDS_H
+#define ENTRY_IDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace PasswordNS
+{
+
+    // Names one vault entry for as long as the vault stays loaded; 0 is never an id
+    using EntryId = uint64_t;
+
+    // Maps entry ids to vault positions. Ids are handed out in vault order and never
+    // reused, so the position of an id is the number of live ids below it. A Fenwick
+    // tree keeps those counts: lookups, appends and removals are O(log n), and removing
+    // an entry never renumbers the ones after it.
+    class EntryIdIndex
+    {
+    private:
+        std::vector<uint32_t> tree{0}; // 1-based; tree[i] counts live ids in (i - lowbit(i), i]
+        size_t live = 0;
+
+        size_t liveUpTo(EntryId id) const; // Live ids in [1, id]
+
+    public:
+        void reset(size_t count); // Ids 1 .. count for positions 0 .. count - 1
+        EntryId append();         // Id of a new last entry
+        void remove(EntryId id);
+        bool contains(EntryId id) const;
+        std::optional<size_t> positionOf(EntryId id) const;
+        EntryId idAt(size_t position) const;
+        size_t size() const { return live; }
+    };
+
+} // namespace PasswordNS
+
+#endif
@@ -0,0 +1,27 @@
+// fuzz_decrypt.cpp
+// Fuzzes AES decryption with arbitrary ciphertext (wrong lengths, bad
+// padding), through both the plain and the secure-memory paths, and checks
+// that the input itself survives encrypt followed by decrypt.
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "encryption.h"
+#include "manager.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const std::string &key = PasswordNS::PasswordManager::getDefaultEncryptionKey();
+    std::vector<unsigned char> ciphertext(data, data + size);
+    std::string plain = EncryptionNS::decrypt(ciphertext, key);
+    EncryptionNS::SecureString secure = EncryptionNS::decryptSecure(ciphertext, key);
+    if (secure.str() != plain) {
+        std::abort();
+    }
+
+    std::string message(reinterpret_cast<const char *>(data), size);
+    if (EncryptionNS::decrypt(EncryptionNS::encrypt(message, key), key) != message) {
+        std::abort();
+    }
+    return 0;
+}
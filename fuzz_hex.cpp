@@ -0,0 +1,32 @@
+// fuzz_hex.cpp
+// Fuzzes the vault's hex encoding: fromHex either throws or returns bytes
+// that toHex turns back into the (lowercased) input, and any bytes survive
+// toHex followed by fromHex.
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "encryption.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    std::string text(reinterpret_cast<const char *>(data), size);
+    try {
+        std::vector<unsigned char> bytes = EncryptionNS::fromHex(text);
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (EncryptionNS::toHex(bytes) != text) {
+            std::abort();
+        }
+    } catch (const std::invalid_argument &) {
+        // Odd lengths and non-hex characters are rejected
+    }
+
+    std::vector<unsigned char> bytes(data, data + size);
+    if (EncryptionNS::fromHex(EncryptionNS::toHex(bytes)) != bytes) {
+        std::abort();
+    }
+    return 0;
+}
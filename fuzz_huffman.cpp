@@ -0,0 +1,53 @@
+// fuzz_huffman.cpp
+// Fuzzes Huffman decompression of arbitrary .huff files, which may fail but
+// must not crash, and checks that the input survives compress followed by
+// decompress. Compression works on files, so each run uses scratch files
+// named after the process.
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+#include "Huffman-Encoding/Huffman_C/huffman.h"
+
+namespace {
+
+std::string scratchFile(const char *suffix) {
+    return "fuzz_huffman_" + std::to_string(getpid()) + suffix;
+}
+
+void writeFile(const std::string &path, const uint8_t *data, size_t size) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+}
+
+std::string readFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const std::string input = scratchFile(".in");
+    const std::string packed = scratchFile(".huff");
+    const std::string output = scratchFile(".out");
+    Compression compressor;
+
+    writeFile(packed, data, size);
+    compressor.decompress(packed, output);
+
+    writeFile(input, data, size);
+    if (compressor.compress(input, packed) && compressor.decompress(packed, output) &&
+        readFile(output) != std::string(reinterpret_cast<const char *>(data), size)) {
+        std::abort();
+    }
+
+    std::remove(input.c_str());
+    std::remove(packed.c_str());
+    std::remove(output.c_str());
+    return 0;
+}
@@ -0,0 +1,56 @@
+// fuzz_replay.cpp
+// Stand-in for libFuzzer's main when the compiler has no -fsanitize=fuzzer:
+// runs a fuzz target once per file (directories are walked) or on stdin, so
+// crash reproducers and corpora can be replayed under GCC and debuggers.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+namespace {
+
+void replay(std::istream &in) {
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size());
+}
+
+void replayFile(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open '" << path.string() << "'." << std::endl;
+        return;
+    }
+    replay(file);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        replay(std::cin);
+        return 0;
+    }
+    size_t inputs = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::filesystem::path path(argv[i]);
+        if (std::filesystem::is_directory(path)) {
+            for (const auto &entry : std::filesystem::recursive_directory_iterator(path)) {
+                if (entry.is_regular_file()) {
+                    replayFile(entry.path());
+                    ++inputs;
+                }
+            }
+        } else {
+            replayFile(path);
+            ++inputs;
+        }
+    }
+    std::cerr << "Replayed " << inputs << " inputs." << std::endl;
+    return 0;
+}
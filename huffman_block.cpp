@@ -0,0 +1,182 @@
+#include "huffman_block.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace PasswordNS {
+
+namespace {
+
+constexpr int maxCodeLength = 15;
+constexpr size_t headerSize = 4 + 128; // Byte count, then 256 four-bit code lengths
+
+using CodeLengths = std::array<uint8_t, 256>;
+
+// Code lengths of a Huffman tree over the frequencies; 0 for bytes that never occur
+CodeLengths buildLengths(std::array<uint64_t, 256> frequencies) {
+    CodeLengths lengths{};
+    while (true) {
+        using Node = std::pair<uint64_t, size_t>; // (weight, node)
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+        std::vector<size_t> parent(256, 0);
+        for (size_t symbol = 0; symbol < 256; ++symbol) {
+            if (frequencies[symbol] != 0) {
+                queue.push({frequencies[symbol], symbol});
+            }
+        }
+        if (queue.size() == 1) {
+            lengths[queue.top().second] = 1; // A lone symbol still needs one bit per byte
+            return lengths;
+        }
+        while (queue.size() > 1) {
+            Node first = queue.top();
+            queue.pop();
+            Node second = queue.top();
+            queue.pop();
+            parent.push_back(0);
+            parent[first.second] = parent[second.second] = parent.size() - 1;
+            queue.push({first.first + second.first, parent.size() - 1});
+        }
+
+        // Depth of each leaf; internal nodes are created after their children, so walk down from the root
+        std::vector<uint8_t> depth(parent.size(), 0);
+        int deepest = 0;
+        for (size_t node = parent.size() - 1; node-- > 0;) {
+            depth[node] = static_cast<uint8_t>(std::min(depth[parent[node]] + 1, 255));
+        }
+        for (size_t symbol = 0; symbol < 256; ++symbol) {
+            lengths[symbol] = frequencies[symbol] != 0 ? depth[symbol] : 0;
+            deepest = std::max<int>(deepest, lengths[symbol]);
+        }
+        if (deepest <= maxCodeLength) {
+            return lengths;
+        }
+        // Too deep: flatten the frequencies and try again
+        for (auto &frequency : frequencies) {
+            frequency = frequency == 0 ? 0 : (frequency + 1) / 2;
+        }
+    }
+}
+
+// Canonical codes: shorter codes first, then by byte value. Throws if the lengths are not a prefix code.
+std::array<uint16_t, 256> assignCodes(const CodeLengths &lengths) {
+    std::array<uint32_t, maxCodeLength + 1> counts{};
+    for (uint8_t length : lengths) {
+        ++counts[length];
+    }
+    counts[0] = 0;
+    std::array<uint32_t, maxCodeLength + 1> next{};
+    uint32_t code = 0;
+    for (int length = 1; length <= maxCodeLength; ++length) {
+        code = (code + counts[length - 1]) << 1;
+        next[length] = code;
+        if (code + counts[length] > (1u << length)) {
+            throw std::invalid_argument("Huffman block has an invalid code table.");
+        }
+    }
+    std::array<uint16_t, 256> codes{};
+    for (size_t symbol = 0; symbol < 256; ++symbol) {
+        if (lengths[symbol] != 0) {
+            codes[symbol] = static_cast<uint16_t>(next[lengths[symbol]]++);
+        }
+    }
+    return codes;
+}
+
+} // namespace
+
+// Huffman-Code One Block in Memory
+std::string compressBlock(const std::string &data) {
+    if (data.size() > UINT32_MAX) {
+        throw std::invalid_argument("Huffman blocks hold at most 4 GiB.");
+    }
+    std::array<uint64_t, 256> frequencies{};
+    for (unsigned char c : data) {
+        ++frequencies[c];
+    }
+    CodeLengths lengths = data.empty() ? CodeLengths{} : buildLengths(frequencies);
+    std::array<uint16_t, 256> codes = assignCodes(lengths);
+
+    std::string block(headerSize, '\0');
+    for (int i = 0; i < 4; ++i) {
+        block[i] = static_cast<char>(data.size() >> (8 * i));
+    }
+    for (size_t symbol = 0; symbol < 256; symbol += 2) {
+        block[4 + symbol / 2] = static_cast<char>(lengths[symbol] << 4 | lengths[symbol + 1]);
+    }
+
+    uint64_t bits = 0;
+    int pending = 0;
+    block.reserve(headerSize + data.size());
+    for (unsigned char c : data) {
+        bits = bits << lengths[c] | codes[c];
+        pending += lengths[c];
+        while (pending >= 8) {
+            pending -= 8;
+            block += static_cast<char>(bits >> pending);
+        }
+    }
+    if (pending > 0) {
+        block += static_cast<char>(bits << (8 - pending));
+    }
+    return block;
+}
+
+// Decode a Block Written by compressBlock
+std::string decompressBlock(const std::string &block, size_t maxSize) {
+    if (block.size() < headerSize) {
+        throw std::invalid_argument("Huffman block is truncated.");
+    }
+    size_t size = 0;
+    for (int i = 0; i < 4; ++i) {
+        size |= static_cast<size_t>(static_cast<unsigned char>(block[i])) << (8 * i);
+    }
+    if (size > maxSize) {
+        throw std::invalid_argument("Huffman block is larger than allowed.");
+    }
+    CodeLengths lengths;
+    for (size_t symbol = 0; symbol < 256; symbol += 2) {
+        unsigned char packed = static_cast<unsigned char>(block[4 + symbol / 2]);
+        lengths[symbol] = packed >> 4;
+        lengths[symbol + 1] = packed & 0x0f;
+    }
+    std::array<uint16_t, 256> codes = assignCodes(lengths);
+
+    // Every 15-bit window names the symbol whose code it starts with; length 0 marks unused codes
+    std::vector<std::pair<uint8_t, uint8_t>> table(size_t(1) << maxCodeLength, {0, 0});
+    for (size_t symbol = 0; symbol < 256; ++symbol) {
+        if (lengths[symbol] != 0) {
+            int shift = maxCodeLength - lengths[symbol];
+            std::fill(table.begin() + (static_cast<size_t>(codes[symbol]) << shift),
+                      table.begin() + (static_cast<size_t>(codes[symbol] + 1) << shift),
+                      std::make_pair(static_cast<uint8_t>(symbol), lengths[symbol]));
+        }
+    }
+
+    std::string data;
+    data.reserve(size);
+    uint64_t bits = 0; // Left-aligned
+    int available = 0;
+    size_t next = headerSize;
+    while (data.size() < size) {
+        while (available <= 56 && next < block.size()) {
+            bits |= static_cast<uint64_t>(static_cast<unsigned char>(block[next++])) << (56 - available);
+            available += 8;
+        }
+        auto entry = table[bits >> (64 - maxCodeLength)];
+        if (entry.second == 0 || entry.second > available) {
+            throw std::invalid_argument("Huffman block is corrupt.");
+        }
+        data += static_cast<char>(entry.first);
+        bits <<= entry.second;
+        available -= entry.second;
+    }
+    return data;
+}
+
+} // namespace PasswordNS
@@ -0,0 +1,22 @@
+#ifndef HUFFMAN_BLOCK_H
+#define HUFFMAN_BLOCK_H
+
+#include <cstddef>
+#include <string>
+
+namespace PasswordNS
+{
+
+    // In-memory Huffman coding of one block, for data that must not pass through the
+    // file-based Compression class (which needs its input and output on disk). Codes are
+    // canonical and at most 15 bits long, so a block stores only its byte count and the
+    // 256 code lengths (132 bytes) ahead of the bit stream, and decoding is one table
+    // lookup per byte.
+    std::string compressBlock(const std::string &data);
+
+    // Throws std::invalid_argument for corrupt input or a block larger than maxSize
+    std::string decompressBlock(const std::string &block, size_t maxSize);
+
+} // namespace PasswordNS
+
+#endif
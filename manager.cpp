@@ -3,31 +3,73 @@
 #include <sstream>
 #include <random>
 #include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
 #include <iomanip> // For formatting output
 #include <stdexcept> // For exceptions
 #include <filesystem> // For checking file existence
 #include <memory> // For smart pointers
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <openssl/crypto.h> // For OPENSSL_cleanse
 #include "Huffman-Encoding/Huffman_C/huffman.h" // Include Huffman Encoding library
+#include "trace.h"
+#include "metrics.h"
+#include "vault_snapshot.h"
+#include "task_scheduler.h"
+#include "record_schema.h"
 
 namespace PasswordNS {
 
 // Encryption Key (Define here)
-const std::string PasswordManager::encryptionKey = "my_secure_key_for_aes_encryption";
+const std::string PasswordManager::defaultEncryptionKey = "my_secure_key_for_aes_encryption";
 
 // Constructor Definitions
 PasswordManager::PasswordManager() : username(""), mainPassword("") {}
 
 PasswordManager::PasswordManager(const PasswordManager &other)
-    : credentials(other.credentials), username(other.username), mainPassword(other.mainPassword) {}
+    : credentials(other.credentials), username(other.username), mainPassword(other.mainPassword),
+      vaultDirectory(other.vaultDirectory), compressOnExitEnabled(other.compressOnExitEnabled), minimumStrength(other.minimumStrength), durability(other.durability),
+      storageEngine(other.storageEngine), storage(other.customStorage ? other.storage : nullptr), customStorage(other.customStorage),
+      credentialIndex(other.credentialIndex), metadataChanged(other.metadataChanged), entryIds(other.entryIds),
+      pendingSave(other.pendingSave), encryptionKey(other.encryptionKey) {}
 
 PasswordManager::PasswordManager(PasswordManager &&other) noexcept
-    : credentials(std::move(other.credentials)), username(std::move(other.username)), mainPassword(std::move(other.mainPassword)) {}
+    : credentials(std::move(other.credentials)), username(std::move(other.username)), mainPassword(std::move(other.mainPassword)),
+      vaultDirectory(std::move(other.vaultDirectory)), compressOnExitEnabled(other.compressOnExitEnabled), minimumStrength(other.minimumStrength), durability(other.durability),
+      storageEngine(std::move(other.storageEngine)), storage(std::move(other.storage)), storageBase(std::move(other.storageBase)), customStorage(other.customStorage),
+      credentialIndex(std::move(other.credentialIndex)), metadataChanged(other.metadataChanged), entryIds(std::move(other.entryIds)),
+      pendingSave(std::move(other.pendingSave)), encryptionKey(std::move(other.encryptionKey)) {
+    // The moved-from manager still flushes when it is destroyed: leave it nothing to write
+    other.metadataChanged = false;
+    other.storage.reset();
+    other.storageBase.clear();
+    other.customStorage = false;
+}
 
 PasswordManager &PasswordManager::operator=(const PasswordManager &other) {
     if (this != &other) {
         credentials = other.credentials;
         username = other.username;
         mainPassword = other.mainPassword;
+        vaultDirectory = other.vaultDirectory;
+        compressOnExitEnabled = other.compressOnExitEnabled;
+        minimumStrength = other.minimumStrength;
+        durability = other.durability;
+        storageEngine = other.storageEngine;
+        storage = other.customStorage ? other.storage : nullptr;
+        storageBase.clear();
+        customStorage = other.customStorage;
+        credentialIndex = other.credentialIndex;
+        metadataChanged = other.metadataChanged;
+        entryIds = other.entryIds;
+        waitForPendingSave();
+        pendingSave = other.pendingSave;
+        encryptionKey = other.encryptionKey;
     }
     return *this;
 }
@@ -37,18 +79,78 @@ PasswordManager &PasswordManager::operator=(PasswordManager &&other) noexcept {
         credentials = std::move(other.credentials);
         username = std::move(other.username);
         mainPassword = std::move(other.mainPassword);
+        vaultDirectory = std::move(other.vaultDirectory);
+        compressOnExitEnabled = other.compressOnExitEnabled;
+        minimumStrength = other.minimumStrength;
+        durability = other.durability;
+        storageEngine = std::move(other.storageEngine);
+        storage = std::move(other.storage);
+        storageBase = std::move(other.storageBase);
+        customStorage = other.customStorage;
+        credentialIndex = std::move(other.credentialIndex);
+        metadataChanged = other.metadataChanged;
+        entryIds = std::move(other.entryIds);
+        waitForPendingSave();
+        pendingSave = std::move(other.pendingSave);
+        encryptionKey = std::move(other.encryptionKey);
+        other.metadataChanged = false;
+        other.storage.reset();
+        other.storageBase.clear();
+        other.customStorage = false;
     }
     return *this;
 }
 
 PasswordManager::~PasswordManager() noexcept {
-    handleExit();
+    // Compression only reads user_credentials.csv, so it runs on the shared scheduler beside the
+    // flush. If every worker is busy, wait() below runs it on this thread instead.
+    TaskGroup compression;
+    if (compressOnExitEnabled) {
+        try {
+            compression.run([this]() { compressOnExit(); });
+        } catch (const std::exception &e) {
+            std::cerr << "Failed to compress credentials: " << e.what() << std::endl;
+        }
+    }
+    try {
+        flushCredentials();
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to save credentials: " << e.what() << std::endl;
+    }
+    try {
+        compression.wait();
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to compress credentials: " << e.what() << std::endl;
+    }
+    std::cout << "Exiting Password Manager..." << std::endl;
     std::cout << "PasswordManager destroyed for user: " << username << std::endl;
 }
 
 // Password Validation
 bool PasswordManager::validate(const std::string &password) const {
-    return password.length() > 8;
+    return describeWeakness(password).empty();
+}
+
+// Explain Why a Password Is Rejected (empty when it is accepted)
+std::string PasswordManager::describeWeakness(const std::string &password) const {
+    if (password.length() <= 8) {
+        return "It must be longer than 8 characters.";
+    }
+    if (minimumStrength > 0) {
+        StrengthEstimate estimate = estimateStrength(password);
+        if (estimate.score < minimumStrength) {
+            return "Its strength is " + std::to_string(estimate.score) + " of 4 and at least " +
+                   std::to_string(minimumStrength) + " is required. " + estimate.feedback;
+        }
+    }
+    return "";
+}
+
+void PasswordManager::setMinimumStrength(int score) {
+    if (score < 0 || score > 4) {
+        throw std::invalid_argument("Minimum strength must be between 0 and 4.");
+    }
+    minimumStrength = score;
 }
 
 // Encrypt Functionality
@@ -56,6 +158,91 @@ void PasswordManager::encrypt(const std::string &data) const {
     std::cout << "Encrypting data with key: " << encryptionKey << std::endl;
 }
 
+void PasswordManager::setEncryptionKey(const std::string &key) {
+    if (key.size() < 32) {
+        throw std::invalid_argument("Encryption keys must be at least 32 bytes.");
+    }
+    encryptionKey = key;
+}
+
+// Pick the Key a User's Vault Is Opened With
+std::string PasswordManager::startupEncryptionKey(const std::string &user) {
+    const char *passphrase = std::getenv("PASSWORD_MANAGER_VAULT_PASSPHRASE");
+    if (passphrase == nullptr || *passphrase == '\0') {
+        return defaultEncryptionKey;
+    }
+    return EncryptionNS::deriveKey(passphrase, user);
+}
+
+// Re-Encrypt the Vault Under a New Key
+RekeyStats PasswordManager::rekey(const std::string &newKey, const RekeyOptions &options,
+                                  const ProgressCallback &progress, const CancellationToken &cancel) {
+    if (newKey.size() < 32) {
+        throw std::invalid_argument("Encryption keys must be at least 32 bytes.");
+    }
+    // Journaled edits are encrypted under the old key, so they go into the vault first. Without any,
+    // the vault is left as it is: rewriting it would stop an interrupted re-key from resuming.
+    compactVault();
+    StorageBackend &backend = storageBackend();
+    std::string vaultFile = backend.vaultFile();
+    RekeyStats stats;
+    if (!vaultFile.empty() && std::filesystem::exists(vaultFile)) {
+        stats = rekeyVaultFile(vaultFile, encryptionKey, newKey, options, progress, cancel);
+    } else if (vaultFile.empty() && backend.exists()) {
+        // Engines without a vault file re-encrypt in memory and store the result in one go
+        auto start = std::chrono::steady_clock::now();
+        CredentialList rekeyed = backend.load();
+        for (size_t i = 0; i < rekeyed.size(); ++i) {
+            if (i % 1024 == 0) {
+                cancel.throwIfCancelled();
+                if (progress) {
+                    progress(i, rekeyed.size());
+                }
+            }
+            std::pair<std::string, std::string> entry = rekeyed[i];
+            AccountView account;
+            if (!AccountSchema::decodeText(entry.second, account)) {
+                throw std::invalid_argument("Malformed vault record for service '" + entry.first + "'.");
+            }
+            std::string password = EncryptionNS::decrypt(EncryptionNS::fromHex(account.passwordHex), encryptionKey);
+            entry.second.replace(account.username.size() + 1, std::string::npos,
+                                 EncryptionNS::toHex(EncryptionNS::encrypt(password, newKey)));
+            OPENSSL_cleanse(&password[0], password.size());
+            rekeyed.set(i, std::move(entry));
+        }
+        backend.replaceAll(rekeyed);
+        backend.flush();
+        stats.entries = rekeyed.size();
+        stats.chunks = 1;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (progress) {
+            progress(rekeyed.size(), rekeyed.size());
+        }
+    } else {
+        setEncryptionKey(newKey); // Nothing saved yet, so nothing to re-encrypt
+        return stats;
+    }
+    setEncryptionKey(newKey);
+    loadCredentialsFromFile();
+    return stats;
+}
+
+// Encrypt a password into the hex form stored in the vault
+std::string PasswordManager::encryptToHex(const std::string &password, const std::string &key) {
+    return EncryptionNS::toHex(EncryptionNS::encrypt(password, key));
+}
+
+// Decrypt a hex password read from the vault
+std::string PasswordManager::decryptFromHex(const std::string &passwordHex, const std::string &key) {
+    return EncryptionNS::decrypt(EncryptionNS::fromHex(passwordHex), key);
+}
+
+// Decrypt a hex password from the vault into protected memory
+EncryptionNS::SecureString PasswordManager::decryptFromHexSecure(const std::string &passwordHex, const std::string &key,
+                                                                 const std::shared_ptr<EncryptionNS::SecureArena> &arena) {
+    return EncryptionNS::decryptSecure(EncryptionNS::fromHex(passwordHex), key, arena);
+}
+
 // Set Test Credentials
 void PasswordManager::setTestCredentials(const std::string &testUsername, const std::string &testPassword) {
     username = testUsername;
@@ -63,25 +250,130 @@ void PasswordManager::setTestCredentials(const std::string &testUsername, const
 }
 
 // Add a New Password
-void PasswordManager::addNewPassword(std::string serviceName, std::string serviceUsername, std::string password) {
-    if (!validate(password)) {
-        throw std::invalid_argument("Password is too weak! It must be longer than 8 characters.");
+EntryId PasswordManager::addNewPassword(std::string serviceName, std::string serviceUsername, std::string password) {
+    METRICS_SCOPE(MetricsNS::Operation::AddNewPassword);
+    std::string weakness = describeWeakness(password);
+    if (!weakness.empty()) {
+        throw std::invalid_argument("Password is too weak! " + weakness);
+    }
+    // The vault keeps one "service username:hex" line per entry, split at the last space
+    if (serviceName.empty() || serviceName.find('\n') != std::string::npos) {
+        throw std::invalid_argument("Service names must be a single, non-empty line.");
+    }
+    if (serviceUsername.empty() ||
+        std::any_of(serviceUsername.begin(), serviceUsername.end(), [](unsigned char c) { return std::isspace(c) || c == ':'; })) {
+        throw std::invalid_argument("Usernames must not be empty or hold spaces or ':'.");
+    }
+
+    // Encrypt the password and store it as hex
+    std::string encryptedPasswordHex = encryptToHex(password, encryptionKey);
+
+    credentials.emplace_back(serviceName, serviceUsername + ":" + encryptedPasswordHex);
+    EntryId id = entryIds.append();
+
+    // A second password for the same account keeps its tags, URL and creation time
+    CredentialKey key(serviceName, serviceUsername);
+    credentialIndex.addEntry(key, id);
+    const CredentialMetadata *existing = credentialIndex.find(key);
+    CredentialMetadata metadata = existing != nullptr ? *existing : CredentialMetadata();
+    metadata.modified = static_cast<int64_t>(std::time(nullptr));
+    metadata.created = metadata.created != 0 ? metadata.created : metadata.modified;
+    credentialIndex.put(key, std::move(metadata));
+    metadataChanged = true;
+
+    // Metadata goes first: after a crash, entries it no longer names just have empty columns
+    saveMetadata();
+    storageBackend().appended(credentials);
+    std::cout << "Password successfully added for service: " << serviceName << std::endl;
+    return id;
+}
+
+std::vector<EntryId> PasswordManager::findEntries(const std::string &serviceName) const {
+    return credentialIndex.entriesOfService(serviceName);
+}
+
+std::vector<EntryId> PasswordManager::findEntries(const std::string &serviceName, const std::string &serviceUsername) const {
+    return credentialIndex.entriesOf({serviceName, serviceUsername});
+}
+
+std::optional<std::pair<std::string, std::string>> PasswordManager::getEntry(EntryId id) const {
+    std::optional<size_t> position = entryIds.positionOf(id);
+    return position ? std::optional<std::pair<std::string, std::string>>(credentials[*position]) : std::nullopt;
+}
+
+// Replace the Password of One Entry
+void PasswordManager::updatePassword(EntryId id, const std::string &password) {
+    METRICS_SCOPE(MetricsNS::Operation::UpdatePassword);
+    std::string weakness = describeWeakness(password);
+    if (!weakness.empty()) {
+        throw std::invalid_argument("Password is too weak! " + weakness);
+    }
+    std::optional<size_t> position = entryIds.positionOf(id);
+    if (!position) {
+        throw std::invalid_argument("Entry not found.");
     }
 
-    // Encrypt the password
-    auto encryptedPassword = EncryptionNS::encrypt(password, encryptionKey);
+    std::pair<std::string, std::string> entry = credentials[*position];
+    std::string serviceUsername = usernameOf(entry.second);
+    entry.second = serviceUsername + ":" + encryptToHex(password, encryptionKey);
+    CredentialList updated = credentials;
+    updated.set(*position, entry);
+    storageBackend().updated(updated, *position); // The list only changes once the engine has the edit
+    credentials = std::move(updated);
+
+    // The sidecar is only rewritten with the vault, so the new time reaches it on the next full save or flush
+    CredentialKey key(entry.first, serviceUsername);
+    CredentialMetadata metadata = *credentialIndex.find(key);
+    metadata.modified = static_cast<int64_t>(std::time(nullptr));
+    credentialIndex.put(key, std::move(metadata));
+    metadataChanged = true;
+}
 
-    // Convert encrypted password to hex
-    std::string encryptedPasswordHex;
-    for (unsigned char c : encryptedPassword) {
-        std::ostringstream oss;
-        oss << std::hex << std::setfill('0') << std::setw(2) << static_cast<int>(c);
-        encryptedPasswordHex += oss.str();
+// Delete One Entry
+void PasswordManager::deleteEntry(EntryId id) {
+    std::optional<size_t> position = entryIds.positionOf(id);
+    if (!position) {
+        throw std::invalid_argument("Entry not found.");
     }
 
-    credentials.emplace_back(serviceName, serviceUsername + ":" + encryptedPasswordHex);
+    const auto &entry = credentials[*position];
+    CredentialKey key(entry.first, usernameOf(entry.second));
+    CredentialList remaining = credentials;
+    remaining.erase(*position);
+    storageBackend().erased(remaining, *position);
+    credentials = std::move(remaining);
+    entryIds.remove(id);
+    credentialIndex.removeEntry(key, id);
+    metadataChanged = true;
+}
+
+// Set the Tags and URL of an Entry
+void PasswordManager::setMetadata(const std::string &serviceName, const std::string &serviceUsername,
+                                  std::vector<std::string> tags, const std::string &url) {
+    CredentialKey key(serviceName, serviceUsername);
+    const CredentialMetadata *existing = credentialIndex.find(key);
+    if (existing == nullptr) {
+        throw std::invalid_argument("No entry for " + serviceUsername + " at " + serviceName + ".");
+    }
+    for (const auto &tag : tags) {
+        if (tag.empty()) {
+            throw std::invalid_argument("Tags must not be empty.");
+        }
+    }
+
+    CredentialMetadata metadata = *existing;
+    metadata.tags = std::move(tags);
+    metadata.url = url;
+    metadata.modified = static_cast<int64_t>(std::time(nullptr));
+    credentialIndex.put(key, std::move(metadata));
+    metadataChanged = true;
     saveCredentialsToFile();
-    std::cout << "Password successfully added for service: " << serviceName << std::endl;
+}
+
+std::optional<CredentialMetadata> PasswordManager::getMetadata(const std::string &serviceName,
+                                                               const std::string &serviceUsername) const {
+    const CredentialMetadata *metadata = credentialIndex.find({serviceName, serviceUsername});
+    return metadata != nullptr ? std::optional<CredentialMetadata>(*metadata) : std::nullopt;
 }
 
 // Show All Stored Passwords
@@ -96,38 +388,27 @@ void PasswordManager::showAllPasswords() {
               << "Password" << std::endl;
     std::cout << "-----------------------------------------------" << std::endl;
 
-    for (const auto &entry : credentials) {
-        std::string service = entry.first;
-        std::string username_password = entry.second;
-
-        size_t delimiter_pos = username_password.find(':');
-        std::string username = username_password.substr(0, delimiter_pos);
-        std::string passwordHex = username_password.substr(delimiter_pos + 1);
-
-        // Convert hex back to binary
-        std::vector<unsigned char> encryptedPassword;
-        for (size_t i = 0; i < passwordHex.size(); i += 2) {
-            unsigned char byte = std::stoi(passwordHex.substr(i, 2), nullptr, 16);
-            encryptedPassword.push_back(byte);
-        }
-
-        // Decrypt password
-        std::string password = EncryptionNS::decrypt(encryptedPassword, encryptionKey);
-
-        std::cout << std::setw(20) << service
-                  << std::setw(20) << username
-                  << password << std::endl;
+    // Decrypted passwords stay in the secure arena and are wiped when the list goes out of scope
+    for (const auto &entry : getSecureCredentials(0, credentials.size())) {
+        std::cout << std::setw(20) << entry.service
+                  << std::setw(20) << entry.username
+                  << entry.password << std::endl;
     }
 }
 
 // Delete a Password
 void PasswordManager::deletePassword(std::string serviceName) {
-    auto it = std::remove_if(credentials.begin(), credentials.end(),
-                             [&serviceName](const auto &entry) { return entry.first == serviceName; });
+    std::vector<EntryId> removedIds = credentialIndex.entriesOfService(serviceName);
+    size_t removed = credentials.removeIf([&serviceName](const auto &entry) { return entry.first == serviceName; });
 
-    if (it != credentials.end()) {
-        credentials.erase(it, credentials.end());
-        saveCredentialsToFile();
+    if (removed != 0) {
+        for (EntryId id : removedIds) {
+            entryIds.remove(id);
+        }
+        credentialIndex.eraseService(serviceName);
+        metadataChanged = true;
+        saveMetadata();
+        storageBackend().erasedService(credentials, serviceName);
         std::cout << "Password for service: " << serviceName << " has been deleted." << std::endl;
     } else {
         throw std::invalid_argument("Service not found.");
@@ -146,47 +427,123 @@ bool PasswordManager::hasPassword(const std::string &serviceName) const {
 
 // Retrieve all stored credentials
 std::vector<std::pair<std::string, std::string>> PasswordManager::getAllCredentials() const {
-    return credentials;
+    return credentials.toVector();
 }
 
 // Retrieve all decrypted credentials
 std::vector<std::pair<std::string, std::string>> PasswordManager::getAllDecryptedCredentials() const {
+    return getAllDecryptedCredentials(ProgressCallback(), CancellationToken());
+}
+
+// Retrieve all decrypted credentials, reporting progress and honouring cancellation
+std::vector<std::pair<std::string, std::string>> PasswordManager::getAllDecryptedCredentials(const ProgressCallback &progress,
+                                                                                           const CancellationToken &cancel) const {
     std::vector<std::pair<std::string, std::string>> decryptedCredentials;
-    for (const auto &entry : credentials) {
-        std::string service = entry.first;
-        std::string username_password = entry.second;
-
-        size_t delimiter_pos = username_password.find(':');
-        if (delimiter_pos != std::string::npos) {
-            std::string username = username_password.substr(0, delimiter_pos);
-            std::string passwordHex = username_password.substr(delimiter_pos + 1);
-
-            // Convert hex back to binary
-            std::vector<unsigned char> encryptedPassword;
-            for (size_t i = 0; i < passwordHex.size(); i += 2) {
-                unsigned char byte = static_cast<unsigned char>(std::stoi(passwordHex.substr(i, 2), nullptr, 16));
-                encryptedPassword.push_back(byte);
+    auto secureCredentials = getSecureCredentials(0, credentials.size(), progress, cancel);
+    decryptedCredentials.reserve(secureCredentials.size());
+    for (const auto &entry : secureCredentials) {
+        decryptedCredentials.emplace_back(entry.service, entry.decryptedValue());
+    }
+    return decryptedCredentials;
+}
+
+// Retrieve one page of decrypted credentials
+std::vector<std::pair<std::string, std::string>> PasswordManager::getDecryptedCredentials(size_t offset, size_t count) const {
+    std::vector<std::pair<std::string, std::string>> decryptedCredentials;
+    for (const auto &entry : getSecureCredentials(offset, count)) {
+        decryptedCredentials.emplace_back(entry.service, entry.decryptedValue());
+    }
+    return decryptedCredentials;
+}
+
+// Decrypt a range of entries into secure arenas
+std::vector<SecureCredential> PasswordManager::getSecureCredentials(size_t offset, size_t count,
+                                                                    const ProgressCallback &progress,
+                                                                    const CancellationToken &cancel) const {
+    std::vector<SecureCredential> decryptedCredentials;
+    size_t end = offset < credentials.size() ? offset + std::min(count, credentials.size() - offset) : offset;
+    if (offset >= end) {
+        return decryptedCredentials;
+    }
+
+    // Chunks decrypt in parallel on the shared scheduler, each into its own arena sized from its
+    // ciphertext, so a chunk needs a single mapping and no arena is shared between threads
+    const size_t chunkSize = 1024;
+    decryptedCredentials.resize(end - offset);
+    auto decryptChunk = [&](size_t first, size_t last) {
+        size_t arenaSize = 0;
+        for (size_t i = first; i < last; ++i) {
+            arenaSize += credentials[i].second.size() / 2 + 32;
+        }
+        auto arena = std::make_shared<EncryptionNS::SecureArena>(arenaSize);
+        std::vector<SecureCredential *> encrypted;
+        std::vector<std::vector<unsigned char>> ciphertexts;
+        for (size_t i = first; i < last; ++i) {
+            const auto &entry = credentials[i];
+            AccountView account;
+            SecureCredential &credential = decryptedCredentials[i - offset];
+            credential.service = entry.first;
+            if (!AccountSchema::decodeText(entry.second, account)) {
+                // Handle cases where delimiter is not found
+                credential.username = entry.second;
+            } else {
+                credential.username = account.username;
+                credential.encrypted = true;
+                ciphertexts.push_back(EncryptionNS::fromHex(account.passwordHex));
+                encrypted.push_back(&credential);
             }
+        }
+
+        // The whole chunk goes through the multi-buffer cipher at once (see aes_batch.h)
+        auto passwords = EncryptionNS::decryptSecureBatch(ciphertexts, encryptionKey, arena);
+        for (size_t k = 0; k < encrypted.size(); ++k) {
+            encrypted[k]->password = std::move(passwords[k]);
+        }
+    };
 
-            // Decrypt password
-            std::string decryptedPassword = EncryptionNS::decrypt(encryptedPassword, encryptionKey);
+    cancel.throwIfCancelled();
+    if (progress) {
+        progress(0, end - offset);
+    }
+    if (end - offset <= chunkSize) {
+        decryptChunk(offset, end);
+    } else {
+        std::atomic<size_t> completed{0};
+        TaskGroup group;
+        for (size_t first = offset; first < end; first += chunkSize) {
+            size_t last = std::min(first + chunkSize, end);
+            group.run([&, first, last]() {
+                if (!cancel.isCancelled()) {
+                    decryptChunk(first, last);
+                    completed += last - first;
+                }
+            });
+        }
 
-            decryptedCredentials.emplace_back(service, username + ":" + decryptedPassword);
-        } else {
-            // Handle cases where delimiter is not found
-            decryptedCredentials.emplace_back(service, username_password);
+        // Progress is reported from the calling thread, like the other long operations
+        size_t reported = 0;
+        while (!group.waitFor(std::chrono::milliseconds(20))) {
+            if (progress && completed != reported) {
+                reported = completed;
+                progress(reported, end - offset);
+            }
         }
+        cancel.throwIfCancelled();
+    }
+    if (progress) {
+        progress(decryptedCredentials.size(), end - offset);
     }
     return decryptedCredentials;
 }
 
 // Retrieve a credential for a specific service
 std::optional<std::string> PasswordManager::getCredential(const std::string &serviceName) const {
+    METRICS_SCOPE(MetricsNS::Operation::GetCredential);
     for (const auto &entry : credentials) {
         if (entry.first == serviceName) {
-            size_t delimiter_pos = entry.second.find(':');
-            if (delimiter_pos != std::string::npos) {
-                return entry.second.substr(delimiter_pos + 1);
+            AccountView account;
+            if (AccountSchema::decodeText(entry.second, account)) {
+                return std::string(account.passwordHex);
             }
             return entry.second; // Return the entire value if no delimiter
         }
@@ -225,30 +582,240 @@ void PasswordManager::useGeneratedPasswordForNewEntry(const std::string &generat
 
 // Save Stored Passwords to File
 void PasswordManager::saveCredentialsToFile() {
-    std::ofstream file(username + "_passwords.dat", std::ios::trunc);
-    if (!file.is_open()) {
-        throw std::ios_base::failure("Unable to open '" + username + "_passwords.dat' for writing.");
+    TRACE_SCOPE("vault.save");
+    METRICS_SCOPE(MetricsNS::Operation::SaveCredentials);
+    // Metadata goes first: after a crash, entries it no longer names just have empty columns
+    saveMetadata();
+    storageBackend().replaceAll(credentials);
+}
+
+// The Storage Engine for the Current Vault
+StorageBackend &PasswordManager::storageBackend() {
+    waitForPendingSave();
+    std::string base = currentStorageBase();
+    if (!customStorage && (!storage || storageBase != base)) {
+        if (storage) {
+            storage->flush();
+        }
+        storage = makeStorageBackend(storageEngine, base, durability);
+        storageBase = base;
     }
+    return *storage;
+}
 
-    for (const auto &entry : credentials) {
-        file << entry.first << " " << entry.second << std::endl;
+std::string PasswordManager::currentStorageBase() const {
+    return vaultDirectory.empty() ? username : vaultDirectory + "/" + username;
+}
+
+// Let an Asynchronous Save Finish Before the Engine Is Used Again
+void PasswordManager::waitForPendingSave() const {
+    if (pendingSave.valid()) {
+        pendingSave.wait(); // Its task reports any error
     }
-    // File closes automatically (RAII principle).
+}
+
+// Choose Where the Vault Is Kept
+void PasswordManager::setStorageEngine(const std::string &engine) {
+    std::vector<std::string> engines = storageEngines();
+    if (std::find(engines.begin(), engines.end(), engine) == engines.end()) {
+        throw std::invalid_argument("Unknown or unavailable storage engine: " + engine);
+    }
+    flushCredentials();
+    storage.reset();
+    customStorage = false;
+    storageEngine = engine;
+}
+
+void PasswordManager::setStorageBackend(std::shared_ptr<StorageBackend> backend) {
+    if (!backend) {
+        throw std::invalid_argument("A storage backend is required.");
+    }
+    flushCredentials();
+    backend->setDurability(durability);
+    storageEngine = backend->engine();
+    storage = std::move(backend);
+    customStorage = true;
+}
+
+// Choose How Saves Reach the Disk
+void PasswordManager::setDurability(Durability mode) {
+    waitForPendingSave();
+    if (storage) {
+        storage->setDurability(mode);
+    }
+    durability = mode;
+}
+
+// Wait for Pending Saves
+void PasswordManager::flushCredentials() {
+    waitForPendingSave();
+    if (storage) {
+        storage->flush();
+    }
+    saveMetadata();
+}
+
+// Rewrite the Metadata Sidecar After a Change
+void PasswordManager::saveMetadata() {
+    if (!metadataChanged) {
+        return;
+    }
+    storageBackend().saveMetadata(credentialIndex.serialize());
+    metadataChanged = false;
+}
+
+// Fold the Journal into the Vault
+void PasswordManager::compactVault() {
+    saveMetadata();
+    storageBackend().compact(credentials);
+    flushCredentials();
 }
 
 // Load Stored Passwords from File
 void PasswordManager::loadCredentialsFromFile() {
-    std::ifstream file(username + "_passwords.dat");
-    if (!file.is_open()) {
-        throw std::ios_base::failure("Unable to open '" + username + "_passwords.dat' for reading.");
+    TRACE_SCOPE("vault.load");
+    flushCredentials();
+    StorageBackend &backend = storageBackend();
+    credentials = backend.load();
+    loadMetadata(backend);
+}
+
+// Load a Vault File Read Elsewhere
+void PasswordManager::loadCredentialsFrom(const std::string &vaultContents) {
+    TRACE_SCOPE("vault.load");
+    flushCredentials();
+    auto *backend = dynamic_cast<FlatFileBackend *>(&storageBackend());
+    if (backend == nullptr) {
+        throw std::invalid_argument("Only the file storage engine loads vault contents read elsewhere.");
     }
+    credentials = backend->loadContents(vaultContents);
+    loadMetadata(*backend);
+}
 
-    credentials.clear();
-    std::string serviceName, username_password;
-    while (file >> serviceName >> username_password) {
-        credentials.emplace_back(serviceName, username_password);
+// Decrypt a Credential on the Executor's Workers
+Task<std::optional<std::string>> PasswordManager::getDecryptedCredentialAsync(const std::string &serviceName,
+                                                                      Executor &executor) const {
+    for (const auto &entry : credentials) {
+        if (entry.first == serviceName) {
+            AccountView account;
+            std::string passwordHex(AccountSchema::decodeText(entry.second, account) ? account.passwordHex : entry.second);
+            return executor.compute([passwordHex, key = encryptionKey]() -> std::optional<std::string> {
+                return decryptFromHex(passwordHex, key);
+            });
+        }
     }
-    // File closes automatically (RAII principle).
+    return executor.completed(std::optional<std::string>());
+}
+
+// Save a Snapshot of the Credentials on the Executor's Workers
+Task<void> PasswordManager::saveAsync(Executor &executor) {
+    // Switching vaults waits for earlier saves; saving the same vault again queues behind them
+    std::shared_ptr<StorageBackend> backend = storage;
+    if (!backend || (!customStorage && storageBase != currentStorageBase())) {
+        storageBackend();
+        backend = storage;
+    }
+    // The change counts as saved from here on, so later saves do not write it again; a failed
+    // save marks it unsaved once more, on the loop and before the task reports the failure
+    std::optional<std::string> metadata;
+    if (metadataChanged) {
+        metadata = credentialIndex.serialize();
+        metadataChanged = false;
+    }
+    CredentialList snapshot = credentials;
+    std::shared_future<void> previous = pendingSave;
+    auto finished = std::make_shared<std::promise<void>>();
+    pendingSave = finished->get_future().share();
+
+    return executor.offload([this, &executor, backend, snapshot, metadata, previous, finished]() {
+        if (previous.valid()) {
+            previous.wait();
+        }
+        try {
+            // Metadata goes first, as in saveCredentialsToFile()
+            if (metadata) {
+                backend->saveMetadata(*metadata);
+            }
+            backend->replaceAll(snapshot);
+        } catch (...) {
+            if (metadata) {
+                executor.post([this]() { metadataChanged = true; });
+            }
+            finished->set_value();
+            throw;
+        }
+        finished->set_value();
+    });
+}
+
+// Load the Vault Through the Executor
+Task<void> PasswordManager::loadAsync(Executor &executor) {
+    flushCredentials();
+    if (dynamic_cast<FlatFileBackend *>(&storageBackend()) == nullptr) {
+        return executor.schedule([this]() { loadCredentialsFromFile(); });
+    }
+    return executor.readFile(storage->vaultFile()).then([this](std::string contents) { loadCredentialsFrom(contents); });
+}
+
+// Rebuild Entry Ids and the Metadata Index for Freshly Loaded Credentials
+void PasswordManager::loadMetadata(StorageBackend &backend) {
+    entryIds.reset(credentials.size());
+
+    // Metadata is optional: vaults written before it existed have none
+    CredentialIndex index;
+    if (std::optional<std::string> metadata = backend.loadMetadata()) {
+        index = CredentialIndex::parse(*metadata);
+    }
+    index.sync(credentials);
+    credentialIndex = std::move(index);
+    metadataChanged = false;
+}
+
+// Split a Vault Line into Service and "username:hex"
+bool PasswordManager::parseVaultRecord(const std::string &line, std::pair<std::string, std::string> &record) {
+    VaultLineView view;
+    if (!VaultLineSchema::decodeText(line, view)) {
+        return false;
+    }
+    record.first.assign(view.service);
+    record.second.assign(view.account);
+    return true;
+}
+
+// Replace the Credentials with a Snapshot
+void PasswordManager::restoreCredentialList(const CredentialList &snapshot) {
+    credentials = snapshot;
+    entryIds.reset(credentials.size());
+    credentialIndex.sync(credentials);
+    metadataChanged = true;
+    saveCredentialsToFile();
+}
+
+std::string PasswordManager::getSnapshotDirectory() const {
+    std::string directory = username + "_snapshots";
+    return vaultDirectory.empty() ? directory : vaultDirectory + "/" + directory;
+}
+
+// Save the Credentials as a Named Snapshot
+void PasswordManager::saveSnapshot(const std::string &label) {
+    ChunkStore store(getSnapshotDirectory());
+    writeSnapshot(store, label, credentials);
+}
+
+std::vector<std::string> PasswordManager::listSnapshots() const {
+    if (!std::filesystem::exists(getSnapshotDirectory())) {
+        return {};
+    }
+    return ChunkStore(getSnapshotDirectory()).listManifests();
+}
+
+// Restore the Credentials from a Named Snapshot
+void PasswordManager::restoreSnapshot(const std::string &label) {
+    ChunkStore store(getSnapshotDirectory());
+    if (!store.hasManifest(label)) {
+        throw std::invalid_argument("Snapshot not found: " + label);
+    }
+    restoreCredentialList(readSnapshot(store, label));
 }
 
 // Save User Credentials to File
@@ -264,32 +831,54 @@ void PasswordManager::saveUserCredentialsToFile() {
 
 // Load User Credentials from File
 bool PasswordManager::loadUserCredentialsFromFile() {
+    TRACE_SCOPE("login.verify");
     std::ifstream file("user_credentials.csv");
     if (!file.is_open()) {
         return false;
     }
 
-    std::string line, file_username, file_password;
+    // Compare each line in place instead of splitting it, so a miss costs one prefix check
+    const std::string prefix = username + ",";
+    std::string line;
     while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::getline(ss, file_username, ',');
-        std::getline(ss, file_password, ',');
-
-        if (file_username == username && file_password == mainPassword) {
+        if (line.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        size_t passwordEnd = line.find(',', prefix.size());
+        size_t passwordLength = (passwordEnd == std::string::npos ? line.size() : passwordEnd) - prefix.size();
+        if (line.compare(prefix.size(), passwordLength, mainPassword) == 0) {
             return true;
         }
     }
     return false;
 }
 
+// Restore user_credentials.csv from the compressed copy when only that exists
+bool PasswordManager::restoreUserCredentials() {
+    if (std::filesystem::exists("user_credentials.csv") || !std::filesystem::exists("user_credentials.huff")) {
+        return false;
+    }
+
+    TRACE_SCOPE("login.decompress");
+    Compression compressor;
+    if (!compressor.decompress("user_credentials.huff", "user_credentials.csv")) {
+        std::cerr << "Failed to decompress credentials." << std::endl;
+        return false;
+    }
+    return true;
+}
+
 // Handle Exit
 void PasswordManager::handleExit() {
-    compressOnExit();
+    if (compressOnExitEnabled) {
+        compressOnExit();
+    }
     std::cout << "Exiting Password Manager..." << std::endl;
 }
 
 // Compress Data on Exit
 void PasswordManager::compressOnExit() {
+    TRACE_SCOPE("exit.compress");
     Compression compressor;
     if (compressor.compress("user_credentials.csv", "user_credentials.huff")) {
         std::cout << "Compressed credentials successfully!" << std::endl;
@@ -8,12 +8,34 @@
 #include <utility>
 #include <optional> // For std::optional
 #include <memory>   // For smart pointers
-#include <filesystem>                           // For file system operations
-#include "Huffman-Encoding/Huffman_C/huffman.h" // Include Huffman Encoding library
+#include <future>   // For waiting on asynchronous saves
+#include <filesystem> // For file system operations
+#include "worker_pool.h" // For progress and cancellation of long operations
+#include "durable_file.h" // For crash-safe vault writes
+#include "persistent_vector.h" // For O(1) credential snapshots
+#include "secure_memory.h" // For plaintext passwords in locked, wiped memory
+#include "password_strength.h" // For strength checks beyond the minimum length
+#include "credential_index.h" // For metadata and secondary indexes
+#include "entry_ids.h" // For stable entry ids
+#include "storage_backend.h" // For the engines that keep the vault (flat file, memory, SQLite)
+#include "vault_rekey.h" // For re-encrypting the vault under a new key
+#include "async_task.h" // For operations that complete on an executor
 
 namespace PasswordNS
 {
 
+    // Decrypted entry whose password lives in protected memory
+    struct SecureCredential
+    {
+        std::string service;
+        std::string username;
+        EncryptionNS::SecureString password;
+        bool encrypted = false; // False for a record without "username:", which is kept whole in username
+
+        // The entry's value with the password decrypted; a record without one comes back unchanged
+        std::string decryptedValue() const { return encrypted ? username + ":" + password.str() : username; }
+    };
+
     // Abstract base class for managing common operations
     class BaseManager
     {
@@ -27,13 +49,31 @@ namespace PasswordNS
     class PasswordManager : public BaseManager
     {
     private:
-        std::vector<std::pair<std::string, std::string>> credentials; // Container for credentials (service, password)
+        CredentialList credentials; // Container for credentials (service, password)
         std::string username;
         std::string mainPassword;
+        std::string vaultDirectory; // Empty: vaults live in the working directory
+        bool compressOnExitEnabled = true; // Tools that never touch user_credentials.csv can turn this off
+        int minimumStrength = 0; // estimateStrength() score new passwords need; 0 only checks the length
+        Durability durability = Durability::Atomic;
+        std::string storageEngine = "file";
+        std::shared_ptr<StorageBackend> storage; // Created on first use for the current vault, unless set
+        std::string storageBase;                 // Vault the created engine belongs to
+        bool customStorage = false;              // Set with setStorageBackend(); shared by copies
+        CredentialIndex credentialIndex; // Metadata and secondary indexes, saved beside the vault
+        bool metadataChanged = false;    // The sidecar file is rewritten only after a change
+        EntryIdIndex entryIds;           // Position of each entry id
+        std::shared_future<void> pendingSave; // Latest saveAsync(); the engine is not used again before it ends
 
         void saveCredentialsToFile();
+        void saveMetadata();
+        void loadMetadata(StorageBackend &backend); // After credentials were replaced by a load
+        StorageBackend &storageBackend(); // The engine for the current vault
+        std::string currentStorageBase() const;
+        void waitForPendingSave() const;
         void compressOnExit();                  // Compress credentials on exit
-        static const std::string encryptionKey; // Declare the encryption key
+        static const std::string defaultEncryptionKey; // Key of vaults that were never re-keyed
+        std::string encryptionKey = defaultEncryptionKey; // Key of this manager's vault
 
         // Memory Handling with RAII for File Streams
         std::unique_ptr<std::ifstream> createInputStream(const std::string &fileName) const {
@@ -63,36 +103,147 @@ namespace PasswordNS
 
         std::vector<std::pair<std::string, std::string>> getAllCredentials() const;
         std::vector<std::pair<std::string, std::string>> getAllDecryptedCredentials() const;
+        // Long-running variant for background tasks; throws OperationCancelled when cancelled
+        std::vector<std::pair<std::string, std::string>> getAllDecryptedCredentials(const ProgressCallback &progress,
+                                                                                    const CancellationToken &cancel) const;
+        // Decrypts only entries [offset, offset + count), for paged views of large vaults
+        std::vector<std::pair<std::string, std::string>> getDecryptedCredentials(size_t offset, size_t count) const;
+        // Decrypts entries [offset, offset + count) in parallel chunks, each into a secure arena wiped when its last entry goes
+        std::vector<SecureCredential> getSecureCredentials(size_t offset, size_t count,
+                                                           const ProgressCallback &progress = ProgressCallback(),
+                                                           const CancellationToken &cancel = CancellationToken()) const;
 
         // Pure virtual function overrides
         void encrypt(const std::string &data) const override;      // Encryption implementation
         bool validate(const std::string &password) const override; // Validation implementation
 
+        // Strength policy for validate(): longer than 8 characters and, when set, a minimum score (0-4)
+        void setMinimumStrength(int score);
+        int getMinimumStrength() const { return minimumStrength; }
+        std::string describeWeakness(const std::string &password) const; // Empty when validate() accepts the password
+
         // Encapsulation: Getters and Setters
         void setUsername(const std::string &name) { username = name; }
         const std::string &getUsername() const { return username; }
         void setMainPassword(const std::string &password) { mainPassword = password; }
         const std::string &getMainPassword() const { return mainPassword; }
 
-        // Static public getter for the encryption key
-        static const std::string &getEncryptionKey()
+        // Static public getter for the key every manager starts with
+        static const std::string &getDefaultEncryptionKey()
+        {
+            return defaultEncryptionKey;
+        }
+        // The key of this manager's vault. Nothing stores it: set it before loading a re-keyed vault,
+        // for instance to startupEncryptionKey(). Throws std::invalid_argument for keys shorter than 32 bytes.
+        const std::string &getEncryptionKey() const { return encryptionKey; }
+        void setEncryptionKey(const std::string &key);
+        // The key the GUI and CLI open user's vault with: derived with EncryptionNS::deriveKey() from
+        // PASSWORD_MANAGER_VAULT_PASSPHRASE (salted with the username) when that is set, else the default key
+        static std::string startupEncryptionKey(const std::string &user);
+
+        // Re-encrypts the vault under newKey and makes it this manager's key (see vault_rekey.h).
+        // Journaled edits are folded in first, an interrupted re-key to the same key resumes, and
+        // the entries are reloaded afterwards. Snapshots on disk keep the key they were taken under.
+        RekeyStats rekey(const std::string &newKey, const RekeyOptions &options = RekeyOptions(),
+                         const ProgressCallback &progress = ProgressCallback(),
+                         const CancellationToken &cancel = CancellationToken());
+
+        // Record helpers shared by the manager and the batch import/export tools
+        static std::string encryptToHex(const std::string &password, const std::string &key);
+        static std::string decryptFromHex(const std::string &passwordHex, const std::string &key);
+        static EncryptionNS::SecureString decryptFromHexSecure(const std::string &passwordHex, const std::string &key,
+                                                               const std::shared_ptr<EncryptionNS::SecureArena> &arena = nullptr);
+        // Splits one "service username:hex" vault line at its last space, so service names may hold spaces;
+        // false when the line has no separator
+        static bool parseVaultRecord(const std::string &line, std::pair<std::string, std::string> &record);
+
+        // Point-in-time copies of the credentials: taking one is O(1) and shares all entries
+        const CredentialList &getCredentialList() const { return credentials; }
+        void restoreCredentialList(const CredentialList &snapshot); // Replaces the credentials and saves the vault
+
+        // Snapshots on disk, in <vault directory>/<user>_snapshots; unchanged blocks are stored once
+        std::string getSnapshotDirectory() const;
+        void saveSnapshot(const std::string &label);
+        std::vector<std::string> listSnapshots() const;
+        void restoreSnapshot(const std::string &label);
+
+        // Entries by id: a service may hold several accounts, and each account several entries. Ids stay valid
+        // until the vault is reloaded or replaced. Edits by id append one record to the journal instead of
+        // rewriting the vault; the journal is folded into the vault once it outgrows half of it.
+        std::vector<EntryId> findEntries(const std::string &serviceName) const; // Every account, in vault order
+        std::vector<EntryId> findEntries(const std::string &serviceName, const std::string &serviceUsername) const;
+        std::optional<std::pair<std::string, std::string>> getEntry(EntryId id) const; // (service, "username:hex")
+        void updatePassword(EntryId id, const std::string &password);
+        void deleteEntry(EntryId id);
+        void compactVault(); // Folds journaled edits into the vault
+        std::string getJournalFileName() const
+        {
+            return vaultDirectory.empty() ? username + "_passwords.journal" : vaultDirectory + "/" + username + "_passwords.journal";
+        }
+
+        // Plaintext metadata of each (service, username) entry; the index answers queries without decrypting
+        void setMetadata(const std::string &serviceName, const std::string &serviceUsername,
+                         std::vector<std::string> tags, const std::string &url); // Throws if there is no such entry
+        std::optional<CredentialMetadata> getMetadata(const std::string &serviceName, const std::string &serviceUsername) const;
+        const CredentialIndex &getCredentialIndex() const { return credentialIndex; }
+        std::string getMetadataFileName() const
         {
-            return encryptionKey;
+            return vaultDirectory.empty() ? username + "_metadata.dat" : vaultDirectory + "/" + username + "_metadata.dat";
         }
 
-        void addNewPassword(std::string serviceName, std::string serviceUsername, std::string password);
+        // Vault file for the current user
+        std::string getVaultFileName() const
+        {
+            return vaultDirectory.empty() ? username + "_passwords.dat" : vaultDirectory + "/" + username + "_passwords.dat";
+        }
+        void setVaultDirectory(const std::string &directory) { vaultDirectory = directory; }
+        const std::string &getVaultDirectory() const { return vaultDirectory; }
+        void setCompressOnExit(bool enabled) { compressOnExitEnabled = enabled; }
+
+        // Where the vault is kept: "file" (the default), "memory" or "sqlite" (see storage_backend.h).
+        // Changing the engine does not move what the old one stored. Throws std::invalid_argument
+        // for an engine this build does not have.
+        void setStorageEngine(const std::string &engine);
+        const std::string &getStorageEngine() const { return storageEngine; }
+        // Uses backend instead of an engine created per vault, whatever the username or directory
+        void setStorageBackend(std::shared_ptr<StorageBackend> backend);
+        StorageBackend &getStorageBackend() { return storageBackend(); }
+
+        // Atomic by default; Sync fsyncs every save, GroupCommit shares one fsync between saves in a short window
+        void setDurability(Durability mode);
+        Durability getDurability() const { return durability; }
+        // Blocks until every save so far is on disk (only GroupCommit saves can still be pending)
+        void flushCredentials();
+
+        EntryId addNewPassword(std::string serviceName, std::string serviceUsername, std::string password);
         void showAllPasswords();
         void deletePassword(std::string serviceName);
         std::string generatePassword(int length);
         void useGeneratedPasswordForNewEntry(const std::string &generatedPassword);
         void saveUserCredentialsToFile();
-        bool loadUserCredentialsFromFile(); // Handles decompression if necessary
+        bool loadUserCredentialsFromFile();
+        bool restoreUserCredentials(); // Decompresses user_credentials.huff if the CSV is missing
         void loadCredentialsFromFile();
+        // loadCredentialsFromFile() with the vault file already read (e.g. in a batch, see async_io.h);
+        // the journal and metadata are still read here. File engine only.
+        void loadCredentialsFrom(const std::string &vaultContents);
 
         // Wrapper methods for performance testing
         void saveCredentials() { saveCredentialsToFile(); }
         void loadCredentials() { loadCredentialsFromFile(); }
 
+        // Asynchronous variants for one thread driving many vaults (see async_task.h). Call them on the
+        // executor's loop thread, and keep the manager alive until the task completes.
+        // getDecryptedCredentialAsync() decrypts the password of the service's first account on a worker;
+        // unlike getCredential(), which returns the stored hex, it yields the plaintext.
+        Task<std::optional<std::string>> getDecryptedCredentialAsync(const std::string &serviceName, Executor &executor) const;
+        // Saves a snapshot of the entries on a worker; saves complete in the order they were started,
+        // and blocking methods that need the engine wait for them. After a failed save the metadata
+        // counts as unsaved again, so the next save or flush writes it.
+        Task<void> saveAsync(Executor &executor);
+        // The file engine reads the vault through the executor's file I/O; other engines load on the loop
+        Task<void> loadAsync(Executor &executor);
+
         // Method to retrieve all credentials
         [[nodiscard]] std::optional<std::string> getCredential(const std::string &serviceName) const;
         bool hasPassword(const std::string &serviceName) const;
@@ -0,0 +1,247 @@
+#include "metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace MetricsNS {
+
+namespace {
+
+// Counters owned by one thread. Only the owner writes, so plain load/store pairs
+// (no lock prefix) are enough; relaxed atomics keep concurrent snapshots well defined.
+struct ThreadShard {
+    struct Counters {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+        std::array<std::atomic<uint64_t>, BucketCount> buckets{};
+    };
+
+    std::array<Counters, OperationCount> operations;
+    std::atomic<bool> inUse{true};
+};
+
+inline void increment(std::atomic<uint64_t> &counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// Shards are never freed: a thread that exits hands its shard (and counts) to the next new thread
+class ShardRegistry {
+public:
+    ThreadShard *acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &shard : shards) {
+            // Acquire pairs with the release in ~ShardHandle: the new owner sees the last
+            // counts the old one wrote before it adds its own on top of them
+            if (!shard->inUse.load(std::memory_order_acquire)) {
+                shard->inUse.store(true, std::memory_order_relaxed);
+                return shard.get();
+            }
+        }
+        shards.push_back(std::make_unique<ThreadShard>());
+        return shards.back().get();
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &shard : shards) {
+            fn(*shard);
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadShard>> shards;
+};
+
+ShardRegistry &registry() {
+    static ShardRegistry *instance = new ShardRegistry(); // Leaked so threads exiting after main stay safe
+    return *instance;
+}
+
+// Releases the thread's shard for reuse when the thread exits
+struct ShardHandle {
+    ThreadShard *shard = registry().acquire();
+    ~ShardHandle() { shard->inUse.store(false, std::memory_order_release); }
+};
+
+ThreadShard *acquireShardForThread() {
+    thread_local ShardHandle handle;
+    return handle.shard;
+}
+
+// The plain pointer is trivially initialized, so the hot path has no TLS init guard
+thread_local ThreadShard *cachedShard = nullptr;
+
+inline ThreadShard &currentShard() {
+    if (cachedShard == nullptr) {
+        cachedShard = acquireShardForThread();
+    }
+    return *cachedShard;
+}
+
+const char *const operationNames[OperationCount] = {
+    "add_new_password",
+    "update_password",
+    "get_credential",
+    "save_credentials",
+    "encrypt",
+    "decrypt",
+};
+
+} // namespace
+
+uint64_t bucketLowerBound(size_t index) {
+    if (index < SubBucketCount) {
+        return index;
+    }
+    size_t exponent = index / SubBucketCount + SubBucketBits - 1;
+    uint64_t subBucket = index % SubBucketCount;
+    return (SubBucketCount + subBucket) << (exponent - SubBucketBits);
+}
+
+const char *operationName(Operation operation) {
+    return operationNames[static_cast<size_t>(operation)];
+}
+
+// Record an Event on the Calling Thread
+void record(Operation operation, uint64_t nanoseconds) {
+    record(operation, nanoseconds, 1);
+}
+
+void record(Operation operation, uint64_t nanoseconds, uint64_t events) {
+    if (events == 0) {
+        return;
+    }
+    uint64_t each = nanoseconds / events;
+    ThreadShard::Counters &counters = currentShard().operations[static_cast<size_t>(operation)];
+    increment(counters.count, events);
+    increment(counters.sum, nanoseconds);
+    increment(counters.buckets[bucketIndex(each)], events);
+    if (each > counters.max.load(std::memory_order_relaxed)) {
+        counters.max.store(each, std::memory_order_relaxed);
+    }
+}
+
+uint64_t OperationStats::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // Report the bucket's upper edge, but never more than the observed maximum
+            uint64_t upper = i + 1 < BucketCount ? bucketLowerBound(i + 1) - 1 : maxNanoseconds;
+            return std::min(upper, maxNanoseconds);
+        }
+    }
+    return maxNanoseconds;
+}
+
+// Merge All Threads' Counters
+MetricsSnapshot snapshot() {
+    MetricsSnapshot result;
+    registry().forEach([&result](const ThreadShard &shard) {
+        for (size_t op = 0; op < OperationCount; ++op) {
+            const ThreadShard::Counters &counters = shard.operations[op];
+            OperationStats &stats = result.operations[op];
+            stats.count += counters.count.load(std::memory_order_relaxed);
+            stats.sumNanoseconds += counters.sum.load(std::memory_order_relaxed);
+            stats.maxNanoseconds = std::max(stats.maxNanoseconds, counters.max.load(std::memory_order_relaxed));
+            for (size_t i = 0; i < BucketCount; ++i) {
+                stats.buckets[i] += counters.buckets[i].load(std::memory_order_relaxed);
+            }
+        }
+    });
+    return result;
+}
+
+void reset() {
+    registry().forEach([](ThreadShard &shard) {
+        for (auto &counters : shard.operations) {
+            counters.count.store(0, std::memory_order_relaxed);
+            counters.sum.store(0, std::memory_order_relaxed);
+            counters.max.store(0, std::memory_order_relaxed);
+            for (auto &bucket : counters.buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    });
+}
+
+// Format a Human-Readable Summary
+std::string toText(const MetricsSnapshot &snapshot) {
+    std::ostringstream out;
+    out << std::left << std::setw(20) << "operation" << std::right << std::setw(12) << "count" << std::setw(12)
+        << "mean_us" << std::setw(12) << "p50_us" << std::setw(12) << "p90_us" << std::setw(12) << "p99_us"
+        << std::setw(12) << "max_us" << "\n";
+    out << std::fixed << std::setprecision(2);
+    for (size_t op = 0; op < OperationCount; ++op) {
+        const OperationStats &stats = snapshot.operations[op];
+        out << std::left << std::setw(20) << operationNames[op] << std::right << std::setw(12) << stats.count
+            << std::setw(12) << stats.meanNanoseconds() / 1e3 << std::setw(12) << stats.percentile(0.50) / 1e3
+            << std::setw(12) << stats.percentile(0.90) / 1e3 << std::setw(12) << stats.percentile(0.99) / 1e3
+            << std::setw(12) << stats.maxNanoseconds / 1e3 << "\n";
+    }
+    return out.str();
+}
+
+// Format as Prometheus Text Exposition
+std::string toPrometheus(const MetricsSnapshot &snapshot) {
+    std::ostringstream out;
+    out << std::setprecision(9);
+    out << "# HELP password_manager_operation_duration_seconds Latency of password manager operations.\n";
+    out << "# TYPE password_manager_operation_duration_seconds histogram\n";
+    for (size_t op = 0; op < OperationCount; ++op) {
+        const OperationStats &stats = snapshot.operations[op];
+        const char *name = operationNames[op];
+
+        // Cumulative buckets; empty buckets are skipped to keep the output small
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i + 1 < BucketCount; ++i) {
+            cumulative += stats.buckets[i];
+            if (stats.buckets[i] != 0) {
+                out << "password_manager_operation_duration_seconds_bucket{operation=\"" << name << "\",le=\""
+                    << bucketLowerBound(i + 1) / 1e9 << "\"} " << cumulative << "\n";
+            }
+        }
+        out << "password_manager_operation_duration_seconds_bucket{operation=\"" << name << "\",le=\"+Inf\"} "
+            << stats.count << "\n";
+        out << "password_manager_operation_duration_seconds_sum{operation=\"" << name << "\"} "
+            << stats.sumNanoseconds / 1e9 << "\n";
+        out << "password_manager_operation_duration_seconds_count{operation=\"" << name << "\"} " << stats.count << "\n";
+    }
+    return out.str();
+}
+
+// Write a Snapshot File
+void writeSnapshot(const std::string &path) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::ios_base::failure("Unable to open '" + path + "' for writing metrics.");
+    }
+
+    bool prometheus = path.size() >= 5 && path.compare(path.size() - 5, 5, ".prom") == 0;
+    file << (prometheus ? toPrometheus(snapshot()) : toText(snapshot()));
+}
+
+bool writeSnapshotFromEnvironment() {
+    const char *path = std::getenv("PASSWORD_MANAGER_METRICS");
+    if (path == nullptr || *path == '\0') {
+        return false;
+    }
+    writeSnapshot(path);
+    return true;
+}
+
+} // namespace MetricsNS
@@ -0,0 +1,132 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Low-overhead runtime metrics: per-operation counters and latency histograms.
+// Every thread records into its own shard with relaxed single-writer stores (no locks,
+// no atomic read-modify-write); snapshots merge the shards on demand.
+namespace MetricsNS
+{
+
+    // Operations that are measured; names are listed in operationName()
+    enum class Operation : size_t
+    {
+        AddNewPassword,
+        UpdatePassword,
+        GetCredential,
+        SaveCredentials,
+        Encrypt,
+        Decrypt,
+        Count
+    };
+
+    constexpr size_t OperationCount = static_cast<size_t>(Operation::Count);
+
+    // Log-linear buckets: 8 sub-buckets per power of two (12.5% resolution) up to ~2^40 ns
+    constexpr size_t SubBucketBits = 3;
+    constexpr size_t SubBucketCount = size_t(1) << SubBucketBits;
+    constexpr size_t MaxExponent = 40;
+    constexpr size_t BucketCount = (MaxExponent - SubBucketBits + 2) * SubBucketCount;
+
+    // Bucket holding a latency in nanoseconds (values past the last bucket are clamped)
+    inline size_t bucketIndex(uint64_t nanoseconds)
+    {
+        if (nanoseconds < SubBucketCount)
+        {
+            return static_cast<size_t>(nanoseconds);
+        }
+        size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(nanoseconds));
+        if (exponent > MaxExponent)
+        {
+            return BucketCount - 1;
+        }
+        size_t subBucket = static_cast<size_t>(nanoseconds >> (exponent - SubBucketBits)) & (SubBucketCount - 1);
+        return (exponent - SubBucketBits + 1) * SubBucketCount + subBucket;
+    }
+
+    // Smallest latency (ns) that falls into the bucket
+    uint64_t bucketLowerBound(size_t index);
+
+    const char *operationName(Operation operation);
+
+    // Records one event for the calling thread
+    void record(Operation operation, uint64_t nanoseconds);
+    // events operations done together in nanoseconds (a batch): each is counted at the mean latency
+    void record(Operation operation, uint64_t nanoseconds, uint64_t events);
+
+    // Merged view of all threads' counters
+    struct OperationStats
+    {
+        uint64_t count = 0;
+        uint64_t sumNanoseconds = 0;
+        uint64_t maxNanoseconds = 0;
+        std::array<uint64_t, BucketCount> buckets{};
+
+        // Approximate latency at quantile q in [0, 1] (upper edge of the matching bucket)
+        uint64_t percentile(double q) const;
+        double meanNanoseconds() const { return count ? static_cast<double>(sumNanoseconds) / count : 0.0; }
+    };
+
+    struct MetricsSnapshot
+    {
+        std::array<OperationStats, OperationCount> operations{};
+
+        const OperationStats &operator[](Operation operation) const { return operations[static_cast<size_t>(operation)]; }
+    };
+
+    MetricsSnapshot snapshot();
+
+    // Clears all counters (intended for tests and benchmarks; not synchronized with writers)
+    void reset();
+
+    // Human-readable summary: count, mean, p50/p90/p99 and max per operation
+    std::string toText(const MetricsSnapshot &snapshot);
+
+    // Prometheus text exposition format (histogram in seconds)
+    std::string toPrometheus(const MetricsSnapshot &snapshot);
+
+    // Writes a snapshot to path; ".prom" files use the Prometheus format, anything else the text summary
+    void writeSnapshot(const std::string &path);
+
+    // Writes a snapshot if PASSWORD_MANAGER_METRICS names an output file; returns whether it did
+    bool writeSnapshotFromEnvironment();
+
+    // Records the lifetime of the enclosing scope
+    class ScopedLatency
+    {
+    private:
+        Operation operation;
+        uint64_t events;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit ScopedLatency(Operation op, uint64_t count = 1)
+            : operation(op), events(count), start(std::chrono::steady_clock::now()) {}
+        ~ScopedLatency()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            record(operation, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                   events);
+        }
+
+        ScopedLatency(const ScopedLatency &) = delete;
+        ScopedLatency &operator=(const ScopedLatency &) = delete;
+    };
+
+} // namespace MetricsNS
+
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+
+// Usage: METRICS_SCOPE(MetricsNS::Operation::GetCredential);
+#define METRICS_SCOPE(operation) MetricsNS::ScopedLatency METRICS_CONCAT(metricsScope, __LINE__)(operation)
+// Usage: METRICS_SCOPE_BATCH(MetricsNS::Operation::Decrypt, entries.size());
+#define METRICS_SCOPE_BATCH(operation, events) \
+    MetricsNS::ScopedLatency METRICS_CONCAT(metricsScope, __LINE__)(operation, events)
+
+#endif
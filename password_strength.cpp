@@ -0,0 +1,686 @@
+#include "password_strength.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace PasswordNS {
+
+namespace {
+
+// Dictionaries, most common first: a word's guesses are its rank
+constexpr std::string_view commonPasswords[] = {
+    "123456", "password", "123456789", "12345678", "12345", "qwerty", "1234567", "111111", "1234567890", "123123",
+    "abc123", "1234", "password1", "iloveyou", "1q2w3e4r", "000000", "qwerty123", "zaq12wsx", "dragon", "sunshine",
+    "princess", "letmein", "654321", "monkey", "27653", "1qaz2wsx", "123321", "qwertyuiop", "superman", "asdfghjkl",
+    "football", "baseball", "welcome", "master", "shadow", "login", "passw0rd", "trustno1", "hello", "freedom",
+    "whatever", "qazwsx", "michael", "charlie", "donald", "121212", "666666", "7777777", "aa123456", "admin",
+    "888888", "starwars", "jordan23", "batman", "access", "flower", "hottie", "loveme", "zaq1zaq1", "696969",
+    "mustang", "112233", "ashley", "bailey", "555555", "jessica", "ninja", "azerty", "solo", "987654321",
+    "lovely", "159753", "michelle", "daniel", "11111111", "football1", "jennifer", "hunter", "buster", "soccer",
+    "harley", "ranger", "thomas", "robert", "tigger", "ginger", "pepper", "summer", "andrew", "joshua",
+    "cheese", "matrix", "computer", "internet", "secret", "pokemon", "killer", "cookie", "hannah", "maggie",
+    "test", "test123", "changeme", "default", "guest", "root", "administrator", "pass", "1111", "0000",
+    "blink182", "chelsea", "liverpool", "arsenal", "samsung", "google", "yankees", "dallas", "austin", "taylor",
+    "love", "money", "friends", "family", "purple", "orange", "banana", "chocolate", "butterfly", "angel",
+    "sparky", "snoopy", "garfield", "mickey", "pepsi", "nascar", "player", "hockey", "golf", "fishing",
+    "chicken", "bigdog", "biteme", "corvette", "ferrari", "porsche", "mercedes", "yamaha", "hello123", "welcome1",
+    "letmein1", "qwerty1", "abc1234", "asdf", "asdfgh", "zxcvbn", "zxcvbnm", "qweasd", "qweasdzxc", "asdasd",
+    "147258369", "147258", "789456", "159357", "q1w2e3r4", "iloveu", "loveyou", "babygirl", "lovers", "sweety",
+    "princess1", "monkey1", "dragon1", "shadow1", "master1", "superman1", "whatever1", "secret1", "password123",
+    "password12", "admin123", "root123", "123abc", "1password", "qwer1234", "1qazxsw2", "asdf1234", "zxcv1234",
+};
+
+constexpr std::string_view englishWords[] = {
+    "love", "life", "baby", "angel", "summer", "winter", "spring", "autumn", "house", "horse", "tiger", "lion", "bear",
+    "wolf", "eagle", "dragon", "sun", "moon", "star", "sky", "blue", "red", "green", "black", "white", "happy", "lucky",
+    "magic", "music", "dance", "heart", "soul", "king", "queen", "prince", "lady", "boy", "girl", "man", "woman", "cat",
+    "dog", "puppy", "kitty", "bird", "fish", "apple", "cherry", "lemon", "peach", "sugar", "honey", "candy", "coffee",
+    "water", "fire", "earth", "wind", "storm", "rain", "snow", "ice", "gold", "silver", "diamond", "crystal", "flower",
+    "rose", "garden", "forest", "river", "ocean", "sea", "beach", "island", "mountain", "city", "world", "home",
+    "family", "friend", "secret", "hello", "welcome", "strong", "power", "super", "hero", "dream", "hope", "faith",
+    "peace", "freedom", "spirit", "ghost", "shadow", "dark", "light", "night", "day", "time", "good", "best", "cool",
+    "sweet", "pretty", "beautiful", "crazy", "sexy", "hot", "big", "little", "small", "new", "old", "first", "last",
+    "one", "two", "three", "four", "five", "six", "seven", "eight", "nine", "ten", "hundred", "thousand", "unique",
+    "other", "shared", "correct", "battery", "staple", "table", "chair", "window", "door", "paper", "book", "school",
+    "college", "office", "computer", "phone", "game", "play", "player", "team", "sport", "ball", "car", "truck",
+    "bike", "road", "street", "money", "cash", "bank", "mail", "email", "shop", "work", "job", "boss", "pass", "word",
+    "key", "lock", "open", "close", "test", "admin", "user", "login", "master", "private", "public", "service",
+    "system", "server", "network", "data", "monday", "friday", "sunday", "january", "june", "july", "december",
+};
+
+constexpr std::string_view names[] = {
+    "michael", "james", "john", "robert", "david", "william", "richard", "joseph", "thomas", "charles", "daniel",
+    "matthew", "anthony", "mark", "paul", "steven", "andrew", "joshua", "kevin", "brian", "george", "edward", "jason",
+    "ryan", "jacob", "nicholas", "eric", "jessica", "jennifer", "ashley", "sarah", "emily", "amanda", "elizabeth",
+    "melissa", "michelle", "stephanie", "nicole", "heather", "rebecca", "laura", "anna", "maria", "lisa", "karen",
+    "nancy", "susan", "linda", "mary", "patricia", "barbara", "emma", "olivia", "sophia", "isabella", "mia",
+    "charlotte", "alice", "bob", "alex", "sam", "max", "jack", "harry", "oliver", "charlie", "lucy", "chloe", "grace",
+    "ruby", "lily", "ella", "jordan", "taylor", "morgan",
+};
+
+// FNV-1a; findDictionaryMatches computes the same hash incrementally
+constexpr uint64_t hashWord(std::string_view word) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : word) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Open-addressing table of (rank) built by the compiler: slots hold rank + 1, 0 is empty
+template <size_t Slots, size_t N>
+struct Dictionary {
+    const std::string_view (&words)[N];
+    std::array<uint16_t, Slots> slots{};
+
+    constexpr explicit Dictionary(const std::string_view (&list)[N]) : words(list) {
+        static_assert(Slots >= 2 * N && (Slots & (Slots - 1)) == 0, "Dictionary tables must be sparse powers of two.");
+        for (size_t rank = 0; rank < N; ++rank) {
+            size_t slot = hashWord(list[rank]) & (Slots - 1);
+            while (slots[slot] != 0 && list[slots[slot] - 1] != list[rank]) {
+                slot = (slot + 1) & (Slots - 1);
+            }
+            if (slots[slot] == 0) {
+                slots[slot] = static_cast<uint16_t>(rank + 1); // The first (most common) duplicate wins
+            }
+        }
+    }
+
+    // Rank of word (1 = most common), 0 if absent; hash is hashWord(word)
+    size_t rank(std::string_view word, uint64_t hash) const {
+        size_t slot = hash & (Slots - 1);
+        while (slots[slot] != 0) {
+            if (words[slots[slot] - 1] == word) {
+                return slots[slot];
+            }
+            slot = (slot + 1) & (Slots - 1);
+        }
+        return 0;
+    }
+};
+
+template <size_t N>
+constexpr size_t longestWord(const std::string_view (&list)[N]) {
+    size_t longest = 0;
+    for (const auto &word : list) {
+        longest = word.size() > longest ? word.size() : longest;
+    }
+    return longest;
+}
+
+// No dictionary token is longer than this, so longer substrings are never looked up
+constexpr size_t maxWordLength = std::max({longestWord(commonPasswords), longestWord(englishWords), longestWord(names)});
+
+constexpr Dictionary<512, std::size(commonPasswords)> passwordDictionary(commonPasswords);
+constexpr Dictionary<512, std::size(englishWords)> wordDictionary(englishWords);
+constexpr Dictionary<256, std::size(names)> nameDictionary(names);
+
+enum class Pattern { Bruteforce, CommonPassword, Word, Name, Spatial, Repeat, Sequence, Year };
+
+struct Match {
+    size_t i = 0; // First character
+    size_t j = 0; // Last character
+    double guesses = 0.0;
+    Pattern pattern = Pattern::Bruteforce;
+};
+
+const size_t maxAnalysedLength = 100;
+const double bruteforceCardinality = 10.0;
+const double minSequenceGuesses = 10000.0; // Cost of each extra match in a decomposition
+
+// bruteforceCardinality^length for every analysed length
+const std::array<double, maxAnalysedLength + 1> bruteforceGuesses = []() {
+    std::array<double, maxAnalysedLength + 1> powers{};
+    powers[0] = 1.0;
+    for (size_t length = 1; length <= maxAnalysedLength; ++length) {
+        powers[length] = powers[length - 1] * bruteforceCardinality;
+    }
+    return powers;
+}();
+
+double binomial(size_t n, size_t k) {
+    if (k > n) {
+        return 0.0;
+    }
+    double result = 1.0;
+    for (size_t d = 1; d <= k; ++d) {
+        result = result * static_cast<double>(n - k + d) / static_cast<double>(d);
+    }
+    return result;
+}
+
+double factorial(size_t n) {
+    double result = 1.0;
+    for (size_t i = 2; i <= n; ++i) {
+        result *= static_cast<double>(i);
+    }
+    return result;
+}
+
+bool isUpper(char c) { return c >= 'A' && c <= 'Z'; }
+bool isLower(char c) { return c >= 'a' && c <= 'z'; }
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+char toLower(char c) { return isUpper(c) ? static_cast<char>(c - 'A' + 'a') : c; }
+
+// Guesses added by capitalisation: none, first/last/all upper are cheap, anything else costs more
+double uppercaseVariations(std::string_view token) {
+    size_t upper = static_cast<size_t>(std::count_if(token.begin(), token.end(), isUpper));
+    size_t lower = static_cast<size_t>(std::count_if(token.begin(), token.end(), isLower));
+    if (upper == 0) {
+        return 1.0;
+    }
+    bool firstOnly = upper == 1 && isUpper(token.front());
+    bool lastOnly = upper == 1 && isUpper(token.back());
+    if (firstOnly || lastOnly || lower == 0) {
+        return 2.0;
+    }
+    double variations = 0.0;
+    for (size_t k = 1; k <= std::min(upper, lower); ++k) {
+        variations += binomial(upper + lower, k);
+    }
+    return variations;
+}
+
+// Common l33t substitutions; '1' is read as both 'i' and 'l'
+char unleet(char c, bool oneIsL) {
+    switch (c) {
+    case '4':
+    case '@':
+        return 'a';
+    case '3':
+        return 'e';
+    case '1':
+        return oneIsL ? 'l' : 'i';
+    case '!':
+        return 'i';
+    case '0':
+        return 'o';
+    case '$':
+    case '5':
+        return 's';
+    case '7':
+    case '+':
+        return 't';
+    default:
+        return c;
+    }
+}
+
+// Guesses added by substitutions: for each substituted letter, the ways to choose which occurrences were swapped
+double leetVariations(std::string_view token, std::string_view plain) {
+    double variations = 1.0;
+    for (char letter : {'a', 'e', 'i', 'l', 'o', 's', 't'}) {
+        size_t substituted = 0;
+        size_t unsubstituted = 0;
+        for (size_t k = 0; k < token.size(); ++k) {
+            if (plain[k] == letter) {
+                (toLower(token[k]) == letter ? unsubstituted : substituted) += 1;
+            }
+        }
+        if (substituted == 0) {
+            continue;
+        }
+        if (unsubstituted == 0) {
+            variations *= 2.0;
+        } else {
+            double options = 0.0;
+            for (size_t k = 1; k <= std::min(substituted, unsubstituted); ++k) {
+                options += binomial(substituted + unsubstituted, k);
+            }
+            variations *= options;
+        }
+    }
+    return variations;
+}
+
+const uint64_t hashBasis = 14695981039346656037ULL;
+const uint64_t hashPrime = 1099511628211ULL;
+
+// Looks word up in every dictionary; token is the original text it came from. With leet set,
+// factor is replaced by the l33t variations, worked out only once something matches.
+void matchDictionaries(std::string_view token, std::string_view word, uint64_t hash, size_t i, double factor,
+                       std::vector<Match> &matches, bool leet = false) {
+    const std::pair<size_t, Pattern> ranks[] = {
+        {passwordDictionary.rank(word, hash), Pattern::CommonPassword},
+        {wordDictionary.rank(word, hash), Pattern::Word},
+        {nameDictionary.rank(word, hash), Pattern::Name},
+    };
+    for (const auto &rank : ranks) {
+        if (rank.first != 0) {
+            if (leet) {
+                factor = leetVariations(token, word);
+                leet = false;
+            }
+            double guesses = static_cast<double>(rank.first) * uppercaseVariations(token) * factor;
+            matches.push_back({i, i + token.size() - 1, guesses, rank.second});
+        }
+    }
+}
+
+// Every dictionary word in the password: plain, reversed and with l33t substitutions undone.
+// Substrings starting at one position are hashed incrementally as they grow.
+void findDictionaryMatches(std::string_view password, std::vector<Match> &matches) {
+    size_t n = password.size();
+    std::array<char, maxAnalysedLength> lowered{};
+    std::array<char, maxAnalysedLength> reversed{};
+    std::array<char, maxAnalysedLength> leetI{};
+    std::array<char, maxAnalysedLength> leetL{};
+    for (size_t k = 0; k < n; ++k) {
+        lowered[k] = toLower(password[k]);
+        reversed[n - 1 - k] = lowered[k];
+        leetI[k] = unleet(lowered[k], false);
+        leetL[k] = unleet(lowered[k], true);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t plainHash = hashBasis;
+        uint64_t backwardsHash = hashBasis;
+        uint64_t leetIHash = hashBasis;
+        uint64_t leetLHash = hashBasis;
+        bool hasLetter = false;
+        size_t substitutions = 0;
+        size_t ones = 0;
+        for (size_t j = i; j < std::min(n, i + maxWordLength); ++j) {
+            plainHash = (plainHash ^ static_cast<unsigned char>(lowered[j])) * hashPrime;
+            backwardsHash = (backwardsHash ^ static_cast<unsigned char>(reversed[j])) * hashPrime;
+            leetIHash = (leetIHash ^ static_cast<unsigned char>(leetI[j])) * hashPrime;
+            leetLHash = (leetLHash ^ static_cast<unsigned char>(leetL[j])) * hashPrime;
+            hasLetter = hasLetter || isLower(lowered[j]);
+            substitutions += leetI[j] != lowered[j] ? 1 : 0;
+            ones += lowered[j] == '1' ? 1 : 0;
+
+            size_t length = j - i + 1;
+            if (length < 3) {
+                continue;
+            }
+            matchDictionaries(password.substr(i, length), std::string_view(lowered.data() + i, length), plainHash, i, 1.0,
+                              matches);
+
+            // reversed[i, j] is the reversal of password[n - 1 - j, n - 1 - i]; palindromes are already plain matches
+            std::string_view backwards(reversed.data() + i, length);
+            if (backwards != std::string_view(lowered.data() + (n - 1 - j), length)) {
+                matchDictionaries(password.substr(n - 1 - j, length), backwards, backwardsHash, n - 1 - j, 2.0, matches);
+            }
+
+            // Substitutions only count in tokens with a real letter ("1234" is not "iz34")
+            if (hasLetter && substitutions != 0) {
+                std::string_view token = password.substr(i, length);
+                std::string_view unleeted(leetI.data() + i, length);
+                matchDictionaries(token, unleeted, leetIHash, i, 1.0, matches, true);
+                if (ones != 0) {
+                    unleeted = std::string_view(leetL.data() + i, length);
+                    matchDictionaries(token, unleeted, leetLHash, i, 1.0, matches, true);
+                }
+            }
+        }
+    }
+}
+
+// QWERTY key positions: x in key widths (rows are staggered), y the row
+struct KeyPosition {
+    double x = 0.0;
+    int y = -1;
+    bool shifted = false;
+};
+
+struct Keyboard {
+    std::array<KeyPosition, 128> keys{};
+    double averageDegree = 0.0;
+    double startingPositions = 0.0;
+
+    Keyboard() {
+        const char *rows[] = {"`1234567890-=", "qwertyuiop[]\\", "asdfghjkl;'", "zxcvbnm,./"};
+        const char *shiftedRows[] = {"~!@#$%^&*()_+", "QWERTYUIOP{}|", "ASDFGHJKL:\"", "ZXCVBNM<>?"};
+        const double offsets[] = {0.0, 1.5, 1.75, 2.25};
+        for (int y = 0; y < 4; ++y) {
+            for (size_t x = 0; rows[y][x] != '\0'; ++x) {
+                keys[static_cast<unsigned char>(rows[y][x])] = {offsets[y] + x, y, false};
+                keys[static_cast<unsigned char>(shiftedRows[y][x])] = {offsets[y] + x, y, true};
+            }
+        }
+
+        size_t degrees = 0;
+        for (int c = 0; c < 128; ++c) {
+            if (keys[c].y < 0 || keys[c].shifted) {
+                continue;
+            }
+            startingPositions += 1.0;
+            for (int d = 0; d < 128; ++d) {
+                if (d != c && keys[d].y >= 0 && !keys[d].shifted && direction(static_cast<char>(c), static_cast<char>(d)) != 0) {
+                    ++degrees;
+                }
+            }
+        }
+        averageDegree = degrees / startingPositions;
+    }
+
+    // Non-zero code for the direction from a to b when the keys are adjacent
+    int direction(char a, char b) const {
+        const KeyPosition &from = keys[static_cast<unsigned char>(a) & 0x7f];
+        const KeyPosition &to = keys[static_cast<unsigned char>(b) & 0x7f];
+        if (from.y < 0 || to.y < 0 || (static_cast<unsigned char>(a) | static_cast<unsigned char>(b)) & 0x80) {
+            return 0;
+        }
+        double dx = to.x - from.x;
+        int dy = to.y - from.y;
+        if (dy == 0 && std::abs(dx) == 1.0) {
+            return dx > 0 ? 1 : 2;
+        }
+        if (std::abs(dy) == 1 && std::abs(dx) <= 0.75 && dx != 0.0) {
+            return 3 + (dy > 0 ? 0 : 2) + (dx > 0 ? 0 : 1);
+        }
+        return 0;
+    }
+};
+
+const Keyboard &keyboard() {
+    static const Keyboard layout;
+    return layout;
+}
+
+// Runs of adjacent keys ("qwerty", "zxcvbn", "1qaz"), priced by length, turns and shifted keys
+void findSpatialMatches(std::string_view password, std::vector<Match> &matches) {
+    const Keyboard &layout = keyboard();
+    size_t i = 0;
+    while (i + 2 < password.size()) {
+        size_t j = i;
+        size_t turns = 0;
+        int lastDirection = 0;
+        while (j + 1 < password.size()) {
+            int next = layout.direction(password[j], password[j + 1]);
+            if (next == 0) {
+                break;
+            }
+            turns += next != lastDirection ? 1 : 0;
+            lastDirection = next;
+            ++j;
+        }
+
+        size_t length = j - i + 1;
+        if (length >= 3) {
+            double guesses = 0.0;
+            for (size_t k = 2; k <= length; ++k) {
+                for (size_t t = 1; t <= std::min(turns, k - 1); ++t) {
+                    guesses += binomial(k - 1, t - 1) * layout.startingPositions * std::pow(layout.averageDegree, t);
+                }
+            }
+            size_t shifted = 0;
+            for (size_t k = i; k <= j; ++k) {
+                shifted += layout.keys[static_cast<unsigned char>(password[k]) & 0x7f].shifted ? 1 : 0;
+            }
+            if (shifted != 0) {
+                size_t unshifted = length - shifted;
+                if (unshifted == 0) {
+                    guesses *= 2.0;
+                } else {
+                    double options = 0.0;
+                    for (size_t k = 1; k <= std::min(shifted, unshifted); ++k) {
+                        options += binomial(length, k);
+                    }
+                    guesses *= options;
+                }
+            }
+            matches.push_back({i, j, guesses, Pattern::Spatial});
+        }
+        i = j > i ? j : i + 1;
+    }
+}
+
+// Runs with a constant step inside one character class ("abcd", "9753", "ACEG")
+void findSequenceMatches(std::string_view password, std::vector<Match> &matches) {
+    auto sameClass = [](char a, char b) {
+        return (isLower(a) && isLower(b)) || (isUpper(a) && isUpper(b)) || (isDigit(a) && isDigit(b));
+    };
+    size_t i = 0;
+    while (i + 2 < password.size()) {
+        int delta = password[i + 1] - password[i];
+        size_t j = i + 1;
+        if (delta != 0 && std::abs(delta) <= 5 && sameClass(password[i], password[i + 1])) {
+            while (j + 1 < password.size() && password[j + 1] - password[j] == delta && sameClass(password[j], password[j + 1])) {
+                ++j;
+            }
+        }
+        size_t length = j - i + 1;
+        if (length >= 3 && j > i + 1) {
+            char first = password[i];
+            double base = (first == 'a' || first == 'A' || first == 'z' || first == 'Z' || first == '0' || first == '1' ||
+                           first == '9')
+                              ? 4.0
+                              : (isDigit(first) ? 10.0 : 26.0);
+            matches.push_back({i, j, base * static_cast<double>(length) * (delta > 0 ? 1.0 : 2.0), Pattern::Sequence});
+            i = j;
+        } else {
+            ++i;
+        }
+    }
+}
+
+int currentYear() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+    return utc.tm_year + 1900;
+}
+
+// Four-digit years from 1900 to 2049
+void findYearMatches(std::string_view password, std::vector<Match> &matches) {
+    static const int referenceYear = currentYear();
+    for (size_t i = 0; i + 4 <= password.size(); ++i) {
+        if (!std::all_of(password.begin() + i, password.begin() + i + 4, isDigit)) {
+            continue;
+        }
+        int year = (password[i] - '0') * 1000 + (password[i + 1] - '0') * 100 + (password[i + 2] - '0') * 10 + (password[i + 3] - '0');
+        if (year >= 1900 && year <= 2049) {
+            matches.push_back({i, i + 3, std::max(std::abs(year - referenceYear), 20) * 1.0, Pattern::Year});
+        }
+    }
+}
+
+double estimateGuesses(std::string_view password, Pattern *dominant);
+
+// Repeated units ("aaaa", "abcabc"): the unit's own guesses times the number of repeats
+void findRepeatMatches(std::string_view password, std::vector<Match> &matches) {
+    size_t i = 0;
+    while (i + 1 < password.size()) {
+        size_t bestUnit = 0;
+        size_t bestCount = 0;
+        for (size_t unit = 1; i + 2 * unit <= password.size(); ++unit) {
+            size_t count = 1;
+            while (i + (count + 1) * unit <= password.size() &&
+                   password.compare(i + count * unit, unit, password, i, unit) == 0) {
+                ++count;
+            }
+            bool long_enough = unit == 1 ? count >= 3 : count >= 2;
+            if (long_enough && unit * count > bestUnit * bestCount) {
+                bestUnit = unit;
+                bestCount = count;
+            }
+        }
+        if (bestCount == 0) {
+            ++i;
+            continue;
+        }
+        double unitGuesses = estimateGuesses(password.substr(i, bestUnit), nullptr);
+        matches.push_back({i, i + bestUnit * bestCount - 1, unitGuesses * static_cast<double>(bestCount), Pattern::Repeat});
+        i += bestUnit * bestCount;
+    }
+}
+
+// Minimum-guess cover of the password by matches (zxcvbn's search): a cover of l matches
+// costs l! * (product of their guesses) + minSequenceGuesses^(l - 1), and gaps are bruteforced
+double estimateGuesses(std::string_view password, Pattern *dominant) {
+    size_t n = password.size();
+    if (n == 0) {
+        if (dominant != nullptr) {
+            *dominant = Pattern::Bruteforce;
+        }
+        return 1.0;
+    }
+
+    std::vector<Match> matches;
+    findDictionaryMatches(password, matches);
+    findSpatialMatches(password, matches);
+    findSequenceMatches(password, matches);
+    findYearMatches(password, matches);
+    findRepeatMatches(password, matches);
+    for (auto &match : matches) {
+        // A match inside a longer password is never cheaper than a few dozen guesses
+        if (match.j - match.i + 1 < n) {
+            match.guesses = std::max(match.guesses, match.i == match.j ? 10.0 : 50.0);
+        }
+    }
+    // Visit matches by last character (a counting sort), so every cover of [0, i - 1] is final before use
+    std::vector<size_t> byEnd(matches.size());
+    std::vector<size_t> firstOfEnd(n + 1, 0);
+    for (const auto &match : matches) {
+        ++firstOfEnd[match.j + 1];
+    }
+    for (size_t k = 0; k < n; ++k) {
+        firstOfEnd[k + 1] += firstOfEnd[k];
+    }
+    for (size_t m = 0; m < matches.size(); ++m) {
+        byEnd[firstOfEnd[matches[m].j]++] = m;
+    }
+
+    // State (k, l) is the cheapest cover of [0, k] by l matches: the product of their guesses,
+    // and where the last of them starts and what it is, to walk the cover back
+    const size_t stride = n + 1;
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> product(n * stride, infinity);
+    std::vector<uint8_t> lastStart(n * stride);
+    std::vector<Pattern> lastPattern(n * stride, Pattern::Bruteforce);
+    // Covers of [0, k] worth extending: a cover with more matches and no smaller product can
+    // never win, because both l! and the sequence penalty grow with l, so only the falling
+    // frontier of products is kept (usually a handful of l out of n)
+    std::vector<uint8_t> frontier(n * stride);
+    std::vector<uint8_t> frontierSize(n, 0);
+
+    auto extend = [&](size_t i, size_t k, double guesses, Pattern pattern) {
+        auto update = [&](size_t l, double candidate) {
+            size_t to = k * stride + l;
+            if (candidate < product[to]) {
+                product[to] = candidate;
+                lastStart[to] = static_cast<uint8_t>(i);
+                lastPattern[to] = pattern;
+            }
+        };
+        if (i == 0) {
+            update(1, guesses);
+            return;
+        }
+        for (size_t f = 0; f < frontierSize[i - 1]; ++f) {
+            size_t from = (i - 1) * stride + frontier[(i - 1) * stride + f];
+            // Two bruteforce runs in a row are one longer run
+            if (pattern == Pattern::Bruteforce && lastPattern[from] == Pattern::Bruteforce) {
+                continue;
+            }
+            update(frontier[(i - 1) * stride + f] + 1, product[from] * guesses);
+        }
+    };
+
+    size_t next = 0;
+    for (size_t k = 0; k < n; ++k) {
+        for (; next < byEnd.size() && matches[byEnd[next]].j == k; ++next) {
+            const Match &match = matches[byEnd[next]];
+            extend(match.i, k, match.guesses, match.pattern);
+        }
+        // Any run of characters ending here may also be bruteforced
+        for (size_t i = 0; i <= k; ++i) {
+            double guesses = bruteforceGuesses[k - i + 1];
+            if (k - i + 1 < n) {
+                guesses = std::max(guesses, i == k ? 11.0 : 51.0);
+            }
+            extend(i, k, guesses, Pattern::Bruteforce);
+        }
+        double lowest = infinity;
+        for (size_t l = 1; l <= k + 1; ++l) {
+            if (product[k * stride + l] < lowest) {
+                lowest = product[k * stride + l];
+                frontier[k * stride + frontierSize[k]++] = static_cast<uint8_t>(l);
+            }
+        }
+    }
+
+    double bestGuesses = infinity;
+    size_t bestLength = 1;
+    for (size_t l = 1; l <= n; ++l) {
+        double p = product[(n - 1) * stride + l];
+        if (p == infinity) {
+            continue;
+        }
+        double guesses = factorial(l) * p + std::pow(minSequenceGuesses, static_cast<double>(l - 1));
+        if (guesses < bestGuesses) {
+            bestGuesses = guesses;
+            bestLength = l;
+        }
+    }
+
+    if (dominant != nullptr) {
+        // Report the longest pattern in the winning cover
+        *dominant = Pattern::Bruteforce;
+        size_t longest = 0;
+        size_t k = n - 1;
+        for (size_t l = bestLength; l >= 1; --l) {
+            size_t i = lastStart[k * stride + l];
+            if (lastPattern[k * stride + l] != Pattern::Bruteforce && k - i + 1 > longest) {
+                longest = k - i + 1;
+                *dominant = lastPattern[k * stride + l];
+            }
+            if (i == 0) {
+                break;
+            }
+            k = i - 1;
+        }
+    }
+    return bestGuesses;
+}
+
+std::string feedbackFor(Pattern pattern, size_t length) {
+    switch (pattern) {
+    case Pattern::CommonPassword:
+        return "This is similar to a commonly used password.";
+    case Pattern::Word:
+        return "Words from the dictionary are easy to guess, even with substitutions or capitals.";
+    case Pattern::Name:
+        return "Names are easy to guess.";
+    case Pattern::Spatial:
+        return "Keyboard patterns like qwerty or 1qaz are easy to guess.";
+    case Pattern::Repeat:
+        return "Repeats like aaa or abcabc are easy to guess.";
+    case Pattern::Sequence:
+        return "Sequences like abc or 6543 are easy to guess.";
+    case Pattern::Year:
+        return "Recent years are easy to guess.";
+    case Pattern::Bruteforce:
+        break;
+    }
+    return length < 12 ? "Add more characters." : "Add another word or two; uncommon words are better.";
+}
+
+} // namespace
+
+// Estimate How Guessable a Password Is
+StrengthEstimate estimateStrength(std::string_view password) {
+    password = password.substr(0, maxAnalysedLength);
+    Pattern dominant = Pattern::Bruteforce;
+
+    StrengthEstimate estimate;
+    estimate.guesses = estimateGuesses(password, &dominant);
+    estimate.guessesLog10 = std::log10(estimate.guesses);
+    const double thresholds[] = {1e3 + 5, 1e6 + 5, 1e8 + 5, 1e10 + 5};
+    estimate.score = static_cast<int>(std::upper_bound(std::begin(thresholds), std::end(thresholds), estimate.guesses) -
+                                      std::begin(thresholds));
+    if (estimate.score < 4) {
+        estimate.feedback = feedbackFor(dominant, password.size());
+    }
+    return estimate;
+}
+
+} // namespace PasswordNS
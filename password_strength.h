@@ -0,0 +1,29 @@
+#ifndef PASSWORD_STRENGTH_H
+#define PASSWORD_STRENGTH_H
+
+#include <string>
+#include <string_view>
+
+namespace PasswordNS
+{
+
+    // Result of estimating how many guesses an attacker needs for a password
+    struct StrengthEstimate
+    {
+        double guesses = 0.0;
+        double guessesLog10 = 0.0;
+        int score = 0;        // 0 (too guessable) to 4 (very unguessable), as in zxcvbn
+        std::string feedback; // Why the password is guessable; empty for score 4
+    };
+
+    // zxcvbn-style estimator: finds dictionary words (common passwords, English words and
+    // names, also reversed, capitalised or with l33t substitutions), keyboard walks,
+    // repeats, sequences and years, then picks the cheapest way to cover the password
+    // with them. The dictionaries are compile-time hash tables, so an estimate takes a
+    // few microseconds and allocates nothing per lookup. Only the first 100 characters
+    // are analysed. Thread-safe.
+    StrengthEstimate estimateStrength(std::string_view password);
+
+} // namespace PasswordNS
+
+#endif
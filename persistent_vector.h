@@ -0,0 +1,267 @@
+#ifndef PERSISTENT_VECTOR_H
+#define PERSISTENT_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace PasswordNS
+{
+
+    // Sequence with O(1) copies: elements live in shared, immutable blocks of up to
+    // BlockSize items, and a copy only shares the block list. A mutation copies the
+    // block list and the one block it touches if (and only if) another copy still
+    // shares them, so without outstanding copies it edits in place like a vector.
+    // Copies may be read from other threads; mutating one copy never affects another.
+    template <typename T, size_t BlockSize = 1024>
+    class PersistentVector
+    {
+    public:
+        struct Block
+        {
+            std::vector<T> items;
+            // Free for serializers to cache e.g. a content hash; cleared whenever the block changes
+            mutable std::string contentId;
+        };
+        using BlockPtr = std::shared_ptr<const Block>;
+
+    private:
+        struct Root
+        {
+            std::vector<std::shared_ptr<Block>> blocks;
+            std::vector<size_t> ends; // ends[b]: number of items in blocks [0, b]
+        };
+
+        std::shared_ptr<Root> root;
+
+        size_t endOf(size_t blockIndex) const { return root->ends[blockIndex]; }
+        size_t beginOf(size_t blockIndex) const { return blockIndex == 0 ? 0 : root->ends[blockIndex - 1]; }
+
+        // Block holding item index (blocks may hold fewer than BlockSize items after removals)
+        size_t blockFor(size_t index) const
+        {
+            return static_cast<size_t>(std::upper_bound(root->ends.begin(), root->ends.end(), index) - root->ends.begin());
+        }
+
+        Root &mutableRoot()
+        {
+            if (!root)
+            {
+                root = std::make_shared<Root>();
+            }
+            else if (root.use_count() != 1)
+            {
+                root = std::make_shared<Root>(*root);
+            }
+            return *root;
+        }
+
+        Block &mutableBlock(size_t blockIndex)
+        {
+            Root &r = mutableRoot();
+            std::shared_ptr<Block> &block = r.blocks[blockIndex];
+            if (block.use_count() != 1)
+            {
+                block = std::make_shared<Block>(Block{block->items, std::string()});
+            }
+            block->contentId.clear();
+            return *block;
+        }
+
+        void recomputeEnds(Root &r)
+        {
+            r.ends.resize(r.blocks.size());
+            size_t total = 0;
+            for (size_t b = 0; b < r.blocks.size(); ++b)
+            {
+                total += r.blocks[b]->items.size();
+                r.ends[b] = total;
+            }
+        }
+
+    public:
+        class const_iterator
+        {
+        private:
+            const Root *root = nullptr;
+            size_t blockIndex = 0;
+            size_t offset = 0;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T *;
+            using reference = const T &;
+
+            const_iterator() = default;
+            const_iterator(const Root *r, size_t block) : root(r), blockIndex(block) {}
+
+            reference operator*() const { return root->blocks[blockIndex]->items[offset]; }
+            pointer operator->() const { return &**this; }
+
+            const_iterator &operator++()
+            {
+                if (++offset == root->blocks[blockIndex]->items.size())
+                {
+                    ++blockIndex;
+                    offset = 0;
+                }
+                return *this;
+            }
+            const_iterator operator++(int)
+            {
+                const_iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const const_iterator &other) const
+            {
+                return blockIndex == other.blockIndex && offset == other.offset;
+            }
+            bool operator!=(const const_iterator &other) const { return !(*this == other); }
+        };
+
+        PersistentVector() = default;
+        PersistentVector(const std::vector<T> &items)
+        {
+            for (const auto &item : items)
+            {
+                push_back(item);
+            }
+        }
+
+        const_iterator begin() const { return const_iterator(root.get(), 0); }
+        const_iterator end() const { return const_iterator(root.get(), root ? root->blocks.size() : 0); }
+
+        size_t size() const { return root && !root->ends.empty() ? root->ends.back() : 0; }
+        bool empty() const { return size() == 0; }
+
+        const T &operator[](size_t index) const
+        {
+            size_t b = blockFor(index);
+            return root->blocks[b]->items[index - beginOf(b)];
+        }
+
+        const T &at(size_t index) const
+        {
+            if (index >= size())
+            {
+                throw std::out_of_range("PersistentVector index out of range.");
+            }
+            return (*this)[index];
+        }
+
+        void push_back(T item) { emplace_back(std::move(item)); }
+
+        template <typename... Args>
+        void emplace_back(Args &&...args)
+        {
+            Root &r = mutableRoot();
+            if (r.blocks.empty() || r.blocks.back()->items.size() >= BlockSize)
+            {
+                r.blocks.push_back(std::make_shared<Block>());
+                r.blocks.back()->items.reserve(BlockSize);
+                r.ends.push_back(size());
+            }
+            mutableBlock(r.blocks.size() - 1).items.emplace_back(std::forward<Args>(args)...);
+            ++r.ends.back();
+        }
+
+        void set(size_t index, T item)
+        {
+            if (index >= size())
+            {
+                throw std::out_of_range("PersistentVector index out of range.");
+            }
+            size_t b = blockFor(index);
+            mutableBlock(b).items[index - beginOf(b)] = std::move(item);
+        }
+
+        // Removes one item: O(BlockSize) within its block plus O(blocks) to shift the block ends
+        void erase(size_t index)
+        {
+            if (index >= size())
+            {
+                throw std::out_of_range("PersistentVector index out of range.");
+            }
+            size_t b = blockFor(index);
+            auto &items = mutableBlock(b).items;
+            items.erase(items.begin() + static_cast<std::ptrdiff_t>(index - beginOf(b)));
+            Root &r = mutableRoot();
+            for (size_t later = b; later < r.ends.size(); ++later)
+            {
+                --r.ends[later];
+            }
+            if (items.empty())
+            {
+                r.blocks.erase(r.blocks.begin() + static_cast<std::ptrdiff_t>(b));
+                r.ends.erase(r.ends.begin() + static_cast<std::ptrdiff_t>(b));
+            }
+        }
+
+        // Removes matching items; blocks without a match stay shared with other copies
+        template <typename Predicate>
+        size_t removeIf(Predicate predicate)
+        {
+            if (!root)
+            {
+                return 0;
+            }
+            size_t removed = 0;
+            for (size_t b = 0; b < root->blocks.size(); ++b)
+            {
+                const auto &items = root->blocks[b]->items;
+                if (std::none_of(items.begin(), items.end(), predicate))
+                {
+                    continue;
+                }
+                auto &block = mutableBlock(b).items;
+                auto it = std::remove_if(block.begin(), block.end(), predicate);
+                removed += static_cast<size_t>(block.end() - it);
+                block.erase(it, block.end());
+            }
+            if (removed != 0)
+            {
+                Root &r = mutableRoot();
+                r.blocks.erase(std::remove_if(r.blocks.begin(), r.blocks.end(),
+                                              [](const std::shared_ptr<Block> &block) { return block->items.empty(); }),
+                               r.blocks.end());
+                recomputeEnds(r);
+            }
+            return removed;
+        }
+
+        void clear() { root.reset(); }
+
+        // Block-level access for serializers
+        size_t blockCount() const { return root ? root->blocks.size() : 0; }
+        BlockPtr block(size_t blockIndex) const { return root->blocks[blockIndex]; }
+
+        // Appends a whole block (e.g. one read back from a snapshot)
+        void appendBlock(std::vector<T> items, std::string contentId = std::string())
+        {
+            if (items.empty())
+            {
+                return;
+            }
+            Root &r = mutableRoot();
+            r.blocks.push_back(std::make_shared<Block>(Block{std::move(items), std::move(contentId)}));
+            r.ends.push_back(size() + r.blocks.back()->items.size());
+        }
+
+        std::vector<T> toVector() const { return std::vector<T>(begin(), end()); }
+
+        // True when both copies share every block (used by tests and benchmarks)
+        bool sharesStorageWith(const PersistentVector &other) const { return root == other.root; }
+    };
+
+} // namespace PasswordNS
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef RECORD_SCHEMA_H
+#define RECORD_SCHEMA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace PasswordNS
+{
+
+    // Which occurrence of a field's delimiter ends the field when text is parsed
+    enum class Split
+    {
+        First, // The field cannot hold its delimiter
+        Last   // The fields after it cannot hold the delimiter, but this one may
+    };
+
+    constexpr char toEnd = '\0'; // Delimiter of the last field, which runs to the end of the text
+
+    // One field of a record: the std::string_view member that holds it, the character that ends
+    // it in the text format, and whether it may be empty
+    template <auto Member, char Delimiter = toEnd, Split Where = Split::First, bool AllowEmpty = true>
+    struct Field
+    {
+        static constexpr auto member = Member;
+        static constexpr char delimiter = Delimiter;
+        static constexpr Split split = Where;
+        static constexpr bool allowEmpty = AllowEmpty;
+    };
+
+    namespace detail
+    {
+        template <char... Delimiters>
+        constexpr bool onlyLastRunsToEnd()
+        {
+            constexpr char delimiters[] = {Delimiters...};
+            for (size_t i = 0; i + 1 < sizeof...(Delimiters); ++i)
+            {
+                if (delimiters[i] == toEnd)
+                {
+                    return false;
+                }
+            }
+            return delimiters[sizeof...(Delimiters) - 1] == toEnd;
+        }
+    } // namespace detail
+
+    // Encoders and parsers for a record, generated from its field list at compile time.
+    // Text: the fields in order, each followed by its delimiter ("service username:hex").
+    // Binary: each field as a 4-byte little-endian length and its bytes, so any byte may appear.
+    // Decoding never allocates: the record's views point into the input, which must outlive them.
+    template <typename Record, typename... Fields>
+    class RecordSchema
+    {
+    private:
+        static_assert(sizeof...(Fields) > 0 && detail::onlyLastRunsToEnd<Fields::delimiter...>(),
+                      "Every field but the last needs a delimiter, and the last runs to the end");
+
+        static constexpr size_t lengthBytes = 4;
+
+        static char *putText(char *out, std::string_view value, char delimiter)
+        {
+            std::memcpy(out, value.data(), value.size());
+            out += value.size();
+            if (delimiter != toEnd)
+            {
+                *out++ = delimiter;
+            }
+            return out;
+        }
+
+        template <typename F>
+        static bool takeText(std::string_view &text, Record &record)
+        {
+            size_t end = text.size();
+            if constexpr (F::delimiter != toEnd)
+            {
+                end = F::split == Split::First ? text.find(F::delimiter) : text.rfind(F::delimiter);
+                if (end == std::string_view::npos)
+                {
+                    return false;
+                }
+            }
+            record.*F::member = text.substr(0, end);
+            text.remove_prefix(std::min(text.size(), end + 1));
+            return F::allowEmpty || end != 0;
+        }
+
+        static char *putBinary(char *out, std::string_view value)
+        {
+            if (value.size() > UINT32_MAX)
+            {
+                throw std::invalid_argument("Record fields are limited to 4 GiB.");
+            }
+            uint32_t length = static_cast<uint32_t>(value.size());
+            for (size_t i = 0; i < lengthBytes; ++i)
+            {
+                out[i] = static_cast<char>(length >> (8 * i));
+            }
+            std::memcpy(out + lengthBytes, value.data(), value.size());
+            return out + lengthBytes + value.size();
+        }
+
+        template <typename F>
+        static bool takeBinary(std::string_view &input, Record &record)
+        {
+            if (input.size() < lengthBytes)
+            {
+                return false;
+            }
+            uint32_t length = 0;
+            for (size_t i = 0; i < lengthBytes; ++i)
+            {
+                length |= static_cast<uint32_t>(static_cast<unsigned char>(input[i])) << (8 * i);
+            }
+            if (input.size() - lengthBytes < length || (!F::allowEmpty && length == 0))
+            {
+                return false;
+            }
+            record.*F::member = input.substr(lengthBytes, length);
+            input.remove_prefix(lengthBytes + length);
+            return true;
+        }
+
+    public:
+        static constexpr size_t fieldCount = sizeof...(Fields);
+        static constexpr size_t delimiterCount = fieldCount - 1;
+
+        static size_t textSize(const Record &record)
+        {
+            return ((record.*Fields::member).size() + ...) + delimiterCount;
+        }
+
+        // Writes textSize(record) bytes to out and returns the end
+        static char *encodeText(const Record &record, char *out)
+        {
+            ((out = putText(out, record.*Fields::member, Fields::delimiter)), ...);
+            return out;
+        }
+
+        static void appendText(const Record &record, std::string &out)
+        {
+            size_t start = out.size();
+            out.resize(start + textSize(record));
+            encodeText(record, &out[start]);
+        }
+
+        // False when a delimiter is missing or a field that may not be empty is
+        static bool decodeText(std::string_view text, Record &record)
+        {
+            return (takeText<Fields>(text, record) && ...);
+        }
+
+        static size_t binarySize(const Record &record)
+        {
+            return ((record.*Fields::member).size() + ...) + lengthBytes * fieldCount;
+        }
+
+        static char *encodeBinary(const Record &record, char *out)
+        {
+            ((out = putBinary(out, record.*Fields::member)), ...);
+            return out;
+        }
+
+        static void appendBinary(const Record &record, std::string &out)
+        {
+            size_t start = out.size();
+            out.resize(start + binarySize(record));
+            encodeBinary(record, &out[start]);
+        }
+
+        // Takes one record off the front of input; false (input in an unspecified state) when it is cut short
+        static bool decodeBinary(std::string_view &input, Record &record)
+        {
+            return (takeBinary<Fields>(input, record) && ...);
+        }
+    };
+
+    // One vault line, "service username:hex". The service is split off at the last space, so it
+    // may hold spaces. The account is the value of a CredentialList entry.
+    struct VaultLineView
+    {
+        std::string_view service;
+        std::string_view account;
+    };
+    using VaultLineSchema = RecordSchema<VaultLineView, Field<&VaultLineView::service, ' ', Split::Last, false>,
+                                         Field<&VaultLineView::account, toEnd, Split::First, false>>;
+
+    // An account, "username:hex". Usernames never hold a colon (batch_io.h refuses them).
+    struct AccountView
+    {
+        std::string_view username;
+        std::string_view passwordHex;
+    };
+    using AccountSchema =
+        RecordSchema<AccountView, Field<&AccountView::username, ':'>, Field<&AccountView::passwordHex>>;
+
+    // A vault line split all the way, for code that wants every field at once. Its binary form is
+    // the compact one: three length-prefixed fields instead of delimiters.
+    struct VaultRecordView
+    {
+        std::string_view service;
+        std::string_view username;
+        std::string_view passwordHex;
+    };
+    using VaultRecordSchema = RecordSchema<VaultRecordView, Field<&VaultRecordView::service, ' ', Split::Last, false>,
+                                           Field<&VaultRecordView::username, ':'>,
+                                           Field<&VaultRecordView::passwordHex>>;
+
+    inline VaultLineView vaultLine(const std::pair<std::string, std::string> &entry)
+    {
+        return {entry.first, entry.second};
+    }
+
+    // The vault text of entries, one "service username:hex" line each
+    template <typename Entries>
+    size_t vaultTextSize(const Entries &entries)
+    {
+        size_t size = 0;
+        for (const auto &entry : entries)
+        {
+            size += VaultLineSchema::textSize(vaultLine(entry)) + 1;
+        }
+        return size;
+    }
+
+    template <typename Entries>
+    std::string vaultText(const Entries &entries)
+    {
+        std::string text(vaultTextSize(entries), '\0');
+        char *out = &text[0];
+        for (const auto &entry : entries)
+        {
+            out = VaultLineSchema::encodeText(vaultLine(entry), out);
+            *out++ = '\n';
+        }
+        return text;
+    }
+
+} // namespace PasswordNS
+
+#endif
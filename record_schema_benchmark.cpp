@@ -0,0 +1,125 @@
+// record_schema_benchmark.cpp
+// Measures the record codecs generated by record_schema.h in records per second: parsing vault
+// lines the way the manager used to (rfind, find and substr into strings) against the schema's
+// text and binary decoders, which only hand out views, and building vault text both ways.
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "record_schema.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+double secondsFor(const std::function<void()> &operation) {
+    auto start = std::chrono::steady_clock::now();
+    operation();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const std::string &label, size_t records, double seconds, double baseline) {
+    std::cout << std::left << std::setw(32) << label << std::right << std::fixed << std::setprecision(0)
+              << std::setw(14) << records / seconds << " records/s" << std::setprecision(2) << std::setw(8)
+              << baseline / seconds << "x\n";
+}
+
+// Calls line(view) for every non-empty line of text
+template <typename Fn>
+void forEachLine(std::string_view text, Fn line) {
+    for (size_t start = 0; start < text.size();) {
+        size_t end = std::min(text.find('\n', start), text.size());
+        if (end != start) {
+            line(text.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t records = argc > 1 ? std::stoull(argv[1]) : 1000000;
+
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (size_t i = 0; i < records; ++i) {
+        entries.emplace_back("service " + std::to_string(i % 977), "user" + std::to_string(i) + ":" +
+                                                                     std::string(32 + 32 * (i % 2), 'a' + i % 6));
+    }
+    std::string text = vaultText(entries);
+    std::vector<VaultRecordView> split; // Views into text
+    forEachLine(text, [&](std::string_view line) {
+        split.emplace_back();
+        VaultRecordSchema::decodeText(line, split.back());
+    });
+    std::string binary;
+    for (const auto &record : split) {
+        VaultRecordSchema::appendBinary(record, binary);
+    }
+
+    // Parsing: every field of every record, as getAllDecryptedCredentials needs them
+    size_t checksum = 0;
+    size_t parsed = 0;
+    double adHoc = secondsFor([&] {
+        forEachLine(text, [&](std::string_view view) {
+            std::string line(view);
+            size_t space = line.rfind(' ');
+            std::string service = line.substr(0, space);
+            std::string account = line.substr(space + 1);
+            size_t colon = account.find(':');
+            std::string username = account.substr(0, colon);
+            std::string passwordHex = account.substr(colon + 1);
+            checksum += service.size() + username.size() + passwordHex.size();
+        });
+    });
+    size_t expected = checksum;
+    std::cout << "Parsing " << records << " vault records\n";
+    report("find/substr into strings", records, adHoc, adHoc);
+
+    checksum = 0;
+    double schemaText = secondsFor([&] {
+        forEachLine(text, [&](std::string_view line) {
+            VaultRecordView record;
+            parsed += VaultRecordSchema::decodeText(line, record);
+            checksum += record.service.size() + record.username.size() + record.passwordHex.size();
+        });
+    });
+    bool consistent = checksum == expected;
+    report("schema, text", records, schemaText, adHoc);
+
+    checksum = 0;
+    double schemaBinary = secondsFor([&] {
+        std::string_view input(binary);
+        VaultRecordView record;
+        while (!input.empty() && VaultRecordSchema::decodeBinary(input, record)) {
+            ++parsed;
+            checksum += record.service.size() + record.username.size() + record.passwordHex.size();
+        }
+    });
+    consistent = consistent && checksum == expected && parsed == 2 * records;
+    report("schema, binary", records, schemaBinary, adHoc);
+
+    // Encoding: a whole vault, as the flat file engine and snapshots write it
+    std::string built;
+    double appended = secondsFor([&] {
+        for (const auto &entry : entries) {
+            built.append(entry.first).append(" ").append(entry.second).append("\n");
+        }
+    });
+    std::cout << "\nEncoding " << records << " vault records\n";
+    report("string appends", records, appended, appended);
+    std::string encoded;
+    report("schema, text", records, secondsFor([&] { encoded = vaultText(entries); }), appended);
+    std::string encodedBinary;
+    report("schema, binary", records, secondsFor([&] {
+        encodedBinary.reserve(binary.size());
+        for (const auto &record : split) {
+            VaultRecordSchema::appendBinary(record, encodedBinary);
+        }
+    }), appended);
+    consistent = consistent && built == text && encoded == text && encodedBinary == binary;
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// scheduler_benchmark.cpp
+// Measures the work-stealing scheduler (task_scheduler.h). Spawn overhead: empty tasks
+// spawned from outside the scheduler, spawned by its own workers (parallelFor with a grain
+// of one), and submitted to a WorkerPool for comparison. Scaling: decrypting a vault's
+// passwords with parallelFor on 1, 2, 4... workers, and the full getAllDecryptedCredentials
+// on the shared scheduler.
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "manager.h"
+#include "task_scheduler.h"
+#include "worker_pool.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+double millisecondsFor(const std::function<void()> &operation) {
+    auto start = std::chrono::steady_clock::now();
+    operation();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void reportSpawn(const std::string &label, size_t tasks, double milliseconds) {
+    std::cout << std::left << std::setw(36) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << milliseconds * 1e6 / tasks << " ns/task\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t tasks = argc > 1 ? std::stoull(argv[1]) : 200000;
+    size_t entries = argc > 2 ? std::stoull(argv[2]) : 50000;
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "Spawn overhead (" << tasks << " empty tasks, " << cores << " workers)\n";
+    std::atomic<size_t> ran{0};
+    {
+        TaskScheduler scheduler;
+        reportSpawn("Scheduler, spawned from outside", tasks, millisecondsFor([&] {
+            TaskGroup group(scheduler);
+            for (size_t i = 0; i < tasks; ++i) {
+                group.run([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); });
+            }
+            group.wait();
+        }));
+        reportSpawn("Scheduler, spawned by its workers", tasks, millisecondsFor([&] {
+            parallelFor(0, tasks, 1, [&ran](size_t, size_t) { ran.fetch_add(1, std::memory_order_relaxed); },
+                        scheduler);
+        }));
+        std::cout << std::left << std::setw(36) << "  (tasks stolen so far)" << std::right << std::setw(10)
+                  << scheduler.steals() << "\n";
+    }
+    reportSpawn("WorkerPool, submitted from outside", tasks, millisecondsFor([&] {
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t done = 0;
+        {
+            WorkerPool pool(cores);
+            for (size_t i = 0; i < tasks; ++i) {
+                pool.submit([&]() {
+                    ran.fetch_add(1, std::memory_order_relaxed);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ++done;
+                    finished.notify_one();
+                });
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&]() { return done == tasks; });
+        }
+    }));
+
+    // Decryption is the CPU-bound work the scheduler exists for
+    std::vector<std::string> ciphertexts;
+    for (size_t i = 0; i < entries; ++i) {
+        ciphertexts.push_back(PasswordManager::encryptToHex("Passw0rd-" + std::to_string(i), PasswordManager::getDefaultEncryptionKey()));
+    }
+    std::set<size_t> workerCounts = {1, 2, 4, cores};
+    std::cout << "\nDecrypting " << entries << " passwords\n";
+    double single = 0;
+    bool consistent = ran.load() == tasks * 3;
+    for (size_t workers : workerCounts) {
+        SchedulerOptions options;
+        options.threads = workers;
+        TaskScheduler scheduler(options);
+        std::atomic<size_t> decrypted{0};
+        double milliseconds = millisecondsFor([&] {
+            parallelFor(0, entries, 256, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    decrypted += PasswordManager::decryptFromHex(ciphertexts[i], PasswordManager::getDefaultEncryptionKey()).size() > 0;
+                }
+            }, scheduler);
+        });
+        consistent = consistent && decrypted == entries;
+        single = single == 0 ? milliseconds : single;
+        std::cout << std::left << std::setw(36) << ("parallelFor, " + std::to_string(workers) + " workers") << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(10) << milliseconds << " ms" << std::setw(8)
+                  << single / milliseconds << "x\n";
+    }
+
+    // The manager reports its destruction on the console; keep that out of the output
+    std::streambuf *console = std::cout.rdbuf(nullptr);
+    size_t listed = 0;
+    double milliseconds;
+    {
+        PasswordManager manager;
+        manager.setCompressOnExit(false);
+        manager.setStorageEngine("memory");
+        CredentialList vault;
+        for (size_t i = 0; i < entries; ++i) {
+            vault.emplace_back("service" + std::to_string(i), "user:" + ciphertexts[i]);
+        }
+        manager.restoreCredentialList(vault);
+        milliseconds = millisecondsFor([&] { listed = manager.getAllDecryptedCredentials().size(); });
+    }
+    std::cout.rdbuf(console);
+    consistent = consistent && listed == entries;
+    std::cout << std::left << std::setw(36) << "getAllDecryptedCredentials (shared)" << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << milliseconds << " ms\n";
+    return consistent ? 0 : 1;
+}
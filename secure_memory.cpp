@@ -0,0 +1,175 @@
+#include "secure_memory.h"
+#include <openssl/crypto.h>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace EncryptionNS {
+
+namespace {
+
+size_t pageSize() {
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t roundUpToPages(size_t size) {
+    size_t page = pageSize();
+    return (std::max<size_t>(size, 1) + page - 1) / page * page;
+}
+
+} // namespace
+
+// Map a Guarded, Locked Region
+SecureRegion allocateSecureRegion(size_t size) {
+    size_t page = pageSize();
+    size_t usable = roundUpToPages(size);
+    void *mapping = ::mmap(nullptr, usable + 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    auto *base = static_cast<unsigned char *>(mapping);
+    // Guard pages turn an overrun into a crash instead of a read of neighbouring secrets
+    ::mprotect(base, page, PROT_NONE);
+    ::mprotect(base + page + usable, page, PROT_NONE);
+
+    SecureRegion region;
+    region.data = base + page;
+    region.size = usable;
+    region.locked = ::mlock(region.data, usable) == 0;
+#ifdef MADV_DONTDUMP
+    ::madvise(region.data, usable, MADV_DONTDUMP);
+#endif
+    return region;
+}
+
+void releaseSecureRegion(SecureRegion &region) {
+    if (region.data == nullptr) {
+        return;
+    }
+    OPENSSL_cleanse(region.data, region.size);
+    if (region.locked) {
+        ::munlock(region.data, region.size);
+    }
+    ::munmap(region.data - pageSize(), region.size + 2 * pageSize());
+    region = SecureRegion();
+}
+
+SecureArena::SecureArena(size_t initialSize) : nextRegionSize(roundUpToPages(initialSize)) {}
+
+SecureArena::~SecureArena() noexcept {
+    for (auto &region : regions) {
+        releaseSecureRegion(region);
+    }
+}
+
+// Allocate by Bumping a Pointer
+void *SecureArena::allocate(size_t size, size_t alignment) {
+    size_t offset = (used + alignment - 1) / alignment * alignment;
+    if (regions.empty() || offset + size > regions.back().size) {
+        // Regions double in size (up to 16 MB) so bulk work needs few mappings
+        size_t regionSize = std::max(nextRegionSize, roundUpToPages(size));
+        regions.push_back(allocateSecureRegion(regionSize));
+        nextRegionSize = std::min<size_t>(regionSize * 2, 16 * 1024 * 1024);
+        offset = 0;
+    }
+    used = offset + size;
+    return regions.back().data + offset;
+}
+
+// Wipe Everything Handed Out
+void SecureArena::reset() {
+    while (regions.size() > 1) {
+        releaseSecureRegion(regions.back());
+        regions.pop_back();
+    }
+    if (!regions.empty()) {
+        OPENSSL_cleanse(regions.front().data, regions.front().size);
+    }
+    used = 0;
+}
+
+size_t SecureArena::capacity() const {
+    size_t total = 0;
+    for (const auto &region : regions) {
+        total += region.size;
+    }
+    return total;
+}
+
+bool SecureArena::isLocked() const {
+    return std::all_of(regions.begin(), regions.end(), [](const SecureRegion &region) { return region.locked; });
+}
+
+SecureString::SecureString(size_t size, std::shared_ptr<SecureArena> fromArena) : arena(std::move(fromArena)), length(size) {
+    if (size == 0) {
+        return;
+    }
+    if (arena) {
+        bytes = static_cast<char *>(arena->allocate(size, 1));
+    } else {
+        region = allocateSecureRegion(size);
+        bytes = reinterpret_cast<char *>(region.data);
+    }
+}
+
+SecureString::SecureString(std::string_view text, std::shared_ptr<SecureArena> fromArena)
+    : SecureString(text.size(), std::move(fromArena)) {
+    if (!text.empty()) {
+        std::memcpy(bytes, text.data(), text.size());
+    }
+}
+
+// Copies get their own region, so only the code that owns an arena ever allocates from it
+SecureString::SecureString(const SecureString &other) : SecureString(other.view()) {}
+
+SecureString::SecureString(SecureString &&other) noexcept
+    : arena(std::move(other.arena)), region(other.region), bytes(other.bytes), length(other.length) {
+    other.region = SecureRegion();
+    other.bytes = nullptr;
+    other.length = 0;
+}
+
+SecureString &SecureString::operator=(const SecureString &other) {
+    if (this != &other) {
+        *this = SecureString(other);
+    }
+    return *this;
+}
+
+SecureString &SecureString::operator=(SecureString &&other) noexcept {
+    if (this != &other) {
+        release();
+        arena = std::move(other.arena);
+        region = other.region;
+        bytes = other.bytes;
+        length = other.length;
+        other.region = SecureRegion();
+        other.bytes = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+void SecureString::truncate(size_t newSize) {
+    if (newSize < length) {
+        OPENSSL_cleanse(bytes + newSize, length - newSize);
+        length = newSize;
+    }
+}
+
+// Wipe the Secret (arena memory is wiped again when the arena goes away)
+void SecureString::release() noexcept {
+    if (bytes != nullptr) {
+        OPENSSL_cleanse(bytes, length);
+    }
+    releaseSecureRegion(region);
+    arena.reset();
+    bytes = nullptr;
+    length = 0;
+}
+
+} // namespace EncryptionNS
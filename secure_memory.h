@@ -0,0 +1,100 @@
+#ifndef SECURE_MEMORY_H
+#define SECURE_MEMORY_H
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace EncryptionNS
+{
+
+    // Memory for plaintext secrets: page-aligned mappings with an inaccessible guard page
+    // on each side, locked into RAM (mlock, best effort when RLIMIT_MEMLOCK is low),
+    // excluded from core dumps where supported, and wiped with OPENSSL_cleanse on release.
+    struct SecureRegion
+    {
+        unsigned char *data = nullptr; // Usable bytes, between the guard pages
+        size_t size = 0;
+        bool locked = false;
+    };
+
+    SecureRegion allocateSecureRegion(size_t size); // Throws std::bad_alloc when mapping fails
+    void releaseSecureRegion(SecureRegion &region); // Wipes, unlocks and unmaps
+
+    // Bump allocator over secure regions for bulk work: an allocation is a pointer
+    // increment, nothing is freed individually, and reset()/destruction wipes every
+    // region at once. Grows by adding regions. Not thread-safe.
+    class SecureArena
+    {
+    private:
+        std::vector<SecureRegion> regions;
+        size_t used = 0; // Bytes handed out from regions.back()
+        size_t nextRegionSize;
+
+    public:
+        explicit SecureArena(size_t initialSize = 64 * 1024);
+        ~SecureArena() noexcept;
+
+        SecureArena(const SecureArena &) = delete;
+        SecureArena &operator=(const SecureArena &) = delete;
+
+        void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        // Wipes everything handed out so far and keeps the first region for reuse
+        void reset();
+
+        size_t capacity() const;
+        bool isLocked() const; // Whether every region is locked into RAM
+    };
+
+    // Byte string for a secret. Small or large, it never uses the std::string small-buffer
+    // (which would keep the secret inside the object) and wipes its bytes when destroyed.
+    // Strings from an arena share ownership of it; standalone ones get their own region.
+    class SecureString
+    {
+    private:
+        std::shared_ptr<SecureArena> arena;
+        SecureRegion region; // Only for standalone strings
+        char *bytes = nullptr;
+        size_t length = 0;
+
+        void release() noexcept;
+
+    public:
+        SecureString() = default;
+        explicit SecureString(size_t size, std::shared_ptr<SecureArena> fromArena = nullptr);
+        SecureString(std::string_view text, std::shared_ptr<SecureArena> fromArena = nullptr);
+        ~SecureString() noexcept { release(); }
+
+        SecureString(const SecureString &other);
+        SecureString(SecureString &&other) noexcept;
+        SecureString &operator=(const SecureString &other);
+        SecureString &operator=(SecureString &&other) noexcept;
+
+        char *data() { return bytes; }
+        const char *data() const { return bytes; }
+        size_t size() const { return length; }
+        bool empty() const { return length == 0; }
+
+        // Shortens the string, wiping the bytes cut off
+        void truncate(size_t newSize);
+
+        std::string_view view() const { return std::string_view(bytes, length); }
+        // Plain copy for APIs that need std::string; the copy is not protected
+        std::string str() const { return std::string(bytes, length); }
+
+        bool operator==(std::string_view other) const { return view() == other; }
+        bool operator!=(std::string_view other) const { return view() != other; }
+    };
+
+    inline std::ostream &operator<<(std::ostream &out, const SecureString &secret)
+    {
+        return out.write(secret.data(), static_cast<std::streamsize>(secret.size()));
+    }
+
+} // namespace EncryptionNS
+
+#endif
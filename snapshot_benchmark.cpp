@@ -0,0 +1,109 @@
+// snapshot_benchmark.cpp
+// Measures the cost of taking, writing and restoring credential snapshots
+// for a large vault, against a deep copy of the credentials.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <filesystem>
+#include "batch_io.h"
+#include "manager.h"
+#include "vault_snapshot.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+const std::string benchUser = "snapshot_bench_user";
+
+double microsecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Builds a vault of the requested size through the batch importer
+void writeVault(const PasswordManager &manager, size_t entries) {
+    {
+        std::ofstream plain("bench_entries.csv", std::ios::trunc);
+        for (size_t i = 0; i < entries; ++i) {
+            plain << "service" << i << ",user" << i << ",Passw0rd-" << i << "\n";
+        }
+    }
+
+    std::ifstream input("bench_entries.csv");
+    std::ofstream vault(manager.getVaultFileName(), std::ios::trunc);
+    BatchOptions options;
+    options.progressInterval = 0;
+    importCredentials(manager, input, vault, options);
+    std::filesystem::remove("bench_entries.csv");
+}
+
+void printDiskStats(const std::string &label, const SnapshotStats &stats) {
+    std::cout << std::left << std::setw(34) << label << std::right << std::setw(8) << stats.blocksWritten << "/"
+              << std::left << std::setw(8) << stats.blocks << std::right << std::setw(14) << stats.bytesWritten
+              << std::setw(12) << std::fixed << std::setprecision(3) << stats.seconds * 1e3 << " ms\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t entries = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    const int copies = 1000000;
+
+    // Work in a scratch directory so the benchmark never touches real vaults
+    auto originalDirectory = std::filesystem::current_path();
+    auto workDirectory = std::filesystem::temp_directory_path() / "password_manager_snapshot_benchmark";
+    std::filesystem::remove_all(workDirectory);
+    std::filesystem::create_directories(workDirectory);
+    std::filesystem::current_path(workDirectory);
+
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setUsername(benchUser);
+    writeVault(manager, entries);
+    manager.loadCredentialsFromFile();
+    std::cout << "Snapshots of a " << entries << "-entry vault\n";
+
+    // In-memory snapshots only share the block list
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = 0;
+    for (int i = 0; i < copies; ++i) {
+        CredentialList snapshot = manager.getCredentialList();
+        checksum += snapshot.size();
+    }
+    std::cout << "Take snapshot (O(1) copy):          " << microsecondsSince(start) * 1e3 / copies << " ns\n";
+
+    start = std::chrono::steady_clock::now();
+    auto deepCopy = manager.getAllCredentials();
+    std::cout << "Deep copy of all entries:           " << microsecondsSince(start) << " us\n";
+    checksum += deepCopy.size();
+
+    // The first write after a snapshot copies the block list and one block; later ones edit in place
+    CredentialList working = manager.getCredentialList();
+    CredentialList snapshot = working;
+    start = std::chrono::steady_clock::now();
+    working.set(entries / 2, {"changed", "user:00"});
+    std::cout << "First write after a snapshot:       " << microsecondsSince(start) << " us\n";
+    start = std::chrono::steady_clock::now();
+    working.set(entries / 2 + 1, {"changed", "user:00"});
+    std::cout << "Second write (block now private):   " << microsecondsSince(start) << " us\n";
+    std::cout << "Snapshot still sees the old entry:  " << (snapshot[entries / 2].first != "changed" ? "yes" : "no")
+              << "\n\n";
+
+    std::cout << std::left << std::setw(34) << "On-disk snapshot" << std::right << std::setw(17) << "Blocks written"
+              << std::setw(14) << "Bytes" << std::setw(15) << "Time" << "\n";
+    ChunkStore store("snapshots");
+    printDiskStats("first snapshot", writeSnapshot(store, "first", working));
+    printDiskStats("unchanged vault", writeSnapshot(store, "unchanged", working));
+    working.set(entries / 3, {"changed", "user:00"});
+    printDiskStats("after one changed entry", writeSnapshot(store, "one_change", working));
+
+    start = std::chrono::steady_clock::now();
+    CredentialList restored = readSnapshot(store, "one_change");
+    std::cout << "Restore from disk:                  " << microsecondsSince(start) / 1e3 << " ms ("
+              << restored.size() << " entries)\n";
+
+    std::filesystem::current_path(originalDirectory);
+    std::filesystem::remove_all(workDirectory);
+    return checksum == 0 ? 1 : 0;
+}
@@ -0,0 +1,322 @@
+#include "sqlite_backend.h"
+#include <sqlite3.h>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace PasswordNS {
+
+namespace {
+
+const char schema[] =
+    "CREATE TABLE IF NOT EXISTS credentials (id INTEGER PRIMARY KEY, service TEXT NOT NULL, value TEXT NOT NULL);"
+    "CREATE INDEX IF NOT EXISTS credentials_by_service ON credentials (service);"
+    "CREATE TABLE IF NOT EXISTS metadata (id INTEGER PRIMARY KEY CHECK (id = 0), text TEXT NOT NULL);";
+
+// Resets a prepared statement when it goes out of scope, so an exception never leaves one mid-step
+class StatementScope {
+public:
+    explicit StatementScope(sqlite3_stmt *statement) : statement(statement) {}
+    ~StatementScope() {
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+    }
+
+    StatementScope(const StatementScope &) = delete;
+    StatementScope &operator=(const StatementScope &) = delete;
+
+private:
+    sqlite3_stmt *statement;
+};
+
+// Rolls back unless committed
+class Transaction {
+public:
+    explicit Transaction(sqlite3 *database) : database(database) {
+        if (sqlite3_exec(database, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            throw std::ios_base::failure(std::string("SQLite: unable to start a transaction: ") + sqlite3_errmsg(database));
+        }
+    }
+    ~Transaction() {
+        if (!committed) {
+            sqlite3_exec(database, "ROLLBACK", nullptr, nullptr, nullptr);
+        }
+    }
+
+    void commit() {
+        if (sqlite3_exec(database, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            throw std::ios_base::failure(std::string("SQLite: unable to commit: ") + sqlite3_errmsg(database));
+        }
+        committed = true;
+    }
+
+    Transaction(const Transaction &) = delete;
+    Transaction &operator=(const Transaction &) = delete;
+
+private:
+    sqlite3 *database;
+    bool committed = false;
+};
+
+void bindText(sqlite3_stmt *statement, int index, const std::string &text) {
+    // The strings outlive the step, so SQLite need not copy them
+    sqlite3_bind_text(statement, index, text.data(), static_cast<int>(text.size()), SQLITE_STATIC);
+}
+
+std::string columnText(sqlite3_stmt *statement, int column) {
+    const unsigned char *text = sqlite3_column_text(statement, column);
+    return text != nullptr ? std::string(reinterpret_cast<const char *>(text), sqlite3_column_bytes(statement, column))
+                           : std::string();
+}
+
+} // namespace
+
+SqliteBackend::SqliteBackend(std::string databaseFile, Durability mode)
+    : path(std::move(databaseFile)), durability(mode) {}
+
+SqliteBackend::~SqliteBackend() noexcept {
+    for (sqlite3_stmt *statement : {insertRecord, updateRecord, deleteRecord, deleteService, selectService, selectAll,
+                                    selectMetadata, replaceMetadata}) {
+        sqlite3_finalize(statement);
+    }
+    if (database != nullptr && sqlite3_close(database) != SQLITE_OK) {
+        std::cerr << "Failed to close '" << path << "': " << sqlite3_errmsg(database) << std::endl;
+    }
+}
+
+void SqliteBackend::check(int status, const char *action) {
+    if (status == SQLITE_OK || status == SQLITE_ROW || status == SQLITE_DONE) {
+        return;
+    }
+    std::string message = std::string("SQLite: unable to ") + action + " '" + path + "': " +
+                          (database != nullptr ? sqlite3_errmsg(database) : sqlite3_errstr(status));
+    if (status == SQLITE_CORRUPT || status == SQLITE_NOTADB) {
+        throw std::invalid_argument(message);
+    }
+    throw std::ios_base::failure(message);
+}
+
+void SqliteBackend::execute(const char *sql) {
+    check(sqlite3_exec(open(), sql, nullptr, nullptr, nullptr), "update");
+}
+
+// Open the Database and Prepare Every Statement
+sqlite3 *SqliteBackend::open() {
+    if (database != nullptr) {
+        return database;
+    }
+    int status = sqlite3_open_v2(path.c_str(), &database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    if (status != SQLITE_OK) {
+        std::string message = database != nullptr ? sqlite3_errmsg(database) : sqlite3_errstr(status);
+        sqlite3_close(database);
+        database = nullptr;
+        throw std::ios_base::failure("SQLite: unable to open '" + path + "': " + message);
+    }
+    try {
+        execute("PRAGMA journal_mode = WAL");
+        setDurability(durability);
+        execute(schema);
+        struct {
+            sqlite3_stmt **statement;
+            const char *sql;
+        } statements[] = {
+            {&insertRecord, "INSERT INTO credentials (service, value) VALUES (?1, ?2)"},
+            {&updateRecord, "UPDATE credentials SET service = ?1, value = ?2 WHERE id = ?3"},
+            {&deleteRecord, "DELETE FROM credentials WHERE id = ?1"},
+            {&deleteService, "DELETE FROM credentials WHERE service = ?1"},
+            {&selectService, "SELECT service, value FROM credentials WHERE service = ?1 ORDER BY id"},
+            {&selectAll, "SELECT id, service, value FROM credentials ORDER BY id"},
+            {&selectMetadata, "SELECT text FROM metadata WHERE id = 0"},
+            {&replaceMetadata, "INSERT OR REPLACE INTO metadata (id, text) VALUES (0, ?1)"},
+        };
+        for (const auto &entry : statements) {
+            check(sqlite3_prepare_v3(database, entry.sql, -1, SQLITE_PREPARE_PERSISTENT, entry.statement, nullptr),
+                  "prepare a statement for");
+        }
+    } catch (...) {
+        for (const auto &statement : {&insertRecord, &updateRecord, &deleteRecord, &deleteService, &selectService,
+                                      &selectAll, &selectMetadata, &replaceMetadata}) {
+            sqlite3_finalize(*statement);
+            *statement = nullptr;
+        }
+        sqlite3_close(database);
+        database = nullptr;
+        throw;
+    }
+    return database;
+}
+
+// A vault exists once it has been stored; user_version marks that, since it may hold no records
+bool SqliteBackend::exists() const {
+    if (database == nullptr && !std::filesystem::exists(path)) {
+        return false;
+    }
+    sqlite3 *connection = const_cast<SqliteBackend *>(this)->open();
+    sqlite3_stmt *statement = nullptr;
+    int version = 0;
+    if (sqlite3_prepare_v2(connection, "PRAGMA user_version", -1, &statement, nullptr) == SQLITE_OK &&
+        sqlite3_step(statement) == SQLITE_ROW) {
+        version = sqlite3_column_int(statement, 0);
+    }
+    sqlite3_finalize(statement);
+    return version != 0;
+}
+
+// Load Every Record in Vault Order
+CredentialList SqliteBackend::load() {
+    if (!exists()) {
+        throw std::ios_base::failure("Unable to open '" + path + "' for reading.");
+    }
+    CredentialList loaded;
+    std::vector<int64_t> loadedRowids;
+    StatementScope scope(selectAll);
+    int status;
+    while ((status = sqlite3_step(selectAll)) == SQLITE_ROW) {
+        loadedRowids.push_back(sqlite3_column_int64(selectAll, 0));
+        loaded.emplace_back(columnText(selectAll, 1), columnText(selectAll, 2));
+    }
+    check(status, "read");
+    rowids = std::move(loadedRowids);
+    positionsKnown = true;
+    return loaded;
+}
+
+int64_t SqliteBackend::insert(const std::pair<std::string, std::string> &entry) {
+    StatementScope scope(insertRecord);
+    bindText(insertRecord, 1, entry.first);
+    bindText(insertRecord, 2, entry.second);
+    check(sqlite3_step(insertRecord), "insert into");
+    return sqlite3_last_insert_rowid(database);
+}
+
+// Replace Every Record in One Transaction
+void SqliteBackend::replaceAll(const CredentialList &credentials) {
+    open();
+    positionsKnown = false;
+    std::vector<int64_t> storedRowids;
+    storedRowids.reserve(credentials.size());
+    Transaction transaction(database);
+    execute("DELETE FROM credentials");
+    for (const auto &entry : credentials) {
+        storedRowids.push_back(insert(entry));
+    }
+    execute("PRAGMA user_version = 1");
+    transaction.commit();
+    rowids = std::move(storedRowids);
+    positionsKnown = true;
+}
+
+// Single-record changes run as one statement each (SQLite wraps it in a transaction of its own)
+void SqliteBackend::appended(const CredentialList &credentials) {
+    if (!positionsKnown || credentials.size() != rowids.size() + 1) {
+        replaceAll(credentials);
+        return;
+    }
+    rowids.push_back(insert(credentials[credentials.size() - 1]));
+}
+
+void SqliteBackend::updated(const CredentialList &credentials, size_t position) {
+    if (!positionsKnown || credentials.size() != rowids.size()) {
+        replaceAll(credentials);
+        return;
+    }
+    const auto &entry = credentials[position];
+    StatementScope scope(updateRecord);
+    bindText(updateRecord, 1, entry.first);
+    bindText(updateRecord, 2, entry.second);
+    sqlite3_bind_int64(updateRecord, 3, rowids[position]);
+    check(sqlite3_step(updateRecord), "update");
+}
+
+void SqliteBackend::erased(const CredentialList &credentials, size_t position) {
+    if (!positionsKnown || credentials.size() + 1 != rowids.size()) {
+        replaceAll(credentials);
+        return;
+    }
+    StatementScope scope(deleteRecord);
+    sqlite3_bind_int64(deleteRecord, 1, rowids[position]);
+    check(sqlite3_step(deleteRecord), "delete from");
+    rowids.erase(rowids.begin() + static_cast<std::ptrdiff_t>(position));
+}
+
+void SqliteBackend::erasedService(const CredentialList &credentials, const std::string &service) {
+    if (!positionsKnown) {
+        replaceAll(credentials);
+        return;
+    }
+    {
+        StatementScope scope(deleteService);
+        bindText(deleteService, 1, service);
+        check(sqlite3_step(deleteService), "delete from");
+    }
+    readRowids();
+    if (rowids.size() != credentials.size()) {
+        replaceAll(credentials); // The table held records the list did not
+    }
+}
+
+void SqliteBackend::readRowids() {
+    positionsKnown = false;
+    std::vector<int64_t> storedRowids;
+    sqlite3_stmt *statement = nullptr;
+    check(sqlite3_prepare_v2(open(), "SELECT id FROM credentials ORDER BY id", -1, &statement, nullptr), "read");
+    int status;
+    while ((status = sqlite3_step(statement)) == SQLITE_ROW) {
+        storedRowids.push_back(sqlite3_column_int64(statement, 0));
+    }
+    sqlite3_finalize(statement);
+    check(status, "read");
+    rowids = std::move(storedRowids);
+    positionsKnown = true;
+}
+
+// Look Up One Service Through Its Index
+std::vector<std::pair<std::string, std::string>> SqliteBackend::findService(const std::string &service) {
+    std::vector<std::pair<std::string, std::string>> found;
+    if (!exists()) {
+        return found;
+    }
+    StatementScope scope(selectService);
+    bindText(selectService, 1, service);
+    int status;
+    while ((status = sqlite3_step(selectService)) == SQLITE_ROW) {
+        found.emplace_back(columnText(selectService, 0), columnText(selectService, 1));
+    }
+    check(status, "read");
+    return found;
+}
+
+std::optional<std::string> SqliteBackend::loadMetadata() {
+    if (database == nullptr && !std::filesystem::exists(path)) {
+        return std::nullopt;
+    }
+    open();
+    StatementScope scope(selectMetadata);
+    int status = sqlite3_step(selectMetadata);
+    check(status, "read");
+    return status == SQLITE_ROW ? std::optional<std::string>(columnText(selectMetadata, 0)) : std::nullopt;
+}
+
+void SqliteBackend::saveMetadata(const std::string &text) {
+    open();
+    StatementScope scope(replaceMetadata);
+    bindText(replaceMetadata, 1, text);
+    check(sqlite3_step(replaceMetadata), "update");
+}
+
+// Choose How Commits Reach the Disk
+void SqliteBackend::setDurability(Durability mode) {
+    durability = mode;
+    if (database != nullptr) {
+        execute(mode == Durability::Sync ? "PRAGMA synchronous = FULL" : "PRAGMA synchronous = NORMAL");
+    }
+}
+
+// In WAL mode with synchronous = NORMAL, commits become durable when the log is checkpointed
+void SqliteBackend::flush() {
+    if (database != nullptr && durability == Durability::GroupCommit) {
+        check(sqlite3_wal_checkpoint_v2(database, nullptr, SQLITE_CHECKPOINT_FULL, nullptr, nullptr), "checkpoint");
+    }
+}
+
+} // namespace PasswordNS
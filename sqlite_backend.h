@@ -0,0 +1,75 @@
+#ifndef SQLITE_BACKEND_H
+#define SQLITE_BACKEND_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "storage_backend.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace PasswordNS
+{
+
+    // Embedded SQLite engine, built when CMake finds SQLite (PASSWORD_MANAGER_WITH_SQLITE).
+    // Records live in a credentials table keyed by rowid, in vault order, with an index on the
+    // service; the metadata text is one row of its own. The database runs in WAL mode, so a
+    // change is one short append to the log rather than a rewrite, and every statement is
+    // prepared once when the database is opened.
+    //
+    // Durability maps onto synchronous: Atomic and GroupCommit use NORMAL (commits survive a
+    // crash of the process; flush() checkpoints the log in GroupCommit mode), Sync uses FULL.
+    class SqliteBackend : public StorageBackend
+    {
+    private:
+        std::string path;
+        Durability durability;
+        sqlite3 *database = nullptr; // Opened on first use, so probing a missing vault creates nothing
+        sqlite3_stmt *insertRecord = nullptr;
+        sqlite3_stmt *updateRecord = nullptr;
+        sqlite3_stmt *deleteRecord = nullptr;
+        sqlite3_stmt *deleteService = nullptr;
+        sqlite3_stmt *selectService = nullptr;
+        sqlite3_stmt *selectAll = nullptr;
+        sqlite3_stmt *selectMetadata = nullptr;
+        sqlite3_stmt *replaceMetadata = nullptr;
+
+        // Rowid of each position of the list last loaded or stored; edits fall back to
+        // replaceAll() until it is known
+        std::vector<int64_t> rowids;
+        bool positionsKnown = false;
+
+        sqlite3 *open();
+        void execute(const char *sql);
+        void check(int status, const char *action);
+        int64_t insert(const std::pair<std::string, std::string> &entry);
+        void readRowids();
+
+    public:
+        explicit SqliteBackend(std::string databaseFile, Durability mode = Durability::Atomic);
+        ~SqliteBackend() noexcept override;
+
+        SqliteBackend(const SqliteBackend &) = delete;
+        SqliteBackend &operator=(const SqliteBackend &) = delete;
+
+        const char *engine() const override { return "sqlite"; }
+        bool exists() const override;
+        CredentialList load() override;
+        void replaceAll(const CredentialList &credentials) override;
+        void appended(const CredentialList &credentials) override;
+        void updated(const CredentialList &credentials, size_t position) override;
+        void erased(const CredentialList &credentials, size_t position) override;
+        void erasedService(const CredentialList &credentials, const std::string &service) override;
+        std::vector<std::pair<std::string, std::string>> findService(const std::string &service) override;
+        std::optional<std::string> loadMetadata() override;
+        void saveMetadata(const std::string &text) override;
+        void setDurability(Durability mode) override;
+        void flush() override;
+
+        const std::string &getDatabaseFile() const { return path; }
+    };
+
+} // namespace PasswordNS
+
+#endif
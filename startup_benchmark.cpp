@@ -0,0 +1,153 @@
+// startup_benchmark.cpp
+// Measures login time (credential check, vault load, first page of the list view)
+// for vaults of increasing size, with a cold and a warm page cache.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include "batch_io.h"
+#include "manager.h"
+#include "trace.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+const std::string benchUser = "bench_user";
+const std::string benchPassword = "bench_password";
+
+struct LoginTiming {
+    double verifyMs = 0.0;
+    double loadMs = 0.0;
+    double firstPageMs = 0.0;
+
+    double totalMs() const { return verifyMs + loadMs + firstPageMs; }
+};
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Best effort: flush the file and ask the kernel to drop its cached pages
+void evictFromPageCache(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    ::fdatasync(fd);
+#ifdef POSIX_FADV_DONTNEED
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    ::close(fd);
+}
+
+// user_credentials.csv with the benchmark user in the middle
+void writeUserDatabase(size_t users) {
+    std::ofstream file("user_credentials.csv", std::ios::trunc);
+    for (size_t i = 0; i < users; ++i) {
+        if (i == users / 2) {
+            file << benchUser << "," << benchPassword << "\n";
+        }
+        file << "user" << i << ",password" << i << "\n";
+    }
+}
+
+// Builds a vault of the requested size through the batch importer
+void writeVault(const PasswordManager &manager, size_t entries) {
+    {
+        std::ofstream plain("bench_entries.csv", std::ios::trunc);
+        for (size_t i = 0; i < entries; ++i) {
+            plain << "service" << i << ",user" << i << ",Passw0rd-" << i << "\n";
+        }
+    }
+
+    std::ifstream input("bench_entries.csv");
+    std::ofstream vault(manager.getVaultFileName(), std::ios::trunc);
+    BatchOptions options;
+    options.progressInterval = 0;
+    importCredentials(manager, input, vault, options);
+    std::filesystem::remove("bench_entries.csv");
+}
+
+LoginTiming login(PasswordManager &manager) {
+    LoginTiming timing;
+    manager.setTestCredentials(benchUser, benchPassword);
+
+    auto start = std::chrono::steady_clock::now();
+    manager.restoreUserCredentials();
+    if (!manager.loadUserCredentialsFromFile()) {
+        throw std::runtime_error("Benchmark user was not found in user_credentials.csv.");
+    }
+    timing.verifyMs = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    manager.loadCredentialsFromFile();
+    timing.loadMs = millisecondsSince(start);
+
+    // What the list view decrypts for its first screen
+    start = std::chrono::steady_clock::now();
+    manager.getDecryptedCredentials(0, 64);
+    timing.firstPageMs = millisecondsSince(start);
+    return timing;
+}
+
+void printTiming(const std::string &label, size_t entries, const LoginTiming &timing) {
+    std::cout << std::left << std::setw(10) << entries << std::setw(8) << label << std::right << std::fixed
+              << std::setprecision(3) << std::setw(12) << timing.verifyMs << std::setw(12) << timing.loadMs
+              << std::setw(12) << timing.firstPageMs << std::setw(12) << timing.totalMs() << "\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t maxEntries = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    size_t users = argc > 2 ? std::stoull(argv[2]) : 10000;
+    const int warmRuns = 5;
+
+    // Set PASSWORD_MANAGER_TRACE=startup_benchmark.json to also get a Chrome trace of every login
+    TraceNS::startFromEnvironment();
+
+    // Work in a scratch directory so the benchmark never touches real vaults
+    auto originalDirectory = std::filesystem::current_path();
+    auto workDirectory = std::filesystem::temp_directory_path() / "password_manager_startup_benchmark";
+    std::filesystem::create_directories(workDirectory);
+    std::filesystem::current_path(workDirectory);
+
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setUsername(benchUser);
+    writeUserDatabase(users);
+
+    std::cout << "Login time in ms (" << users << " registered users, median of " << warmRuns << " warm runs)\n";
+    std::cout << std::left << std::setw(10) << "Entries" << std::setw(8) << "Cache" << std::right << std::setw(12)
+              << "Verify" << std::setw(12) << "Load" << std::setw(12) << "FirstPage" << std::setw(12) << "Total" << "\n";
+
+    for (size_t entries = 1000; entries <= maxEntries; entries *= 10) {
+        writeVault(manager, entries);
+
+        evictFromPageCache("user_credentials.csv");
+        evictFromPageCache(manager.getVaultFileName());
+        printTiming("cold", entries, login(manager));
+
+        std::vector<LoginTiming> warm;
+        for (int run = 0; run < warmRuns; ++run) {
+            warm.push_back(login(manager));
+        }
+        std::sort(warm.begin(), warm.end(),
+                  [](const LoginTiming &a, const LoginTiming &b) { return a.totalMs() < b.totalMs(); });
+        printTiming("warm", entries, warm[warm.size() / 2]);
+    }
+
+    std::filesystem::remove(manager.getVaultFileName());
+    std::filesystem::remove("user_credentials.csv");
+    std::filesystem::current_path(originalDirectory);
+    TraceNS::stop();
+    return 0;
+}
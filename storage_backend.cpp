@@ -0,0 +1,266 @@
+#include "storage_backend.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include "manager.h"
+#include "record_schema.h"
+#ifdef PASSWORD_MANAGER_HAVE_SQLITE
+#include "sqlite_backend.h"
+#endif
+
+namespace PasswordNS {
+
+namespace {
+
+std::string serializeVault(const CredentialList &credentials) {
+    return vaultText(credentials);
+}
+
+} // namespace
+
+FlatFileBackend::FlatFileBackend(std::string vaultFile, std::string journalFile, std::string metadataFile,
+                                 Durability mode)
+    : vaultPath(std::move(vaultFile)), journalPath(std::move(journalFile)), metadataPath(std::move(metadataFile)),
+      durability(mode) {}
+
+FlatFileBackend::~FlatFileBackend() noexcept {
+    try {
+        flush();
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to save '" << vaultPath << "': " << e.what() << std::endl;
+    }
+}
+
+bool FlatFileBackend::exists() const {
+    return committer != nullptr || std::filesystem::exists(vaultPath);
+}
+
+// Read the Vault File
+CredentialList FlatFileBackend::load() {
+    flush();
+    std::ifstream file(vaultPath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::ios_base::failure("Unable to open '" + vaultPath + "' for reading.");
+    }
+    return loadContents(std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()));
+}
+
+// Parse the Vault File and Replay Its Journal
+CredentialList FlatFileBackend::loadContents(const std::string &contents) {
+    flush();
+
+    // One record per line; a malformed line is reported rather than pairing words across lines
+    CredentialList loaded;
+    std::pair<std::string, std::string> record;
+    std::string_view text(contents);
+    VaultLineView view;
+    size_t lineNumber = 0;
+    for (size_t lineStart = 0; lineStart < text.size();) {
+        size_t lineEnd = std::min(text.find('\n', lineStart), text.size());
+        std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        ++lineNumber;
+        if (line.empty()) {
+            continue;
+        }
+        if (!VaultLineSchema::decodeText(line, view)) {
+            throw std::invalid_argument("Malformed record on line " + std::to_string(lineNumber) + " of '" +
+                                        vaultPath + "'.");
+        }
+        loaded.emplace_back(std::string(view.service), std::string(view.account));
+    }
+
+    // Replay the edits made since the vault was last written in full
+    uint64_t fingerprint = vaultFingerprint(contents);
+    size_t editBytes = 0;
+    std::vector<JournalEdit> edits = readJournal(journalPath, fingerprint);
+    for (const auto &edit : edits) {
+        if (edit.position >= loaded.size()) {
+            throw std::invalid_argument("Journal edit past the end of '" + vaultPath + "'.");
+        }
+        if (edit.kind == JournalEdit::Kind::Erase) {
+            loaded.erase(edit.position);
+        } else if (PasswordManager::parseVaultRecord(edit.record, record)) {
+            loaded.set(edit.position, std::move(record));
+        } else {
+            throw std::invalid_argument("Malformed journal record for '" + vaultPath + "'.");
+        }
+        editBytes += edit.record.size() + 32; // Close enough for the compaction threshold
+    }
+    // A journal with no edits is missing or left from an older vault. Reading must not delete
+    // it: another writer may have just replaced the vault and started a journal for it. It goes
+    // once this engine writes the vault itself.
+    journalLeftover = edits.empty() && std::filesystem::exists(journalPath);
+    vaultKnown = true;
+    baseFingerprint = fingerprint;
+    vaultBytes = contents.size();
+    journalOpen = !edits.empty();
+    journalBytes = editBytes;
+    return loaded;
+}
+
+// Rewrite the Vault File
+void FlatFileBackend::replaceAll(const CredentialList &credentials) {
+    std::string contents = serializeVault(credentials);
+
+    // The journal now describes an older vault; it can go once the new vault is on disk
+    vaultKnown = true;
+    baseFingerprint = vaultFingerprint(contents);
+    vaultBytes = contents.size();
+    journalStale = journalStale || journalOpen || journalLeftover;
+    journalOpen = false;
+    journalLeftover = false;
+
+    // The vault is replaced through a temp file, so a crash never leaves it half written
+    if (durability != Durability::GroupCommit) {
+        writeFileAtomically(vaultPath, contents, durability == Durability::Sync);
+        if (journalStale) {
+            std::remove(journalPath.c_str());
+            journalStale = false;
+        }
+        return;
+    }
+
+    if (!committer) {
+        committer = std::make_unique<GroupCommitter>(vaultPath);
+    }
+    committer->submit(std::move(contents));
+}
+
+void FlatFileBackend::updated(const CredentialList &credentials, size_t position) {
+    const auto &entry = credentials[position];
+    appendToJournal(credentials, {JournalEdit::Kind::Set, position, entry.first + " " + entry.second});
+}
+
+void FlatFileBackend::erased(const CredentialList &credentials, size_t position) {
+    appendToJournal(credentials, {JournalEdit::Kind::Erase, position, std::string()});
+}
+
+// Record One Edit Without Rewriting the Vault
+void FlatFileBackend::appendToJournal(const CredentialList &credentials, const JournalEdit &edit) {
+    // Edits only make sense against a vault file this engine knows the contents of
+    if (!vaultKnown) {
+        replaceAll(credentials);
+        return;
+    }
+    if (!journalOpen) {
+        // A journal must not reach the disk before the vault version it applies to
+        flush();
+        journalBytes = 0;
+    }
+    journalBytes += appendJournal(journalPath, baseFingerprint, edit, !journalOpen, durability != Durability::Atomic);
+    journalOpen = true;
+
+    // Replaying a long journal on every load would cost more than the rewrites it saved
+    if (journalBytes > std::max<size_t>(vaultBytes / 2, 64 * 1024)) {
+        compact(credentials);
+    }
+}
+
+// The file engine has no index: a lookup reads the whole vault
+std::vector<std::pair<std::string, std::string>> FlatFileBackend::findService(const std::string &service) {
+    std::vector<std::pair<std::string, std::string>> found;
+    for (const auto &entry : load()) {
+        if (entry.first == service) {
+            found.push_back(entry);
+        }
+    }
+    return found;
+}
+
+// Metadata is optional: vaults written before it existed have no sidecar file
+std::optional<std::string> FlatFileBackend::loadMetadata() {
+    std::ifstream metadataFile(metadataPath, std::ios::binary);
+    if (!metadataFile.is_open()) {
+        return std::nullopt;
+    }
+    std::ostringstream text;
+    text << metadataFile.rdbuf();
+    return text.str();
+}
+
+void FlatFileBackend::saveMetadata(const std::string &text) {
+    if (!text.empty() || std::filesystem::exists(metadataPath)) {
+        writeFileAtomically(metadataPath, text, durability != Durability::Atomic);
+    }
+}
+
+// Choose How Saves Reach the Disk
+void FlatFileBackend::setDurability(Durability mode) {
+    if (mode != Durability::GroupCommit) {
+        flush();
+        committer.reset();
+    }
+    durability = mode;
+}
+
+// Wait for Pending Saves
+void FlatFileBackend::flush() {
+    if (committer) {
+        committer->flush();
+    }
+    if (journalStale) {
+        std::remove(journalPath.c_str());
+        journalStale = false;
+    }
+}
+
+// Fold the Journal into the Vault
+void FlatFileBackend::compact(const CredentialList &credentials) {
+    if (journalOpen) {
+        replaceAll(credentials);
+    }
+    flush();
+}
+
+CredentialList MemoryBackend::load() {
+    if (!stored) {
+        throw std::ios_base::failure("Nothing has been stored in the memory engine.");
+    }
+    return *stored;
+}
+
+std::vector<std::pair<std::string, std::string>> MemoryBackend::findService(const std::string &service) {
+    std::vector<std::pair<std::string, std::string>> found;
+    if (stored) {
+        for (const auto &entry : *stored) {
+            if (entry.first == service) {
+                found.push_back(entry);
+            }
+        }
+    }
+    return found;
+}
+
+std::vector<std::string> storageEngines() {
+    std::vector<std::string> engines = {"file", "memory"};
+#ifdef PASSWORD_MANAGER_HAVE_SQLITE
+    engines.push_back("sqlite");
+#endif
+    return engines;
+}
+
+// Create a Storage Engine by Name
+std::shared_ptr<StorageBackend> makeStorageBackend(const std::string &engine, const std::string &base,
+                                                   Durability mode) {
+    if (engine == "file") {
+        return std::make_shared<FlatFileBackend>(base + "_passwords.dat", base + "_passwords.journal",
+                                                 base + "_metadata.dat", mode);
+    }
+    if (engine == "memory") {
+        return std::make_shared<MemoryBackend>();
+    }
+#ifdef PASSWORD_MANAGER_HAVE_SQLITE
+    if (engine == "sqlite") {
+        return std::make_shared<SqliteBackend>(base + "_passwords.sqlite", mode);
+    }
+#endif
+    throw std::invalid_argument("Unknown or unavailable storage engine: " + engine);
+}
+
+} // namespace PasswordNS
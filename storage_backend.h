@@ -0,0 +1,130 @@
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "durable_file.h"
+#include "persistent_vector.h"
+#include "vault_journal.h"
+
+namespace PasswordNS
+{
+
+    // Stored credentials as (service, "username:hex password"); copies share storage
+    using CredentialList = PersistentVector<std::pair<std::string, std::string>>;
+
+    // Where a manager keeps its vault and metadata. The manager holds the entries in memory and
+    // tells the engine about every change; after a change the engine gets the whole list as it
+    // now is, so an engine that cannot apply one record at a time can just store the list again.
+    // Engines throw std::ios_base::failure when storage fails and std::invalid_argument when what
+    // they read back is malformed. An engine belongs to one manager and is not thread-safe.
+    class StorageBackend
+    {
+    public:
+        virtual ~StorageBackend() noexcept = default;
+
+        virtual const char *engine() const = 0; // "file", "memory" or "sqlite"
+        virtual bool exists() const = 0;         // Something has been stored
+        virtual CredentialList load() = 0;       // Throws std::ios_base::failure when nothing has been stored
+        virtual void replaceAll(const CredentialList &credentials) = 0;
+
+        // One change; credentials is the list after it
+        virtual void appended(const CredentialList &credentials) { replaceAll(credentials); }
+        virtual void updated(const CredentialList &credentials, size_t /*position*/) { replaceAll(credentials); }
+        virtual void erased(const CredentialList &credentials, size_t /*position*/) { replaceAll(credentials); }
+        virtual void erasedService(const CredentialList &credentials, const std::string & /*service*/) { replaceAll(credentials); }
+
+        // Records of one service, read from storage rather than from a loaded list
+        virtual std::vector<std::pair<std::string, std::string>> findService(const std::string &service) = 0;
+
+        // The metadata sidecar text (credential_index.h); none when it was never saved
+        virtual std::optional<std::string> loadMetadata() = 0;
+        virtual void saveMetadata(const std::string &text) = 0;
+
+        virtual void setDurability(Durability /*mode*/) {}
+        virtual void flush() {} // Blocks until every change so far is durable under the durability mode
+        // Folds changes recorded apart from the main store back into it; credentials is the current list
+        virtual void compact(const CredentialList & /*credentials*/) { flush(); }
+        // The vault file, for tools that work on it directly (re-key, sync); empty for other engines
+        virtual std::string vaultFile() const { return std::string(); }
+    };
+
+    // The original engine: "service username:hex" lines in <base>_passwords.dat, replaced as a
+    // whole through writeFileAtomically or a GroupCommitter; in-place updates and erasures append
+    // to <base>_passwords.journal (vault_journal.h); metadata in <base>_metadata.dat.
+    class FlatFileBackend : public StorageBackend
+    {
+    private:
+        std::string vaultPath;
+        std::string journalPath;
+        std::string metadataPath;
+        Durability durability;
+        std::unique_ptr<GroupCommitter> committer; // Created on the first save in GroupCommit mode
+
+        // The vault file as last written in full, and the journal of edits made since
+        bool vaultKnown = false; // Set once this engine has read or written the vault
+        uint64_t baseFingerprint = 0;
+        size_t vaultBytes = 0;
+        bool journalOpen = false;     // The journal file holds edits for baseFingerprint
+        bool journalStale = false;    // It holds edits for an older vault, to delete once the new one is durable
+        bool journalLeftover = false; // The last load found a journal for another vault, to delete on the next write
+        size_t journalBytes = 0;
+
+        void appendToJournal(const CredentialList &credentials, const JournalEdit &edit);
+
+    public:
+        FlatFileBackend(std::string vaultFile, std::string journalFile, std::string metadataFile,
+                        Durability mode = Durability::Atomic);
+        ~FlatFileBackend() noexcept override;
+
+        const char *engine() const override { return "file"; }
+        bool exists() const override;
+        CredentialList load() override;
+        // load() with the vault file already read, e.g. by a batch of AsyncFileIO reads (async_io.h)
+        CredentialList loadContents(const std::string &contents);
+        void replaceAll(const CredentialList &credentials) override;
+        void updated(const CredentialList &credentials, size_t position) override;
+        void erased(const CredentialList &credentials, size_t position) override;
+        std::vector<std::pair<std::string, std::string>> findService(const std::string &service) override;
+        std::optional<std::string> loadMetadata() override;
+        void saveMetadata(const std::string &text) override;
+        void setDurability(Durability mode) override;
+        void flush() override;
+        void compact(const CredentialList &credentials) override;
+        std::string vaultFile() const override { return vaultPath; }
+    };
+
+    // Keeps everything in memory, for tests and benchmarks that should not touch the disk.
+    // Copies of a list share their entries, so storing one is O(1).
+    class MemoryBackend : public StorageBackend
+    {
+    private:
+        std::optional<CredentialList> stored;
+        std::optional<std::string> metadata;
+
+    public:
+        const char *engine() const override { return "memory"; }
+        bool exists() const override { return stored.has_value(); }
+        CredentialList load() override;
+        void replaceAll(const CredentialList &credentials) override { stored = credentials; }
+        std::vector<std::pair<std::string, std::string>> findService(const std::string &service) override;
+        std::optional<std::string> loadMetadata() override { return metadata; }
+        void saveMetadata(const std::string &text) override { metadata = text; }
+    };
+
+    // Engines this build can create; "sqlite" only when it was built with SQLite (sqlite_backend.h)
+    std::vector<std::string> storageEngines();
+
+    // Creates an engine for the vault named by base (<vault directory>/<user>). Throws
+    // std::invalid_argument for an unknown engine or one this build does not have.
+    std::shared_ptr<StorageBackend> makeStorageBackend(const std::string &engine, const std::string &base,
+                                                       Durability mode = Durability::Atomic);
+
+} // namespace PasswordNS
+
+#endif
@@ -0,0 +1,103 @@
+// storage_benchmark.cpp
+// Compares the storage engines (storage_backend.h) on one vault: storing it in bulk,
+// adding, updating and deleting single entries, looking up a service straight from
+// storage, and loading it back. Every engine gets the same pre-encrypted entries.
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "manager.h"
+#include "storage_backend.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+const std::string benchUser = "storage_bench_user";
+
+// Average microseconds per call, stopping early once the budget is spent (the file engine
+// rewrites or rereads the whole vault for some of these)
+double averageMicroseconds(size_t count, const std::function<void(size_t)> &operation, double budgetSeconds = 3.0) {
+    auto start = std::chrono::steady_clock::now();
+    size_t done = 0;
+    while (done < count) {
+        operation(done++);
+        if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > budgetSeconds) {
+            break;
+        }
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / done;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t entries = argc > 1 ? std::stoull(argv[1]) : 100000;
+    const size_t singles = 1000;
+
+    // Work in a scratch directory so the benchmark never touches real vaults
+    auto originalDirectory = std::filesystem::current_path();
+    auto workDirectory = std::filesystem::temp_directory_path() / "password_manager_storage_benchmark";
+    std::filesystem::remove_all(workDirectory);
+    std::filesystem::create_directories(workDirectory);
+    std::filesystem::current_path(workDirectory);
+
+    CredentialList vault;
+    std::string encrypted = PasswordManager::encryptToHex("Passw0rd-benchmark", PasswordManager::getDefaultEncryptionKey());
+    for (size_t i = 0; i < entries; ++i) {
+        vault.emplace_back("service" + std::to_string(i), "user" + std::to_string(i) + ":" + encrypted);
+    }
+    std::cout << "Storage engines on a " << entries << "-entry vault (microseconds per operation)\n";
+    std::cout << std::left << std::setw(8) << "engine" << std::right << std::setw(12) << "store all" << std::setw(12)
+              << "add" << std::setw(12) << "update" << std::setw(12) << "delete" << std::setw(12) << "lookup"
+              << std::setw(12) << "load" << "\n";
+
+    bool consistent = true;
+    for (const std::string &engine : storageEngines()) {
+        std::shared_ptr<StorageBackend> backend = makeStorageBackend(engine, benchUser);
+        PasswordManager manager;
+        manager.setCompressOnExit(false);
+        manager.setUsername(benchUser);
+        manager.setStorageBackend(backend);
+
+        // addNewPassword reports every entry it adds; keep that out of the timings
+        std::streambuf *console = std::cout.rdbuf(nullptr);
+        double store = averageMicroseconds(1, [&](size_t) { manager.restoreCredentialList(vault); });
+        double add = averageMicroseconds(singles, [&](size_t i) {
+            manager.addNewPassword("added" + std::to_string(i), "user", "Added-Passw0rd-" + std::to_string(i));
+        });
+        double update = averageMicroseconds(singles, [&](size_t i) {
+            std::vector<EntryId> ids = manager.findEntries("service" + std::to_string((i * 7919 + 1) % entries));
+            if (!ids.empty()) {
+                manager.updatePassword(ids.front(), "Updated-Passw0rd-" + std::to_string(i));
+            }
+        });
+        double erase = averageMicroseconds(singles, [&](size_t i) {
+            std::vector<EntryId> ids = manager.findEntries("service" + std::to_string(entries - 1 - i));
+            if (!ids.empty()) {
+                manager.deleteEntry(ids.front());
+            }
+        });
+        manager.flushCredentials();
+        double lookup = averageMicroseconds(singles, [&](size_t i) {
+            std::string service = "service" + std::to_string(i * 7919 % std::max<size_t>(1, entries / 2));
+            consistent = consistent && backend->findService(service).size() == 1;
+        });
+        size_t expected = manager.getPasswordCount();
+        double load = averageMicroseconds(5, [&](size_t) { manager.loadCredentialsFromFile(); });
+        std::cout.rdbuf(console);
+        consistent = consistent && manager.getPasswordCount() == expected;
+
+        std::cout << std::left << std::setw(8) << engine << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << store << std::setw(12) << add << std::setw(12) << update << std::setw(12)
+                  << erase << std::setw(12) << lookup << std::setw(12) << load << "\n";
+    }
+
+    std::filesystem::current_path(originalDirectory);
+    std::filesystem::remove_all(workDirectory);
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+// sync_benchmark.cpp
+// Measures how many bytes an incremental chunk sync moves after single-entry
+// changes to a large vault, compared to copying the whole file.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <filesystem>
+#include "batch_io.h"
+#include "chunk_sync.h"
+#include "manager.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+const std::string benchUser = "sync_bench_user";
+
+// Builds a vault of the requested size through the batch importer
+void writeVault(const PasswordManager &manager, size_t entries) {
+    {
+        std::ofstream plain("bench_entries.csv", std::ios::trunc);
+        for (size_t i = 0; i < entries; ++i) {
+            plain << "service" << i << ",user" << i << ",Passw0rd-" << i << "\n";
+        }
+    }
+
+    std::ifstream input("bench_entries.csv");
+    std::ofstream vault(manager.getVaultFileName(), std::ios::trunc);
+    BatchOptions options;
+    options.progressInterval = 0;
+    importCredentials(manager, input, vault, options);
+    std::filesystem::remove("bench_entries.csv");
+}
+
+void printStats(const std::string &label, const SyncStats &stats) {
+    std::cout << std::left << std::setw(28) << label << std::right << std::setw(14) << stats.totalBytes
+              << std::setw(10) << stats.chunksTransferred << "/" << std::left << std::setw(8) << stats.chunks
+              << std::right << std::setw(14) << stats.bytesTransferred << std::setw(12) << std::fixed
+              << std::setprecision(3) << stats.seconds * 1e3 << "\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t entries = argc > 1 ? std::stoull(argv[1]) : 1000000;
+
+    // Work in a scratch directory so the benchmark never touches real vaults
+    auto originalDirectory = std::filesystem::current_path();
+    auto workDirectory = std::filesystem::temp_directory_path() / "password_manager_sync_benchmark";
+    std::filesystem::remove_all(workDirectory);
+    std::filesystem::create_directories(workDirectory);
+    std::filesystem::current_path(workDirectory);
+
+    // Discard the manager's console chatter while the vault is edited
+    std::streambuf *console = std::cout.rdbuf();
+    std::ofstream devNull("/dev/null");
+    std::cout.rdbuf(devNull.rdbuf());
+
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setUsername(benchUser);
+    writeVault(manager, entries);
+    manager.loadCredentialsFromFile();
+
+    ChunkStore remote("remote");
+    std::cout.rdbuf(console);
+    std::cout << "Chunk sync of a " << entries << "-entry vault (a full copy moves the whole vault size)\n";
+    std::cout << std::left << std::setw(28) << "Change" << std::right << std::setw(14) << "VaultBytes" << std::setw(19)
+              << "Chunks sent" << std::setw(14) << "BytesSent" << std::setw(12) << "Ms" << "\n";
+    printStats("initial push", pushVault(manager.getVaultFileName(), remote, benchUser));
+
+    std::cout.rdbuf(devNull.rdbuf());
+    manager.addNewPassword("added-service", "added-user", "AddedPassw0rd");
+    std::cout.rdbuf(console);
+    printStats("add one entry (end)", pushVault(manager.getVaultFileName(), remote, benchUser));
+
+    std::cout.rdbuf(devNull.rdbuf());
+    manager.deletePassword("service" + std::to_string(entries / 2));
+    std::cout.rdbuf(console);
+    printStats("delete one entry (middle)", pushVault(manager.getVaultFileName(), remote, benchUser));
+
+    // A second machine that holds the original vault pulls the latest version
+    std::filesystem::create_directories("replica");
+    std::string replica = "replica/" + benchUser + "_passwords.dat";
+    pullVault(remote, benchUser, replica);
+    std::cout.rdbuf(devNull.rdbuf());
+    manager.deletePassword("service" + std::to_string(entries / 3));
+    std::cout.rdbuf(console);
+    pushVault(manager.getVaultFileName(), remote, benchUser);
+    printStats("pull after one delete", pullVault(remote, benchUser, replica));
+
+    std::filesystem::current_path(originalDirectory);
+    std::filesystem::remove_all(workDirectory);
+    return 0;
+}
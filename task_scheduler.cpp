@@ -0,0 +1,264 @@
+#include "task_scheduler.h"
+#include <algorithm>
+#include <iostream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace PasswordNS {
+
+namespace {
+
+// Which scheduler's worker the current thread is, if any
+thread_local const TaskScheduler *currentScheduler = nullptr;
+thread_local size_t currentWorker = 0;
+
+void runTask(const std::function<void()> &task) {
+    try {
+        task();
+    } catch (const std::exception &e) {
+        // Tasks report their own errors (TaskGroup does); never let one take down a worker
+        std::cerr << "Unhandled exception in scheduled task: " << e.what() << std::endl;
+    }
+}
+
+} // namespace
+
+// Start the Workers, One Deque Each
+TaskScheduler::TaskScheduler(SchedulerOptions options) {
+    size_t count = std::max<size_t>(1, options.threads);
+    for (size_t i = 0; i < count; ++i) {
+        queues.push_back(std::make_unique<Worker>());
+    }
+    threads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads.emplace_back(&TaskScheduler::workerLoop, this, i);
+#if defined(__linux__)
+        if (options.pinThreads) {
+            // Best effort: a container may not let us choose cores
+            cpu_set_t cores;
+            CPU_ZERO(&cores);
+            CPU_SET(i % std::max(1u, std::thread::hardware_concurrency()), &cores);
+            pthread_setaffinity_np(threads.back().native_handle(), sizeof(cores), &cores);
+        }
+#endif
+    }
+}
+
+// Drain the Deques and Join the Workers
+TaskScheduler::~TaskScheduler() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+// Never destroyed: managers in static storage may still use it while the process exits
+TaskScheduler &TaskScheduler::shared() {
+    static TaskScheduler *scheduler = new TaskScheduler();
+    return *scheduler;
+}
+
+bool TaskScheduler::onWorkerThread() const {
+    return currentScheduler == this;
+}
+
+// Queue a Task, on the Spawning Worker's Own Deque When There Is One
+void TaskScheduler::spawn(std::function<void()> task) {
+    size_t index = onWorkerThread() ? currentWorker : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+
+    // Only wake a worker when one is asleep; a sleeping worker checks queued under sleepMutex
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        available.notify_one();
+    }
+}
+
+// Pop the Newest Own Task, or Steal the Oldest Task of Another Deque
+std::function<void()> TaskScheduler::take(size_t home) {
+    std::function<void()> task;
+    if (queued.load() == 0) {
+        return task;
+    }
+    bool owner = onWorkerThread() && home == currentWorker;
+    for (size_t offset = 0; offset < queues.size(); ++offset) {
+        Worker &queue = *queues[(home + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (offset == 0 && owner) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            stealCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        queued.fetch_sub(1);
+        break;
+    }
+    return task;
+}
+
+bool TaskScheduler::runOneTask() {
+    size_t home = onWorkerThread() ? currentWorker : nextQueue.load(std::memory_order_relaxed) % queues.size();
+    std::function<void()> task = take(home);
+    if (!task) {
+        return false;
+    }
+    runTask(task);
+    return true;
+}
+
+// Run Tasks Until the Scheduler Stops
+void TaskScheduler::workerLoop(size_t index) {
+    currentScheduler = this;
+    currentWorker = index;
+    while (true) {
+        std::function<void()> task = take(index);
+        if (task) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers.fetch_add(1);
+        available.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        sleepers.fetch_sub(1);
+        if (stopping && queued.load() == 0) {
+            return; // Stopping and nothing left to run
+        }
+    }
+}
+
+TaskGroup::~TaskGroup() noexcept {
+    try {
+        wait();
+    } catch (...) {
+        // Errors of a group nobody waited for have nowhere to go
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    state->pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->queued.push_back(std::move(task));
+    }
+    state->changed.notify_all();
+    try {
+        // The scheduler's task runs whichever of the group's tasks is oldest, unless the waiter got there first
+        scheduler.spawn([group = state]() { runQueued(group, false); });
+    } catch (...) {
+        // Still queued: the waiter runs it itself
+    }
+}
+
+bool TaskGroup::runQueued(const std::shared_ptr<State> &group, bool newest) {
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(group->mutex);
+        if (group->queued.empty()) {
+            return false;
+        }
+        if (newest) {
+            task = std::move(group->queued.back());
+            group->queued.pop_back();
+        } else {
+            task = std::move(group->queued.front());
+            group->queued.pop_front();
+        }
+    }
+
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(group->mutex);
+        if (!group->error) {
+            group->error = std::current_exception();
+        }
+    }
+    if (group->pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(group->mutex);
+        group->changed.notify_all();
+    }
+    return true;
+}
+
+void TaskGroup::wait() {
+    waitUntil(std::nullopt);
+}
+
+bool TaskGroup::waitFor(std::chrono::microseconds timeout) {
+    return waitUntil(std::chrono::steady_clock::now() + timeout);
+}
+
+// Help Run the Group's Own Tasks Until It Is Done
+bool TaskGroup::waitUntil(const std::optional<std::chrono::steady_clock::time_point> &deadline) {
+    while (state->pending.load() != 0) {
+        if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+            return false;
+        }
+        // Newest first, like a worker on its own deque: its data is the most likely to be in cache
+        if (runQueued(state, true)) {
+            continue;
+        }
+
+        // Our tasks are running elsewhere; they may still queue more for us (parallelFor does)
+        auto ready = [this]() { return state->pending.load() == 0 || !state->queued.empty(); };
+        std::unique_lock<std::mutex> lock(state->mutex);
+        if (deadline) {
+            state->changed.wait_until(lock, *deadline, ready);
+        } else {
+            state->changed.wait(lock, ready);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->error) {
+        std::exception_ptr failure = state->error;
+        state->error = nullptr;
+        std::rethrow_exception(failure);
+    }
+    return true;
+}
+
+// Split a Range in Halves Until the Pieces Reach the Grain
+void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)> &body,
+                 TaskScheduler &scheduler) {
+    grain = std::max<size_t>(1, grain);
+    if (end <= begin) {
+        return;
+    }
+    if (end - begin <= grain) {
+        body(begin, end);
+        return;
+    }
+
+    std::function<void(size_t, size_t)> split; // Outlives the group, which waits for its tasks
+    TaskGroup group(scheduler);
+    split = [&](size_t first, size_t last) {
+        while (last - first > grain) {
+            size_t middle = first + (last - first) / 2;
+            group.run([&split, middle, last]() { split(middle, last); });
+            last = middle;
+        }
+        body(first, last);
+    };
+    split(begin, end);
+    group.wait();
+}
+
+} // namespace PasswordNS
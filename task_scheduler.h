@@ -0,0 +1,122 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace PasswordNS
+{
+
+    struct SchedulerOptions
+    {
+        size_t threads = std::thread::hardware_concurrency(); // Workers (0 = 1)
+        bool pinThreads = false;                              // Pin worker i to core i (Linux only)
+    };
+
+    // Work-stealing scheduler for CPU-bound work: bulk decryption, compression and the like.
+    // Each worker owns a deque. A task spawned on a worker goes to the back of that worker's
+    // deque and is run from there (newest first, while its data is still in cache). An idle
+    // worker steals from the front of another worker's deque (the oldest task, usually the
+    // largest remaining piece). Tasks spawned from other threads are spread over the deques.
+    //
+    // Tasks must not block on I/O or on each other except through TaskGroup::wait(), which
+    // runs the group's queued tasks while it waits. Blocking I/O belongs on a WorkerPool or AsyncFileIO.
+    class TaskScheduler
+    {
+    private:
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<Worker>> queues;
+        std::vector<std::thread> threads;
+        std::atomic<size_t> queued{0};   // Tasks sitting in a deque
+        std::atomic<size_t> sleepers{0}; // Workers waiting for a task
+        std::atomic<size_t> nextQueue{0}; // Round robin for tasks from outside
+        std::atomic<size_t> stealCount{0};
+        std::mutex sleepMutex;
+        std::condition_variable available;
+        bool stopping = false;
+
+        void workerLoop(size_t index);
+        std::function<void()> take(size_t home); // Own deque first, then steal; empty when none
+
+    public:
+        explicit TaskScheduler(SchedulerOptions options = SchedulerOptions());
+        ~TaskScheduler() noexcept; // Runs the tasks still queued, then joins the workers
+
+        TaskScheduler(const TaskScheduler &) = delete;
+        TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+        // The scheduler shared by the whole process, created on first use with one worker per core
+        static TaskScheduler &shared();
+
+        void spawn(std::function<void()> task);
+
+        // Runs one queued task on the calling thread; false when there was none
+        bool runOneTask();
+
+        size_t size() const { return threads.size(); }
+        size_t steals() const { return stealCount.load(std::memory_order_relaxed); }
+        bool onWorkerThread() const; // Whether the caller is one of this scheduler's workers
+    };
+
+    // Tasks that are waited for together. wait() runs the group's own tasks that have not started
+    // yet on the calling thread, so groups may be nested inside tasks without tying up workers.
+    // It never runs another group's tasks, which could block the waiter for longer than it asked.
+    class TaskGroup
+    {
+    private:
+        // Shared with the tasks, so the last one can signal after the waiter has already returned
+        struct State
+        {
+            std::atomic<size_t> pending{0};
+            std::mutex mutex;
+            std::condition_variable changed;          // A task finished or was queued
+            std::deque<std::function<void()>> queued; // Not started yet: the scheduler or the waiter takes them
+            std::exception_ptr error;                 // First failure of a task
+        };
+
+        TaskScheduler &scheduler;
+        std::shared_ptr<State> state = std::make_shared<State>();
+
+        // Runs one queued task of the group, the oldest or the newest; false when none was left
+        static bool runQueued(const std::shared_ptr<State> &group, bool newest);
+        bool waitUntil(const std::optional<std::chrono::steady_clock::time_point> &deadline);
+
+    public:
+        explicit TaskGroup(TaskScheduler &taskScheduler = TaskScheduler::shared()) : scheduler(taskScheduler) {}
+        ~TaskGroup() noexcept; // Waits for the tasks; their errors are dropped
+
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        void run(std::function<void()> task);
+
+        // Blocks until every task has finished, then rethrows the first exception one threw
+        void wait();
+        // wait() for at most timeout: false if tasks are still running (nothing is rethrown then).
+        // The deadline is checked between tasks, so one of the group's own tasks may overrun it.
+        bool waitFor(std::chrono::microseconds timeout);
+    };
+
+    // Calls body on subranges of [begin, end) of at least grain items, in parallel. Ranges are
+    // halved recursively, so idle workers steal large pieces first. Rethrows the first failure.
+    void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)> &body,
+                     TaskScheduler &scheduler = TaskScheduler::shared());
+
+} // namespace PasswordNS
+
+#endif
@@ -1,8 +1,38 @@
 #include "manager.h"
 #include "encryption.h"
+#include "batch_io.h"
+#include "worker_pool.h"
+#include "trace.h"
+#include "metrics.h"
+#include "durable_file.h"
+#include "vault_store.h"
+#include "chunk_sync.h"
+#include "vault_snapshot.h"
+#include "vault_audit.h"
+#include "breach_corpus.h"
+#include "password_strength.h"
+#include "huffman_block.h"
+#include "vault_bundle.h"
+#include "storage_backend.h"
+#include "async_io.h"
+#include "async_task.h"
+#include "task_scheduler.h"
+#include "record_schema.h"
 #include <gtest/gtest.h>
 #include <vector>
 #include <string>
+#include <sstream>
+#include <atomic>
+#include <future>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <ctime>
+#include <limits>
+#include "Huffman-Encoding/Huffman_C/huffman.h"
 
 using namespace PasswordNS;
 
@@ -22,7 +52,7 @@ namespace
         {
             encryptedPassword.push_back(static_cast<unsigned char>(std::stoi(encryptedPasswordHex.substr(i, 2), nullptr, 16)));
         }
-        auto decryptedPassword = EncryptionNS::decrypt(encryptedPassword, PasswordManager::getEncryptionKey());
+        auto decryptedPassword = EncryptionNS::decrypt(encryptedPassword, PasswordManager::getDefaultEncryptionKey());
 
         EXPECT_EQ(decryptedPassword, "password123");
     }
@@ -53,7 +83,7 @@ namespace
         {
             encryptedPassword.push_back(static_cast<unsigned char>(std::stoi(encryptedPasswordHex.substr(i, 2), nullptr, 16)));
         }
-        auto decryptedPassword = EncryptionNS::decrypt(encryptedPassword, PasswordManager::getEncryptionKey());
+        auto decryptedPassword = EncryptionNS::decrypt(encryptedPassword, PasswordManager::getDefaultEncryptionKey());
 
         EXPECT_EQ(decryptedPassword, "newPassword123");
     }
@@ -76,10 +106,17 @@ namespace
 
         EXPECT_EQ(password.length(), 12);
 
-        EXPECT_NE(password.find_first_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ"), std::string::npos);
-        EXPECT_NE(password.find_first_of("abcdefghijklmnopqrstuvwxyz"), std::string::npos);
-        EXPECT_NE(password.find_first_of("0123456789"), std::string::npos);
-        EXPECT_NE(password.find_first_of("!@#$%^&*()"), std::string::npos);
+        // One password of 12 random characters can miss a class, so check the alphabet over many
+        std::string generated;
+        for (int i = 0; i < 100; ++i) {
+            generated += pm.generatePassword(12);
+        }
+        EXPECT_EQ(generated.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!@#$%^&*()"),
+                  std::string::npos);
+        EXPECT_NE(generated.find_first_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ"), std::string::npos);
+        EXPECT_NE(generated.find_first_of("abcdefghijklmnopqrstuvwxyz"), std::string::npos);
+        EXPECT_NE(generated.find_first_of("0123456789"), std::string::npos);
+        EXPECT_NE(generated.find_first_of("!@#$%^&*()"), std::string::npos);
     }
 
     // Additional test for retrieving all credentials
@@ -130,7 +167,7 @@ namespace
         {
             encryptedPassword.push_back(static_cast<unsigned char>(std::stoi(encryptedPasswordHex.substr(i, 2), nullptr, 16)));
         }
-        auto decryptedPassword = EncryptionNS::decrypt(encryptedPassword, PasswordManager::getEncryptionKey());
+        auto decryptedPassword = EncryptionNS::decrypt(encryptedPassword, PasswordManager::getDefaultEncryptionKey());
 
         EXPECT_EQ(decryptedPassword, maxPassword);
     }
@@ -331,4 +368,1639 @@ TEST(PasswordManagerBranchCoverage, HasPasswordBranches) {
     EXPECT_TRUE(pm.hasPassword("service"));
 }
 
+// Test: Batch import writes vault records and skips unusable rows
+TEST(BatchIOTestSuite, ImportCsvSkipsInvalidRows) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+
+    // Services may hold spaces (the vault splits a line at its last space); usernames may not
+    std::istringstream input("service,username,password\n"
+                             "email,user@example.com,password123\n"
+                             "bank,user1,short\n"
+                             "\"my bank\",user2,securePassword\n"
+                             "shop,\"user 4\",securePassword\n"
+                             "social,user3,\"pass,word\"\"123\"\n");
+    std::ostringstream vault;
+    BatchOptions options;
+    options.threads = 2;
+    options.batchSize = 2;
+
+    BatchStats stats = importCredentials(pm, input, vault, options);
+    EXPECT_EQ(stats.processed, 3);
+    EXPECT_EQ(stats.skipped, 2);
+
+    std::istringstream records(vault.str());
+    std::string line;
+    std::pair<std::string, std::string> record;
+    std::vector<std::pair<std::string, std::string>> expected = {
+        {"email", "password123"}, {"my bank", "securePassword"}, {"social", "pass,word\"123"}};
+    for (const auto &entry : expected) {
+        ASSERT_TRUE(std::getline(records, line));
+        ASSERT_TRUE(PasswordManager::parseVaultRecord(line, record));
+        EXPECT_EQ(record.first, entry.first);
+        EXPECT_EQ(PasswordManager::decryptFromHex(record.second.substr(record.second.find(':') + 1), PasswordManager::getDefaultEncryptionKey()), entry.second);
+    }
+}
+
+// Test: JSONL export followed by import reproduces the plaintext entries
+TEST(BatchIOTestSuite, JsonlRoundTrip) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+
+    std::istringstream input("{\"service\":\"email\",\"username\":\"user@example.com\",\"password\":\"tab\\there\\\"quoted\"}\n"
+                             "{\"username\":\"user2\",\"password\":\"socialPass!1\",\"service\":\"social\"}\n"
+                             "not json\n");
+    std::ostringstream vault;
+    BatchOptions options;
+    options.format = BatchFormat::Jsonl;
+
+    BatchStats imported = importCredentials(pm, input, vault, options);
+    EXPECT_EQ(imported.processed, 2);
+    EXPECT_EQ(imported.skipped, 1);
+
+    std::istringstream vaultIn(vault.str());
+    std::ostringstream output;
+    BatchStats exported = exportCredentials(vaultIn, output, PasswordManager::getDefaultEncryptionKey(), options);
+    EXPECT_EQ(exported.processed, 2);
+    EXPECT_EQ(output.str(),
+              "{\"service\":\"email\",\"username\":\"user@example.com\",\"password\":\"tab\\there\\\"quoted\"}\n"
+              "{\"service\":\"social\",\"username\":\"user2\",\"password\":\"socialPass!1\"}\n");
+}
+
+// Test: Worker pool runs every queued task before shutting down
+TEST(WorkerPoolTestSuite, RunsQueuedTasks) {
+    std::atomic<int> completed{0};
+    {
+        WorkerPool pool(2);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&completed]() { ++completed; });
+        }
+    }
+    EXPECT_EQ(completed.load(), 100);
+}
+
+// Test: Listing the vault reports progress and stops when cancelled
+TEST(WorkerPoolTestSuite, DecryptAllProgressAndCancellation) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("testUser", "testPassword");
+    pm.addNewPassword("email", "user1", "password123");
+    pm.addNewPassword("bank", "user2", "securePassword");
+
+    size_t lastCompleted = 0, lastTotal = 0;
+    auto credentials = pm.getAllDecryptedCredentials(
+        [&](size_t completed, size_t total) {
+            lastCompleted = completed;
+            lastTotal = total;
+        },
+        CancellationToken());
+    EXPECT_EQ(credentials.size(), 2);
+    EXPECT_EQ(lastCompleted, 2);
+    EXPECT_EQ(lastTotal, 2);
+
+    CancellationToken cancel;
+    cancel.cancel();
+    EXPECT_THROW(pm.getAllDecryptedCredentials(ProgressCallback(), cancel), OperationCancelled);
+}
+
+// Test: Paged decryption returns only the requested window of entries
+TEST(PasswordManagerTestSuite, DecryptedCredentialPages) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("testUser", "testPassword");
+    pm.addNewPassword("email", "user1", "password123");
+    pm.addNewPassword("bank", "user2", "securePassword");
+    pm.addNewPassword("social", "user3", "socialPass!1");
+
+    auto page = pm.getDecryptedCredentials(1, 5);
+    ASSERT_EQ(page.size(), 2);
+    EXPECT_EQ(page[0].first, "bank");
+    EXPECT_EQ(page[0].second, "user2:securePassword");
+    EXPECT_EQ(page[1].second, "user3:socialPass!1");
+
+    EXPECT_TRUE(pm.getDecryptedCredentials(3, 5).empty());
+}
+
+// Test: Traced scopes are written as Chrome trace events
+TEST(TraceTestSuite, WritesTraceEvents) {
+    TraceNS::start("test_trace.json");
+    {
+        TRACE_SCOPE("test.scope");
+    }
+    TraceNS::stop();
+    EXPECT_FALSE(TraceNS::isEnabled());
+
+    std::ifstream file("test_trace.json");
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(contents.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(contents.find("\"name\":\"test.scope\""), std::string::npos);
+    EXPECT_NE(contents.find("\"ph\":\"X\""), std::string::npos);
+
+    std::remove("test_trace.json");
+}
+
+// Test: Histogram buckets cover every value with bounded relative error
+TEST(MetricsTestSuite, BucketBounds) {
+    for (uint64_t value : {0ULL, 1ULL, 7ULL, 8ULL, 9ULL, 15ULL, 16ULL, 1000ULL, 123456789ULL}) {
+        size_t index = MetricsNS::bucketIndex(value);
+        EXPECT_LE(MetricsNS::bucketLowerBound(index), value);
+        EXPECT_GT(MetricsNS::bucketLowerBound(index + 1), value);
+    }
+}
+
+// Test: Events from several threads are merged into one snapshot
+TEST(MetricsTestSuite, SnapshotMergesThreads) {
+    MetricsNS::reset();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([]() {
+            for (uint64_t i = 1; i <= 1000; ++i) {
+                MetricsNS::record(MetricsNS::Operation::Decrypt, i * 1000);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    auto snapshot = MetricsNS::snapshot();
+    const auto &decrypt = snapshot[MetricsNS::Operation::Decrypt];
+    EXPECT_EQ(decrypt.count, 4000);
+    EXPECT_EQ(decrypt.maxNanoseconds, 1000000);
+    EXPECT_NEAR(static_cast<double>(decrypt.percentile(0.5)), 500000.0, 500000.0 * 0.125);
+
+    std::string prometheus = MetricsNS::toPrometheus(snapshot);
+    EXPECT_NE(prometheus.find("password_manager_operation_duration_seconds_count{operation=\"decrypt\"} 4000"),
+              std::string::npos);
+    MetricsNS::reset();
+}
+
+// Test: Batch encryption and decryption count every entry, whichever engine runs them
+TEST(MetricsTestSuite, BatchCallsRecordEachEntry) {
+    const std::string key(32, 'k');
+    std::vector<std::string> plaintexts(10, "password");
+    MetricsNS::reset();
+    auto ciphertexts = EncryptionNS::encryptBatch(plaintexts, key);
+    EncryptionNS::decryptBatch(ciphertexts, key);
+    auto snapshot = MetricsNS::snapshot();
+    EXPECT_EQ(snapshot[MetricsNS::Operation::Encrypt].count, 10);
+    EXPECT_EQ(snapshot[MetricsNS::Operation::Decrypt].count, 10);
+    MetricsNS::reset();
+}
+
+// Test: Atomic writes replace the file and leave no temp files behind
+TEST(DurableFileTestSuite, WriteFileAtomically) {
+    writeFileAtomically("test_atomic.dat", "old contents\n", false);
+    writeFileAtomically("test_atomic.dat", "new contents\n", true);
+
+    std::ifstream file("test_atomic.dat");
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents, "new contents\n");
+    for (const auto &entry : std::filesystem::directory_iterator(".")) {
+        EXPECT_EQ(entry.path().filename().string().rfind("test_atomic.dat.tmp", 0), std::string::npos);
+    }
+
+    EXPECT_THROW(writeFileAtomically("missing_directory/test_atomic.dat", "x", true), std::ios_base::failure);
+    std::remove("test_atomic.dat");
+}
+
+// Test: Saves in GroupCommit mode share fsyncs and the newest vault wins
+TEST(DurableFileTestSuite, GroupCommitKeepsNewestVault) {
+    {
+        PasswordManager pm;
+        pm.setCompressOnExit(false);
+        pm.setTestCredentials("groupCommitUser", "testPassword");
+        pm.setDurability(Durability::GroupCommit);
+        for (int i = 0; i < 20; ++i) {
+            pm.addNewPassword("service" + std::to_string(i), "user", "password123");
+        }
+        pm.flushCredentials();
+
+        PasswordManager reader;
+        reader.setCompressOnExit(false);
+        reader.setTestCredentials("groupCommitUser", "testPassword");
+        reader.loadCredentialsFromFile();
+        EXPECT_EQ(reader.getPasswordCount(), 20);
+    }
+
+    GroupCommitter committer("test_group_commit.dat", std::chrono::milliseconds(20));
+    uint64_t first = committer.submit("first\n");
+    uint64_t last = committer.submit("second\n");
+    committer.wait(first);
+    committer.wait(last);
+    EXPECT_EQ(committer.commits(), 1);
+
+    std::ifstream file("test_group_commit.dat");
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents, "second\n");
+
+    std::remove("test_group_commit.dat");
+    std::remove("groupCommitUser_passwords.dat");
+}
+
+// Test: Vaults are sharded by username and only the most recent stay loaded
+TEST(VaultStoreTestSuite, ShardedLayoutAndLru) {
+    VaultStoreOptions options;
+    options.cacheCapacity = 2;
+    {
+        VaultStore store("test_vault_store", options);
+        EXPECT_EQ(store.vaultPathFor("alice").rfind(store.shardDirectoryFor("alice") + "/", 0), 0);
+        EXPECT_THROW(store.vaultPathFor("../alice"), std::invalid_argument);
+
+        auto alice = store.open("alice");
+        alice->addNewPassword("email", "alice@example.com", "password123");
+        EXPECT_EQ(alice->getVaultFileName(), store.vaultPathFor("alice"));
+        EXPECT_EQ(store.open("alice"), alice);
+
+        store.open("bob");
+        store.open("carol");
+        EXPECT_EQ(store.residentCount(), 2);
+        EXPECT_TRUE(store.contains("alice"));
+
+        // alice was evicted; reopening loads her vault from disk
+        alice.reset();
+        EXPECT_EQ(store.open("alice")->getPasswordCount(), 1);
+        EXPECT_EQ(store.listUsers(), std::vector<std::string>{"alice"});
+    }
+    std::filesystem::remove_all("test_vault_store");
+}
+
+// Test: Preload loads vaults in parallel and reports the ones that fail verification
+TEST(VaultStoreTestSuite, PreloadVerifiesInParallel) {
+    VaultStoreOptions options;
+    options.threads = 4;
+    {
+        VaultStore store("test_vault_store", options);
+        for (int i = 0; i < 40; ++i) {
+            store.open("user" + std::to_string(i))->addNewPassword("service", "name", "password123");
+        }
+        std::ofstream(store.vaultPathFor("user7"), std::ios::app) << "broken name:xyz\n";
+
+        VaultStore fresh("test_vault_store", options);
+        size_t lastProgress = 0;
+        PreloadReport report = fresh.preloadAll(true, [&](size_t completed, size_t) { lastProgress = completed; });
+        EXPECT_EQ(report.loaded, 39);
+        ASSERT_EQ(report.failed, 1);
+        EXPECT_EQ(report.failures[0].username, "user7");
+        EXPECT_EQ(lastProgress, 40);
+        EXPECT_EQ(fresh.residentCount(), 39);
+    }
+    std::filesystem::remove_all("test_vault_store");
+}
+
+// Test: Each user's vault has its own key, and re-keying one leaves the others readable
+TEST(VaultStoreTestSuite, KeysArePerUser) {
+    VaultStoreOptions options;
+    options.encryptionKey = [](const std::string &username) { return username + "_key_padded_to_32_bytes_or_more"; };
+    {
+        VaultStore store("test_vault_store", options);
+        for (const std::string user : {"alice", "bob"}) {
+            store.open(user)->addNewPassword("email", user, "password123");
+        }
+        EXPECT_EQ(store.open("alice")->getEncryptionKey(), "alice_key_padded_to_32_bytes_or_more");
+
+        auto alice = store.open("alice");
+        alice->rekey("alice_new_key_padded_to_32_bytes!");
+        EXPECT_EQ(store.open("bob")->getEncryptionKey(), "bob_key_padded_to_32_bytes_or_more");
+        store.open("bob")->addNewPassword("bank", "bob", "password456");
+        EXPECT_EQ(store.open("bob")->getAllDecryptedCredentials()[1].second, "bob:password456");
+
+        // A fresh store asks for the keys again; alice's is now the new one
+        options.encryptionKey = [](const std::string &username) {
+            return username == "alice" ? "alice_new_key_padded_to_32_bytes!" : username + "_key_padded_to_32_bytes_or_more";
+        };
+        VaultStore fresh("test_vault_store", options);
+        PreloadReport report = fresh.preloadAll(true);
+        EXPECT_EQ(report.loaded, 2);
+        EXPECT_EQ(report.failed, 0);
+    }
+    std::filesystem::remove_all("test_vault_store");
+}
+
+// Test: Chunk boundaries follow the content, so an insert only changes nearby chunks
+TEST(ChunkSyncTestSuite, BoundariesSurviveInsertions) {
+    std::string data;
+    for (int i = 0; i < 20000; ++i) {
+        data += "service" + std::to_string(i) + " user" + std::to_string(i) + ":" + sha256Hex(data.data(), i % 7) + "\n";
+    }
+    std::string edited = "inserted line\n" + data;
+
+    auto original = splitIntoChunks(data);
+    auto shifted = splitIntoChunks(edited);
+    ASSERT_GT(original.size(), 10);
+    for (const auto &chunk : shifted) {
+        EXPECT_LE(chunk.size, ChunkerOptions().maxSize);
+    }
+
+    size_t shared = 0;
+    for (const auto &chunk : shifted) {
+        shared += std::any_of(original.begin(), original.end(), [&](const ChunkRef &c) { return c.id == chunk.id; });
+    }
+    EXPECT_GE(shared + 2, original.size());
+}
+
+// Test: A push after a one-entry change uploads only the changed chunks, and pull restores the vault
+TEST(ChunkSyncTestSuite, PushPullTransfersOnlyChangedChunks) {
+    std::string vault;
+    for (int i = 0; i < 5000; ++i) {
+        vault += "service" + std::to_string(i) + " user:" + PasswordManager::encryptToHex("password" + std::to_string(i), PasswordManager::getDefaultEncryptionKey()) + "\n";
+    }
+    std::ofstream("test_sync_passwords.dat", std::ios::trunc) << vault;
+
+    ChunkStore remote("test_sync_remote");
+    SyncStats first = pushVault("test_sync_passwords.dat", remote, "test_sync");
+    EXPECT_EQ(first.chunksTransferred, first.chunks);
+
+    std::string changed = vault;
+    changed.replace(changed.find("service2500 "), 11, "service2500x");
+    std::ofstream("test_sync_passwords.dat", std::ios::trunc) << changed;
+    SyncStats second = pushVault("test_sync_passwords.dat", remote, "test_sync");
+    EXPECT_LE(second.chunksTransferred, 2);
+    EXPECT_LT(second.bytesTransferred, vault.size() / 4);
+
+    // A chunk left empty by a crash is written again by the next push instead of being kept
+    std::string damaged = remote.getManifest("test_sync").chunks[0].id;
+    std::ofstream("test_sync_remote/chunks/" + damaged.substr(0, 2) + "/" + damaged, std::ios::trunc);
+    EXPECT_THROW(remote.getChunk(damaged), std::ios_base::failure);
+    EXPECT_EQ(pushVault("test_sync_passwords.dat", remote, "test_sync").chunksTransferred, 1);
+    EXPECT_NO_THROW(remote.getChunk(damaged));
+
+    std::ofstream("test_sync_replica.dat", std::ios::trunc) << vault;
+    SyncStats pulled = pullVault(remote, "test_sync", "test_sync_replica.dat");
+    EXPECT_LE(pulled.chunksTransferred, 2);
+    std::ifstream replica("test_sync_replica.dat");
+    std::string contents((std::istreambuf_iterator<char>(replica)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents, changed);
+
+    std::filesystem::remove_all("test_sync_remote");
+    std::remove("test_sync_passwords.dat");
+    std::remove("test_sync_replica.dat");
+    std::remove("test_sync_replica.dat.manifest");
+}
+
+// Test: Copies share blocks until one of them is written
+TEST(PersistentVectorTestSuite, CopiesShareUntilWritten) {
+    PersistentVector<int, 4> numbers;
+    for (int i = 0; i < 10; ++i) {
+        numbers.push_back(i);
+    }
+    PersistentVector<int, 4> snapshot = numbers;
+    EXPECT_TRUE(snapshot.sharesStorageWith(numbers));
+
+    numbers.set(5, 51);
+    numbers.push_back(10);
+    EXPECT_EQ(numbers.removeIf([](int n) { return n % 2 == 0; }), 6);
+    EXPECT_FALSE(snapshot.sharesStorageWith(numbers));
+
+    EXPECT_EQ(snapshot.toVector(), std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    EXPECT_EQ(numbers.toVector(), std::vector<int>({1, 3, 51, 7, 9}));
+    EXPECT_EQ(numbers[2], 51);
+    PersistentVector<int, 4> copy = snapshot;
+    EXPECT_EQ(snapshot.block(0), copy.block(0));
+    EXPECT_THROW(numbers.at(5), std::out_of_range);
+}
+
+// Test: Snapshots survive deletes and restore the vault to an earlier state
+TEST(PasswordManagerTestSuite, SnapshotAndRestore) {
+    {
+        PasswordManager pm;
+        pm.setCompressOnExit(false);
+        pm.setTestCredentials("snapshotUser", "testPassword");
+        pm.addNewPassword("email", "user1", "password123");
+        pm.addNewPassword("bank", "user2", "securePassword");
+
+        CredentialList before = pm.getCredentialList();
+        pm.saveSnapshot("before_delete");
+        pm.deletePassword("email");
+        EXPECT_EQ(before.size(), 2);
+        EXPECT_FALSE(pm.hasPassword("email"));
+
+        EXPECT_EQ(pm.listSnapshots(), std::vector<std::string>{"before_delete"});
+        pm.restoreSnapshot("before_delete");
+        EXPECT_TRUE(pm.hasPassword("email"));
+        EXPECT_THROW(pm.restoreSnapshot("missing"), std::invalid_argument);
+
+        // An unchanged vault reuses every stored block
+        ChunkStore store(pm.getSnapshotDirectory());
+        SnapshotStats stats = writeSnapshot(store, "again", pm.getCredentialList());
+        EXPECT_EQ(stats.blocksWritten, 0);
+
+        PasswordManager reader;
+        reader.setCompressOnExit(false);
+        reader.setTestCredentials("snapshotUser", "testPassword");
+        reader.loadCredentialsFromFile();
+        EXPECT_EQ(reader.getPasswordCount(), 2);
+    }
+    std::filesystem::remove_all("snapshotUser_snapshots");
+    std::remove("snapshotUser_passwords.dat");
+}
+
+// Test: The arena hands out aligned memory and wipes it on reset
+TEST(SecureMemoryTestSuite, ArenaAllocatesAndWipes) {
+    EncryptionNS::SecureArena arena(4096);
+    auto *first = static_cast<char *>(arena.allocate(100, 16));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 16, 0);
+    std::memset(first, 'x', 100);
+
+    // Allocations larger than the region grow the arena instead of overrunning it
+    auto *large = static_cast<char *>(arena.allocate(10000));
+    std::memset(large, 'y', 10000);
+    EXPECT_GE(arena.capacity(), 4096 + 10000);
+
+    arena.reset();
+    EXPECT_EQ(arena.capacity(), 4096);
+    EXPECT_EQ(std::count(first, first + 100, 'x'), 0);
+}
+
+// Test: Secure decryption matches the plain path and secure strings copy into their own memory
+TEST(SecureMemoryTestSuite, SecureStringsFromDecryption) {
+    auto ciphertext = EncryptionNS::encrypt("a much longer password than sso", PasswordManager::getDefaultEncryptionKey());
+    auto arena = std::make_shared<EncryptionNS::SecureArena>();
+    EncryptionNS::SecureString secret = EncryptionNS::decryptSecure(ciphertext, PasswordManager::getDefaultEncryptionKey(), arena);
+    EXPECT_EQ(secret, "a much longer password than sso");
+    EXPECT_EQ(EncryptionNS::decrypt(ciphertext, PasswordManager::getDefaultEncryptionKey()), secret.str());
+
+    EncryptionNS::SecureString copy = secret;
+    EXPECT_NE(copy.data(), secret.data());
+    EXPECT_EQ(copy, secret.view());
+
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("testUser", "testPassword");
+    pm.addNewPassword("email", "user1", "password123");
+    pm.addNewPassword("bank", "user2", "securePassword");
+    auto credentials = pm.getSecureCredentials(0, 10);
+    ASSERT_EQ(credentials.size(), 2);
+    EXPECT_EQ(credentials[1].service, "bank");
+    EXPECT_EQ(credentials[1].username, "user2");
+    EXPECT_EQ(credentials[1].password, "securePassword");
+}
+
+TEST(VaultAuditTestSuite, FindsReusedWeakAndUnreadableEntries) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("auditUser", "secure_password");
+    pm.addNewPassword("mail", "alice", "SharedPassw0rd!");
+    pm.addNewPassword("bank", "alice", "UniquePassw0rd!");
+    pm.addNewPassword("forum", "al", "SharedPassw0rd!");
+    pm.addNewPassword("shop", "alice", "SharedPassw0rd!");
+    pm.addNewPassword("wiki", "bob", "OtherPassw0rd!");
+    pm.addNewPassword("chat", "bob", "OtherPassw0rd!");
+
+    // Weak entries never get past addNewPassword, so write one straight into the list
+    CredentialList list = pm.getCredentialList();
+    list.push_back({"router", "admin:" + PasswordManager::encryptToHex("admin", PasswordManager::getDefaultEncryptionKey())});
+    list.push_back({"broken", "nobody:abcd"});
+    pm.restoreCredentialList(list);
+
+    AuditOptions options;
+    options.threads = 2;
+    size_t lastProgress = 0;
+    AuditReport report = auditVault(pm, options, [&](size_t completed, size_t) { lastProgress = completed; });
+
+    EXPECT_EQ(report.entries, 8u);
+    EXPECT_EQ(lastProgress, 8u);
+    ASSERT_EQ(report.reuseClusters.size(), 2u);
+    ASSERT_EQ(report.reuseClusters[0].size(), 3u);
+    EXPECT_EQ(report.reuseClusters[0][0].service, "mail");
+    EXPECT_EQ(report.reuseClusters[0][1].service, "forum");
+    EXPECT_EQ(report.reuseClusters[0][1].username, "al");
+    EXPECT_EQ(report.reuseClusters[0][2].index, 3u);
+    ASSERT_EQ(report.reuseClusters[1].size(), 2u);
+    EXPECT_EQ(report.reuseClusters[1][0].service, "wiki");
+    EXPECT_EQ(report.reuseClusters[1][1].service, "chat");
+    EXPECT_EQ(report.reusedEntries(), 5u);
+
+    ASSERT_EQ(report.weak.size(), 1u);
+    EXPECT_EQ(report.weak[0].service, "router");
+    ASSERT_EQ(report.unreadable.size(), 1u);
+    EXPECT_EQ(report.unreadable[0].service, "broken");
+
+    std::filesystem::remove(pm.getVaultFileName());
+}
+
+TEST(VaultAuditTestSuite, SpansBlocksAndCancels) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("auditBlocksUser", "secure_password");
+
+    // More than two 1024-entry blocks, with one reused password far apart
+    CredentialList list;
+    for (int i = 0; i < 2500; ++i) {
+        std::string password = i == 7 || i == 2400 ? "Reused-Passw0rd" : "Kq7#vX-" + std::to_string(1000 + i);
+        list.push_back({"service" + std::to_string(i), "user:" + PasswordManager::encryptToHex(password, PasswordManager::getDefaultEncryptionKey())});
+    }
+    pm.restoreCredentialList(list);
+
+    AuditReport report = auditVault(pm);
+    EXPECT_EQ(report.entries, 2500u);
+    ASSERT_EQ(report.reuseClusters.size(), 1u);
+    ASSERT_EQ(report.reuseClusters[0].size(), 2u);
+    EXPECT_EQ(report.reuseClusters[0][0].index, 7u);
+    EXPECT_EQ(report.reuseClusters[0][1].index, 2400u);
+    EXPECT_TRUE(report.weak.empty());
+    EXPECT_GT(report.entriesPerSecond(), 0.0);
+
+    CancellationToken cancel;
+    cancel.cancel();
+    EXPECT_THROW(auditVault(pm, AuditOptions(), ProgressCallback(), cancel), OperationCancelled);
+
+    std::filesystem::remove(pm.getVaultFileName());
+}
+
+TEST(BreachCorpusTestSuite, BuildsAndLooksUpSortedDigests) {
+    // SHA-1 of "password", "123456" and "letmein", in hash order
+    std::vector<std::string> hashes = {"5BAA61E4C9B93F3F0682250B6CF8331B7EE68FD8", "7C4A8D09CA3762AF61E59520943DC26494F8941B",
+                                       "B7A875FC1EA228B9061041B7CEC4BD3C52AB3CE3"};
+    std::sort(hashes.begin(), hashes.end());
+    std::stringstream list;
+    list << hashes[0] << ":3861493\n" << hashes[1] << ":37359195\n" << hashes[1] << ":1\n"
+         << "\n" << hashes[2] << "\r\n";
+    EXPECT_EQ(writeBreachCorpus(list, "test_breaches.bin"), 3u);
+    EXPECT_EQ(std::filesystem::file_size("test_breaches.bin"), 60u);
+
+    BreachCorpus corpus("test_breaches.bin");
+    EXPECT_EQ(corpus.size(), 3u);
+    EXPECT_GT(corpus.indexBytes(), 0u);
+    EXPECT_TRUE(corpus.containsPassword("password"));
+    EXPECT_TRUE(corpus.containsPassword("123456"));
+    EXPECT_TRUE(corpus.containsPassword("letmein"));
+    EXPECT_FALSE(corpus.containsPassword("Correct-Horse-Battery-Staple"));
+
+    // Out-of-order and malformed lists are refused without leaving a file behind
+    std::stringstream unsorted;
+    unsorted << hashes[2] << "\n" << hashes[0] << "\n";
+    EXPECT_THROW(writeBreachCorpus(unsorted, "test_unsorted.bin"), std::invalid_argument);
+    std::stringstream malformed("not-a-hash\n");
+    EXPECT_THROW(writeBreachCorpus(malformed, "test_unsorted.bin"), std::invalid_argument);
+    EXPECT_FALSE(std::filesystem::exists("test_unsorted.bin"));
+    EXPECT_FALSE(std::filesystem::exists("test_unsorted.bin.tmp"));
+
+    // A raw file in the wrong order is caught when it is indexed
+    {
+        std::vector<Sha1Digest> digests = {sha1Digest("password"), sha1Digest("123456"), sha1Digest("letmein")};
+        std::sort(digests.rbegin(), digests.rend());
+        std::ofstream reversed("test_unsorted.bin", std::ios::binary);
+        for (const auto &digest : digests) {
+            reversed.write(reinterpret_cast<const char *>(digest.data()), digest.size());
+        }
+    }
+    EXPECT_THROW(BreachCorpus("test_unsorted.bin"), std::invalid_argument);
+    EXPECT_THROW(BreachCorpus("missing_breaches.bin"), std::ios_base::failure);
+
+    std::filesystem::remove("test_breaches.bin");
+    std::filesystem::remove("test_unsorted.bin");
+}
+
+TEST(BreachCorpusTestSuite, AuditFlagsBreachedPasswords) {
+    std::stringstream list;
+    std::vector<Sha1Digest> digests;
+    for (int i = 0; i < 5000; ++i) {
+        digests.push_back(sha1Digest("leaked-password-" + std::to_string(i)));
+    }
+    std::sort(digests.begin(), digests.end());
+    static const char hexDigits[] = "0123456789ABCDEF";
+    for (const auto &digest : digests) {
+        for (unsigned char c : digest) {
+            list << hexDigits[c >> 4] << hexDigits[c & 0x0f];
+        }
+        list << ":1\n";
+    }
+    ASSERT_EQ(writeBreachCorpus(list, "test_audit_breaches.bin"), 5000u);
+    BreachCorpus corpus("test_audit_breaches.bin");
+
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("breachAuditUser", "secure_password");
+    pm.addNewPassword("mail", "alice", "leaked-password-4321");
+    pm.addNewPassword("bank", "alice", "Not-In-Any-Breach-42");
+
+    AuditOptions options;
+    options.breaches = &corpus;
+    AuditReport report = auditVault(pm, options);
+    ASSERT_EQ(report.breached.size(), 1u);
+    EXPECT_EQ(report.breached[0].service, "mail");
+    EXPECT_TRUE(auditVault(pm).breached.empty());
+
+    std::filesystem::remove(pm.getVaultFileName());
+    std::filesystem::remove("test_audit_breaches.bin");
+}
+
+TEST(PasswordStrengthTestSuite, ScoresCommonPatternsLow) {
+    // Common passwords, including reversed, capitalised and l33t forms
+    EXPECT_EQ(estimateStrength("password").score, 0);
+    EXPECT_EQ(estimateStrength("drowssap").score, 0);
+    EXPECT_EQ(estimateStrength("P@ssw0rd").score, 0);
+    EXPECT_EQ(estimateStrength("password123").score, 0);
+
+    // Keyboard walks, repeats, sequences and years
+    EXPECT_LE(estimateStrength("qwertyuiop").score, 1);
+    EXPECT_LE(estimateStrength("zxcvbnm,./").score, 1);
+    EXPECT_EQ(estimateStrength("aaaaaaaaaaaa").score, 0);
+    EXPECT_EQ(estimateStrength("abcabcabcabc").score, 0);
+    EXPECT_LE(estimateStrength("Jessica1990").score, 1);
+    EXPECT_NE(estimateStrength("zxcvbnm,./").feedback.find("Keyboard"), std::string::npos);
+    EXPECT_NE(estimateStrength("aaaaaaaaaaaa").feedback.find("Repeats"), std::string::npos);
+
+    // Random-looking and long multi-word passwords
+    EXPECT_EQ(estimateStrength("mV9#qLz2!xRt").score, 4);
+    EXPECT_EQ(estimateStrength("correcthorsebatterystaple").score, 4);
+    EXPECT_TRUE(estimateStrength("mV9#qLz2!xRt").feedback.empty());
+
+    // Longer passwords never score lower than their prefix
+    EXPECT_GE(estimateStrength("Summer2024!xq7").guesses, estimateStrength("Summer2024!").guesses);
+    EXPECT_EQ(estimateStrength("").score, 0);
+}
+
+TEST(PasswordStrengthTestSuite, MinimumStrengthGuardsNewPasswords) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("strengthUser", "secure_password");
+
+    // Without a minimum, only the length is checked
+    EXPECT_EQ(pm.getMinimumStrength(), 0);
+    EXPECT_TRUE(pm.validate("password123"));
+    EXPECT_FALSE(pm.validate("short"));
+
+    pm.setMinimumStrength(2);
+    EXPECT_FALSE(pm.validate("password123"));
+    EXPECT_FALSE(pm.describeWeakness("password123").empty());
+    EXPECT_TRUE(pm.validate("mV9#qLz2!xRt"));
+    EXPECT_THROW(pm.addNewPassword("mail", "alice", "qwertyuiop"), std::invalid_argument);
+    EXPECT_NO_THROW(pm.addNewPassword("mail", "alice", "mV9#qLz2!xRt"));
+    EXPECT_EQ(pm.getPasswordCount(), 1u);
+    EXPECT_THROW(pm.setMinimumStrength(5), std::invalid_argument);
+
+    // The audit applies its own minimum to entries that were stored before the policy
+    pm.setMinimumStrength(0);
+    pm.addNewPassword("forum", "alice", "password123");
+    AuditReport report = auditVault(pm);
+    ASSERT_EQ(report.weak.size(), 1u);
+    EXPECT_EQ(report.weak[0].service, "forum");
+    EXPECT_EQ(report.weak[0].strength, 0);
+
+    std::filesystem::remove(pm.getVaultFileName());
+}
+
+// Random printable text from charset, for the round-trip property tests
+std::string randomText(std::mt19937 &generator, const std::string &charset, size_t minLength, size_t maxLength) {
+    std::uniform_int_distribution<size_t> length(minLength, maxLength);
+    std::uniform_int_distribution<size_t> pick(0, charset.size() - 1);
+    std::string text(length(generator), ' ');
+    for (auto &c : text) {
+        c = charset[pick(generator)];
+    }
+    return text;
+}
+
+TEST(PropertyTestSuite, VaultSaveLoadRoundTrip) {
+    std::mt19937 generator(40);
+    const std::string serviceChars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 .-_:@#/";
+    const std::string usernameChars = "abcdefghijklmnopqrstuvwxyz0123456789.-_@+";
+    const std::string passwordChars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 !\"#$%&'()*+,-./:;<=>?@[]^_{|}~";
+
+    PasswordManager writer;
+    writer.setCompressOnExit(false);
+    writer.setTestCredentials("propertyUser", "secure_password");
+
+    // Spans several copy-on-write blocks; services may hold spaces and colons
+    std::vector<std::pair<std::string, std::string>> plain;
+    CredentialList list;
+    for (size_t i = 0; i < 2500; ++i) {
+        std::string service = randomText(generator, serviceChars, 1, 40);
+        std::string username = randomText(generator, usernameChars, 1, 24);
+        std::string password = randomText(generator, passwordChars, 0, 64);
+        plain.emplace_back(service, username + ":" + password);
+        list.push_back({service, username + ":" + PasswordManager::encryptToHex(password, PasswordManager::getDefaultEncryptionKey())});
+    }
+    writer.restoreCredentialList(list);
+    writer.addNewPassword("My Bank", "alice", "correct horse battery");
+    plain.emplace_back("My Bank", "alice:correct horse battery");
+
+    PasswordManager reader;
+    reader.setCompressOnExit(false);
+    reader.setTestCredentials("propertyUser", "secure_password");
+    reader.loadCredentialsFromFile();
+    EXPECT_EQ(reader.getAllCredentials(), writer.getAllCredentials());
+    EXPECT_EQ(reader.getAllDecryptedCredentials(), plain);
+
+    // Fields that would not survive the line format are refused, malformed lines are reported
+    EXPECT_THROW(writer.addNewPassword("bank", "alice smith", "ValidPassword123"), std::invalid_argument);
+    EXPECT_THROW(writer.addNewPassword("bank", "alice:1", "ValidPassword123"), std::invalid_argument);
+    EXPECT_THROW(writer.addNewPassword("two\nlines", "alice", "ValidPassword123"), std::invalid_argument);
+    std::ofstream(reader.getVaultFileName(), std::ios::app) << "\nno-separator\n";
+    EXPECT_THROW(reader.loadCredentialsFromFile(), std::invalid_argument);
+    EXPECT_EQ(reader.getPasswordCount(), plain.size()); // A failed load keeps the old entries
+
+    std::filesystem::remove(reader.getVaultFileName());
+}
+
+TEST(PropertyTestSuite, EncryptDecryptAndHexRoundTrip) {
+    std::mt19937 generator(41);
+    std::uniform_int_distribution<int> byte(0, 255);
+    const std::string &key = PasswordManager::getDefaultEncryptionKey();
+
+    std::vector<size_t> lengths = {0, 1, 15, 16, 17, 31, 32, 33, 255, 4096, 1 << 20};
+    for (int i = 0; i < 50; ++i) {
+        lengths.push_back(std::uniform_int_distribution<size_t>(0, 70000)(generator));
+    }
+    for (size_t length : lengths) {
+        std::string message(length, '\0');
+        for (auto &c : message) {
+            c = static_cast<char>(byte(generator));
+        }
+        std::vector<unsigned char> ciphertext = EncryptionNS::encrypt(message, key);
+        EXPECT_EQ(ciphertext.size(), (length / 16 + 1) * 16);
+        EXPECT_EQ(EncryptionNS::decrypt(ciphertext, key), message);
+        EXPECT_EQ(EncryptionNS::fromHex(EncryptionNS::toHex(ciphertext)), ciphertext);
+    }
+
+    // Malformed hex and short keys are rejected instead of misread
+    EXPECT_EQ(EncryptionNS::fromHex("00Ff7a"), std::vector<unsigned char>({0x00, 0xff, 0x7a}));
+    EXPECT_THROW(EncryptionNS::fromHex("abc"), std::invalid_argument);
+    EXPECT_THROW(EncryptionNS::fromHex("1z"), std::invalid_argument);
+    EXPECT_THROW(EncryptionNS::fromHex("-1"), std::invalid_argument);
+    EXPECT_THROW(EncryptionNS::encrypt("secret", "short key"), std::invalid_argument);
+    EXPECT_THROW(PasswordManager::decryptFromHex("0", PasswordManager::getDefaultEncryptionKey()), std::invalid_argument);
+}
+
+TEST(PropertyTestSuite, CompressDecompressRoundTrip) {
+    std::mt19937 generator(42);
+    const std::string charset = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789,._-!@#";
+    Compression compressor;
+
+    for (size_t lines : {1, 10, 1000, 20000}) {
+        std::string text;
+        for (size_t i = 0; i < lines; ++i) {
+            text += randomText(generator, charset, 1, 30) + "," + randomText(generator, charset, 1, 40) + "\n";
+        }
+        std::ofstream("property_input.csv", std::ios::binary | std::ios::trunc) << text;
+        ASSERT_TRUE(compressor.compress("property_input.csv", "property_input.huff"));
+        ASSERT_TRUE(compressor.decompress("property_input.huff", "property_output.csv"));
+
+        std::ifstream output("property_output.csv", std::ios::binary);
+        std::string roundTrip((std::istreambuf_iterator<char>(output)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(roundTrip, text) << lines << " lines";
+    }
+
+    std::remove("property_input.csv");
+    std::remove("property_input.huff");
+    std::remove("property_output.csv");
+}
+
+TEST(CredentialIndexTestSuite, IndexesFollowVaultChanges) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("metadataUser", "secure_password");
+    std::filesystem::remove(pm.getMetadataFileName());
+
+    int64_t before = static_cast<int64_t>(std::time(nullptr));
+    pm.addNewPassword("email", "alice", "password123");
+    pm.addNewPassword("bank", "alice", "securePassword");
+    pm.addNewPassword("bank", "bob", "securePassword2");
+    pm.setMetadata("email", "alice", {"work", "mail", "work"}, "https://mail.example.com");
+    pm.setMetadata("bank", "bob", {"finance", "shared, family"}, "https://bank.example.com/\tlogin");
+    EXPECT_THROW(pm.setMetadata("bank", "carol", {"finance"}, ""), std::invalid_argument);
+
+    const CredentialIndex &index = pm.getCredentialIndex();
+    EXPECT_EQ(index.findByUsername("alice"), (std::vector<CredentialKey>{{"bank", "alice"}, {"email", "alice"}}));
+    EXPECT_EQ(index.findByTag("work"), (std::vector<CredentialKey>{{"email", "alice"}}));
+    EXPECT_EQ(index.findByTag("shared, family"), (std::vector<CredentialKey>{{"bank", "bob"}}));
+    EXPECT_EQ(pm.getMetadata("email", "alice")->tags, (std::vector<std::string>{"mail", "work"}));
+    EXPECT_GE(pm.getMetadata("bank", "alice")->created, before);
+    EXPECT_EQ(index.findModifiedBetween(before, std::numeric_limits<int64_t>::max()).size(), 3u);
+    EXPECT_TRUE(index.findModifiedBetween(0, before - 1).empty());
+
+    // Deleting a service drops all of its accounts from every index
+    pm.deletePassword("bank");
+    EXPECT_EQ(index.findByUsername("alice"), (std::vector<CredentialKey>{{"email", "alice"}}));
+    EXPECT_TRUE(index.findByUsername("bob").empty());
+    EXPECT_TRUE(index.findByTag("finance").empty());
+    EXPECT_FALSE(pm.getMetadata("bank", "bob").has_value());
+
+    // The sidecar file brings the metadata back; entries it does not name get empty columns
+    pm.addNewPassword("bank", "bob", "securePassword2");
+    pm.setMetadata("bank", "bob", {"finance", "shared, family"}, "https://bank.example.com/\tlogin");
+    std::ofstream(pm.getVaultFileName(), std::ios::app) << "forum carol:" << PasswordManager::encryptToHex("forumPassword", PasswordManager::getDefaultEncryptionKey()) << "\n";
+    PasswordManager reader;
+    reader.setCompressOnExit(false);
+    reader.setTestCredentials("metadataUser", "secure_password");
+    reader.loadCredentialsFromFile();
+    EXPECT_EQ(*reader.getMetadata("bank", "bob"), *pm.getMetadata("bank", "bob"));
+    EXPECT_EQ(*reader.getMetadata("email", "alice"), *pm.getMetadata("email", "alice"));
+    EXPECT_EQ(*reader.getMetadata("forum", "carol"), CredentialMetadata());
+    EXPECT_EQ(reader.getCredentialIndex().findByTag("shared, family"), (std::vector<CredentialKey>{{"bank", "bob"}}));
+    EXPECT_EQ(reader.getCredentialIndex().findByUsername("carol"), (std::vector<CredentialKey>{{"forum", "carol"}}));
+
+    std::filesystem::remove(pm.getVaultFileName());
+    std::filesystem::remove(pm.getMetadataFileName());
+}
+
+TEST(CredentialIndexTestSuite, SerializesAndSyncs) {
+    CredentialIndex index;
+    CredentialMetadata metadata;
+    metadata.tags = {"a,b", "tab\there", "back\\slash"};
+    metadata.url = "https://example.com/?q=1,2";
+    metadata.created = 100;
+    metadata.modified = 200;
+    index.put({"my service", "alice"}, metadata);
+    index.put({"other", "bob"}, CredentialMetadata());
+
+    CredentialIndex parsed = CredentialIndex::parse(index.serialize());
+    EXPECT_EQ(parsed.size(), 1u); // Entries without metadata are not written
+    ASSERT_NE(parsed.find({"my service", "alice"}), nullptr);
+    std::sort(metadata.tags.begin(), metadata.tags.end());
+    EXPECT_EQ(*parsed.find({"my service", "alice"}), metadata);
+    EXPECT_EQ(parsed.findModifiedBetween(200, 200), (std::vector<CredentialKey>{{"my service", "alice"}}));
+    EXPECT_THROW(CredentialIndex::parse("only\tthree\tcolumns\n"), std::invalid_argument);
+
+    CredentialList list;
+    list.push_back({"my service", "alice:00"});
+    list.push_back({"new", "carol:00"});
+    parsed.sync(list);
+    EXPECT_EQ(parsed.size(), 2u);
+    EXPECT_EQ(parsed.find({"my service", "alice"})->modified, 200);
+    EXPECT_EQ(parsed.findByUsername("carol"), (std::vector<CredentialKey>{{"new", "carol"}}));
+    EXPECT_EQ(parsed.findByTag("a,b").size(), 1u);
+}
+
+TEST(EntryIdTestSuite, IdsSurviveRemovals) {
+    EntryIdIndex ids;
+    ids.reset(5);
+    EXPECT_EQ(ids.append(), 6u);
+    ids.remove(2);
+    ids.remove(5);
+    EXPECT_THROW(ids.remove(5), std::invalid_argument);
+    EXPECT_FALSE(ids.positionOf(2).has_value());
+    EXPECT_EQ(*ids.positionOf(3), 1u);
+    EXPECT_EQ(*ids.positionOf(6), 3u);
+    EXPECT_EQ(ids.size(), 4u);
+    for (size_t position = 0; position < ids.size(); ++position) {
+        EXPECT_EQ(*ids.positionOf(ids.idAt(position)), position);
+    }
+    EXPECT_EQ(ids.append(), 7u);
+    EXPECT_EQ(*ids.positionOf(7), 4u);
+}
+
+TEST(MultiAccountTestSuite, UpdatesGoToTheJournal) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("multiAccountUser", "secure_password");
+    std::filesystem::remove(pm.getVaultFileName());
+    std::filesystem::remove(pm.getJournalFileName());
+    std::filesystem::remove(pm.getMetadataFileName());
+    auto readFile = [](const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    };
+
+    // A service may hold several accounts, and an account several passwords
+    EntryId work = pm.addNewPassword("email", "alice@work", "password123");
+    EntryId home = pm.addNewPassword("email", "alice@home", "securePassword");
+    EntryId bank = pm.addNewPassword("bank", "alice", "securePassword2");
+    EntryId spare = pm.addNewPassword("email", "alice@home", "securePassword3");
+    EXPECT_EQ(pm.findEntries("email"), (std::vector<EntryId>{work, home, spare}));
+    EXPECT_EQ(pm.findEntries("email", "alice@home"), (std::vector<EntryId>{home, spare}));
+    EXPECT_TRUE(pm.findEntries("forum").empty());
+
+    // Updating one entry appends to the journal and leaves the vault file alone
+    std::string vaultBefore = readFile(pm.getVaultFileName());
+    pm.updatePassword(home, "newHomePassword");
+    EXPECT_EQ(readFile(pm.getVaultFileName()), vaultBefore);
+    EXPECT_TRUE(std::filesystem::exists(pm.getJournalFileName()));
+    EXPECT_EQ(PasswordManager::decryptFromHex(pm.getEntry(home)->second.substr(11), PasswordManager::getDefaultEncryptionKey()), "newHomePassword");
+    EXPECT_THROW(pm.updatePassword(home, "abc"), std::invalid_argument);
+
+    // Deleting by id keeps every other id pointing at its entry
+    pm.deleteEntry(work);
+    EXPECT_FALSE(pm.getEntry(work).has_value());
+    EXPECT_THROW(pm.deleteEntry(work), std::invalid_argument);
+    EXPECT_EQ(pm.getEntry(bank)->first, "bank");
+    EXPECT_EQ(pm.findEntries("email"), (std::vector<EntryId>{home, spare}));
+    EXPECT_EQ(readFile(pm.getVaultFileName()), vaultBefore);
+
+    // A reload replays the journal onto the vault
+    PasswordManager reader;
+    reader.setCompressOnExit(false);
+    reader.setTestCredentials("multiAccountUser", "secure_password");
+    reader.loadCredentialsFromFile();
+    EXPECT_EQ(reader.getCredentialList().toVector(), pm.getCredentialList().toVector());
+    std::vector<EntryId> reloaded = reader.findEntries("email", "alice@home");
+    ASSERT_EQ(reloaded.size(), 2u);
+    EXPECT_EQ(PasswordManager::decryptFromHex(reader.getEntry(reloaded[0])->second.substr(11), PasswordManager::getDefaultEncryptionKey()), "newHomePassword");
+
+    // A torn last line is an edit that never finished; it is dropped
+    std::ofstream(pm.getJournalFileName(), std::ios::app) << "set 0 email alice@home:00";
+    reader.loadCredentialsFromFile();
+    EXPECT_EQ(reader.getCredentialList().toVector(), pm.getCredentialList().toVector());
+
+    // Compaction folds the journal into the vault
+    pm.compactVault();
+    EXPECT_FALSE(std::filesystem::exists(pm.getJournalFileName()));
+    EXPECT_NE(readFile(pm.getVaultFileName()), vaultBefore);
+    reader.loadCredentialsFromFile();
+    EXPECT_EQ(reader.getCredentialList().toVector(), pm.getCredentialList().toVector());
+
+    // A journal written for another version of the vault is ignored
+    pm.updatePassword(bank, "newBankPassword");
+    std::string journal = readFile(pm.getJournalFileName());
+    pm.addNewPassword("forum", "alice", "forumPassword");
+    std::ofstream(pm.getJournalFileName(), std::ios::binary) << journal;
+    reader.loadCredentialsFromFile();
+    EXPECT_EQ(reader.getCredentialList().toVector(), pm.getCredentialList().toVector());
+
+    // Reading leaves it alone; the reader's next write of the vault removes it
+    EXPECT_TRUE(std::filesystem::exists(pm.getJournalFileName()));
+    reader.addNewPassword("chat", "alice", "chatPassword");
+    reader.flushCredentials();
+    EXPECT_FALSE(std::filesystem::exists(pm.getJournalFileName()));
+}
+
+TEST(RekeyTestSuite, ReencryptsAndResumesAfterInterruption) {
+    const std::string oldKey = PasswordManager::getDefaultEncryptionKey();
+    const std::string newKey = "a_different_key_for_aes_encryption";
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("rekeyUser", "secure_password");
+    std::filesystem::remove(pm.getVaultFileName());
+    std::filesystem::remove(pm.getJournalFileName());
+    abandonRekey(pm.getVaultFileName());
+    for (int i = 0; i < 5; ++i) {
+        pm.addNewPassword("service " + std::to_string(i), "user" + std::to_string(i), "password-" + std::to_string(i) + "-long");
+    }
+    EntryId first = pm.findEntries("service 0").front();
+    pm.updatePassword(first, "updatedPassword"); // Still in the journal when the re-key starts
+
+    // Cancel after the first chunk: the vault stays readable under the old key
+    RekeyOptions options;
+    options.chunkSize = 2;
+    options.threads = 2;
+    CancellationToken cancel;
+    std::vector<std::pair<size_t, size_t>> reports;
+    auto progress = [&](size_t completed, size_t total) {
+        reports.emplace_back(completed, total);
+        cancel.cancel();
+    };
+    EXPECT_THROW(pm.rekey(newKey, options, progress, cancel), OperationCancelled);
+    EXPECT_EQ(pm.getEncryptionKey(), oldKey);
+    EXPECT_TRUE(hasInterruptedRekey(pm.getVaultFileName()));
+    EXPECT_EQ(reports, (std::vector<std::pair<size_t, size_t>>{{2, 5}}));
+    PasswordManager reader;
+    reader.setCompressOnExit(false);
+    reader.setTestCredentials("rekeyUser", "secure_password");
+    reader.loadCredentialsFromFile();
+    EXPECT_EQ(reader.getAllDecryptedCredentials().front().second, "user0:updatedPassword");
+
+    // A second call picks up from the checkpoint
+    RekeyStats stats = pm.rekey(newKey, options);
+    EXPECT_EQ(stats.entries, 5u);
+    EXPECT_EQ(stats.resumedEntries, 2u);
+    EXPECT_EQ(stats.chunks, 2u);
+    EXPECT_FALSE(hasInterruptedRekey(pm.getVaultFileName()));
+    EXPECT_EQ(pm.getEncryptionKey(), newKey);
+
+    // The key belongs to the manager that re-keyed: others keep theirs until told
+    EXPECT_EQ(reader.getEncryptionKey(), oldKey);
+    reader.loadCredentialsFromFile();
+    EXPECT_ANY_THROW(reader.getAllDecryptedCredentials());
+    reader.setEncryptionKey(newKey);
+    auto decrypted = reader.getAllDecryptedCredentials();
+    ASSERT_EQ(decrypted.size(), 5u);
+    EXPECT_EQ(decrypted[0].second, "user0:updatedPassword");
+    EXPECT_EQ(decrypted[4].second, "user4:password-4-long");
+
+    // The wrong old key is caught before anything is replaced
+    std::ifstream before(pm.getVaultFileName());
+    std::string vault((std::istreambuf_iterator<char>(before)), std::istreambuf_iterator<char>());
+    EXPECT_THROW(rekeyVaultFile(pm.getVaultFileName(), oldKey, newKey, options), std::invalid_argument);
+    std::ifstream after(pm.getVaultFileName());
+    EXPECT_EQ(std::string((std::istreambuf_iterator<char>(after)), std::istreambuf_iterator<char>()), vault);
+    EXPECT_THROW(reader.setEncryptionKey("short"), std::invalid_argument);
+
+    // Keys derived from a master password are full-length and depend on the salt
+    std::string derived = EncryptionNS::deriveKey("new master password", "rekeyUser", 1000);
+    EXPECT_EQ(derived.size(), 32u);
+    EXPECT_EQ(derived, EncryptionNS::deriveKey("new master password", "rekeyUser", 1000));
+    EXPECT_NE(derived, EncryptionNS::deriveKey("new master password", "otherUser", 1000));
+    pm.rekey(derived, options);
+    reader.setEncryptionKey(derived);
+    reader.loadCredentialsFromFile();
+    EXPECT_EQ(reader.getAllDecryptedCredentials()[4].second, "user4:password-4-long");
+
+    pm.rekey(oldKey, options);
+    EXPECT_EQ(pm.getEncryptionKey(), oldKey);
+    abandonRekey(pm.getVaultFileName());
+}
+
+TEST(PropertyTestSuite, HuffmanBlockRoundTrip) {
+    std::mt19937 generator(7);
+    std::vector<std::string> blocks = {"", "a", std::string(100000, 'x'), "0123456789abcdef"};
+    for (size_t length : {1, 100, 5000, 200000}) {
+        std::string binary(length, '\0');
+        for (auto &c : binary) {
+            c = static_cast<char>(generator());
+        }
+        blocks.push_back(binary);
+        blocks.push_back(randomText(generator, "0123456789abcdef", length, length));
+    }
+    // Fibonacci frequencies make the deepest possible tree, which has to be flattened to 15 bits
+    std::string skewed;
+    for (size_t symbol = 0, a = 1, b = 1; symbol < 26; ++symbol, b = a + b, a = b - a) {
+        skewed += std::string(a, static_cast<char>('A' + symbol));
+    }
+    blocks.push_back(skewed);
+
+    for (const auto &block : blocks) {
+        std::string coded = compressBlock(block);
+        EXPECT_EQ(decompressBlock(coded, block.size()), block) << block.size() << " bytes";
+    }
+    EXPECT_LT(compressBlock(blocks.back()).size(), skewed.size() / 2);
+    EXPECT_THROW(decompressBlock(compressBlock("too long"), 4), std::invalid_argument);
+    EXPECT_THROW(decompressBlock("short", 100), std::invalid_argument);
+    std::string truncated = compressBlock(std::string(1000, 'a') + "b");
+    truncated.resize(truncated.size() - 10);
+    EXPECT_THROW(decompressBlock(truncated, 2000), std::invalid_argument);
+}
+
+TEST(BundleTestSuite, ExportsAndImportsThroughFrames) {
+    std::string vault;
+    for (int i = 0; i < 500; ++i) {
+        vault += "service " + std::to_string(i) + " user" + std::to_string(i) + ":" +
+                 PasswordManager::encryptToHex("pass word:" + std::to_string(i), PasswordManager::getDefaultEncryptionKey()) + "\n";
+    }
+    BundleOptions options;
+    options.frameSize = 4096;
+    options.kdfIterations = 1000;
+    std::istringstream vaultInput(vault);
+    std::ostringstream bundleOutput;
+    BundleStats exported = exportBundle(vaultInput, bundleOutput, "correct horse", PasswordManager::getDefaultEncryptionKey(), options);
+    std::string bundle = bundleOutput.str();
+    EXPECT_EQ(exported.entries, 500u);
+    EXPECT_GT(exported.frames, 2u);
+    EXPECT_EQ(exported.bundleBytes, bundle.size());
+    EXPECT_EQ(bundle.find("pass word"), std::string::npos);
+
+    std::istringstream bundleInput(bundle);
+    std::ostringstream imported;
+    BundleStats stats = importBundle(bundleInput, imported, "correct horse", PasswordManager::getDefaultEncryptionKey());
+    EXPECT_EQ(stats.entries, 500u);
+    EXPECT_EQ(stats.frames, exported.frames);
+    EXPECT_EQ(imported.str(), vault); // The vault key is the same on both sides here
+
+    auto importFails = [](const std::string &data, const std::string &passphrase) {
+        std::istringstream input(data);
+        std::ostringstream output;
+        EXPECT_THROW(importBundle(input, output, passphrase, PasswordManager::getDefaultEncryptionKey()), std::invalid_argument);
+    };
+    importFails(bundle, "wrong horse");
+    std::string tampered = bundle;
+    tampered[tampered.size() / 2] ^= 1;
+    importFails(tampered, "correct horse");
+    importFails(bundle.substr(0, bundle.size() - 1), "correct horse");
+    importFails(bundle + "x", "correct horse");
+    importFails("not a bundle", "correct horse");
+
+    // Dropping whole frames from the end is caught by the last-frame flag
+    std::istringstream oneFrame(vault.substr(0, vault.find('\n') + 1));
+    std::ostringstream single;
+    exportBundle(oneFrame, single, "correct horse", PasswordManager::getDefaultEncryptionKey(), options);
+    importFails(single.str().substr(0, 40), "correct horse");
+}
+
+TEST(StorageTestSuite, EveryEngineRoundTrips) {
+    std::vector<std::string> engines = storageEngines();
+    EXPECT_NE(std::find(engines.begin(), engines.end(), "file"), engines.end());
+    EXPECT_NE(std::find(engines.begin(), engines.end(), "memory"), engines.end());
+    EXPECT_THROW(makeStorageBackend("tape", "storageUser"), std::invalid_argument);
+
+    for (const std::string &engine : engines) {
+        SCOPED_TRACE(engine);
+        std::shared_ptr<StorageBackend> backend = makeStorageBackend(engine, "storageUser_" + engine);
+        if (!backend->vaultFile().empty()) {
+            std::filesystem::remove(backend->vaultFile());
+        }
+        std::filesystem::remove("storageUser_" + engine + "_passwords.journal");
+        std::filesystem::remove("storageUser_" + engine + "_metadata.dat");
+        std::filesystem::remove("storageUser_" + engine + "_passwords.sqlite");
+        EXPECT_FALSE(backend->exists());
+        EXPECT_THROW(backend->load(), std::ios_base::failure);
+
+        PasswordManager pm;
+        pm.setCompressOnExit(false);
+        pm.setTestCredentials("storageUser_" + engine, "secure_password");
+        pm.setStorageBackend(backend);
+        EXPECT_EQ(pm.getStorageEngine(), engine);
+        EntryId mail = pm.addNewPassword("email", "alice", "password123");
+        EntryId bank = pm.addNewPassword("bank account", "alice", "securePassword");
+        pm.addNewPassword("email", "bob", "securePassword2");
+        pm.addNewPassword("forum", "alice", "forumPassword");
+        pm.updatePassword(mail, "newMailPassword");
+        pm.deleteEntry(bank);
+        pm.deletePassword("forum");
+        pm.setMetadata("email", "bob", {"work"}, "https://mail.example.com");
+        pm.flushCredentials();
+        EXPECT_TRUE(backend->exists());
+
+        // Lookups go to storage, not to the manager's list
+        auto found = backend->findService("email");
+        ASSERT_EQ(found.size(), 2u);
+        EXPECT_EQ(found[0].second.substr(0, 6), "alice:");
+        EXPECT_EQ(PasswordManager::decryptFromHex(found[0].second.substr(6), PasswordManager::getDefaultEncryptionKey()), "newMailPassword");
+        EXPECT_TRUE(backend->findService("bank account").empty());
+
+        // A second manager on the same engine sees every change
+        PasswordManager reader;
+        reader.setCompressOnExit(false);
+        reader.setTestCredentials("storageUser_" + engine, "secure_password");
+        reader.setStorageBackend(backend);
+        reader.loadCredentialsFromFile();
+        EXPECT_EQ(reader.getCredentialList().toVector(), pm.getCredentialList().toVector());
+        EXPECT_EQ(reader.getMetadata("email", "bob")->url, "https://mail.example.com");
+
+        // Edits after a reload apply to the right records
+        EntryId bob = reader.findEntries("email", "bob").front();
+        reader.updatePassword(bob, "bobsNewPassword");
+        reader.addNewPassword("chat", "alice", "chatPassword");
+        reader.flushCredentials();
+        pm.loadCredentialsFromFile();
+        EXPECT_EQ(pm.getCredentialList().toVector(), reader.getCredentialList().toVector());
+        EXPECT_EQ(pm.getCredentialList().size(), 3u);
+    }
+}
+
+TEST(StorageTestSuite, ManagerPicksEngineByName) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("storageByNameUser", "secure_password");
+    EXPECT_EQ(pm.getStorageEngine(), "file");
+    EXPECT_THROW(pm.setStorageEngine("tape"), std::invalid_argument);
+    EXPECT_EQ(pm.getStorageEngine(), "file");
+
+    // The memory engine keeps the vault away from the disk, and re-keys in memory
+    pm.setStorageEngine("memory");
+    std::filesystem::remove(pm.getVaultFileName());
+    pm.addNewPassword("email", "alice", "password123");
+    EXPECT_FALSE(std::filesystem::exists(pm.getVaultFileName()));
+    const std::string oldKey = pm.getEncryptionKey();
+    RekeyStats stats = pm.rekey("another_key_for_the_memory_engine!");
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(pm.getAllDecryptedCredentials().front().second, "alice:password123");
+    pm.rekey(oldKey);
+    EXPECT_EQ(pm.getEncryptionKey(), oldKey);
+    EXPECT_EQ(pm.getAllDecryptedCredentials().front().second, "alice:password123");
+}
+
+TEST(AsyncIoTestSuite, BatchedReadsAndWritesOnEveryEngine) {
+    for (bool useIoUring : {true, false}) {
+        AsyncIoOptions options;
+        options.useIoUring = useIoUring;
+        options.queueDepth = 2;   // Fewer slots than files, so operations wait for each other
+        options.bufferSize = 4096; // And files larger than a buffer take several rounds
+        AsyncFileIO io(options);
+        SCOPED_TRACE(io.engineName());
+        if (!useIoUring) {
+            EXPECT_EQ(io.engine(), AsyncFileIO::Engine::ThreadPool);
+        }
+        std::filesystem::remove_all("test_async_io");
+        std::filesystem::create_directories("test_async_io");
+
+        std::string large;
+        for (int i = 0; i < 2000; ++i) {
+            large += "service" + std::to_string(i) + " user:" + std::to_string(i * 7919) + "\n";
+        }
+        std::vector<std::pair<std::string, std::string>> files = {
+            {"test_async_io/large", large}, {"test_async_io/empty", ""}, {"test_async_io/small", "one line\n"}};
+        std::vector<FileResult> written = io.writeAll(files, true);
+        ASSERT_EQ(written.size(), 3u);
+        for (const auto &result : written) {
+            EXPECT_FALSE(result.error) << result.path;
+        }
+        EXPECT_THROW(io.write("test_async_io/missing/file", "data", false).get(), std::ios_base::failure);
+
+        std::vector<FileResult> read = io.readAll({"test_async_io/large", "test_async_io/missing", "test_async_io/empty",
+                                                   "test_async_io/small"});
+        ASSERT_EQ(read.size(), 4u);
+        EXPECT_EQ(read[0].contents, large);
+        EXPECT_THROW(std::rethrow_exception(read[1].error), std::ios_base::failure);
+        EXPECT_FALSE(read[2].error);
+        EXPECT_EQ(read[2].contents, "");
+        EXPECT_EQ(io.read("test_async_io/small").get(), "one line\n");
+
+        // Only whole files are ever visible: no temp files are left behind
+        size_t entries = std::distance(std::filesystem::directory_iterator("test_async_io"),
+                                       std::filesystem::directory_iterator());
+        EXPECT_EQ(entries, 3u);
+    }
+    std::filesystem::remove_all("test_async_io");
+}
+
+TEST(VaultStoreTestSuite, ExportCopiesVaultsWithTheirJournals) {
+    VaultStoreOptions options;
+    options.io.queueDepth = 4;
+    {
+        VaultStore store("test_vault_store", options);
+        for (int i = 0; i < 5; ++i) {
+            auto manager = store.open("user" + std::to_string(i));
+            manager->addNewPassword("service", "name", "password123");
+            manager->addNewPassword("other", "name", "password456");
+        }
+        // One vault has an edit that only lives in its journal
+        auto edited = store.open("user3");
+        edited->updatePassword(edited->findEntries("other").front(), "journaledPassword");
+        edited->flushCredentials();
+
+        ExportReport report = store.exportAll("test_vault_export", false);
+        EXPECT_EQ(report.vaults, 5u);
+        EXPECT_TRUE(report.failures.empty());
+        EXPECT_GE(report.files, 6u);
+        EXPECT_TRUE(store.exportVaults({"../escape"}, "test_vault_export", false).failures.size() == 1);
+
+        PasswordManager copy;
+        copy.setCompressOnExit(false);
+        copy.setUsername("user3");
+        copy.setVaultDirectory("test_vault_export");
+        copy.loadCredentialsFromFile();
+        EXPECT_EQ(copy.getAllDecryptedCredentials()[1].second, "name:journaledPassword");
+
+        // Preload reads through the same engine and sees the journaled edit too
+        VaultStore fresh("test_vault_store", options);
+        PreloadReport preload = fresh.preloadAll(true);
+        EXPECT_EQ(preload.loaded, 5u);
+        EXPECT_EQ(fresh.open("user3")->getAllDecryptedCredentials()[1].second, "name:journaledPassword");
+    }
+    std::filesystem::remove_all("test_vault_store");
+    std::filesystem::remove_all("test_vault_export");
+}
+
+TEST(AsyncTaskTestSuite, ContinuationsRunOnTheLoopThread) {
+    Executor executor(2);
+    std::thread::id loop = std::this_thread::get_id();
+    std::vector<std::thread::id> seen;
+
+    Task<int> chained = executor.offload([]() { return 20; })
+                            .then([&](int value) {
+                                seen.push_back(std::this_thread::get_id());
+                                return executor.offload([value]() { return value + 1; }); // Waited for too
+                            })
+                            .then([&](int value) {
+                                seen.push_back(std::this_thread::get_id());
+                                return value * 2;
+                            });
+    EXPECT_FALSE(chained.ready());
+    EXPECT_EQ(executor.run(chained), 42);
+    EXPECT_EQ(seen, std::vector<std::thread::id>({loop, loop}));
+
+    // Errors skip the continuations that expect a value
+    bool skipped = true;
+    Task<void> failing = executor.offload([]() -> int { throw std::ios_base::failure("disk"); })
+                             .then([&](int) { skipped = false; });
+    EXPECT_THROW(executor.run(failing), std::ios_base::failure);
+    EXPECT_TRUE(skipped);
+
+    // Continuations of a finished task still wait for the loop
+    int counted = 0;
+    Task<void> later = executor.completed(5).then([&](int value) { counted = value; });
+    EXPECT_EQ(counted, 0);
+    EXPECT_EQ(executor.run(), 1u);
+    EXPECT_EQ(counted, 5);
+    EXPECT_TRUE(later.ready());
+    EXPECT_THROW(Task<int>().get(), std::logic_error);
+
+    // A task takes one continuation, even through a copy
+    Task<int> pending = executor.offload([]() { return 1; });
+    Task<int> copy = pending;
+    pending.then([](int) {});
+    EXPECT_THROW(copy.then([](int) {}), std::logic_error);
+    executor.run();
+}
+
+TEST(AsyncTaskTestSuite, ManagersSaveLoadAndDecryptConcurrently) {
+    Executor executor(2);
+    std::vector<std::unique_ptr<PasswordManager>> managers;
+    for (int i = 0; i < 20; ++i) {
+        managers.push_back(std::make_unique<PasswordManager>());
+        managers.back()->setCompressOnExit(false);
+        managers.back()->setUsername("test_async_user" + std::to_string(i));
+        managers.back()->addNewPassword("service", "name", "password" + std::to_string(i * 1000));
+    }
+
+    // Every vault saves twice and reloads, all in flight at once; the second save carries an edit
+    std::vector<Task<std::optional<std::string>>> sessions;
+    for (auto &manager : managers) {
+        PasswordManager *vault = manager.get();
+        vault->updatePassword(vault->findEntries("service").front(), "changedPassword");
+        vault->saveAsync(executor);
+        vault->addNewPassword("later", "name", "laterPassword");
+        sessions.push_back(vault->saveAsync(executor)
+                               .then([vault, &executor]() { return vault->loadAsync(executor); })
+                               .then([vault, &executor]() { return vault->getDecryptedCredentialAsync("later", executor); }));
+    }
+    executor.run();
+    for (size_t i = 0; i < managers.size(); ++i) {
+        ASSERT_TRUE(sessions[i].ready());
+        EXPECT_EQ(sessions[i].get(), std::optional<std::string>("laterPassword"));
+        EXPECT_EQ(managers[i]->getPasswordCount(), 2u);
+    }
+    EXPECT_EQ(executor.run(managers[0]->getDecryptedCredentialAsync("missing", executor)), std::nullopt);
+
+    // A blocking load waits for the save still writing
+    PasswordManager &first = *managers[0];
+    first.addNewPassword("third", "name", "thirdPassword");
+    first.saveAsync(executor);
+    PasswordManager reader;
+    reader.setCompressOnExit(false);
+    reader.setUsername(first.getUsername());
+    first.loadCredentialsFromFile();
+    reader.loadCredentialsFromFile();
+    EXPECT_EQ(reader.getPasswordCount(), 3u);
+    executor.run();
+
+    // Other engines load on the loop
+    PasswordManager memory;
+    memory.setCompressOnExit(false);
+    memory.setStorageEngine("memory");
+    memory.addNewPassword("service", "name", "memoryPassword");
+    executor.run(memory.saveAsync(executor));
+    executor.run(memory.loadAsync(executor));
+    EXPECT_EQ(executor.run(memory.getDecryptedCredentialAsync("service", executor)), std::optional<std::string>("memoryPassword"));
+
+    for (auto &manager : managers) {
+        std::filesystem::remove(manager->getVaultFileName());
+        std::filesystem::remove(manager->getJournalFileName());
+        std::filesystem::remove(manager->getMetadataFileName());
+    }
+}
+
+TEST(AsyncTaskTestSuite, FailedSaveKeepsMetadataUnsaved) {
+    struct FailingBackend : MemoryBackend {
+        bool failing = true;
+        int metadataSaves = 0;
+        void saveMetadata(const std::string &text) override {
+            if (failing) {
+                throw std::ios_base::failure("Disk full.");
+            }
+            ++metadataSaves;
+            MemoryBackend::saveMetadata(text);
+        }
+    };
+    auto backend = std::make_shared<FailingBackend>();
+    backend->failing = false;
+
+    Executor executor(1);
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setTestCredentials("asyncFailUser", "secure_password");
+    pm.setStorageBackend(backend);
+    EntryId mail = pm.addNewPassword("email", "alice", "password123");
+    pm.updatePassword(mail, "newMailPassword"); // Leaves a metadata change unsaved
+
+    backend->failing = true;
+    EXPECT_THROW(executor.run(pm.saveAsync(executor)), std::ios_base::failure);
+    backend->failing = false;
+    int saves = backend->metadataSaves;
+    pm.flushCredentials();
+    EXPECT_EQ(backend->metadataSaves, saves + 1);
+    EXPECT_EQ(executor.run(pm.getDecryptedCredentialAsync("email", executor)), std::optional<std::string>("newMailPassword"));
+}
+
+TEST(TaskSchedulerTestSuite, StealsNestedWorkAndRethrowsFailures) {
+    SchedulerOptions options;
+    options.threads = 2;
+    TaskScheduler scheduler(options);
+
+    std::atomic<size_t> sum{0};
+    parallelFor(0, 100000, 64, [&](size_t first, size_t last) {
+        size_t local = 0;
+        for (size_t i = first; i < last; ++i) {
+            local += i;
+        }
+        sum += local;
+    }, scheduler);
+    EXPECT_EQ(sum.load(), size_t(100000) * 99999 / 2);
+
+    // Groups waited for inside tasks, more of them than workers: waiting runs other tasks instead of blocking
+    std::atomic<int> leaves{0};
+    TaskGroup outer(scheduler);
+    for (int i = 0; i < 8; ++i) {
+        outer.run([&]() {
+            TaskGroup inner(scheduler);
+            for (int j = 0; j < 50; ++j) {
+                inner.run([&]() { ++leaves; });
+            }
+            inner.wait();
+        });
+    }
+    outer.wait();
+    EXPECT_EQ(leaves.load(), 400);
+
+    TaskGroup failing(scheduler);
+    failing.run([]() { throw std::invalid_argument("bad entry"); });
+    failing.run([]() {});
+    EXPECT_THROW(failing.wait(), std::invalid_argument);
+    failing.wait(); // The error was reported once
+
+    // Only a task a worker has already started may block: the waiter would run a queued one itself
+    std::promise<void> start;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    TaskGroup slow(scheduler);
+    slow.run([&start, released]() {
+        start.set_value();
+        released.wait();
+    });
+    start.get_future().wait();
+    EXPECT_FALSE(slow.waitFor(std::chrono::milliseconds(5)));
+    release.set_value();
+    EXPECT_TRUE(slow.waitFor(std::chrono::seconds(10)));
+}
+
+TEST(PasswordManagerTestSuite, DecryptsLargeVaultsInParallelChunks) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setStorageEngine("memory");
+    CredentialList list;
+    for (int i = 0; i < 3000; ++i) {
+        list.push_back({"service" + std::to_string(i), "user:" + PasswordManager::encryptToHex("password" + std::to_string(i), PasswordManager::getDefaultEncryptionKey())});
+    }
+    pm.restoreCredentialList(list);
+
+    size_t lastCompleted = 0, lastTotal = 0;
+    auto credentials = pm.getAllDecryptedCredentials(
+        [&](size_t completed, size_t total) {
+            lastCompleted = completed;
+            lastTotal = total;
+        },
+        CancellationToken());
+    ASSERT_EQ(credentials.size(), 3000u);
+    EXPECT_EQ(credentials[2999].second, "user:password2999");
+    EXPECT_EQ(credentials[1024].first, "service1024");
+    EXPECT_EQ(lastCompleted, 3000u);
+    EXPECT_EQ(lastTotal, 3000u);
+
+    auto page = pm.getSecureCredentials(1000, 1500);
+    ASSERT_EQ(page.size(), 1500u);
+    EXPECT_EQ(page[1499].password, "password2499");
+
+    CancellationToken cancel;
+    cancel.cancel();
+    EXPECT_THROW(pm.getAllDecryptedCredentials(ProgressCallback(), cancel), OperationCancelled);
+}
+
+TEST(PropertyTestSuite, BatchCipherMatchesEvpOnEveryEngine) {
+    const std::string key(32, 'k');
+    const std::string otherKey(32, 'o');
+    std::vector<std::string> plaintexts;
+    for (size_t length = 0; length <= 40; ++length) {
+        plaintexts.push_back(std::string(length, static_cast<char>('a' + length % 26)));
+    }
+    std::vector<std::vector<unsigned char>> expected;
+    for (const auto &plaintext : plaintexts) {
+        expected.push_back(EncryptionNS::encrypt(plaintext, key));
+    }
+
+    // Entries that are not whole blocks, or carry a pad the wrong key makes of them, must fail as EVP fails
+    std::vector<std::vector<unsigned char>> mixed = {{}, std::vector<unsigned char>(15, 1)};
+    std::vector<bool> evpFails = {true, true};
+    for (size_t i = 0; i < plaintexts.size(); ++i) {
+        mixed.push_back(EncryptionNS::encrypt(plaintexts[i], otherKey));
+        bool fails = false;
+        try {
+            EncryptionNS::decrypt(mixed.back(), key);
+        } catch (const std::invalid_argument &) {
+            fails = true;
+        }
+        evpFails.push_back(fails);
+        mixed.push_back(expected[i]);
+        evpFails.push_back(false);
+    }
+
+    std::vector<std::string> engines = EncryptionNS::batchCipherEngines();
+    ASSERT_FALSE(engines.empty());
+    EXPECT_EQ(engines.back(), "evp");
+    for (const std::string &engine : engines) {
+        SCOPED_TRACE(engine);
+        EncryptionNS::setBatchCipherEngine(engine);
+        EXPECT_EQ(EncryptionNS::batchCipherEngine(), engine);
+        EXPECT_EQ(EncryptionNS::encryptBatch(plaintexts, key), expected);
+        EXPECT_EQ(EncryptionNS::decryptBatch(expected, key), plaintexts);
+        auto secure = EncryptionNS::decryptSecureBatch(expected, key);
+        ASSERT_EQ(secure.size(), plaintexts.size());
+        EXPECT_EQ(secure[40], plaintexts[40]);
+
+        std::vector<bool> failed;
+        auto decrypted = EncryptionNS::decryptBatch(mixed, key, &failed);
+        EXPECT_EQ(failed, evpFails);
+        EXPECT_TRUE(decrypted[0].empty() && decrypted[1].empty());
+        EXPECT_THROW(EncryptionNS::decryptBatch(mixed, key), std::invalid_argument);
+        EXPECT_THROW(EncryptionNS::encryptBatch(plaintexts, "short key"), std::invalid_argument);
+    }
+    EXPECT_THROW(EncryptionNS::setBatchCipherEngine("rot13"), std::invalid_argument);
+    EncryptionNS::setBatchCipherEngine(engines.front());
+}
+
+TEST(PropertyTestSuite, RecordSchemaRoundTripsTextAndBinary) {
+    // Service names keep their spaces; the account is split at its first colon
+    VaultRecordView record;
+    ASSERT_TRUE(VaultRecordSchema::decodeText("my bank account alice:00ff", record));
+    EXPECT_EQ(record.service, "my bank account");
+    EXPECT_EQ(record.username, "alice");
+    EXPECT_EQ(record.passwordHex, "00ff");
+    EXPECT_FALSE(VaultRecordSchema::decodeText("nospace", record));
+    EXPECT_FALSE(VaultRecordSchema::decodeText(" alice:00", record));
+    EXPECT_FALSE(VaultRecordSchema::decodeText("service alice", record));
+
+    // The line schema accepts exactly what parseVaultRecord always has
+    for (const std::string line : {"a b", "a b c", " a", "a ", "a", "", "svc user:", "svc :hex", "x y:z:w"}) {
+        VaultLineView view;
+        std::pair<std::string, std::string> parsed;
+        bool expected = line.rfind(' ') != std::string::npos && line.rfind(' ') != 0 && line.back() != ' ';
+        EXPECT_EQ(VaultLineSchema::decodeText(line, view), expected) << line;
+        EXPECT_EQ(PasswordManager::parseVaultRecord(line, parsed), expected) << line;
+        if (expected) {
+            EXPECT_EQ(VaultLineSchema::textSize(view), line.size());
+            EXPECT_EQ(parsed.first + " " + parsed.second, line);
+        }
+    }
+
+    // Binary fields are length-prefixed, so they may hold the text delimiters and any byte
+    std::string service("a b\n\0c", 6);
+    VaultRecordView original{service, "user", ""};
+    std::string binary;
+    VaultRecordSchema::appendBinary(original, binary);
+    VaultRecordSchema::appendBinary(original, binary);
+    ASSERT_EQ(binary.size(), 2 * VaultRecordSchema::binarySize(original));
+    std::string_view input(binary);
+    for (int i = 0; i < 2; ++i) {
+        VaultRecordView decoded;
+        ASSERT_TRUE(VaultRecordSchema::decodeBinary(input, decoded));
+        EXPECT_EQ(decoded.service, service);
+        EXPECT_EQ(decoded.username, "user");
+        EXPECT_TRUE(decoded.passwordHex.empty());
+    }
+    EXPECT_TRUE(input.empty());
+    for (size_t cut = 0; cut < binary.size() / 2; ++cut) {
+        std::string_view truncated(binary.data(), cut);
+        EXPECT_FALSE(VaultRecordSchema::decodeBinary(truncated, record)) << cut;
+    }
+
+    std::vector<std::pair<std::string, std::string>> entries = {{"mail", "bob:0a"}, {"two words", "eve:"}};
+    EXPECT_EQ(vaultText(entries), "mail bob:0a\ntwo words eve:\n");
+    EXPECT_EQ(vaultTextSize(entries), vaultText(entries).size());
+}
+
+TEST(PasswordManagerTestSuite, PassesRecordsWithoutUsernameThroughDecryption) {
+    PasswordManager pm;
+    pm.setCompressOnExit(false);
+    pm.setStorageEngine("memory");
+    CredentialList list;
+    list.push_back({"legacy", "no-delimiter-here"});
+    list.push_back({"mail", "bob:" + PasswordManager::encryptToHex("password1", PasswordManager::getDefaultEncryptionKey())});
+    pm.restoreCredentialList(list);
+
+    auto all = pm.getAllDecryptedCredentials();
+    ASSERT_EQ(all.size(), 2u);
+    EXPECT_EQ(all[0].second, "no-delimiter-here");
+    EXPECT_EQ(all[1].second, "bob:password1");
+    auto page = pm.getDecryptedCredentials(0, 1);
+    ASSERT_EQ(page.size(), 1u);
+    EXPECT_EQ(page[0].second, "no-delimiter-here");
+    auto secure = pm.getSecureCredentials(0, 2);
+    EXPECT_FALSE(secure[0].encrypted);
+    EXPECT_TRUE(secure[1].encrypted);
+}
+
+TEST(PasswordManagerTestSuite, MovedFromManagerLeavesStorageAlone) {
+    struct CountingBackend : MemoryBackend {
+        int metadataSaves = 0;
+        void saveMetadata(const std::string &text) override {
+            ++metadataSaves;
+            MemoryBackend::saveMetadata(text);
+        }
+    };
+    auto backend = std::make_shared<CountingBackend>();
+    int saves = 0;
+
+    PasswordManager target;
+    target.setCompressOnExit(false);
+    {
+        PasswordManager source;
+        source.setCompressOnExit(false);
+        source.setTestCredentials("moveUser", "secure_password");
+        source.setStorageBackend(backend);
+        EntryId mail = source.addNewPassword("email", "alice", "password123");
+        source.setMetadata("email", "alice", {"work"}, "");
+        source.updatePassword(mail, "newMailPassword"); // Leaves a metadata change unsaved
+        saves = backend->metadataSaves;
+
+        PasswordManager moved(std::move(source));
+        target = std::move(moved);
+    } // Both moved-from managers flush here, with nothing left to save
+    EXPECT_EQ(backend->metadataSaves, saves);
+
+    // The change moved with the vault and is saved by its new owner
+    target.flushCredentials();
+    EXPECT_EQ(backend->metadataSaves, saves + 1);
+    EXPECT_EQ(target.getMetadata("email", "alice")->tags, (std::vector<std::string>{"work"}));
+}
+
 } // namespace
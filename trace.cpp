@@ -0,0 +1,110 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace TraceNS {
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+    uint32_t threadId;
+};
+
+const auto processStart = std::chrono::steady_clock::now();
+
+std::atomic<bool> enabled{false};
+std::mutex eventsMutex;
+std::vector<TraceEvent> events;
+std::string outputFile;
+
+// Small sequential ids read better in the trace viewer than native thread ids
+uint32_t currentThreadId() {
+    static std::atomic<uint32_t> nextId{1};
+    thread_local uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void writeJsonString(std::ostream &out, const char *text) {
+    out << '"';
+    for (const char *c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+// Start Collecting Events
+void start(const std::string &outputPath) {
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    outputFile = outputPath;
+    events.clear();
+    events.reserve(1024);
+    enabled.store(true, std::memory_order_release);
+}
+
+// Start Tracing When Requested by the Environment
+bool startFromEnvironment() {
+    const char *path = std::getenv("PASSWORD_MANAGER_TRACE");
+    if (path == nullptr || *path == '\0') {
+        return false;
+    }
+    start(path);
+    return true;
+}
+
+// Write the Trace File
+void stop() {
+    if (!enabled.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    std::ofstream file(outputFile, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open '" << outputFile << "' for writing the trace." << std::endl;
+        return;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent &event = events[i];
+        file << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(file, event.name);
+        file << ",\"cat\":\"password_manager\",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.duration
+             << ",\"pid\":1,\"tid\":" << event.threadId << "}";
+    }
+    file << "\n]}\n";
+    events.clear();
+}
+
+bool isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t now() {
+    auto elapsed = std::chrono::steady_clock::now() - processStart;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()) + 1;
+}
+
+// Record a Complete Event
+void record(const char *name, uint64_t startMicros, uint64_t endMicros) {
+    if (!isEnabled()) {
+        return;
+    }
+    uint32_t threadId = currentThreadId();
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    events.push_back({name, startMicros, endMicros >= startMicros ? endMicros - startMicros : 0, threadId});
+}
+
+} // namespace TraceNS
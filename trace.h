@@ -0,0 +1,60 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Lightweight startup/operation tracing that writes Chrome trace-event JSON
+// (open the file in chrome://tracing or https://ui.perfetto.dev).
+// Tracing is off unless started; a disabled scope costs a single flag check.
+namespace TraceNS
+{
+
+    // Starts collecting events; they are written to outputPath by stop()
+    void start(const std::string &outputPath);
+
+    // Starts tracing if PASSWORD_MANAGER_TRACE names an output file; returns whether it did
+    bool startFromEnvironment();
+
+    // Writes collected events to the output file and stops tracing
+    void stop();
+
+    bool isEnabled();
+
+    // Microseconds on the trace clock (steady_clock since process start, never 0)
+    uint64_t now();
+
+    // Records a complete event spanning [startMicros, endMicros] on the calling thread (dropped when disabled)
+    void record(const char *name, uint64_t startMicros, uint64_t endMicros);
+
+    // Records the lifetime of the enclosing scope
+    class ScopedTimer
+    {
+    private:
+        const char *name;
+        uint64_t startMicros;
+
+    public:
+        explicit ScopedTimer(const char *eventName) : name(eventName), startMicros(isEnabled() ? now() : 0) {}
+        ~ScopedTimer()
+        {
+            if (startMicros != 0)
+            {
+                record(name, startMicros, now());
+            }
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+    };
+
+} // namespace TraceNS
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Usage: TRACE_SCOPE("vault.load"); — name must be a string literal
+#define TRACE_SCOPE(name) TraceNS::ScopedTimer TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif
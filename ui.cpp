@@ -4,9 +4,15 @@
 #include <wx/textctrl.h>
 #include <wx/valtext.h>
 #include <wx/valnum.h>
+#include <wx/filedlg.h>
 #include <sstream>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
+#include <type_traits>
+#include "batch_io.h"
+#include "trace.h"
+#include "metrics.h"
 
 namespace PasswordNS {
 
@@ -14,12 +20,30 @@ namespace PasswordNS {
 wxIMPLEMENT_APP(PasswordManagerApp);
 
 bool PasswordManagerApp::OnInit() {
+    // Set PASSWORD_MANAGER_TRACE=startup.json to record a Chrome trace of startup and login
+    TraceNS::startFromEnvironment();
+    TRACE_SCOPE("app.init");
+
     PasswordManager* manager = new PasswordManager();
+    manager->setDurability(Durability::Sync); // One save per click, so each can afford its own fsync
+    manager->setMinimumStrength(2); // Interactive entries must resist an online guessing attack, not just be long
     LoginFrame* login = new LoginFrame("Password Manager - Login/Register", *manager);
     login->Show(true);
     return true;
 }
 
+int PasswordManagerApp::OnExit() {
+    TraceNS::stop();
+    // Set PASSWORD_MANAGER_METRICS=metrics.prom (or .txt) to keep operation latencies from this session
+    try {
+        MetricsNS::writeSnapshotFromEnvironment();
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+    return wxApp::OnExit();
+}
+
 // Implement the Login/Register Frame
 LoginFrame::LoginFrame(const wxString& title, PasswordManager& manager)
     : wxFrame(NULL, wxID_ANY, title, wxDefaultPosition, wxSize(400, 300)),
@@ -73,14 +97,25 @@ void LoginFrame::OnLogin(wxCommandEvent& event) {
         return;
     }
 
+    uint64_t loginStart = TraceNS::now();
+    TRACE_SCOPE("login");
     passwordManager.setTestCredentials(std::string(username.mb_str()), std::string(password.mb_str()));
 
     try {
+        passwordManager.setEncryptionKey(PasswordManager::startupEncryptionKey(std::string(username.mb_str())));
+        passwordManager.restoreUserCredentials();
         if (passwordManager.loadUserCredentialsFromFile()) {
-            // Successful login
-            wxMessageBox("Login successful!", "Info", wxOK | wxICON_INFORMATION);
+            // Successful login: load the user's vault and go straight to the main menu
+            if (std::filesystem::exists(passwordManager.getVaultFileName())) {
+                passwordManager.loadCredentialsFromFile();
+            }
+
             MainMenuFrame* mainMenu = new MainMenuFrame("Password Manager - Main Menu", passwordManager);
             mainMenu->Show(true);
+            // Runs once the event loop has processed the frame's show/paint events
+            mainMenu->CallAfter([loginStart]() {
+                TraceNS::record("main_menu.first_render", loginStart, TraceNS::now());
+            });
             this->Close();
         } else {
             wxMessageBox("Invalid username or password.", "Error", wxOK | wxICON_ERROR);
@@ -103,8 +138,10 @@ void LoginFrame::OnRegister(wxCommandEvent& event) {
     passwordManager.setTestCredentials(std::string(username.mb_str()), std::string(password.mb_str()));
 
     try {
-        if (!passwordManager.validate(std::string(password.mb_str()))) {
-            wxMessageBox("Password is too weak. Must be longer than 8 characters.", "Error", wxOK | wxICON_ERROR);
+        passwordManager.setEncryptionKey(PasswordManager::startupEncryptionKey(std::string(username.mb_str())));
+        std::string weakness = passwordManager.describeWeakness(std::string(password.mb_str()));
+        if (!weakness.empty()) {
+            wxMessageBox("Password is too weak. " + weakness, "Error", wxOK | wxICON_ERROR);
             return;
         }
 
@@ -116,10 +153,67 @@ void LoginFrame::OnRegister(wxCommandEvent& event) {
     }
 }
 
+// Implement the Virtual Credential List
+CredentialListCtrl::CredentialListCtrl(wxWindow* parent, const PasswordManager& manager)
+    : wxListCtrl(parent, wxID_ANY, wxDefaultPosition, wxSize(580, 340), wxLC_REPORT | wxLC_VIRTUAL | wxLC_SINGLE_SEL),
+      passwordManager(manager) {
+    AppendColumn("Service", wxLIST_FORMAT_LEFT, 180);
+    AppendColumn("Username", wxLIST_FORMAT_LEFT, 180);
+    AppendColumn("Password", wxLIST_FORMAT_LEFT, 200);
+    SetItemCount(static_cast<long>(passwordManager.getPasswordCount()));
+
+    Bind(wxEVT_LIST_CACHE_HINT, &CredentialListCtrl::OnCacheHint, this);
+}
+
+const CredentialListCtrl::Page& CredentialListCtrl::GetPage(size_t pageIndex) const {
+    auto it = pages.find(pageIndex);
+    if (it != pages.end()) {
+        pageOrder.remove(pageIndex);
+        pageOrder.push_front(pageIndex);
+        return it->second;
+    }
+
+    // Evict the least recently used page before decrypting a new one
+    if (pages.size() >= MaxCachedPages) {
+        pages.erase(pageOrder.back());
+        pageOrder.pop_back();
+    }
+    pageOrder.push_front(pageIndex);
+    return pages[pageIndex] = passwordManager.getSecureCredentials(pageIndex * PageSize, PageSize);
+}
+
+wxString CredentialListCtrl::OnGetItemText(long item, long column) const {
+    const Page& page = GetPage(static_cast<size_t>(item) / PageSize);
+    size_t row = static_cast<size_t>(item) % PageSize;
+    if (row >= page.size()) {
+        return wxEmptyString;
+    }
+
+    const SecureCredential& credential = page[row];
+    switch (column) {
+    case 0:
+        return wxString(credential.service);
+    case 1:
+        return wxString(credential.username);
+    default:
+        return wxString::FromUTF8(credential.password.data(), credential.password.size());
+    }
+}
+
+void CredentialListCtrl::OnCacheHint(wxListEvent& event) {
+    // Decrypt the pages about to be shown in one go
+    size_t firstPage = static_cast<size_t>(event.GetCacheFrom()) / PageSize;
+    size_t lastPage = static_cast<size_t>(event.GetCacheTo()) / PageSize;
+    for (size_t page = firstPage; page <= lastPage && page - firstPage < MaxCachedPages; ++page) {
+        GetPage(page);
+    }
+}
+
 // Implement the Main Menu Frame
 MainMenuFrame::MainMenuFrame(const wxString& title, PasswordManager& manager)
     : wxFrame(NULL, wxID_ANY, title, wxDefaultPosition, wxSize(500, 400)),
-      passwordManager(manager) {
+      passwordManager(manager),
+      vaultWorker(std::make_unique<WorkerPool>(1)) {
 
     wxPanel* panel = new wxPanel(this, wxID_ANY);
 
@@ -136,6 +230,7 @@ MainMenuFrame::MainMenuFrame(const wxString& title, PasswordManager& manager)
     retrievePasswordButton = new wxButton(panel, wxID_ANY, wxT("Retrieve a Password"));
     deletePasswordButton = new wxButton(panel, wxID_ANY, wxT("Delete a Password"));
     viewAllPasswordsButton = new wxButton(panel, wxID_ANY, wxT("View All Passwords"));
+    exportVaultButton = new wxButton(panel, wxID_ANY, wxT("Export Vault"));
     exitButton = new wxButton(panel, wxID_ANY, wxT("Exit"));
 
     vbox->Add(addPasswordButton, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 10);
@@ -143,12 +238,23 @@ MainMenuFrame::MainMenuFrame(const wxString& title, PasswordManager& manager)
     vbox->Add(retrievePasswordButton, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 10);
     vbox->Add(deletePasswordButton, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 10);
     vbox->Add(viewAllPasswordsButton, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 10);
+    vbox->Add(exportVaultButton, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 10);
     vbox->Add(exitButton, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 10);
 
     // Message
     message = new wxStaticText(panel, wxID_ANY, wxT(""), wxDefaultPosition, wxDefaultSize, wxST_NO_AUTORESIZE);
     vbox->Add(message, 0, wxALIGN_CENTER | wxTOP, 10);
 
+    // Progress of background operations (hidden while idle)
+    wxBoxSizer* progressBox = new wxBoxSizer(wxHORIZONTAL);
+    progressGauge = new wxGauge(panel, wxID_ANY, 100);
+    cancelTaskButton = new wxButton(panel, wxID_ANY, wxT("Cancel"));
+    progressBox->Add(progressGauge, 1, wxALIGN_CENTER_VERTICAL);
+    progressBox->Add(cancelTaskButton, 0, wxLEFT, 5);
+    vbox->Add(progressBox, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 10);
+    progressGauge->Hide();
+    cancelTaskButton->Hide();
+
     panel->SetSizer(vbox);
 
     // Bind Events
@@ -157,9 +263,81 @@ MainMenuFrame::MainMenuFrame(const wxString& title, PasswordManager& manager)
     Bind(wxEVT_BUTTON, &MainMenuFrame::OnRetrievePassword, this, retrievePasswordButton->GetId());
     Bind(wxEVT_BUTTON, &MainMenuFrame::OnDeletePassword, this, deletePasswordButton->GetId());
     Bind(wxEVT_BUTTON, &MainMenuFrame::OnViewAllPasswords, this, viewAllPasswordsButton->GetId());
+    Bind(wxEVT_BUTTON, &MainMenuFrame::OnExportVault, this, exportVaultButton->GetId());
+    Bind(wxEVT_BUTTON, &MainMenuFrame::OnCancelTask, this, cancelTaskButton->GetId());
     Bind(wxEVT_BUTTON, &MainMenuFrame::OnExit, this, exitButton->GetId());
 }
 
+MainMenuFrame::~MainMenuFrame() {
+    // Stop any running task and join the worker before the frame goes away;
+    // results it already queued with CallAfter are discarded with the frame.
+    currentTask.cancel();
+    vaultWorker.reset();
+}
+
+template <typename Work, typename Done>
+void MainMenuFrame::RunVaultTask(const wxString& label, Work work, Done onDone) {
+    using Result = std::invoke_result_t<Work, const ProgressCallback&, const CancellationToken&>;
+
+    CancellationToken token;
+    currentTask = token;
+    SetBusy(true, label);
+
+    vaultWorker->submit([this, token, work, onDone]() {
+        // Only post to the GUI thread when the visible percentage changes
+        auto lastPercent = std::make_shared<int>(-1);
+        ProgressCallback progress = [this, lastPercent](size_t completed, size_t total) {
+            int percent = total == 0 ? 100 : static_cast<int>(completed * 100 / total);
+            if (percent != *lastPercent) {
+                *lastPercent = percent;
+                CallAfter([this, percent]() { progressGauge->SetValue(percent); });
+            }
+        };
+
+        try {
+            Result result = work(progress, token);
+            CallAfter([this, result, onDone]() {
+                SetBusy(false);
+                onDone(result);
+            });
+        }
+        catch (const OperationCancelled&) {
+            CallAfter([this]() {
+                SetBusy(false);
+                message->SetLabel("Operation cancelled.");
+            });
+        }
+        catch (const std::exception& e) {
+            std::string error = e.what();
+            CallAfter([this, error]() {
+                SetBusy(false);
+                wxMessageBox(error, "Error", wxOK | wxICON_ERROR);
+            });
+        }
+    });
+}
+
+void MainMenuFrame::SetBusy(bool busy, const wxString& label) {
+    // Vault buttons stay disabled while a task runs so operations never overlap
+    addPasswordButton->Enable(!busy);
+    generatePasswordButton->Enable(!busy);
+    retrievePasswordButton->Enable(!busy);
+    deletePasswordButton->Enable(!busy);
+    viewAllPasswordsButton->Enable(!busy);
+    exportVaultButton->Enable(!busy);
+
+    progressGauge->SetValue(0);
+    progressGauge->Show(busy);
+    cancelTaskButton->Show(busy);
+    message->SetLabel(label);
+    Layout();
+}
+
+void MainMenuFrame::OnCancelTask(wxCommandEvent& event) {
+    currentTask.cancel();
+    message->SetLabel("Cancelling...");
+}
+
 void MainMenuFrame::OnAddPassword(wxCommandEvent& event) {
     wxDialog* dialog = new wxDialog(this, wxID_ANY, "Add a New Password", wxDefaultPosition, wxSize(400, 300));
     wxPanel* panel = new wxPanel(dialog, wxID_ANY);
@@ -210,13 +388,19 @@ void MainMenuFrame::OnAddPassword(wxCommandEvent& event) {
             return;
         }
 
-        try {
-            passwordManager.addNewPassword(std::string(service.mb_str()), std::string(username.mb_str()), std::string(password.mb_str()));
-            wxMessageBox("Password added successfully.", "Info", wxOK | wxICON_INFORMATION);
-        }
-        catch (const std::exception& e) {
-            wxMessageBox(e.what(), "Error", wxOK | wxICON_ERROR);
-        }
+        std::string serviceName(service.mb_str());
+        std::string serviceUsername(username.mb_str());
+        std::string servicePassword(password.mb_str());
+
+        // Encrypting and rewriting the vault happens on the worker
+        RunVaultTask("Adding password...",
+            [this, serviceName, serviceUsername, servicePassword](const ProgressCallback&, const CancellationToken&) {
+                passwordManager.addNewPassword(serviceName, serviceUsername, servicePassword);
+                return true;
+            },
+            [](bool) {
+                wxMessageBox("Password added successfully.", "Info", wxOK | wxICON_INFORMATION);
+            });
     }
 
     dialog->Destroy();
@@ -310,13 +494,17 @@ void MainMenuFrame::OnGeneratePassword(wxCommandEvent& event) {
                         return;
                     }
 
-                    try {
-                        passwordManager.addNewPassword(std::string(service.mb_str()), std::string(username.mb_str()), generatedPassword);
-                        wxMessageBox("Generated password saved successfully.", "Info", wxOK | wxICON_INFORMATION);
-                    }
-                    catch (const std::exception& e) {
-                        wxMessageBox(e.what(), "Error", wxOK | wxICON_ERROR);
-                    }
+                    std::string serviceName(service.mb_str());
+                    std::string serviceUsername(username.mb_str());
+
+                    RunVaultTask("Saving generated password...",
+                        [this, serviceName, serviceUsername, generatedPassword](const ProgressCallback&, const CancellationToken&) {
+                            passwordManager.addNewPassword(serviceName, serviceUsername, generatedPassword);
+                            return true;
+                        },
+                        [](bool) {
+                            wxMessageBox("Generated password saved successfully.", "Info", wxOK | wxICON_INFORMATION);
+                        });
                 }
 
                 saveDialog->Destroy();
@@ -418,55 +606,38 @@ void MainMenuFrame::OnDeletePassword(wxCommandEvent& event) {
             return;
         }
 
-        try {
-            passwordManager.deletePassword(std::string(service.mb_str()));
-            wxMessageBox("Password deleted successfully.", "Info", wxOK | wxICON_INFORMATION);
-        }
-        catch (const std::exception& e) {
-            wxMessageBox(e.what(), "Error", wxOK | wxICON_ERROR);
-        }
+        std::string serviceName(service.mb_str());
+
+        // Removing the entry rewrites the vault, so run it on the worker
+        RunVaultTask("Deleting password...",
+            [this, serviceName](const ProgressCallback&, const CancellationToken&) {
+                passwordManager.deletePassword(serviceName);
+                return true;
+            },
+            [](bool) {
+                wxMessageBox("Password deleted successfully.", "Info", wxOK | wxICON_INFORMATION);
+            });
     }
 
     dialog->Destroy();
 }
 
 void MainMenuFrame::OnViewAllPasswords(wxCommandEvent& event) {
-    wxDialog* dialog = new wxDialog(this, wxID_ANY, "All Stored Passwords", wxDefaultPosition, wxSize(600, 400));
+    wxDialog* dialog = new wxDialog(this, wxID_ANY, "All Stored Passwords", wxDefaultPosition, wxSize(600, 400),
+                                    wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER);
     wxPanel* panel = new wxPanel(dialog, wxID_ANY);
     wxBoxSizer* vbox = new wxBoxSizer(wxVERTICAL);
 
-    // Create a multi-line read-only text control to display passwords
-    wxTextCtrl* passwordsCtrl = new wxTextCtrl(panel, wxID_ANY, "", wxDefaultPosition, wxSize(580, 340), wxTE_MULTILINE | wxTE_READONLY);
-    
-    std::ostringstream oss;
-    std::vector<std::pair<std::string, std::string>> credentials = passwordManager.getAllDecryptedCredentials(); // Assuming you have a method to get all credentials
-
-    if (credentials.empty()) {
-        oss << "No passwords stored.\n";
+    if (passwordManager.getPasswordCount() == 0) {
+        wxStaticText* emptyText = new wxStaticText(panel, wxID_ANY, wxT("No passwords stored."));
+        vbox->Add(emptyText, 1, wxALL, 10);
     }
     else {
-        oss << std::left << std::setw(20) << "Service"
-            << std::setw(20) << "Username"
-            << "Password\n";
-        oss << "------------------------------------------------------------\n";
-        for (const auto& entry : credentials) {
-            std::string service = entry.first;
-            std::string username_password = entry.second;
-
-            size_t delimiter_pos = username_password.find(':');
-            std::string username = (delimiter_pos != std::string::npos) ? username_password.substr(0, delimiter_pos) : username_password;
-            std::string password = (delimiter_pos != std::string::npos) ? username_password.substr(delimiter_pos + 1) : "";
-
-            oss << std::left << std::setw(20) << service
-                << std::setw(20) << username
-                << password << "\n";
-        }
+        // Virtual list: opening is instant regardless of vault size, rows decrypt as they scroll into view
+        CredentialListCtrl* passwordsCtrl = new CredentialListCtrl(panel, passwordManager);
+        vbox->Add(passwordsCtrl, 1, wxEXPAND | wxALL, 10);
     }
 
-    passwordsCtrl->SetValue(oss.str());
-
-    vbox->Add(passwordsCtrl, 1, wxEXPAND | wxALL, 10);
-
     // Close Button
     wxButton* closeButton = new wxButton(panel, wxID_OK, wxT("Close"));
     vbox->Add(closeButton, 0, wxALIGN_CENTER | wxTOP | wxBOTTOM, 10);
@@ -477,6 +648,46 @@ void MainMenuFrame::OnViewAllPasswords(wxCommandEvent& event) {
     dialog->Destroy();
 }
 
+void MainMenuFrame::OnExportVault(wxCommandEvent& event) {
+    wxFileDialog saveDialog(this, "Export Vault", "", passwordManager.getUsername() + "_export.csv",
+                            "CSV files (*.csv)|*.csv|JSON Lines files (*.jsonl)|*.jsonl",
+                            wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (saveDialog.ShowModal() != wxID_OK) {
+        return;
+    }
+
+    std::string exportPath(saveDialog.GetPath().mb_str());
+    std::string vaultPath = passwordManager.getVaultFileName();
+    std::string key = passwordManager.getEncryptionKey();
+    size_t total = passwordManager.getPasswordCount();
+    BatchFormat format = saveDialog.GetFilterIndex() == 1 ? BatchFormat::Jsonl : BatchFormat::Csv;
+
+    RunVaultTask("Exporting vault...",
+        [exportPath, vaultPath, key, total, format](const ProgressCallback& progress, const CancellationToken& cancel) {
+            std::ifstream vault(vaultPath);
+            if (!vault.is_open()) {
+                throw std::ios_base::failure("Unable to open '" + vaultPath + "' for reading.");
+            }
+            std::ofstream output(exportPath, std::ios::trunc);
+            if (!output.is_open()) {
+                throw std::ios_base::failure("Unable to open '" + exportPath + "' for writing.");
+            }
+
+            BatchOptions options;
+            options.format = format;
+            options.cancel = cancel;
+            options.progressInterval = std::max<size_t>(1, total / 100);
+            return exportCredentials(vault, output, key, options, [&progress, total](const BatchStats& stats) {
+                progress(stats.processed + stats.skipped, total);
+            });
+        },
+        [this](const BatchStats& stats) {
+            wxMessageBox(wxString::Format("Exported %lu entries (%lu skipped).",
+                                          static_cast<unsigned long>(stats.processed), static_cast<unsigned long>(stats.skipped)),
+                         "Info", wxOK | wxICON_INFORMATION);
+        });
+}
+
 void MainMenuFrame::OnExit(wxCommandEvent& event) {
     try {
         passwordManager.handleExit();
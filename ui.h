@@ -3,7 +3,14 @@
 #define UI_H
 
 #include <wx/wx.h>
+#include <wx/gauge.h>
+#include <wx/listctrl.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include "manager.h"
+#include "worker_pool.h"
 
 namespace PasswordNS {
 
@@ -14,6 +21,7 @@ class PasswordManager;
 class PasswordManagerApp : public wxApp {
 public:
     virtual bool OnInit();
+    virtual int OnExit();
 };
 
 // Login/Register Frame
@@ -33,10 +41,33 @@ private:
     void OnRegister(wxCommandEvent& event);
 };
 
+// Virtual list of credentials: rows are decrypted a page at a time, only when shown
+class CredentialListCtrl : public wxListCtrl {
+public:
+    CredentialListCtrl(wxWindow* parent, const PasswordManager& manager);
+
+protected:
+    wxString OnGetItemText(long item, long column) const override;
+
+private:
+    static constexpr size_t PageSize = 64;
+    static constexpr size_t MaxCachedPages = 16;
+
+    using Page = std::vector<SecureCredential>; // Passwords stay in a secure arena, wiped on eviction
+
+    const PasswordManager& passwordManager;
+    mutable std::unordered_map<size_t, Page> pages; // page index -> decrypted rows
+    mutable std::list<size_t> pageOrder;            // most recently used page first
+
+    const Page& GetPage(size_t pageIndex) const;
+    void OnCacheHint(wxListEvent& event);
+};
+
 // Main Menu Frame
 class MainMenuFrame : public wxFrame {
 public:
     MainMenuFrame(const wxString& title, PasswordManager& manager);
+    ~MainMenuFrame() override;
 
 private:
     PasswordManager& passwordManager;
@@ -45,14 +76,28 @@ private:
     wxButton* retrievePasswordButton;
     wxButton* deletePasswordButton;
     wxButton* viewAllPasswordsButton;
+    wxButton* exportVaultButton;
     wxButton* exitButton;
+    wxButton* cancelTaskButton;
+    wxGauge* progressGauge;
     wxStaticText* message;
 
+    // Vault operations run one at a time on this single worker so the GUI thread never blocks
+    std::unique_ptr<WorkerPool> vaultWorker;
+    CancellationToken currentTask;
+
+    // Runs work(progress, cancel) on the vault worker and calls onDone(result) back on the GUI thread
+    template <typename Work, typename Done>
+    void RunVaultTask(const wxString& label, Work work, Done onDone);
+    void SetBusy(bool busy, const wxString& label = wxEmptyString);
+
     void OnAddPassword(wxCommandEvent& event);
     void OnGeneratePassword(wxCommandEvent& event);
     void OnRetrievePassword(wxCommandEvent& event);
     void OnDeletePassword(wxCommandEvent& event);
     void OnViewAllPasswords(wxCommandEvent& event);
+    void OnExportVault(wxCommandEvent& event);
+    void OnCancelTask(wxCommandEvent& event);
     void OnExit(wxCommandEvent& event);
 };
 
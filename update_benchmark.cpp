@@ -0,0 +1,113 @@
+// update_benchmark.cpp
+// Measures changing one entry of a large vault: the old delete-then-add pattern,
+// which rewrites the whole vault, against in-place updates and deletes by entry id,
+// which only append to the journal. Also reports the load time with a journal to replay.
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "batch_io.h"
+#include "manager.h"
+
+using namespace PasswordNS;
+
+namespace {
+
+const std::string benchUser = "update_bench_user";
+
+double microsecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Builds a vault of the requested size through the batch importer
+void writeVault(const PasswordManager &manager, size_t entries) {
+    {
+        std::ofstream plain("bench_entries.csv", std::ios::trunc);
+        for (size_t i = 0; i < entries; ++i) {
+            plain << "service" << i << ",user" << i << ",Passw0rd-" << i << "\n";
+        }
+    }
+
+    std::ifstream input("bench_entries.csv");
+    std::ofstream vault(manager.getVaultFileName(), std::ios::trunc);
+    BatchOptions options;
+    options.progressInterval = 0;
+    importCredentials(manager, input, vault, options);
+    std::filesystem::remove("bench_entries.csv");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t entries = argc > 1 ? std::stoull(argv[1]) : 100000;
+    const size_t rewrites = 20;
+    const size_t updates = 2000;
+
+    // Work in a scratch directory so the benchmark never touches real vaults
+    auto originalDirectory = std::filesystem::current_path();
+    auto workDirectory = std::filesystem::temp_directory_path() / "password_manager_update_benchmark";
+    std::filesystem::remove_all(workDirectory);
+    std::filesystem::create_directories(workDirectory);
+    std::filesystem::current_path(workDirectory);
+
+    PasswordManager manager;
+    manager.setCompressOnExit(false);
+    manager.setUsername(benchUser);
+    writeVault(manager, entries);
+    manager.loadCredentialsFromFile();
+    std::cout << "Changing one entry of a " << entries << "-entry vault\n";
+
+    // addNewPassword reports every entry it adds; keep that out of the timings
+    std::streambuf *console = std::cout.rdbuf(nullptr);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rewrites; ++i) {
+        std::string service = "service" + std::to_string(i * entries / rewrites);
+        manager.deletePassword(service);
+        manager.addNewPassword(service, "user", "Changed-Passw0rd-" + std::to_string(i));
+    }
+    double rewriteMicroseconds = microsecondsSince(start) / rewrites;
+    std::cout.rdbuf(console);
+    std::cout << "Delete and re-add (full rewrite):   " << rewriteMicroseconds << " us\n";
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < updates; ++i) {
+        std::vector<EntryId> ids = manager.findEntries("service" + std::to_string((i * 7919 + 1) % entries));
+        if (!ids.empty()) {
+            manager.updatePassword(ids.front(), "Updated-Passw0rd-" + std::to_string(i));
+        }
+    }
+    double updateMicroseconds = microsecondsSince(start) / updates;
+    std::cout << "Update by entry id (journal):       " << updateMicroseconds << " us ("
+              << rewriteMicroseconds / updateMicroseconds << "x faster)\n";
+    std::cout << "Journal size:                       " << std::filesystem::file_size(manager.getJournalFileName())
+              << " bytes\n";
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < updates / 10; ++i) {
+        manager.deleteEntry(manager.findEntries("service" + std::to_string(entries - 1 - i)).front());
+    }
+    std::cout << "Delete by entry id (journal):       " << microsecondsSince(start) / (updates / 10) << " us\n";
+
+    // A load replays the journal onto the vault it was written for
+    PasswordManager reader;
+    reader.setCompressOnExit(false);
+    reader.setUsername(benchUser);
+    start = std::chrono::steady_clock::now();
+    reader.loadCredentialsFromFile();
+    std::cout << "Load with journal replay:           " << microsecondsSince(start) / 1e3 << " ms\n";
+
+    start = std::chrono::steady_clock::now();
+    manager.compactVault();
+    std::cout << "Compaction:                         " << microsecondsSince(start) / 1e3 << " ms\n";
+
+    start = std::chrono::steady_clock::now();
+    reader.loadCredentialsFromFile();
+    std::cout << "Load after compaction:              " << microsecondsSince(start) / 1e3 << " ms\n";
+    bool consistent = reader.getCredentialList().size() == manager.getCredentialList().size();
+
+    std::filesystem::current_path(originalDirectory);
+    std::filesystem::remove_all(workDirectory);
+    return consistent ? 0 : 1;
+}
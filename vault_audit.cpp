@@ -0,0 +1,202 @@
+#include "vault_audit.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include "task_scheduler.h"
+
+namespace PasswordNS {
+
+namespace {
+
+// 128 bits of the HMAC are plenty to tell a million passwords apart and halve the table's memory
+using Fingerprint = std::array<unsigned char, 16>;
+
+struct FingerprintHash {
+    size_t operator()(const Fingerprint &fingerprint) const {
+        uint64_t value;
+        std::memcpy(&value, fingerprint.data(), sizeof(value)); // Already uniformly distributed
+        return static_cast<size_t>(value);
+    }
+};
+
+enum EntryFlags : unsigned char {
+    Weak = 1,
+    Unreadable = 2,
+    Breached = 4,
+};
+
+AuditEntry describeEntry(const CredentialList &credentials, size_t index, const std::vector<signed char> &strengths) {
+    const auto &entry = credentials[index];
+    return {index, entry.first, entry.second.substr(0, entry.second.find(':')), strengths[index]};
+}
+
+// Decrypt, Check and Fingerprint One Block of Entries
+void auditBlock(const PasswordManager &manager, const AuditOptions &options, const CredentialList::Block &block,
+                size_t firstIndex, const std::array<unsigned char, 32> &key, std::vector<Fingerprint> &fingerprints,
+                std::vector<unsigned char> &flags, std::vector<signed char> &strengths) {
+    size_t arenaSize = 0;
+    for (const auto &entry : block.items) {
+        arenaSize += entry.second.size() / 2 + 32;
+    }
+    auto arena = std::make_shared<EncryptionNS::SecureArena>(arenaSize);
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestLength = 0;
+    for (size_t i = 0; i < block.items.size(); ++i) {
+        const std::string &record = block.items[i].second;
+        size_t index = firstIndex + i;
+        size_t delimiter = record.find(':');
+        size_t hexLength = delimiter == std::string::npos ? 0 : record.size() - delimiter - 1;
+        if (hexLength == 0 || hexLength % 32 != 0) {
+            flags[index] = Unreadable;
+            continue;
+        }
+
+        EncryptionNS::SecureString password;
+        try {
+            password = PasswordManager::decryptFromHexSecure(record.substr(delimiter + 1), manager.getEncryptionKey(), arena);
+        } catch (const std::exception &) {
+            flags[index] = Unreadable;
+            continue;
+        }
+
+        HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+             reinterpret_cast<const unsigned char *>(password.data()), password.size(), digest, &digestLength);
+        std::memcpy(fingerprints[index].data(), digest, fingerprints[index].size());
+
+        // validate() takes a std::string, so the temporary copy is wiped straight after
+        std::string candidate = password.str();
+        strengths[index] = static_cast<signed char>(estimateStrength(password.view()).score);
+        if (!manager.validate(candidate) || strengths[index] < options.minimumStrength) {
+            flags[index] |= Weak;
+        }
+        OPENSSL_cleanse(&candidate[0], candidate.size());
+
+        if (options.breaches != nullptr && options.breaches->containsPassword(password.view())) {
+            flags[index] |= Breached;
+        }
+    }
+    OPENSSL_cleanse(digest, sizeof(digest));
+}
+
+} // namespace
+
+size_t AuditReport::reusedEntries() const {
+    size_t total = 0;
+    for (const auto &cluster : reuseClusters) {
+        total += cluster.size();
+    }
+    return total;
+}
+
+// Audit a Vault for Reused, Weak and Unreadable Passwords
+AuditReport auditVault(const PasswordManager &manager, const AuditOptions &options, const ProgressCallback &progress,
+                       const CancellationToken &cancel) {
+    auto start = std::chrono::steady_clock::now();
+    // Workers read a snapshot, so the audit never races with edits to the manager
+    const CredentialList credentials = manager.getCredentialList();
+
+    AuditReport report;
+    report.entries = credentials.size();
+
+    std::array<unsigned char, 32> key;
+    if (RAND_bytes(key.data(), static_cast<int>(key.size())) != 1) {
+        throw std::runtime_error("Unable to generate an audit key.");
+    }
+
+    std::vector<Fingerprint> fingerprints(credentials.size());
+    std::vector<unsigned char> flags(credentials.size(), 0);
+    std::vector<signed char> strengths(credentials.size(), -1);
+
+    // Blocks are immutable and shared by the snapshot, and each task writes its own slots. Up to
+    // options.threads tasks on the shared scheduler take the next block until none is left.
+    std::vector<size_t> firstIndex(credentials.blockCount());
+    for (size_t b = 1; b < credentials.blockCount(); ++b) {
+        firstIndex[b] = firstIndex[b - 1] + credentials.block(b - 1)->items.size();
+    }
+    std::atomic<size_t> nextBlock{0};
+    std::atomic<size_t> completedEntries{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    {
+        TaskGroup group;
+        size_t tasks = std::min(std::max<size_t>(1, options.threads), std::max<size_t>(1, credentials.blockCount()));
+        for (size_t t = 0; t < tasks; ++t) {
+            group.run([&]() {
+                for (size_t b = nextBlock++; b < credentials.blockCount() && !cancel.isCancelled(); b = nextBlock++) {
+                    auto block = credentials.block(b);
+                    try {
+                        auditBlock(manager, options, *block, firstIndex[b], key, fingerprints, flags, strengths);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                    }
+                    completedEntries += block->items.size();
+                }
+            });
+        }
+
+        // Progress is reported from the calling thread, like the other long operations
+        size_t reported = 0;
+        while (!group.waitFor(std::chrono::milliseconds(20))) {
+            if (progress && completedEntries != reported) {
+                reported = completedEntries;
+                progress(reported, credentials.size());
+            }
+        }
+        if (progress && completedEntries != reported) {
+            progress(completedEntries, credentials.size());
+        }
+    }
+    OPENSSL_cleanse(key.data(), key.size());
+
+    cancel.throwIfCancelled();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    // Group equal fingerprints: the first entry with a fingerprint opens a cluster once a second one turns up
+    std::unordered_map<Fingerprint, size_t, FingerprintHash> firstWith;
+    std::unordered_map<size_t, size_t> clusterOf;
+    firstWith.reserve(credentials.size());
+    for (size_t index = 0; index < credentials.size(); ++index) {
+        if (flags[index] & Unreadable) {
+            report.unreadable.push_back(describeEntry(credentials, index, strengths));
+        } else {
+            if (flags[index] & Weak) {
+                report.weak.push_back(describeEntry(credentials, index, strengths));
+            }
+            if (flags[index] & Breached) {
+                report.breached.push_back(describeEntry(credentials, index, strengths));
+            }
+            auto first = firstWith.emplace(fingerprints[index], index);
+            if (!first.second) {
+                auto cluster = clusterOf.emplace(first.first->second, report.reuseClusters.size());
+                if (cluster.second) {
+                    report.reuseClusters.push_back({describeEntry(credentials, first.first->second, strengths)});
+                }
+                report.reuseClusters[cluster.first->second].push_back(describeEntry(credentials, index, strengths));
+            }
+        }
+    }
+    std::stable_sort(report.reuseClusters.begin(), report.reuseClusters.end(),
+                     [](const auto &a, const auto &b) { return a.size() > b.size(); });
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+} // namespace PasswordNS
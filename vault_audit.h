@@ -0,0 +1,56 @@
+#ifndef VAULT_AUDIT_H
+#define VAULT_AUDIT_H
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+#include "breach_corpus.h"
+#include "manager.h"
+#include "worker_pool.h"
+
+namespace PasswordNS
+{
+
+    struct AuditOptions
+    {
+        size_t threads = std::thread::hardware_concurrency(); // Blocks audited at once on the shared scheduler
+        const BreachCorpus *breaches = nullptr;               // Also look every password up here when set
+        int minimumStrength = 2;                              // estimateStrength() score below which a password is weak
+    };
+
+    // One vault entry named in an audit report (index is its position in the vault)
+    struct AuditEntry
+    {
+        size_t index = 0;
+        std::string service;
+        std::string username;
+        int strength = -1; // estimateStrength() score, -1 when the entry did not decrypt
+    };
+
+    struct AuditReport
+    {
+        size_t entries = 0;
+        // Entries sharing one password, largest cluster first; a cluster has at least two entries
+        std::vector<std::vector<AuditEntry>> reuseClusters;
+        std::vector<AuditEntry> weak;       // Passwords that fail validate() or score below minimumStrength
+        std::vector<AuditEntry> breached;   // Passwords found in AuditOptions::breaches
+        std::vector<AuditEntry> unreadable; // Malformed records or ciphertext that does not decrypt
+        double seconds = 0.0;
+
+        size_t reusedEntries() const;
+        double entriesPerSecond() const { return seconds > 0.0 ? entries / seconds : 0.0; }
+    };
+
+    // Decrypts every entry once, in parallel, checking it with validate() and estimateStrength()
+    // (and against the breach corpus, if any) and reducing the plaintext to an HMAC-SHA-256 fingerprint under
+    // a random per-audit key; equal fingerprints are grouped in a hash table. Plaintext only
+    // lives in secure arenas and the fingerprints cannot be compared across audits.
+    // Throws OperationCancelled when cancelled.
+    AuditReport auditVault(const PasswordManager &manager, const AuditOptions &options = AuditOptions(),
+                           const ProgressCallback &progress = ProgressCallback(),
+                           const CancellationToken &cancel = CancellationToken());
+
+} // namespace PasswordNS
+
+#endif
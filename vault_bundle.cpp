@@ -0,0 +1,272 @@
+#include "vault_bundle.h"
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+#include "encryption.h"
+#include "huffman_block.h"
+#include "manager.h"
+
+namespace PasswordNS {
+
+namespace {
+
+const char bundleMagic[] = "PMBUNDL1";
+constexpr size_t magicSize = 8;
+constexpr size_t saltSize = 16;
+constexpr size_t headerSize = magicSize + 4 + saltSize + 12;
+constexpr size_t maxFrameBytes = 64 << 20; // Bounds what a corrupt length field can make the importer allocate
+constexpr uint32_t maxKdfIterations = 10000000;
+
+enum FrameFlags : unsigned char {
+    LastFrame = 1,
+    CompressedFrame = 2,
+};
+
+void putUint32(std::string &out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out += static_cast<char>(value >> (8 * i));
+    }
+}
+
+uint32_t getUint32(const char *in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+// Key, nonce base and header of one bundle; every frame is bound to all three
+struct BundleKey {
+    std::string header;
+    std::string key;
+    EncryptionNS::AeadNonce nonceBase{};
+
+    ~BundleKey() { OPENSSL_cleanse(&key[0], key.size()); }
+
+    EncryptionNS::AeadNonce nonceFor(uint64_t frame) const {
+        EncryptionNS::AeadNonce nonce = nonceBase;
+        for (int i = 0; i < 8; ++i) {
+            nonce[4 + i] ^= static_cast<unsigned char>(frame >> (8 * i));
+        }
+        return nonce;
+    }
+
+    std::string aadFor(uint64_t frame, unsigned char flags) const {
+        std::string aad = header;
+        putUint32(aad, static_cast<uint32_t>(frame));
+        putUint32(aad, static_cast<uint32_t>(frame >> 32));
+        aad += static_cast<char>(flags);
+        return aad;
+    }
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+class FrameWriter {
+public:
+    FrameWriter(std::ostream &out, const BundleKey &bundleKey, bool compress, BundleStats &stats)
+        : out(out), bundleKey(bundleKey), compress(compress), stats(stats) {}
+
+    void write(std::string &payload, bool last) {
+        unsigned char flags = last ? LastFrame : 0;
+        std::string coded;
+        if (compress && !payload.empty()) {
+            coded = compressBlock(payload);
+        }
+        bool compressed = !coded.empty() && coded.size() < payload.size();
+        if (compressed) {
+            flags |= CompressedFrame;
+        }
+
+        std::vector<unsigned char> sealed = EncryptionNS::encryptAead(compressed ? coded : payload, bundleKey.key,
+                                                                      bundleKey.nonceFor(frame),
+                                                                      bundleKey.aadFor(frame, flags));
+        std::string frameHeader(1, static_cast<char>(flags));
+        putUint32(frameHeader, static_cast<uint32_t>(sealed.size()));
+        out.write(frameHeader.data(), static_cast<std::streamsize>(frameHeader.size()));
+        out.write(reinterpret_cast<const char *>(sealed.data()), static_cast<std::streamsize>(sealed.size()));
+        if (!out) {
+            throw std::ios_base::failure("Failed to write bundle frame.");
+        }
+
+        stats.plainBytes += payload.size();
+        stats.bundleBytes += frameHeader.size() + sealed.size();
+        ++stats.frames;
+        ++frame;
+        OPENSSL_cleanse(&payload[0], payload.size());
+        OPENSSL_cleanse(&coded[0], coded.size());
+        payload.clear();
+    }
+
+private:
+    std::ostream &out;
+    const BundleKey &bundleKey;
+    bool compress;
+    BundleStats &stats;
+    uint64_t frame = 0;
+};
+
+} // namespace
+
+// Export a Vault as a Passphrase-Encrypted Bundle
+BundleStats exportBundle(std::istream &vault, std::ostream &bundle, const std::string &passphrase,
+                         const std::string &vaultKey, const BundleOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    if (options.kdfIterations < 1 || static_cast<uint32_t>(options.kdfIterations) > maxKdfIterations) {
+        throw std::invalid_argument("Bundle key derivation needs 1 to 10000000 iterations.");
+    }
+    size_t frameSize = std::clamp<size_t>(options.frameSize, 1, maxFrameBytes / 2);
+
+    BundleKey bundleKey;
+    std::string salt(saltSize, '\0');
+    if (RAND_bytes(reinterpret_cast<unsigned char *>(&salt[0]), static_cast<int>(salt.size())) != 1 ||
+        RAND_bytes(bundleKey.nonceBase.data(), static_cast<int>(bundleKey.nonceBase.size())) != 1) {
+        throw std::runtime_error("Unable to generate a bundle salt.");
+    }
+    bundleKey.header.assign(bundleMagic, magicSize);
+    putUint32(bundleKey.header, static_cast<uint32_t>(options.kdfIterations));
+    bundleKey.header += salt;
+    bundleKey.header.append(reinterpret_cast<const char *>(bundleKey.nonceBase.data()), bundleKey.nonceBase.size());
+    bundleKey.key = EncryptionNS::deriveKey(passphrase, salt, options.kdfIterations);
+
+    BundleStats stats;
+    bundle.write(bundleKey.header.data(), static_cast<std::streamsize>(bundleKey.header.size()));
+    stats.bundleBytes = bundleKey.header.size();
+
+    // Entries keep the vault line format, with the password's plaintext in place of its ciphertext
+    FrameWriter writer(bundle, bundleKey, options.compress, stats);
+    std::string payload;
+    payload.reserve(frameSize + 4096);
+    std::string line;
+    std::pair<std::string, std::string> record;
+    size_t lineNumber = 0;
+    while (std::getline(vault, line)) {
+        ++lineNumber;
+        if (line.empty()) {
+            continue;
+        }
+        size_t colon = std::string::npos;
+        if (PasswordManager::parseVaultRecord(line, record)) {
+            colon = record.second.find(':');
+        }
+        if (colon == std::string::npos) {
+            throw std::invalid_argument("Malformed vault record on line " + std::to_string(lineNumber) + ".");
+        }
+        std::string password = PasswordManager::decryptFromHex(record.second.substr(colon + 1), vaultKey);
+        std::vector<unsigned char> bytes(password.begin(), password.end());
+        OPENSSL_cleanse(&password[0], password.size());
+
+        if (!payload.empty() && payload.size() + line.size() + bytes.size() > frameSize) {
+            writer.write(payload, false);
+        }
+        payload.append(record.first).append(" ").append(record.second, 0, colon + 1);
+        payload.append(EncryptionNS::toHex(bytes)).append("\n");
+        OPENSSL_cleanse(bytes.data(), bytes.size());
+        ++stats.entries;
+    }
+    writer.write(payload, true); // Always present, so a bundle cut at a frame boundary is still caught
+    bundle.flush();
+    if (!bundle) {
+        throw std::ios_base::failure("Failed to write bundle.");
+    }
+    stats.seconds = secondsSince(start);
+    return stats;
+}
+
+// Import the Entries of a Bundle as Vault Records
+BundleStats importBundle(std::istream &bundle, std::ostream &vault, const std::string &passphrase,
+                         const std::string &vaultKey) {
+    auto start = std::chrono::steady_clock::now();
+    BundleKey bundleKey;
+    bundleKey.header.resize(headerSize);
+    if (!bundle.read(&bundleKey.header[0], static_cast<std::streamsize>(headerSize)) ||
+        bundleKey.header.compare(0, magicSize, bundleMagic) != 0) {
+        throw std::invalid_argument("Not a vault bundle.");
+    }
+    uint32_t iterations = getUint32(&bundleKey.header[magicSize]);
+    if (iterations < 1 || iterations > maxKdfIterations) {
+        throw std::invalid_argument("Bundle has an unsupported key derivation setting.");
+    }
+    std::string salt = bundleKey.header.substr(magicSize + 4, saltSize);
+    std::copy(bundleKey.header.begin() + magicSize + 4 + saltSize, bundleKey.header.end(), bundleKey.nonceBase.begin());
+    bundleKey.key = EncryptionNS::deriveKey(passphrase, salt, static_cast<int>(iterations));
+
+    BundleStats stats;
+    stats.bundleBytes = headerSize;
+    std::vector<unsigned char> sealed;
+    std::pair<std::string, std::string> record;
+    for (uint64_t frame = 0;; ++frame) {
+        char frameHeader[5];
+        if (!bundle.read(frameHeader, sizeof(frameHeader))) {
+            throw std::invalid_argument("Bundle is truncated.");
+        }
+        unsigned char flags = static_cast<unsigned char>(frameHeader[0]);
+        uint32_t length = getUint32(frameHeader + 1);
+        if ((flags & ~(LastFrame | CompressedFrame)) != 0 || length > maxFrameBytes) {
+            throw std::invalid_argument("Bundle frame is corrupt.");
+        }
+        sealed.resize(length);
+        if (!bundle.read(reinterpret_cast<char *>(sealed.data()), static_cast<std::streamsize>(length))) {
+            throw std::invalid_argument("Bundle is truncated.");
+        }
+        stats.bundleBytes += sizeof(frameHeader) + length;
+
+        std::string payload = EncryptionNS::decryptAead(sealed, bundleKey.key, bundleKey.nonceFor(frame),
+                                                        bundleKey.aadFor(frame, flags));
+        if (flags & CompressedFrame) {
+            std::string coded = std::move(payload);
+            payload = decompressBlock(coded, maxFrameBytes);
+            OPENSSL_cleanse(&coded[0], coded.size());
+        }
+        stats.plainBytes += payload.size();
+        ++stats.frames;
+
+        // The frame is authentic, so a bad record means a bug rather than tampering; still refuse it
+        for (size_t lineStart = 0; lineStart < payload.size();) {
+            size_t lineEnd = payload.find('\n', lineStart);
+            if (lineEnd == std::string::npos) {
+                throw std::invalid_argument("Bundle frame ends inside a record.");
+            }
+            std::string line = payload.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            size_t colon = std::string::npos;
+            if (PasswordManager::parseVaultRecord(line, record)) {
+                colon = record.second.find(':');
+            }
+            if (colon == std::string::npos) {
+                throw std::invalid_argument("Bundle holds a malformed record.");
+            }
+            std::vector<unsigned char> bytes = EncryptionNS::fromHex(record.second.substr(colon + 1));
+            std::string password(bytes.begin(), bytes.end());
+            vault << record.first << " " << record.second.substr(0, colon + 1)
+                  << PasswordManager::encryptToHex(password, vaultKey) << "\n";
+            OPENSSL_cleanse(bytes.data(), bytes.size());
+            OPENSSL_cleanse(&password[0], password.size());
+            OPENSSL_cleanse(&line[0], line.size());
+            OPENSSL_cleanse(&record.second[0], record.second.size());
+            ++stats.entries;
+        }
+        OPENSSL_cleanse(&payload[0], payload.size());
+
+        if (flags & LastFrame) {
+            break;
+        }
+    }
+    if (bundle.peek() != std::char_traits<char>::eof()) {
+        throw std::invalid_argument("Bundle has data after its last frame.");
+    }
+    vault.flush();
+    if (!vault) {
+        throw std::ios_base::failure("Failed to write vault records.");
+    }
+    stats.seconds = secondsSince(start);
+    return stats;
+}
+
+} // namespace PasswordNS
@@ -0,0 +1,56 @@
+#ifndef VAULT_BUNDLE_H
+#define VAULT_BUNDLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace PasswordNS
+{
+
+    struct BundleOptions
+    {
+        size_t frameSize = 1 << 20; // Plaintext bytes per frame (a longer record gets a frame of its own)
+        bool compress = true;       // Huffman-code frames that shrink by it
+        int kdfIterations = 600000; // PBKDF2 iterations for the passphrase key, written into the bundle
+    };
+
+    struct BundleStats
+    {
+        size_t entries = 0;
+        size_t frames = 0;
+        uint64_t plainBytes = 0;  // Entry text before compression
+        uint64_t bundleBytes = 0; // Bundle size, header included
+        double seconds = 0.0;
+
+        double megabytesPerSecond() const { return seconds > 0.0 ? plainBytes / seconds / 1e6 : 0.0; }
+    };
+
+    // A bundle moves a vault between installations that do not share an encryption key.
+    // It holds the decrypted entries, Huffman-coded, in AES-256-GCM frames under a key
+    // derived from a passphrase:
+    //
+    //   header  "PMBUNDL1", PBKDF2 iterations (u32), salt (16 bytes), nonce base (12 bytes)
+    //   frame   flags (u8: 1 = last, 2 = compressed), sealed length (u32), ciphertext + tag
+    //
+    // Each frame's nonce is the base with the frame number mixed in. Its associated data is
+    // the header, the frame number and the flags, so frames cannot be reordered, moved to
+    // another bundle or dropped from the end. Both directions stream one frame at a time,
+    // so memory use stays constant however large the vault is.
+
+    // Reads "service username:hex" vault records, decrypts them with vaultKey (the vault's
+    // PasswordManager::getEncryptionKey()) and writes a bundle. Throws std::invalid_argument on a
+    // malformed or undecryptable record.
+    BundleStats exportBundle(std::istream &vault, std::ostream &bundle, const std::string &passphrase,
+                             const std::string &vaultKey, const BundleOptions &options = BundleOptions());
+
+    // Reads a bundle and writes its entries as vault records encrypted with vaultKey.
+    // Throws std::invalid_argument for a wrong passphrase or a corrupt, tampered or truncated
+    // bundle; records written before the problem was found must then be discarded.
+    BundleStats importBundle(std::istream &bundle, std::ostream &vault, const std::string &passphrase,
+                             const std::string &vaultKey);
+
+} // namespace PasswordNS
+
+#endif
@@ -0,0 +1,101 @@
+#include "vault_journal.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include "durable_file.h"
+
+namespace PasswordNS {
+
+namespace {
+
+const char journalMagic[] = "vault-journal ";
+
+std::string headerFor(uint64_t base) {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(base));
+    return journalMagic + std::string(hex) + "\n";
+}
+
+std::invalid_argument malformed(const std::string &path, size_t lineNumber) {
+    return std::invalid_argument("Malformed journal record on line " + std::to_string(lineNumber) + " of '" + path + "'.");
+}
+
+} // namespace
+
+// Fingerprint of Vault Contents, Eight Bytes at a Time
+uint64_t vaultFingerprint(const std::string &contents) {
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ contents.size();
+    size_t i = 0;
+    for (; i + 8 <= contents.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, contents.data() + i, 8);
+        hash = (hash ^ word) * 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 32;
+    }
+    for (; i < contents.size(); ++i) {
+        hash = (hash ^ static_cast<unsigned char>(contents[i])) * 0xc4ceb9fe1a85ec53ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    return hash ^ (hash >> 33);
+}
+
+// Append One Edit to the Journal
+size_t appendJournal(const std::string &path, uint64_t base, const JournalEdit &edit, bool startOver, bool sync) {
+    std::string line = edit.kind == JournalEdit::Kind::Set
+                           ? "set " + std::to_string(edit.position) + " " + edit.record + "\n"
+                           : "erase " + std::to_string(edit.position) + "\n";
+    if (startOver) {
+        line = headerFor(base) + line;
+        writeFileAtomically(path, line, sync);
+    } else {
+        appendToFile(path, line, sync);
+    }
+    return line.size();
+}
+
+// Read the Edits Recorded for One Vault Version
+std::vector<JournalEdit> readJournal(const std::string &path, uint64_t base) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return {};
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string header = headerFor(base);
+    if (text.compare(0, header.size(), header) != 0) {
+        return {};
+    }
+
+    std::vector<JournalEdit> edits;
+    size_t lineStart = header.size();
+    size_t lineNumber = 1;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            break; // Torn by a crash mid-append: the edit never completed
+        }
+        ++lineNumber;
+        std::istringstream line(text.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+
+        std::string kind;
+        JournalEdit edit;
+        if (!(line >> kind >> edit.position) || (kind != "set" && kind != "erase")) {
+            throw malformed(path, lineNumber);
+        }
+        if (kind == "set") {
+            if (line.get() != ' ' || !std::getline(line, edit.record) || edit.record.empty()) {
+                throw malformed(path, lineNumber);
+            }
+        } else {
+            edit.kind = JournalEdit::Kind::Erase;
+        }
+        edits.push_back(std::move(edit));
+    }
+    return edits;
+}
+
+} // namespace PasswordNS
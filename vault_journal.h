@@ -0,0 +1,44 @@
+#ifndef VAULT_JOURNAL_H
+#define VAULT_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace PasswordNS
+{
+
+    // One in-place edit of the vault: replace the record at position, or erase it
+    struct JournalEdit
+    {
+        enum class Kind
+        {
+            Set,
+            Erase
+        };
+        Kind kind = Kind::Set;
+        size_t position = 0;
+        std::string record; // "service username:hex" line for Set
+    };
+
+    // Fingerprint of a vault file's contents, naming the version a journal applies to
+    uint64_t vaultFingerprint(const std::string &contents);
+
+    // The journal holds the edits made since the vault file was last written in full. Each
+    // edit is one appended line instead of a rewrite. The first line names the vault contents
+    // it applies to, so a journal left over from before a rewrite (or a vault replaced by sync
+    // or import) is ignored rather than replayed onto the wrong file.
+    //
+    // Appends edit to the journal at path; startOver replaces whatever the file held with a
+    // journal for base. Returns the number of bytes written.
+    size_t appendJournal(const std::string &path, uint64_t base, const JournalEdit &edit, bool startOver, bool sync);
+
+    // Edits recorded for base, oldest first; none when the journal is missing or belongs to
+    // another vault version. A torn last line (from a crash mid-append) is dropped, and any
+    // other malformed line throws std::invalid_argument.
+    std::vector<JournalEdit> readJournal(const std::string &path, uint64_t base);
+
+} // namespace PasswordNS
+
+#endif
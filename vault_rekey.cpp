@@ -0,0 +1,189 @@
+#include "vault_rekey.h"
+#include <openssl/crypto.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "durable_file.h"
+#include "encryption.h"
+#include "manager.h"
+#include "task_scheduler.h"
+
+namespace PasswordNS {
+
+namespace {
+
+const char stateMagic[] = "vault-rekey";
+
+std::string outputPathFor(const std::string &vaultPath) {
+    return vaultPath + ".rekey";
+}
+
+std::string statePathFor(const std::string &vaultPath) {
+    return vaultPath + ".rekey.state";
+}
+
+// Where an interrupted run stopped, and which vault and key it was working on
+struct Checkpoint {
+    uintmax_t vaultBytes = 0;
+    int64_t vaultModified = 0;
+    std::string keyCheck;    // Encryption of a fixed text under the new key (the IV is fixed, so it is stable)
+    uintmax_t inputBytes = 0;  // Vault bytes consumed
+    uintmax_t outputBytes = 0; // Bytes of <vault>.rekey covered by the checkpoint
+    size_t entries = 0;
+
+    std::string serialize() const {
+        std::ostringstream text;
+        text << stateMagic << " " << vaultBytes << " " << vaultModified << " " << keyCheck << " " << inputBytes << " "
+             << outputBytes << " " << entries << "\n";
+        return text.str();
+    }
+
+    static bool parse(const std::string &path, Checkpoint &checkpoint) {
+        std::ifstream file(path);
+        std::string magic;
+        return file >> magic >> checkpoint.vaultBytes >> checkpoint.vaultModified >> checkpoint.keyCheck >>
+                   checkpoint.inputBytes >> checkpoint.outputBytes >> checkpoint.entries &&
+               magic == stateMagic;
+    }
+};
+
+int64_t modifiedTimeOf(const std::string &path) {
+    return static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+}
+
+// Non-empty lines of the vault, for progress reports
+size_t countRecords(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> buffer(1 << 16);
+    size_t records = 0;
+    char previous = '\n';
+    while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0) {
+        size_t length = static_cast<size_t>(file.gcount());
+        for (size_t i = 0; i < length; ++i) {
+            records += buffer[i] != '\n' && previous == '\n';
+            previous = buffer[i];
+        }
+    }
+    return records;
+}
+
+// Re-encrypts one "service username:hex" line, keeping everything but the ciphertext
+std::string rekeyRecord(const std::string &line, const std::string &oldKey, const std::string &newKey) {
+    std::pair<std::string, std::string> record;
+    size_t colon = std::string::npos;
+    if (PasswordManager::parseVaultRecord(line, record)) {
+        colon = record.second.find(':');
+    }
+    if (colon == std::string::npos) {
+        throw std::invalid_argument("Malformed vault record: '" + line + "'.");
+    }
+    std::string password = EncryptionNS::decrypt(EncryptionNS::fromHex(record.second.substr(colon + 1)), oldKey);
+    std::string rekeyed = record.first + " " + record.second.substr(0, colon + 1) +
+                          EncryptionNS::toHex(EncryptionNS::encrypt(password, newKey)) + "\n";
+    OPENSSL_cleanse(&password[0], password.size());
+    return rekeyed;
+}
+
+} // namespace
+
+// Re-Encrypt a Vault File Under a New Key
+RekeyStats rekeyVaultFile(const std::string &vaultPath, const std::string &oldKey, const std::string &newKey,
+                          const RekeyOptions &options, const ProgressCallback &progress,
+                          const CancellationToken &cancel) {
+    auto start = std::chrono::steady_clock::now();
+    std::ifstream vault(vaultPath, std::ios::binary);
+    if (!vault.is_open()) {
+        throw std::ios_base::failure("Unable to open '" + vaultPath + "' for reading.");
+    }
+
+    std::string outputPath = outputPathFor(vaultPath);
+    std::string statePath = statePathFor(vaultPath);
+    Checkpoint current;
+    current.vaultBytes = std::filesystem::file_size(vaultPath);
+    current.vaultModified = modifiedTimeOf(vaultPath);
+    current.keyCheck = EncryptionNS::toHex(EncryptionNS::encrypt(stateMagic, newKey));
+
+    // Resume only a run for this very vault and key whose output is still all there
+    RekeyStats stats;
+    Checkpoint saved;
+    std::error_code error;
+    if (Checkpoint::parse(statePath, saved) && saved.vaultBytes == current.vaultBytes &&
+        saved.vaultModified == current.vaultModified && saved.keyCheck == current.keyCheck &&
+        std::filesystem::file_size(outputPath, error) >= saved.outputBytes && !error) {
+        std::filesystem::resize_file(outputPath, saved.outputBytes); // Drop a chunk written after the checkpoint
+        current = saved;
+        stats.resumedEntries = saved.entries;
+        vault.seekg(static_cast<std::streamoff>(saved.inputBytes));
+    } else {
+        abandonRekey(vaultPath);
+        writeFileAtomically(outputPath, std::string(), options.sync);
+    }
+
+    size_t total = countRecords(vaultPath);
+    size_t chunkSize = std::max<size_t>(1, options.chunkSize);
+    std::vector<std::string> lines;
+    std::vector<std::string> records(chunkSize);
+    size_t sliceCount = std::max<size_t>(1, options.threads);
+
+    while (true) {
+        cancel.throwIfCancelled();
+        lines.clear();
+        std::string line;
+        while (lines.size() < chunkSize && std::getline(vault, line)) {
+            current.inputBytes += line.size() + (vault.eof() ? 0 : 1);
+            if (!line.empty()) {
+                lines.push_back(std::move(line));
+            }
+        }
+        if (lines.empty()) {
+            break;
+        }
+
+        // Contiguous slices on the shared scheduler; every task writes only its own records
+        size_t slice = (lines.size() + sliceCount - 1) / sliceCount;
+        parallelFor(0, lines.size(), slice, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                records[i] = rekeyRecord(lines[i], oldKey, newKey);
+            }
+        });
+
+        // The chunk must be on disk before the checkpoint that covers it
+        std::string chunk;
+        for (size_t i = 0; i < lines.size(); ++i) {
+            chunk += records[i];
+        }
+        appendToFile(outputPath, chunk, options.sync);
+        current.outputBytes += chunk.size();
+        current.entries += lines.size();
+        writeFileAtomically(statePath, current.serialize(), options.sync);
+        ++stats.chunks;
+        if (progress) {
+            progress(current.entries, total);
+        }
+    }
+    vault.close();
+
+    replaceFile(outputPath, vaultPath, options.sync);
+    std::remove(statePath.c_str());
+    stats.entries = current.entries;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+bool hasInterruptedRekey(const std::string &vaultPath) {
+    return std::filesystem::exists(statePathFor(vaultPath));
+}
+
+void abandonRekey(const std::string &vaultPath) {
+    std::remove(statePathFor(vaultPath).c_str());
+    std::remove(outputPathFor(vaultPath).c_str());
+}
+
+} // namespace PasswordNS
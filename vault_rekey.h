@@ -0,0 +1,52 @@
+#ifndef VAULT_REKEY_H
+#define VAULT_REKEY_H
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include "worker_pool.h"
+
+namespace PasswordNS
+{
+
+    struct RekeyOptions
+    {
+        size_t threads = std::thread::hardware_concurrency(); // Slices re-encrypted at once on the shared scheduler (0 = 1)
+        size_t chunkSize = 16384;                             // Entries re-encrypted between checkpoints
+        bool sync = true;                                     // fsync every chunk and checkpoint
+    };
+
+    struct RekeyStats
+    {
+        size_t entries = 0;        // Entries in the re-keyed vault
+        size_t resumedEntries = 0; // Of those, entries an interrupted run had already re-encrypted
+        size_t chunks = 0;         // Chunks re-encrypted by this run
+        double seconds = 0.0;
+
+        double entriesPerSecond() const { return seconds > 0.0 ? (entries - resumedEntries) / seconds : 0.0; }
+    };
+
+    // Re-encrypts every entry of the vault at vaultPath from oldKey to newKey. The vault is
+    // streamed in chunks of options.chunkSize entries, so memory use does not grow with the
+    // vault. Each chunk is re-encrypted in parallel and appended to <vault>.rekey, and a
+    // checkpoint in <vault>.rekey.state records how far the run got. The finished file is then
+    // renamed over the vault, so readers only ever see the vault fully under one key.
+    //
+    // An interrupted run (crash or cancel) resumes from its last checkpoint when called again
+    // with the same newKey. It starts over if the key or the vault has changed since.
+    // Throws std::invalid_argument when a record is malformed or does not decrypt under oldKey,
+    // and OperationCancelled when cancelled. In both cases the vault is left untouched.
+    RekeyStats rekeyVaultFile(const std::string &vaultPath, const std::string &oldKey, const std::string &newKey,
+                              const RekeyOptions &options = RekeyOptions(),
+                              const ProgressCallback &progress = ProgressCallback(),
+                              const CancellationToken &cancel = CancellationToken());
+
+    // True when a re-key of vaultPath was interrupted and can be resumed
+    bool hasInterruptedRekey(const std::string &vaultPath);
+
+    // Drops the partial output of an interrupted re-key
+    void abandonRekey(const std::string &vaultPath);
+
+} // namespace PasswordNS
+
+#endif
@@ -0,0 +1,90 @@
+#include "vault_snapshot.h"
+#include <chrono>
+#include <stdexcept>
+#include "record_schema.h"
+
+namespace PasswordNS {
+
+namespace {
+
+// Snapshot names become file names, so anything that could leave the store is refused
+void checkSnapshotName(const std::string &name) {
+    if (name.empty() || name[0] == '.' || name.find_first_of("/\\") != std::string::npos) {
+        throw std::invalid_argument("Invalid snapshot name: '" + name + "'.");
+    }
+}
+
+std::string serializeBlock(const CredentialList::Block &block) {
+    return vaultText(block.items);
+}
+
+// Length of serializeBlock(block) without building the text
+size_t serializedSize(const CredentialList::Block &block) {
+    return vaultTextSize(block.items);
+}
+
+// Inverse of serializeBlock: one "service username:hex" line per entry
+std::vector<std::pair<std::string, std::string>> parseBlock(const std::string &text) {
+    std::vector<std::pair<std::string, std::string>> items;
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = text.size();
+        }
+        VaultLineView view;
+        if (!VaultLineSchema::decodeText(std::string_view(text).substr(lineStart, lineEnd - lineStart), view)) {
+            throw std::invalid_argument("Malformed snapshot entry.");
+        }
+        items.emplace_back(view.service, view.account);
+        lineStart = lineEnd + 1;
+    }
+    return items;
+}
+
+} // namespace
+
+// Write the Credentials as a Snapshot
+SnapshotStats writeSnapshot(ChunkStore &store, const std::string &name, const CredentialList &credentials) {
+    checkSnapshotName(name);
+    auto start = std::chrono::steady_clock::now();
+
+    SnapshotStats stats;
+    ChunkManifest manifest;
+    for (size_t b = 0; b < credentials.blockCount(); ++b) {
+        CredentialList::BlockPtr block = credentials.block(b);
+        std::string text;
+        if (block->contentId.empty() || !store.hasChunk(block->contentId)) {
+            text = serializeBlock(*block);
+            block->contentId = sha256Hex(text.data(), text.size());
+            if (store.putChunk(block->contentId, text.data(), text.size())) {
+                ++stats.blocksWritten;
+                stats.bytesWritten += text.size();
+            }
+        }
+
+        ChunkRef chunk;
+        chunk.id = block->contentId;
+        chunk.offset = manifest.totalSize;
+        chunk.size = text.empty() ? serializedSize(*block) : text.size();
+        manifest.totalSize += chunk.size;
+        manifest.chunks.push_back(chunk);
+    }
+
+    stats.blocks = manifest.chunks.size();
+    stats.bytesWritten += store.putManifest(name, manifest);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+// Read a Snapshot
+CredentialList readSnapshot(const ChunkStore &store, const std::string &name) {
+    checkSnapshotName(name);
+    CredentialList credentials;
+    for (const auto &chunk : store.getManifest(name).chunks) {
+        credentials.appendBlock(parseBlock(store.getChunk(chunk.id)), chunk.id);
+    }
+    return credentials;
+}
+
+} // namespace PasswordNS
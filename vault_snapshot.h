@@ -0,0 +1,32 @@
+#ifndef VAULT_SNAPSHOT_H
+#define VAULT_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "chunk_sync.h"
+#include "manager.h"
+
+namespace PasswordNS
+{
+
+    // What writing a snapshot cost
+    struct SnapshotStats
+    {
+        size_t blocks = 0;        // Blocks referenced by the snapshot
+        size_t blocksWritten = 0; // Blocks not already in the store
+        uint64_t bytesWritten = 0; // New block bytes plus the manifest
+        double seconds = 0.0;
+    };
+
+    // Stores each credential block as a chunk (in vault line format) and a manifest listing
+    // them under name. Blocks shared with earlier snapshots are neither re-hashed nor re-written.
+    // Not safe to call concurrently on lists that share blocks (each block caches its hash).
+    SnapshotStats writeSnapshot(ChunkStore &store, const std::string &name, const CredentialList &credentials);
+
+    // Reads a snapshot back; every stored block becomes one block of the result
+    CredentialList readSnapshot(const ChunkStore &store, const std::string &name);
+
+} // namespace PasswordNS
+
+#endif
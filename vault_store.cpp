@@ -0,0 +1,371 @@
+#include "vault_store.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+namespace PasswordNS {
+
+namespace {
+
+const std::string vaultSuffix = "_passwords.dat";
+
+// FNV-1a: cheap, stable across platforms and runs, and spreads similar names well
+uint64_t hashUsername(const std::string &username) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : username) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Usernames become file names, so anything that could escape the shard directory is refused
+void checkUsername(const std::string &username) {
+    if (username.empty() || username[0] == '.' || username.find_first_of("/\\") != std::string::npos) {
+        throw std::invalid_argument("Invalid username for the vault store: '" + username + "'.");
+    }
+}
+
+// Decrypts every entry, reporting the first record that is not "username:<hex ciphertext>"
+std::string verifyVault(const PasswordManager &manager) {
+    const CredentialList &credentials = manager.getCredentialList();
+    auto arena = std::make_shared<EncryptionNS::SecureArena>();
+    for (size_t i = 0; i < credentials.size(); ++i) {
+        const std::string &record = credentials[i].second;
+        size_t delimiter = record.find(':');
+        size_t hexLength = delimiter == std::string::npos ? 0 : record.size() - delimiter - 1;
+        if (hexLength == 0 || hexLength % 32 != 0) {
+            return "Malformed entry " + std::to_string(i + 1) + " (" + credentials[i].first + ").";
+        }
+        try {
+            PasswordManager::decryptFromHexSecure(record.substr(delimiter + 1), manager.getEncryptionKey(), arena);
+        } catch (const std::exception &e) {
+            return "Entry " + std::to_string(i + 1) + " (" + credentials[i].first + ") does not decrypt: " + e.what();
+        }
+    }
+    return "";
+}
+
+std::string describeError(const std::exception_ptr &error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception &e) {
+        return e.what();
+    } catch (...) {
+        return "Unknown error.";
+    }
+}
+
+} // namespace
+
+VaultStore::VaultStore(std::string root, VaultStoreOptions storeOptions)
+    : rootDirectory(std::move(root)), options(storeOptions) {
+    options.shardCount = std::max<size_t>(1, options.shardCount);
+    options.cacheCapacity = std::max<size_t>(1, options.cacheCapacity);
+    std::filesystem::create_directories(rootDirectory);
+}
+
+// Locate a User's Shard
+std::string VaultStore::shardDirectoryFor(const std::string &username) const {
+    checkUsername(username);
+
+    // Fixed-width hex names (e.g. "00".."ff" for 256 shards) keep listings sorted
+    int width = 1;
+    for (size_t n = options.shardCount - 1; n > 15; n >>= 4) {
+        ++width;
+    }
+    width = std::min(width, 16); // A size_t needs no more; tells the compiler the name fits
+    char shard[17];
+    std::snprintf(shard, sizeof(shard), "%0*llx", width,
+                  static_cast<unsigned long long>(hashUsername(username) % options.shardCount));
+    return rootDirectory + "/" + shard;
+}
+
+std::string VaultStore::vaultPathFor(const std::string &username) const {
+    return shardDirectoryFor(username) + "/" + username + vaultSuffix;
+}
+
+bool VaultStore::contains(const std::string &username) const {
+    return std::filesystem::exists(vaultPathFor(username));
+}
+
+// Create a Manager for One User's Vault
+std::shared_ptr<PasswordManager> VaultStore::loadVault(const std::string &username, const std::string *contents) const {
+    auto manager = std::make_shared<PasswordManager>();
+    manager->setCompressOnExit(false); // The store never owns user_credentials.csv
+    manager->setUsername(username);
+    manager->setVaultDirectory(shardDirectoryFor(username));
+    manager->setDurability(options.durability);
+    if (options.encryptionKey) {
+        manager->setEncryptionKey(options.encryptionKey(username));
+    }
+
+    if (contents != nullptr) {
+        manager->loadCredentialsFrom(*contents);
+    } else if (std::filesystem::exists(manager->getVaultFileName())) {
+        manager->loadCredentialsFromFile();
+    } else {
+        std::filesystem::create_directories(manager->getVaultDirectory());
+    }
+    return manager;
+}
+
+// Add a Loaded Vault to the Cache, Evicting the Least Recently Used
+std::shared_ptr<PasswordManager> VaultStore::insert(const std::string &username,
+                                                    std::shared_ptr<PasswordManager> manager) {
+    std::shared_ptr<PasswordManager> evicted; // Destroyed outside the lock; it may flush to disk
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Another thread may have loaded the same vault meanwhile; keep the instance already handed out
+    auto found = index.find(username);
+    if (found != index.end()) {
+        recent.splice(recent.begin(), recent, found->second);
+        return found->second->second;
+    }
+
+    recent.emplace_front(username, std::move(manager));
+    index[username] = recent.begin();
+    if (recent.size() > options.cacheCapacity) {
+        evicted = std::move(recent.back().second);
+        index.erase(recent.back().first);
+        recent.pop_back();
+    }
+    return recent.front().second;
+}
+
+// Open a User's Vault
+std::shared_ptr<PasswordManager> VaultStore::open(const std::string &username) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(username);
+        if (found != index.end()) {
+            recent.splice(recent.begin(), recent, found->second);
+            return found->second->second;
+        }
+    }
+
+    // Load without holding the lock so misses on different users run concurrently
+    return insert(username, loadVault(username));
+}
+
+void VaultStore::evict(const std::string &username) {
+    std::shared_ptr<PasswordManager> evicted;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(username);
+    if (found != index.end()) {
+        evicted = std::move(found->second->second);
+        recent.erase(found->second);
+        index.erase(found);
+    }
+}
+
+size_t VaultStore::residentCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recent.size();
+}
+
+// List Every User with a Vault in the Store
+std::vector<std::string> VaultStore::listUsers() const {
+    std::vector<std::string> users;
+    for (const auto &shard : std::filesystem::directory_iterator(rootDirectory)) {
+        if (!shard.is_directory()) {
+            continue;
+        }
+        for (const auto &file : std::filesystem::directory_iterator(shard.path())) {
+            std::string name = file.path().filename().string();
+            if (file.is_regular_file() && name.size() > vaultSuffix.size() &&
+                name.compare(name.size() - vaultSuffix.size(), vaultSuffix.size(), vaultSuffix) == 0) {
+                users.push_back(name.substr(0, name.size() - vaultSuffix.size()));
+            }
+        }
+    }
+    std::sort(users.begin(), users.end());
+    return users;
+}
+
+// Load (and Verify) Many Vaults in Parallel
+PreloadReport VaultStore::preload(const std::vector<std::string> &usernames, bool verify,
+                                  const ProgressCallback &progress, const CancellationToken &cancel) {
+    auto start = std::chrono::steady_clock::now();
+    PreloadReport report;
+
+    std::mutex reportMutex;
+    std::condition_variable finished;
+    size_t completed = 0;
+    size_t unparsed = 0; // Vault files read or being read whose task has not finished
+    {
+        // Files are read in batches by the I/O engine and parsed on the pool as each read completes.
+        // The pool outlives the engine, whose destructor waits for the reads that feed it; the pool's
+        // then waits for stragglers on every exit path.
+        WorkerPool pool(std::min(std::max<size_t>(1, options.threads), std::max<size_t>(1, usernames.size())));
+        AsyncFileIO io(options.io);
+        auto loadTask = [&](const std::string &username, std::shared_ptr<std::string> contents) {
+            VaultCheck check;
+            check.username = username;
+            if (!cancel.isCancelled()) {
+                try {
+                    auto manager = loadVault(username, contents.get());
+                    check.entries = manager->getPasswordCount();
+                    if (verify) {
+                        check.error = verifyVault(*manager);
+                    }
+                    if (check.error.empty()) {
+                        insert(username, std::move(manager));
+                    }
+                } catch (const std::exception &e) {
+                    check.error = e.what();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(reportMutex);
+            if (!check.error.empty()) {
+                ++report.failed;
+                report.failures.push_back(std::move(check));
+            } else {
+                ++report.loaded;
+            }
+            ++completed;
+            --unparsed;
+            finished.notify_one();
+        };
+
+        // Progress is reported from the calling thread, like the other long operations
+        size_t reported = 0;
+        auto waitUntil = [&](std::unique_lock<std::mutex> &lock, auto done) {
+            while (!done()) {
+                finished.wait(lock);
+                if (progress && completed != reported) {
+                    reported = completed;
+                    lock.unlock();
+                    progress(reported, usernames.size());
+                    lock.lock();
+                }
+            }
+        };
+
+        // Bounds the vault contents waiting for a worker
+        size_t readAhead = std::max<size_t>(1, options.io.queueDepth) * 2 + pool.size();
+        for (const auto &username : usernames) {
+            {
+                std::unique_lock<std::mutex> lock(reportMutex);
+                waitUntil(lock, [&] { return unparsed < readAhead; });
+                ++unparsed;
+            }
+            std::string path;
+            try {
+                path = vaultPathFor(username);
+            } catch (const std::exception &) {
+                // Reported by the task, which checks the name again
+            }
+            if (path.empty() || cancel.isCancelled()) {
+                pool.submit([&, username]() { loadTask(username, nullptr); });
+                continue;
+            }
+            io.read(path, [&, username](std::string contents, std::exception_ptr error) {
+                // A vault that cannot be read here is opened the usual way, which also starts missing ones
+                auto read = error ? nullptr : std::make_shared<std::string>(std::move(contents));
+                pool.submit([&, username, read]() { loadTask(username, read); });
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(reportMutex);
+        waitUntil(lock, [&] { return completed == usernames.size(); });
+        if (progress && reported != completed) {
+            progress(completed, usernames.size());
+        }
+    }
+
+    cancel.throwIfCancelled();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+PreloadReport VaultStore::preloadAll(bool verify, const ProgressCallback &progress, const CancellationToken &cancel) {
+    return preload(listUsers(), verify, progress, cancel);
+}
+
+// Copy Many Vaults with Batched Reads and Writes
+ExportReport VaultStore::exportVaults(const std::vector<std::string> &usernames, const std::string &directory, bool sync,
+                                      const ProgressCallback &progress, const CancellationToken &cancel) {
+    auto start = std::chrono::steady_clock::now();
+    const std::string suffixes[] = {vaultSuffix, "_passwords.journal", "_metadata.dat"};
+    const size_t batchSize = 256; // Users per batch; bounds the file contents held at once
+    ExportReport report;
+    std::filesystem::create_directories(directory);
+    AsyncFileIO io(options.io);
+
+    for (size_t first = 0; first < usernames.size(); first += batchSize) {
+        cancel.throwIfCancelled();
+        size_t last = std::min(usernames.size(), first + batchSize);
+        std::vector<std::string> paths;
+        std::vector<size_t> owners; // Index into usernames of each path
+        std::vector<bool> failed(last - first, false);
+        for (size_t i = first; i < last; ++i) {
+            try {
+                std::string base = shardDirectoryFor(usernames[i]) + "/" + usernames[i];
+                for (const auto &suffix : suffixes) {
+                    paths.push_back(base + suffix);
+                    owners.push_back(i);
+                }
+            } catch (const std::exception &e) {
+                failed[i - first] = true;
+                report.failures.push_back({usernames[i], 0, e.what()});
+            }
+        }
+
+        // Journals and metadata files are optional; a vault that cannot be read fails its user
+        std::vector<FileResult> reads = io.readAll(paths);
+        std::vector<std::pair<std::string, std::string>> writes;
+        std::vector<size_t> writeOwners;
+        for (size_t k = 0; k < reads.size(); ++k) {
+            bool isVault = k % 3 == 0;
+            if (reads[k].error) {
+                if (isVault) {
+                    failed[owners[k] - first] = true;
+                    report.failures.push_back({usernames[owners[k]], 0, describeError(reads[k].error)});
+                }
+                continue;
+            }
+            if (!failed[owners[k] - first]) {
+                writes.emplace_back(directory + "/" + usernames[owners[k]] + suffixes[k % 3], std::move(reads[k].contents));
+                writeOwners.push_back(owners[k]);
+            }
+        }
+        std::vector<uint64_t> sizes;
+        for (const auto &write : writes) {
+            sizes.push_back(write.second.size());
+        }
+
+        std::vector<FileResult> written = io.writeAll(std::move(writes), sync);
+        for (size_t k = 0; k < written.size(); ++k) {
+            size_t owner = writeOwners[k];
+            if (written[k].error) {
+                if (!failed[owner - first]) {
+                    failed[owner - first] = true;
+                    report.failures.push_back({usernames[owner], 0, describeError(written[k].error)});
+                }
+                continue;
+            }
+            ++report.files;
+            report.bytes += sizes[k];
+        }
+        for (size_t i = first; i < last; ++i) {
+            report.vaults += failed[i - first] ? 0 : 1;
+        }
+        if (progress) {
+            progress(last, usernames.size());
+        }
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+ExportReport VaultStore::exportAll(const std::string &directory, bool sync, const ProgressCallback &progress,
+                                   const CancellationToken &cancel) {
+    return exportVaults(listUsers(), directory, sync, progress, cancel);
+}
+
+} // namespace PasswordNS
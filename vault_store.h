@@ -0,0 +1,123 @@
+#ifndef VAULT_STORE_H
+#define VAULT_STORE_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "async_io.h"
+#include "manager.h"
+#include "worker_pool.h"
+
+namespace PasswordNS
+{
+
+    // Tuning knobs for a multi-user vault store
+    struct VaultStoreOptions
+    {
+        size_t shardCount = 256;                              // Subdirectories vaults are spread over
+        size_t cacheCapacity = 1024;                          // Loaded vaults kept resident (LRU)
+        size_t threads = std::thread::hardware_concurrency(); // Workers used by preload (0 = 1)
+        Durability durability = Durability::Atomic;           // Applied to every managed vault
+        AsyncIoOptions io;                                    // Batched file reads and writes (preload, export)
+        // Key of each user's vault (PasswordManager::setEncryptionKey()); unset means the default key.
+        // Preload calls it from several threads at once.
+        std::function<std::string(const std::string &username)> encryptionKey;
+    };
+
+    // Result of loading (and optionally verifying) one vault
+    struct VaultCheck
+    {
+        std::string username;
+        size_t entries = 0;
+        std::string error; // Empty when the vault loaded cleanly
+    };
+
+    // Outcome of a preload
+    struct PreloadReport
+    {
+        size_t loaded = 0;
+        size_t failed = 0;
+        double seconds = 0.0;
+        std::vector<VaultCheck> failures;
+
+        double vaultsPerSecond() const { return seconds > 0.0 ? (loaded + failed) / seconds : 0.0; }
+    };
+
+    // Outcome of an export
+    struct ExportReport
+    {
+        size_t vaults = 0;
+        size_t files = 0;   // Vault files plus the journals and metadata files beside them
+        uint64_t bytes = 0;
+        double seconds = 0.0;
+        std::vector<VaultCheck> failures;
+    };
+
+    // Holds many users' vaults under rootDirectory/<shard>/<user>_passwords.dat, where the
+    // shard is a hash of the username, so no directory grows past a few thousand files.
+    // Recently used vaults stay loaded; open() hands out shared instances, so an evicted
+    // vault stays valid for callers that still hold it. All methods are thread-safe, but
+    // a single PasswordManager is not: callers sharing one must serialize access to it.
+    class VaultStore
+    {
+    private:
+        using CacheEntry = std::pair<std::string, std::shared_ptr<PasswordManager>>;
+
+        std::string rootDirectory;
+        VaultStoreOptions options;
+
+        mutable std::mutex mutex;
+        std::list<CacheEntry> recent; // Most recently used first
+        std::unordered_map<std::string, std::list<CacheEntry>::iterator> index;
+
+        // With contents, the vault file has already been read
+        std::shared_ptr<PasswordManager> loadVault(const std::string &username, const std::string *contents = nullptr) const;
+        std::shared_ptr<PasswordManager> insert(const std::string &username, std::shared_ptr<PasswordManager> manager);
+
+    public:
+        explicit VaultStore(std::string root, VaultStoreOptions storeOptions = VaultStoreOptions());
+
+        VaultStore(const VaultStore &) = delete;
+        VaultStore &operator=(const VaultStore &) = delete;
+
+        // Shard directory and vault path of a user (throws invalid_argument for unsafe names)
+        std::string shardDirectoryFor(const std::string &username) const;
+        std::string vaultPathFor(const std::string &username) const;
+
+        // Returns the user's vault, loading it (or starting an empty one) on a cache miss
+        std::shared_ptr<PasswordManager> open(const std::string &username);
+
+        bool contains(const std::string &username) const;
+        std::vector<std::string> listUsers() const;
+
+        // Loads vaults in parallel into the cache; with verify, every entry is also decrypted
+        PreloadReport preload(const std::vector<std::string> &usernames, bool verify,
+                              const ProgressCallback &progress = ProgressCallback(),
+                              const CancellationToken &cancel = CancellationToken());
+        PreloadReport preloadAll(bool verify, const ProgressCallback &progress = ProgressCallback(),
+                                 const CancellationToken &cancel = CancellationToken());
+
+        // Copies each user's vault file, and its journal and metadata file when present, into directory,
+        // where a PasswordManager with that vault directory reads them. The files are read and written in
+        // batches through AsyncFileIO. What is on disk is exported, so flush open vaults first.
+        ExportReport exportVaults(const std::vector<std::string> &usernames, const std::string &directory, bool sync,
+                                  const ProgressCallback &progress = ProgressCallback(),
+                                  const CancellationToken &cancel = CancellationToken());
+        ExportReport exportAll(const std::string &directory, bool sync, const ProgressCallback &progress = ProgressCallback(),
+                               const CancellationToken &cancel = CancellationToken());
+
+        void evict(const std::string &username);
+        size_t residentCount() const;
+        const std::string &getRootDirectory() const { return rootDirectory; }
+    };
+
+} // namespace PasswordNS
+
+#endif
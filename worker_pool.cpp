@@ -0,0 +1,63 @@
+#include "worker_pool.h"
+#include <algorithm>
+#include <iostream>
+
+namespace PasswordNS {
+
+// Start the Worker Threads
+WorkerPool::WorkerPool(size_t threadCount) {
+    threadCount = std::max<size_t>(1, threadCount);
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+// Drain the Queue and Join the Workers
+WorkerPool::~WorkerPool() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+// Queue a Task
+void WorkerPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            throw std::runtime_error("Cannot submit tasks to a stopping worker pool.");
+        }
+        tasks.push(std::move(task));
+    }
+    available.notify_one();
+}
+
+// Run Tasks Until the Pool Stops
+void WorkerPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // Stopping and nothing left to run
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        try {
+            task();
+        } catch (const std::exception &e) {
+            // Tasks report their own errors; never let one take down the pool
+            std::cerr << "Unhandled exception in worker task: " << e.what() << std::endl;
+        }
+    }
+}
+
+} // namespace PasswordNS
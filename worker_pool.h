@@ -0,0 +1,73 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace PasswordNS
+{
+
+    // Reports progress of a long operation as (completed, total) entries
+    using ProgressCallback = std::function<void(size_t completed, size_t total)>;
+
+    // Thrown by long operations when their cancellation token is triggered
+    class OperationCancelled : public std::runtime_error
+    {
+    public:
+        OperationCancelled() : std::runtime_error("Operation cancelled.") {}
+    };
+
+    // Shared cancellation flag; copies observe the same state
+    class CancellationToken
+    {
+    private:
+        std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+
+    public:
+        void cancel() const { flag->store(true, std::memory_order_relaxed); }
+        bool isCancelled() const { return flag->load(std::memory_order_relaxed); }
+
+        // Convenience for loops: throws OperationCancelled once cancelled
+        void throwIfCancelled() const
+        {
+            if (isCancelled())
+            {
+                throw OperationCancelled();
+            }
+        }
+    };
+
+    // Fixed-size pool of threads draining a FIFO task queue
+    class WorkerPool
+    {
+    private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable available;
+        bool stopping = false;
+
+        void workerLoop();
+
+    public:
+        explicit WorkerPool(size_t threadCount = std::thread::hardware_concurrency());
+        ~WorkerPool() noexcept; // Finishes queued tasks, then joins the workers
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        void submit(std::function<void()> task);
+        size_t size() const { return workers.size(); }
+    };
+
+} // namespace PasswordNS
+
+#endif